@@ -121,9 +121,10 @@ typedef struct _BalMatrix{} BalMatrix;
 
 namespace WKAL {
     class FloatSize;
+    struct PathStorage;
 
-    typedef void*           PlatformGradient;
-    typedef void*           PlatformPath;
+    typedef uint32_t*       PlatformGradient;   // A color ramp for EA::Raster::GradientFill. See BCGradientEA.cpp
+    typedef PathStorage     PlatformPath;       // See BCPathEA.h
     typedef int             PlatformCursor;     // This is a guid or enum id.
     typedef BalWidget*      PlatformWidget;     // PlatformWidget refers to the platform-specfic viewport. For Windows this would typically be HWND. In the simplest case it is an ARGB buffer.
     typedef void*           DragImageRef;
@@ -58,6 +58,9 @@ double       gLastFireTime = 0;
 
 static double sFireTimerRate = 0.033;   // 30Hz as default       
 
+static double sTickDeadline = 0;        // 0 means no deadline.
+static bool   sTimersYielded = false;   // True if the last firing ran into the tick deadline, which may have left due timers unfired.
+
 
 void setSharedTimerFiredFunction(void (*f)()) 
 {
@@ -106,6 +109,24 @@ double GetFireTimerRate()
 }
 
 
+void setTickDeadline(double deadline)
+{
+    sTickDeadline = deadline;
+}
+
+
+double tickDeadline()
+{
+    return sTickDeadline;
+}
+
+
+bool tickDeadlinePassed()
+{
+    return sTickDeadline && (OWBAL::currentTime() >= sTickDeadline);
+}
+
+
 
 
 // The fire time is relative to the classic POSIX epoch of January 1, 1970,
@@ -163,8 +184,10 @@ void fireTimerIfNeeded()
     const double currentTime = OWBAL::currentTime();
 
     //Note by Arpit Baldeva - 0.033333f means 30 frames per second. Originally it was 0.10.
-	if(currentTime >= (gLastCheckTime + sFireTimerRate)) // We don't want to have the possibility of firing very soon, as some JavaScript appears to be dependent on a minimum time between ticks.
+    // Timers left over from a firing that hit the tick deadline were already due, so they don't wait for the rate.
+	if(sTimersYielded || (currentTime >= (gLastCheckTime + sFireTimerRate))) // We don't want to have the possibility of firing very soon, as some JavaScript appears to be dependent on a minimum time between ticks.
     {
+        sTimersYielded = false;
         gLastCheckTime = currentTime;
 
         //+ 1/20/10 CSidhall - Added collection of all expired timers and shrinking of the fire timer array.
@@ -187,6 +210,7 @@ void fireTimerIfNeeded()
             gFireTimeCount -=foundCount;
             gLastFireTime = currentTime;
             gSharedTimerFiredFunction();
+            sTimersYielded = tickDeadlinePassed();
         }
 
     }
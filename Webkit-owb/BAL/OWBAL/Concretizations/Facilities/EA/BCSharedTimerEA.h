@@ -59,6 +59,13 @@ namespace OWBAL {
     // Min Rate set by user in params 
     void setFireTimerRate(EA::WebKit::FireTimerRate rate);
     double GetFireTimerRate();
+
+    // The time (as currentTime()) by which the work done in the current View tick should yield, 
+    // or 0 if there is no limit. Timers, main thread functions, transport jobs and painting check 
+    // this between units of work and leave the rest for the next tick.
+    void setTickDeadline(double deadline);
+    double tickDeadline();
+    bool tickDeadlinePassed();
 }
 
 #endif
@@ -33,6 +33,7 @@
 #include "cache.h"              // For the prune
 #include <EAWebKit/internal/EAWebKitAssert.h>
 #include <stdio.h>
+#include <algorithm>
 
 #if PLATFORM(CAIRO) || PLATFORM(QT) || PLATFORM(WX) || PLATFORM(BAL)
 
@@ -175,6 +176,13 @@ RGBA32Buffer* GIFImageDecoder::frameBufferAtIndex(size_t index)
     if (index >= (unsigned)frameCount())
         return 0;
 
+    // A streaming animation frees the frames it moves past, and the reader once it gets to the end.
+    if (m_streamingAnimation && !m_failed) {
+        const RGBA32Buffer& frame = m_frameBufferCache[index];
+        if ((frame.status() == RGBA32Buffer::FrameComplete) ? frame.bytes().isEmpty() : !m_reader)
+            restartAnimation();
+    }
+
     RGBA32Buffer& frame = m_frameBufferCache[index];
     if (frame.status() != RGBA32Buffer::FrameComplete && m_reader)
         // Decode this frame.
@@ -208,6 +216,33 @@ void GIFImageDecoder::decodingHalted(unsigned bytesLeft)
     m_reader->setReadOffset(m_data->size() - bytesLeft);
 }
 
+void GIFImageDecoder::releaseFrameBuffers(unsigned frameIndex)
+{
+    // The next frame starts from this one, or from the last one before it that isn't disposed of
+    // by restoring the previous frame (see initFrameBuffer).
+    unsigned startIndex = frameIndex;
+    while ((startIndex > 0) &&
+            (m_frameBufferCache[startIndex].disposalMethod() == RGBA32Buffer::DisposeOverwritePrevious))
+        --startIndex;
+
+    // The buffers keep their rect, duration and disposal method, and their status stays complete.
+    for (unsigned i = 0; i < frameIndex; ++i) {
+        if (i != startIndex)
+            m_frameBufferCache[i].bytes().shrinkCapacity(0);
+    }
+}
+
+void GIFImageDecoder::restartAnimation()
+{
+    // The frame count is kept. The frames get decoded again in order as they are asked for.
+    const size_t frameCount = m_frameBufferCache.size();
+    m_frameBufferCache.clear();
+    m_frameBufferCache.resize(frameCount);
+
+    delete m_reader;
+    m_reader = new GIFImageDecoderPrivate(this);
+}
+
 void GIFImageDecoder::initFrameBuffer(unsigned frameIndex)
 {
     // Initialize the frame rect in our buffer.
@@ -231,7 +266,8 @@ void GIFImageDecoder::initFrameBuffer(unsigned frameIndex)
         //+ 7/13/09 CSidhall - Added extra size verification in case buffer was resized
         RGBA32Array& bytes = buffer->bytes();
         int curSize = bytes.size(); // Verify that buffer is actually there
-        int size = m_size.width() * m_size.height(); 
+        const IntSize decodedSize = scaledSize();
+        int size = decodedSize.width() * decodedSize.height(); 
         if(curSize != size)
             prepEmptyFrameBuffer(buffer);
         //-CS
@@ -269,12 +305,15 @@ void GIFImageDecoder::initFrameBuffer(unsigned frameIndex)
                 prepEmptyFrameBuffer(buffer);
             } else {
               // Copy the whole previous buffer, then clear just its frame.
+              // The frame rect is in full size coordinates, so clear the
+              // sampled rows and columns that fall inside it.
               buffer->bytes() = prevBuffer->bytes();
               buffer->setHasAlpha(prevBuffer->hasAlpha());
-              for (int y = prevRect.y(); y < prevRect.bottom(); ++y) {
+              const int width = scaledSize().width();
+              for (int y = scaledUpperBound(prevRect.y()); y < scaledUpperBound(prevRect.bottom()); ++y) {
                   unsigned* const currentRow =
-                      buffer->bytes().data() + (y * m_size.width());
-                  for (int x = prevRect.x(); x < prevRect.right(); ++x)
+                      buffer->bytes().data() + (y * width);
+                  for (int x = scaledUpperBound(prevRect.x()); x < scaledUpperBound(prevRect.right()); ++x)
                       buffer->setRGBA(*(currentRow + x), 0, 0, 0, 0);
               }
               if ((prevRect.width() > 0) && (prevRect.height() > 0))
@@ -299,11 +338,13 @@ void GIFImageDecoder::prepEmptyFrameBuffer(RGBA32Buffer* buffer)
     if(!buffer)
         return;
     buffer->setHasAlpha(true);   
-    int size = m_size.width() * m_size.height();        
+    lockScale();
+    const IntSize decodedSize = scaledSize();
+    int size = decodedSize.width() * decodedSize.height();        
     setImagePruneLockStatus(true);  // Lock against pruning this resource   
 #ifdef _DEBUG   
     static bool overflowFlag = false;    // Avoid too many asserts
-    bool cachePrune = cache()->pruneImages(size << 2);
+    bool cachePrune = decodingOffMainThread() || cache()->pruneImages(size << 2);
     if(cachePrune == false){
         if(!overflowFlag){
             char buffer[256];
@@ -315,7 +356,8 @@ void GIFImageDecoder::prepEmptyFrameBuffer(RGBA32Buffer* buffer)
         // return false;
     }
 #else
-    cache()->pruneImages(size << 2);
+    if (!decodingOffMainThread())
+        cache()->pruneImages(size << 2);
 #endif
     setImagePruneLockStatus(false);  // Unlock
 
@@ -342,9 +384,20 @@ void GIFImageDecoder::haveDecodedRow(unsigned frameIndex,
         return;
 
     // Do nothing for bogus data.
-    if (rowBuffer == 0 || static_cast<int>(m_reader->frameYOffset() + rowNumber) >= m_size.height())
+    const int y = m_reader->frameYOffset() + rowNumber;
+    if (rowBuffer == 0 || y >= m_size.height())
       return;
 
+    // When decoding scaled down only every (2^scaleShift())th row and column is kept, so this row
+    // and its repeats may not cover any row of the buffer.
+    const IntSize decodedSize = scaledSize();
+    const int firstRow = scaledUpperBound(y);
+    const int endRow = std::min(scaledUpperBound(y + repeatCount), decodedSize.height());
+    if (firstRow >= endRow) {
+        buffer.ensureHeight(scaledUpperBound(rowNumber + repeatCount));
+        return;
+    }
+
     unsigned colorMapSize;
     unsigned char* colorMap;
     m_reader->getColorMap(colorMap, colorMapSize);
@@ -358,13 +411,15 @@ void GIFImageDecoder::haveDecodedRow(unsigned frameIndex,
     // within the overall image.  The rows we are decoding are within this
     // sub-rectangle.  This means that if the GIF frame's sub-rectangle is (x,y,w,h) then row 0 is really row
     // y, and each row goes from x to x+w.
-    unsigned dstPos = (m_reader->frameYOffset() + rowNumber) * m_size.width() + m_reader->frameXOffset();
-    unsigned* dst = buffer.bytes().data() + dstPos;
-    unsigned* dstEnd = dst + m_size.width() - m_reader->frameXOffset();
+    const unsigned width = decodedSize.width();
+    const int firstColumn = scaledUpperBound(m_reader->frameXOffset());
+    unsigned* dst = buffer.bytes().data() + firstRow * width + firstColumn;
+    unsigned* dstEnd = buffer.bytes().data() + (firstRow + 1) * width;
     unsigned* currDst = dst;
-    unsigned char* currentRowByte = rowBuffer;
+    unsigned char* currentRowByte = rowBuffer + (firstColumn << scaleShift()) - m_reader->frameXOffset();
+    const unsigned columnStep = 1 << scaleShift();
     
-    while (currentRowByte != rowEnd && currDst < dstEnd) {
+    while (currentRowByte < rowEnd && currDst < dstEnd) {
         if ((!m_reader->isTransparent() || *currentRowByte != m_reader->transparentPixel()) && *currentRowByte < colorMapSize) {
             unsigned colorIndex = *currentRowByte * 3;
             unsigned red = colorMap[colorIndex];
@@ -384,37 +439,35 @@ void GIFImageDecoder::haveDecodedRow(unsigned frameIndex,
                 RGBA32Buffer::setRGBA(*currDst, 0, 0, 0, 0);
         }
         currDst++;
-        currentRowByte++;
+        currentRowByte += columnStep;
     }
 
-    if (repeatCount > 1) {
-        // Copy the row |repeatCount|-1 times.
-        unsigned num = currDst - dst;
-        unsigned size = num * sizeof(unsigned);
-        unsigned width = m_size.width();
-        unsigned* end = buffer.bytes().data() + width * m_size.height();
-        currDst = dst + width;
-        for (unsigned i = 1; i < repeatCount; i++) {
-            if (currDst + num > end) // Protect against a buffer overrun from a bogus repeatCount.
-                break;
-            memcpy(currDst, dst, size);
-            currDst += width;
-        }
+    // Copy the row into the other buffer rows it repeats into.  endRow is clipped to the buffer
+    // height, which protects against a buffer overrun from a bogus repeatCount.
+    unsigned num = currDst - dst;
+    unsigned size = num * sizeof(unsigned);
+    currDst = dst + width;
+    for (int row = firstRow + 1; row < endRow; row++) {
+        memcpy(currDst, dst, size);
+        currDst += width;
     }
 
     // Our partial height is rowNumber + 1, e.g., row 2 is the 3rd row, so that's a height of 3.
     // Adding in repeatCount - 1 to rowNumber + 1 works out to just be rowNumber + repeatCount.
-    buffer.ensureHeight(rowNumber + repeatCount);
+    buffer.ensureHeight(scaledUpperBound(rowNumber + repeatCount));
 }
 
 void GIFImageDecoder::frameComplete(unsigned frameIndex, unsigned frameDuration, RGBA32Buffer::FrameDisposalMethod disposalMethod)
 {
     RGBA32Buffer& buffer = m_frameBufferCache[frameIndex];
-    buffer.ensureHeight(m_size.height());
+    buffer.ensureHeight(scaledSize().height());
     buffer.setStatus(RGBA32Buffer::FrameComplete);
     buffer.setDuration(frameDuration);
     buffer.setDisposalMethod(disposalMethod);
 
+    if (m_streamingAnimation)
+        releaseFrameBuffers(frameIndex);
+
     if (!m_currentBufferSawAlpha) {
         // The whole frame was non-transparent, so it's possible that the entire
         // resulting buffer was non-transparent, and we can setHasAlpha(false).
@@ -60,6 +60,10 @@ public:
 
     virtual unsigned frameDurationAtIndex(size_t index) { return 0; }
 
+    virtual bool supportsScaledDecoding() const { return true; }
+
+    virtual bool supportsStreamingAnimation() const { return true; }
+
     enum GIFQuery { GIFFullQuery, GIFSizeQuery, GIFFrameCountQuery };
 
     void decode(GIFQuery query, unsigned haltAtFrame) const;
@@ -81,6 +85,13 @@ private:
     // fills it with transparent pixels.
     void prepEmptyFrameBuffer(RGBA32Buffer* buffer); // 7/14/09 CSidhall - Removed as a const procedure 
 
+    // When streaming an animation, frees the pixels of the frames before frameIndex that the next
+    // frame doesn't start from.
+    void releaseFrameBuffers(unsigned frameIndex);
+
+    // When streaming an animation, frees all the frames and starts reading the data over.
+    void restartAnimation();
+
     bool m_frameCountValid;
     bool m_currentBufferSawAlpha;
     mutable int m_repetitionCount;
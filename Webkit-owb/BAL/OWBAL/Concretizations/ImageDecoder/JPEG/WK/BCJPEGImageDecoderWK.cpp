@@ -250,6 +250,11 @@ public:
                 m_info.enable_2pass_quant = false;
                 m_info.do_block_smoothing = true;
 
+                /* Let the IDCT produce the requested reduced size directly (1/2, 1/4 or 1/8) */
+                m_decoder->lockScale();
+                m_info.scale_num = 1;
+                m_info.scale_denom = 1 << m_decoder->scaleShift();
+
                 /* Start decompressor */
                 if (!jpeg_start_decompress(&m_info))
                     return true; /* I/O suspension */
@@ -474,7 +479,9 @@ bool JPEGImageDecoder::outputScanlines()
     // 7/13/09 CSidhall - Added some RAM cache overflow handling
     RGBA32Array& bytes = buffer.bytes();
     int curSize = bytes.size(); // Verify that buffer is actually there
-    int size = m_size.width() * m_size.height();    
+    jpeg_decompress_struct* info = m_reader->info();
+    // libjpeg rounds the scaled dimensions up, which matches scaledSize().
+    int size = info->output_width * info->output_height;    
     if((buffer.status() == RGBA32Buffer::FrameEmpty) ||(size != curSize) ) {
         // Reserve if possible enough space in the cache + out of memory error handling
 
@@ -486,7 +493,7 @@ bool JPEGImageDecoder::outputScanlines()
         setImagePruneLockStatus(true);  // Lock against pruning this resource   
 #ifdef _DEBUG   
         static bool overflowFlag = false;    // Avoid too many asserts
-        bool cachePrune = cache()->pruneImages(size << 2);
+        bool cachePrune = decodingOffMainThread() || cache()->pruneImages(size << 2);
         if(cachePrune == false){
             if(!overflowFlag){
                char buffer[256];
@@ -498,7 +505,8 @@ bool JPEGImageDecoder::outputScanlines()
             // return false;
         }
 #else
-        cache()->pruneImages(size << 2);
+        if (!decodingOffMainThread())
+            cache()->pruneImages(size << 2);
 #endif
         setImagePruneLockStatus(false);  // Unlock       
     
@@ -517,10 +525,9 @@ bool JPEGImageDecoder::outputScanlines()
         // We don't have alpha (this is the default when the buffer is constructed).
     }
 
-    jpeg_decompress_struct* info = m_reader->info();
     JSAMPARRAY samples = m_reader->samples();
 
-    unsigned* dst = buffer.bytes().data() + info->output_scanline * m_size.width();
+    unsigned* dst = buffer.bytes().data() + info->output_scanline * info->output_width;
    
     while (info->output_scanline < info->output_height) {
         /* Request one scanline.  Returns 0 or 1 scanlines. */
@@ -49,6 +49,8 @@ public:
     
     virtual bool supportsAlpha() const { return false; }
 
+    virtual bool supportsScaledDecoding() const { return true; }
+
     void decode(bool sizeOnly = false) const;
 
     JPEGImageReader* reader() { return m_reader; }
@@ -338,12 +338,14 @@ void PNGImageDecoder::rowAvailable(unsigned char* rowBuffer, unsigned rowIndex,
     //+ 7/13/09 CSidhall - Added buffer size check
     RGBA32Array& bytes = buffer.bytes(); 
     int curSize = bytes.size(); // Verify that buffer is actually there
-    int size = m_size.width() * m_size.height();
+    lockScale();
+    const IntSize decodedSize = scaledSize();
+    int size = decodedSize.width() * decodedSize.height();
     if ((buffer.status() == RGBA32Buffer::FrameEmpty) || (size != curSize)) {
     setImagePruneLockStatus(true);  // Lock against pruning this resource   
 #ifdef _DEBUG   
     static bool overflowFlag = false;    // Avoid too many asserts
-    bool cachePrune = cache()->pruneImages(size << 2);
+    bool cachePrune = decodingOffMainThread() || cache()->pruneImages(size << 2);
     if(cachePrune == false) {
         if(!overflowFlag) {
             char buffer[256];
@@ -355,7 +357,8 @@ void PNGImageDecoder::rowAvailable(unsigned char* rowBuffer, unsigned rowIndex,
         // return false;
     }
 #else
-    cache()->pruneImages(size << 2);
+    if (!decodingOffMainThread())
+        cache()->pruneImages(size << 2);
 #endif
     setImagePruneLockStatus(false); 
 
@@ -418,6 +421,13 @@ void PNGImageDecoder::rowAvailable(unsigned char* rowBuffer, unsigned rowIndex,
     else
         row = rowBuffer;
 
+    // When decoding scaled down, only every (2^scaleShift())th row and column is kept.  Skipped rows
+    // still had to be combined above since later interlace passes build on them.
+    if (!isSampled(rowIndex))
+        return;
+    const unsigned columnStep = colorChannels << scaleShift();
+    const int scaledRowIndex = rowIndex >> scaleShift();
+
     // Old code for reference:
 /*
     // Copy the data into our buffer.
@@ -443,8 +453,8 @@ void PNGImageDecoder::rowAvailable(unsigned char* rowBuffer, unsigned rowIndex,
     if( hasAlpha )
     {
         // Copy the data into our buffer.
-        int width = m_size.width();
-        unsigned* dst = buffer.bytes().data() + rowIndex * width;
+        int width = decodedSize.width();
+        unsigned* dst = buffer.bytes().data() + scaledRowIndex * width;
 
         // EA/Alex Mole: instead of testing whether we've seen any alpha at each pixel,
         //               we can AND together all of the alpha values and see if we end up
@@ -461,27 +471,31 @@ void PNGImageDecoder::rowAvailable(unsigned char* rowBuffer, unsigned rowIndex,
             minalpha = minalpha & alpha;
 
             RGBA32Buffer::setRGBA(*dst++, red, green, blue, alpha);
+            row += columnStep - colorChannels;
         }
         
         // EA/Alex Mole: see comment above minalpha declaration
         if (minalpha != 255) {
             buffer.setHasAlpha(true);
-        }
+            buffer.summarizeRowAlpha(scaledRowIndex, width);
+        } else
+            buffer.setRowOpaque(scaledRowIndex, width);
     }
     else
     {
         // Copy the data into our buffer.
-        int width = m_size.width();
-        unsigned* dst = buffer.bytes().data() + rowIndex * width;
+        int width = decodedSize.width();
+        unsigned* dst = buffer.bytes().data() + scaledRowIndex * width;
         for (int i = 0; i < width; i++) {
             unsigned red = *row++;
             unsigned green = *row++;
             unsigned blue = *row++;
             RGBA32Buffer::setRGBWithPresetAlpha(*dst++, red, green, blue);
+            row += columnStep - colorChannels;
         }
     }
 
-    buffer.ensureHeight(rowIndex + 1);
+    buffer.ensureHeight(scaledRowIndex + 1);
 }
 
 void pngComplete(png_structp png, png_infop info)
@@ -47,6 +47,8 @@ public:
 
     virtual RGBA32Buffer* frameBufferAtIndex(size_t index);
 
+    virtual bool supportsScaledDecoding() const { return true; }
+
     void decode(bool sizeOnly = false) const;
 
     PNGImageReader* reader() { return m_reader; }
@@ -55,6 +55,13 @@ public:
         DisposeOverwritePrevious = 3,  // Clear frame to previous framebuffer contents
     };
 
+    // Where a row of the buffer is opaque, which lets the blits copy that part instead of blending it.
+    struct RowAlpha {
+        int opaqueBegin;  // The widest run of opaque pixels in the row goes from opaqueBegin up to
+        int opaqueEnd;    // but not including opaqueEnd. They are equal if there is none.
+        bool transparent; // Whether every pixel of the row has an alpha of 0.
+    };
+
     RGBA32Buffer() : m_height(0), m_status(FrameEmpty), m_duration(0),
                      m_disposalMethod(DisposeNotSpecified), m_hasAlpha(false)
     {} 
@@ -68,6 +75,10 @@ public:
     FrameDisposalMethod disposalMethod() const { return m_disposalMethod; }
     bool hasAlpha() const { return m_hasAlpha; }
 
+    // The rows the decoder has summarized so far, see summarizeRowAlpha(). Rows in between that
+    // weren't summarized yet are treated as blended everywhere.
+    const Vector<RowAlpha>& rowAlpha() const { return m_rowAlpha; }
+
     void setRect(const IntRect& r) { m_rect = r; }
     void ensureHeight(unsigned rowIndex) { if (rowIndex > m_height) m_height = rowIndex; }
     void setStatus(FrameStatus s) { m_status = s; }
@@ -75,18 +86,61 @@ public:
     void setDisposalMethod(FrameDisposalMethod method) { m_disposalMethod = method; }
     void setHasAlpha(bool alpha) { m_hasAlpha = alpha; }
 
+    // Decoders of formats with alpha call these as they write each row, while its pixels are still in
+    // the cache. A row that is rewritten, e.g. by a later interlace pass, is summarized again.
+    void setRowOpaque(int rowIndex, int width)
+    {
+        RowAlpha& row = rowAlphaAt(rowIndex);
+        row.opaqueBegin = 0;
+        row.opaqueEnd = width;
+        row.transparent = false;
+    }
+
+    void summarizeRowAlpha(int rowIndex, int width)
+    {
+        const unsigned* pixels = m_bytes.data() + rowIndex * width;
+        int runBegin = 0;
+        int bestBegin = 0;
+        int bestEnd = 0;
+        unsigned visibleAlpha = 0;
+
+        for (int i = 0; i < width; ++i) {
+            const unsigned alpha = pixels[i] >> 24;
+            if (alpha != 255) {
+                if (i - runBegin > bestEnd - bestBegin) {
+                    bestBegin = runBegin;
+                    bestEnd = i;
+                }
+                runBegin = i + 1;
+                visibleAlpha |= alpha;
+            }
+        }
+        if (width - runBegin > bestEnd - bestBegin) {
+            bestBegin = runBegin;
+            bestEnd = width;
+        }
+
+        RowAlpha& row = rowAlphaAt(rowIndex);
+        row.opaqueBegin = bestBegin;
+        row.opaqueEnd = bestEnd;
+        row.transparent = (bestBegin == bestEnd) && !visibleAlpha;
+    }
+
     // EA/Alex Mole: always inline this as it's only called from a handful of inner loops
     static ALWAYS_INLINE void setRGBA(unsigned& pos, unsigned r, unsigned g, unsigned b, unsigned a)
     {
-        // We store this data pre-multiplied.
+        // We store this data pre-multiplied, which is what EA::Raster::kPixelFormatTypePARGB expects.
+        // The multiply is rounded to nearest with an exact divide by 255.
         if (a == 0)
             pos = 0;
         else {
             if (a < 255) {
-                float alphaPercent = a / 255.0f;
-                r = static_cast<unsigned>(r * alphaPercent);
-                g = static_cast<unsigned>(g * alphaPercent);
-                b = static_cast<unsigned>(b * alphaPercent);
+                r = r * a + 128;
+                g = g * a + 128;
+                b = b * a + 128;
+                r = (r + (r >> 8)) >> 8;
+                g = (g + (g >> 8)) >> 8;
+                b = (b + (b >> 8)) >> 8;
             }
             pos = (a << 24 | r << 16 | g << 8 | b);
         }
@@ -99,6 +153,15 @@ public:
     }
 
 private:
+    RowAlpha& rowAlphaAt(int rowIndex)
+    {
+        for (int i = m_rowAlpha.size(); i <= rowIndex; ++i) {
+            RowAlpha blended = { 0, 0, false };
+            m_rowAlpha.append(blended);
+        }
+        return m_rowAlpha[rowIndex];
+    }
+
     RGBA32Array m_bytes;
     IntRect m_rect;    // The rect of the original specified frame within the overall buffer.
                        // This will always just be the entire buffer except for GIF frames
@@ -108,6 +171,7 @@ private:
     unsigned m_duration; // The animation delay.
     FrameDisposalMethod m_disposalMethod; // What to do with this frame's data when initializing the next frame.
     bool m_hasAlpha; // Whether or not any of the pixels in the buffer have transparency.
+    Vector<RowAlpha> m_rowAlpha; // See rowAlpha().
 };
 
 // The ImageDecoder class represents a base class for specific image format decoders
@@ -116,7 +180,7 @@ private:
 class ImageDecoder: public WTF::FastAllocBase
 {
 public:
-    ImageDecoder() :m_sizeAvailable(false), m_failed(false),  m_lockPrune(false) {}
+    ImageDecoder() :m_sizeAvailable(false), m_failed(false),  m_lockPrune(false), m_scaleShift(0), m_scaleLocked(false), m_offMainThread(false), m_streamingAnimation(false) {}
     virtual ~ImageDecoder() {}
 
     // All specific decoder plugins must do something with the data they are given.
@@ -144,6 +208,41 @@ public:
     // Whether or not the underlying image format even supports alpha transparency.
     virtual bool supportsAlpha() const { return true; }
 
+    // Whether or not the decoder can decode directly at a reduced size (see setScaleShift).
+    virtual bool supportsScaledDecoding() const { return false; }
+
+    // Requests that frames be decoded at 1/(2^shift) of size() in each direction (shift 0 to 3).
+    // Frame rects stay in size() coordinates, the buffers are scaledSize().  The scale can only change
+    // until the first frame buffer is allocated; returns false if the decoder is already committed
+    // to a different one.  Decoders that can't scale always decode at full size.
+    bool setScaleShift(int shift)
+    {
+        if (!supportsScaledDecoding())
+            return true;
+        if (shift < 0)
+            shift = 0;
+        else if (shift > cMaxScaleShift)
+            shift = cMaxScaleShift;
+        if (m_scaleLocked)
+            return shift == m_scaleShift;
+        m_scaleShift = shift;
+        return true;
+    }
+    int scaleShift() const { return m_scaleShift; }
+
+    // Called by decoders once they commit to a scale, i.e. before allocating the first frame buffer.
+    void lockScale() { m_scaleLocked = true; }
+
+    // The size of the decoded frame buffers.
+    IntSize scaledSize() const { return IntSize(scaledUpperBound(m_size.width()), scaledUpperBound(m_size.height())); }
+
+    static const int cMaxScaleShift = 3;
+
+    // The number of sampled rows/columns below full-size coordinate n, which is also the first sampled
+    // index at or after n.  Every (2^shift)th row and column of the full image is sampled.
+    int scaledUpperBound(int n) const { return (n + (1 << m_scaleShift) - 1) >> m_scaleShift; }
+    bool isSampled(int n) const { return !(n & ((1 << m_scaleShift) - 1)); }
+
     bool failed() const { return m_failed; }
     void setFailed() { m_failed = true; }
 
@@ -151,6 +250,38 @@ public:
     bool imagePruneLockStatus() {return m_lockPrune;}
     void setImagePruneLockStatus(bool status){m_lockPrune = status;} 
 
+    // A decoder running on another thread must leave the RAM cache alone, so it doesn't prune the
+    // cache before allocating frame buffers.  The cache catches up once the decoded frame is reported.
+    bool decodingOffMainThread() const { return m_offMainThread; }
+    void setDecodingOffMainThread(bool offMainThread) { m_offMainThread = offMainThread; }
+
+    // Whether or not the decoder can stream an animation (see setStreamingAnimation).
+    virtual bool supportsStreamingAnimation() const { return false; }
+
+    // A streaming decoder only keeps the pixels of the last frame decoded and of the frame the next one
+    // starts from. The frame buffers handed out before are freed as it moves on, and asking for one of
+    // them again decodes the animation over from the start.
+    void setStreamingAnimation(bool streaming) { m_streamingAnimation = streaming && supportsStreamingAnimation(); }
+    bool streamingAnimation() const { return m_streamingAnimation; }
+
+    // The part of the image, in size() coordinates, where frame index differs from frame index - 1.
+    // This is all of it for the first frame and for frames that aren't decoded yet. Doesn't decode.
+    IntRect frameUpdateRect(size_t index) const
+    {
+        const IntRect imageRect(IntPoint(0, 0), m_size);
+        if (!index || index >= m_frameBufferCache.size() || m_frameBufferCache[index].status() != RGBA32Buffer::FrameComplete)
+            return imageRect;
+
+        // Outside of its rect, a frame starts out as the previous frame after that one is disposed of,
+        // and its disposal can only change the previous frame's own rect.
+        const RGBA32Buffer& prevBuffer = m_frameBufferCache[index - 1];
+        IntRect rect = m_frameBufferCache[index].rect();
+        if (prevBuffer.disposalMethod() == RGBA32Buffer::DisposeOverwriteBgcolor || prevBuffer.disposalMethod() == RGBA32Buffer::DisposeOverwritePrevious)
+            rect.unite(prevBuffer.rect());
+        rect.intersect(imageRect);
+        return rect;
+    }
+
 protected:
     RefPtr<SharedBuffer> m_data; // The encoded data.
     Vector<RGBA32Buffer> m_frameBufferCache;
@@ -158,6 +289,10 @@ protected:
     mutable bool m_failed;
     IntSize m_size;
     mutable bool m_lockPrune;    // 7/14/09 CSidhall - Added to prevent image pruning 
+    int m_scaleShift;            // Frames are decoded at 1/(2^m_scaleShift) of m_size.
+    bool m_scaleLocked;          // Whether the first frame buffer was allocated at m_scaleShift.
+    bool m_offMainThread;        // See decodingOffMainThread().
+    bool m_streamingAnimation;   // See setStreamingAnimation().
 };
 
 }
@@ -35,9 +35,12 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "config.h"
 #include "Font.h"
 #include "GraphicsContext.h"
+#include "DisplayList.h"
 #include "SimpleFontData.h"
 #include "IntSize.h"
+#include "ShadowCache.h"
 #include <EASTL/fixed_string.h>
+#include <algorithm>
 #include "EARaster.h"
 #include <EAWebKit/EAWebKit.h>
 #include <EAWebKit/EAWebKitTextInterface.h>  
@@ -99,6 +102,47 @@ typedef Vector<GlyphDrawInfo, 128> GlyphDrawInfoArray;
     }
 #endif
 
+// Blends a coverage mask into pSurface, or records it while the paint goes into a display list.
+static void blitMask(DisplayList* pDisplayList, EA::Raster::Surface* pSurface, const uint8_t* pMask, int width, int height, int stride, 
+                     int x, int y, const EA::Raster::Color& color)
+{
+    if (pDisplayList)
+        pDisplayList->blitMaskA8(pMask, width, height, stride, x, y, color, 255);
+    else
+        EA::Raster::BlitMaskA8(pMask, width, height, stride, pSurface, x, y, color);
+}
+
+
+struct GlyphShadowContext
+{
+    const GlyphDrawInfo* mpGlyphs;
+    int                  mGlyphCount;
+    const uint8_t*       mpTextureData;
+    int                  mTextureStride;
+    int                  mX;            // The shape's origin, relative to the pen position.
+    int                  mY;
+};
+
+// Draws the coverage of the glyphs for a text shadow. Overlapping glyphs combine as they do when blended.
+static void drawGlyphCoverage(void* pContext, uint8_t* pCoverage, int stride)
+{
+    const GlyphShadowContext& context = *static_cast<const GlyphShadowContext*>(pContext);
+
+    for (int i = 0; i < context.mGlyphCount; i++)
+    {
+        const GlyphDrawInfo& gdi         = context.mpGlyphs[i];
+        const uint8_t*       pGlyphAlpha = context.mpTextureData + (gdi.ty * context.mTextureStride) + gdi.tx;
+        uint8_t*             pDest       = pCoverage + ((-gdi.y1 - context.mY) * stride) + (gdi.x1 - context.mX);
+
+        for (int y = gdi.y2; y < gdi.y1; y++, pGlyphAlpha += context.mTextureStride, pDest += stride)
+        {
+            for (int x = 0; x < (gdi.x2 - gdi.x1); x++)
+                pDest[x] = (uint8_t)(pDest[x] + pGlyphAlpha[x] - ((pDest[x] * pGlyphAlpha[x]) / 255));
+        }
+    }
+}
+
+
 // We need to draw the glyphBuffer glyphs/advances with the pSimpleFontData font onto the 
 // pGraphicsContext pSurface. We draw glyphCount glyphs starting at the glyphIndexBegin.
 void Font::drawGlyphs(GraphicsContext* pGraphicsContext, const SimpleFontData* pSimpleFontData, const GlyphBuffer& glyphBuffer,
@@ -251,81 +295,70 @@ void Font::drawGlyphs(GraphicsContext* pGraphicsContext, const SimpleFontData* p
             gdiArray[0].x1 = 0;
         }
 
-        EA::Raster::Surface* const pSurface = pGraphicsContext->platformContext();
-        const Color                penColor = pGraphicsContext->fillColor();
-
-        // Write the glyphs into a linear buffer.
-        // To consider: See if it's possible to often get away with using stack space for this by
-        //              using Vector<uint32_t, N> in order to avoid a memory allocation. A typical
-        //              width is ~400 pixels and a typical height ~16 pixels, which is 25600 bytes.
-        //              So unless the string is small there won't be any benefit to this.
-        Vector<uint32_t> glyphRGBABuffer(destWidth * destHeight);
-        const int        penA   = penColor.alpha();
-        const int        penR   = penColor.red();
-        const int        penG   = penColor.green();
-        const int        penB   = penColor.blue();
-        const int        penRGB = (penR << 16) | (penG << 8) | penB;
+        DisplayList* const         pDisplayList = pGraphicsContext->displayList();
+        EA::Raster::Surface* const pSurface = pDisplayList ? pDisplayList->target() : pGraphicsContext->platformContext();
+        const EA::Raster::Color    penColor(pGraphicsContext->fillColor().rgb());
+        const int                  penX     = (int)point.x() + x_offset + pGraphicsContext->origin().width();
+        const int                  penY     = (int)point.y() + pGraphicsContext->origin().height();
 
-        glyphRGBABuffer.fill(0);
+        // The text shadow goes under the glyphs. An unblurred one is just the glyphs again in the shadow color, 
+        // while a blurred one is a mask of all of the glyphs together, kept in the shadow cache.
+        IntSize shadowSize;
+        int     shadowBlur;
+        Color   shadowColor;
 
-		for (int i = 0; i < glyphCount; i++)
+        if (pGraphicsContext->getShadow(shadowSize, shadowBlur, shadowColor))
         {
-			const GlyphDrawInfo& gdi         = gdiArray[i];
-            const uint8_t*       pGlyphAlpha = (pTI->GetData()) + (gdi.ty * pTI->GetStride()) + gdi.tx;
-            const int            yOffset     = (destHeight + yMin) - gdi.y1;
-			// Note by Arpit Baldeva: Old index calculation below caused a memory overrun(or I should say underrun on http://get.adobe.com/flashplayer/).
-			// Basically, yOffset * destWidth) + gdi.x1 could end up being negative if the yOffset is 0 and gdi.x1 is negative. Since I do want
-			// to make sure that index is positive, I just force it to be at least 0. There is not enough understanding about this code as of now
-			// and Paul said that he would take a look at this along with other Font problems he is currently looking at.
-			const int bufferIndex = (yOffset * destWidth) + gdi.x1;
-			EAW_ASSERT_FORMATTED(bufferIndex>=0, "Buffer Index is negative. This would corrupt memory. yOffset:%d,destWidth:%u,gdi.x1:%d",yOffset,destWidth,gdi.x1);
-			uint32_t*            pDestColor  = glyphRGBABuffer.data() + (bufferIndex >= 0 ? bufferIndex : 0);//Old Index calculation- (yOffset * destWidth) + gdi.x1;
-            const int            glyphWidth  = (gdi.x2 - gdi.x1);
-            const int            glyphHeight = (gdi.y1 - gdi.y2);
+            const EA::Raster::Color color(shadowColor.red(), shadowColor.green(), shadowColor.blue(), (shadowColor.alpha() * penColor.alpha()) / 255);
+            const int               shadowX = penX + shadowSize.width();
+            const int               shadowY = penY + shadowSize.height();
 
-			for (int y = 0; y < glyphHeight; ++y)
+            if (shadowBlur <= 0)
             {
-				for (int x = 0; x < glyphWidth; ++x)
-				{
-					//+ 1/5/10 CSidhall - When building the text string texture map, kerning can make certain letters overlap and stomp over the alpha of previous letters so 
-                    // we need to preserve texels that were aleady set. Should be able to OR herer because we have a clean buffer and penRGB is the same.
-                    // Old code:
-                    // pDestColor[x] = ((penA * pGlyphAlpha[x] / 255) << 24) | penRGB;
-                    // New code:
-                    pDestColor[x] |= ((penA * pGlyphAlpha[x] / 255) << 24) | penRGB;
-                    // -CS
-				}
-                
-                pDestColor  += destWidth;
-                pGlyphAlpha += pTI->GetStride();
+                for (int i = 0; i < glyphCount; i++)
+                {
+                    const GlyphDrawInfo& gdi = gdiArray[i];
+                    blitMask(pDisplayList, pSurface, (pTI->GetData()) + (gdi.ty * pTI->GetStride()) + gdi.tx, gdi.x2 - gdi.x1, gdi.y1 - gdi.y2, pTI->GetStride(), 
+                             shadowX + gdi.x1, shadowY - gdi.y1, color);
+                }
             }
+            else
+            {
+                GlyphShadowContext context = { gdiArray.data(), glyphCount, pTI->GetData(), (int)pTI->GetStride(), gdiArray[0].x1, -yMax };
+                unsigned long long key = ShadowCache::kInitialKey;
+
+                // The glyphs are known by the font and their ids and boxes; where they are in the texture doesn't matter.
+                key = ShadowCache::addToKey(key, &pFont, sizeof(pFont));
+                for (int i = 0; i < glyphCount; i++)
+                {
+                    const GlyphDrawInfo& gdi   = gdiArray[i];
+                    const int            box[4] = { gdi.x1, gdi.y1, gdi.x2, gdi.y2 };
 
+                    context.mX = std::min(context.mX, gdi.x1);
+                    key = ShadowCache::addToKey(key, &glyphs[i], sizeof(glyphs[i]));
+                    key = ShadowCache::addToKey(key, box, sizeof(box));
+                }
+
+                const IntSize                  size(xMax - context.mX, yMax - yMin);
+                const ShadowCache::Mask* const pMask = shadowCache()->get(key, size, shadowBlur, drawGlyphCoverage, &context);
+
+                if (pMask)
+                    blitMask(pDisplayList, pSurface, pMask->mpCoverage, pMask->mWidth, pMask->mHeight, pMask->mWidth, 
+                             shadowX + context.mX - pMask->mExtent, shadowY + context.mY - pMask->mExtent, color);
+            }
         }
 
-        // It would probably be faster if we kept around a surface for multiple usage instead of 
-        // continually recreating this one.
-        EA::Raster::Surface* const pGlyphSurface = EA::Raster::CreateSurface((void*)glyphRGBABuffer.data(), destWidth, destHeight, destWidth * 4, EA::Raster::kPixelFormatTypeARGB, false, false);
-        EA::Raster::Rect rectSrc;
-        EA::Raster::Rect rectDest;
-
-        rectSrc.w  = destWidth;
-        rectSrc.h  = destHeight;
-        rectSrc.x  = 0;
-        rectSrc.y  = 0;
-        rectDest.x = (int)point.x() + x_offset + pGraphicsContext->origin().width();
-        rectDest.y = (int)point.y() - yMax     + pGraphicsContext->origin().height();
-
-        if (pGraphicsContext->transparencyLayer() == 1.0)
-            EA::Raster::Blit(pGlyphSurface, &rectSrc, pSurface, &rectDest);
-        else
+        // Blend each glyph in the pen color straight from the glyph cache texture into the surface.
+        // Overlapping glyphs (e.g. due to kerning) simply get blended over each other.
+        for (int i = 0; i < glyphCount; i++)
         {
-            const float fTransparency = pGraphicsContext->transparencyLayer();
-            EA::Raster::Surface* const pSurfaceWithAlpha = EA::Raster::CreateTransparentSurface(pGlyphSurface, (int)(fTransparency * 255));
-            EA::Raster::Blit(pSurfaceWithAlpha, &rectSrc, pSurface, &rectDest);
-            EA::Raster::DestroySurface(pSurfaceWithAlpha);
-        }
+            const GlyphDrawInfo& gdi         = gdiArray[i];
+            const uint8_t*       pGlyphAlpha = (pTI->GetData()) + (gdi.ty * pTI->GetStride()) + gdi.tx;
+            const int            glyphWidth  = (gdi.x2 - gdi.x1);
+            const int            glyphHeight = (gdi.y1 - gdi.y2);
 
-        EA::Raster::DestroySurface(pGlyphSurface);
+            blitMask(pDisplayList, pSurface, pGlyphAlpha, glyphWidth, glyphHeight, pTI->GetStride(), penX + gdi.x1, penY - gdi.y1, penColor);
+        }
     }
     pTI->DestroyWrapper();
 
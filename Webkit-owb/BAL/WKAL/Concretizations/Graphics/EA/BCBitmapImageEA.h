@@ -115,6 +115,7 @@ public:
 class BitmapImage : public Image {
     friend class GeneratedImage;
     friend class GraphicsContext;
+    friend class ImageDecodeQueue;
 public:
     BitmapImage(BalSurface*, ImageObserver* = 0);
     BitmapImage(ImageObserver* = 0);
@@ -134,7 +135,7 @@ public:
     
     virtual unsigned decodedSize() const { return m_decodedSize; }
 
-    virtual NativeImagePtr nativeImageForCurrentFrame() { return frameAtIndex(currentFrame()); }
+    virtual NativeImagePtr nativeImageForCurrentFrame() { return decodeFrameAsynchronously() ? 0 : frameAtIndex(currentFrame()); }
 
     bool imagePruneLockStatus() const;  // 7/14/09 CSidhall - Added 
 protected:
@@ -155,6 +156,20 @@ protected:
     // Whether or not size is available yet.    
     bool isSizeAvailable();
 
+    // Decodes at the smallest power of two scale that still covers the largest size drawn so far,
+    // starting the decode over when a draw needs more than was decoded.
+    virtual void updateDecodeScale(float drawScaleX, float drawScaleY);
+    virtual FloatSize nativeImageScale() const;
+
+    // The size in bytes of one decoded frame.
+    unsigned frameBytes() const;
+
+    // Hands the decode of a large frame to the image decode queue instead of decoding it in the paint
+    // that first draws it. Returns true while that decode is in flight; the image draws nothing meanwhile.
+    bool decodeFrameAsynchronously();
+    // Called by the image decode queue on the main thread with the decoder that finished.
+    void decodeJobComplete(NativeImageSourcePtr decoder);
+
     // Animation.
     bool shouldAnimate();
     virtual void startAnimation();
@@ -181,7 +196,7 @@ protected:
     int m_repetitionsComplete;  // How many repetitions we've finished.
 
     Color m_solidColor;  // If we're a 1x1 solid color, this is the color to use to fill.
-    bool m_isSolidColor;  // Whether or not we are a 1x1 solid image.
+    bool m_isSolidColor;  // Whether or not we are a 1x1 solid image, or one that is transparent all over.
 
     bool m_animatingImageType;  // Whether or not we're an image type that is capable of animating (GIF).
     bool m_animationFinished;  // Whether or not we've completed the entire animation.
@@ -194,6 +209,8 @@ protected:
 
     mutable bool m_haveFrameCount;
     size_t m_frameCount;
+
+    int m_decodeScaleShift; // The decode scale asked for by draws so far, or -1 before the first one.
 };
 
 }
@@ -0,0 +1,260 @@
+/*
+Copyright (C) 2010 Electronic Arts, Inc.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of Electronic Arts, Inc. ("EA") nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS AND ITS CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ELECTRONIC ARTS OR ITS CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+// BCCornerMaskCacheEA.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "BCCornerMaskCacheEA.h"
+#include "FloatRect.h"
+#include "Path.h"
+#include <algorithm>
+#include <string.h>
+#include <wtf/Vector.h>
+#include <EARaster/EARaster.h>
+#include <EAWebKit/internal/EAWebKitAssert.h>
+
+
+namespace WKAL {
+
+static const unsigned kDefaultCornerMaskCacheCapacity = 256 * 1024;
+
+// Corners with a larger box than this are rare enough that they are drawn as paths.
+static const int kMaxCornerSize = 128;
+
+// Subpixel offsets are rounded to 1 / kSubpixelSteps of a pixel.
+static const int kSubpixelSteps = 4;
+
+
+struct CornerMaskCache::Entry : public WTF::FastAllocBase {
+    unsigned long long  mKey;
+    Mask                mMask;
+    unsigned            mSize;      // In bytes
+    Entry*              mpPrev;     // LRU list
+    Entry*              mpNext;
+};
+
+
+CornerMaskCache* cornerMaskCache()
+{
+    static CornerMaskCache* pCache = new CornerMaskCache;
+    return pCache;
+}
+
+
+CornerMaskCache::CornerMaskCache()
+    : m_pHead(0)
+    , m_pTail(0)
+    , m_capacity(kDefaultCornerMaskCacheCapacity)
+    , m_size(0)
+{
+}
+
+
+CornerMaskCache::~CornerMaskCache()
+{
+    clear();
+}
+
+
+static int subpixelSteps(float offset)
+{
+    const int steps = static_cast<int>((offset * kSubpixelSteps) + 0.5f);
+    return std::min(std::max(steps, 0), kSubpixelSteps - 1);
+}
+
+
+const CornerMaskCache::Mask* CornerMaskCache::get(Corner corner, const IntSize& radius, int thickness, const FloatSize& offset)
+{
+    const int boxWidth  = std::max(radius.width(), thickness);
+    const int boxHeight = std::max(radius.height(), thickness);
+
+    if ((radius.width() < 0) || (radius.height() < 0) || (thickness < 0) || (boxWidth <= 0) || (boxHeight <= 0) || 
+        (boxWidth > kMaxCornerSize) || (boxHeight > kMaxCornerSize))
+        return 0;
+
+    const int offsetX = subpixelSteps(offset.width());
+    const int offsetY = subpixelSteps(offset.height());
+
+    // The top bit keeps the key away from the values the hash table reserves.
+    const unsigned long long key = (1ULL << 63) | (static_cast<unsigned long long>(corner) << 44) | 
+                                   (static_cast<unsigned long long>(offsetX) << 42) | (static_cast<unsigned long long>(offsetY) << 40) | 
+                                   (static_cast<unsigned long long>(radius.width()) << 20) | (static_cast<unsigned long long>(radius.height()) << 10) | 
+                                    static_cast<unsigned long long>(thickness);
+
+    EntryMap::iterator it = m_entries.find(key);
+    Entry* pEntry;
+
+    if (it != m_entries.end()) {
+        pEntry = it->second;
+
+        // Move to the front of the LRU list.
+        if (pEntry != m_pHead) {
+            unlink(pEntry);
+
+            pEntry->mpNext = m_pHead;
+            m_pHead->mpPrev = pEntry;
+            m_pHead = pEntry;
+        }
+    } else {
+        pEntry = create(corner, radius, thickness, offsetX, offsetY);
+        pEntry->mKey = key;
+
+        // Make room first, so the new mask isn't the one that gets evicted.
+        prune((m_capacity > pEntry->mSize) ? (m_capacity - pEntry->mSize) : 0);
+
+        pEntry->mpPrev = 0;
+        pEntry->mpNext = m_pHead;
+        if (m_pHead)
+            m_pHead->mpPrev = pEntry;
+        else
+            m_pTail = pEntry;
+        m_pHead = pEntry;
+
+        m_entries.set(key, pEntry);
+        m_size += pEntry->mSize;
+    }
+
+    return &pEntry->mMask;
+}
+
+
+struct MaskSpanContext {
+    uint8_t* mpCoverage;
+    int      mStride;
+};
+
+static void maskSpan(void* pContext, int x, int y, int length, const uint8_t* pCoverage)
+{
+    const MaskSpanContext& context = *static_cast<const MaskSpanContext*>(pContext);
+    uint8_t* const pRow = context.mpCoverage + (y * context.mStride) + x;
+
+    if (pCoverage)
+        memcpy(pRow, pCoverage, length);
+    else
+        memset(pRow, 0xff, length);
+}
+
+
+CornerMaskCache::Entry* CornerMaskCache::create(Corner corner, const IntSize& radius, int thickness, int offsetX, int offsetY)
+{
+    const float ox     = static_cast<float>(offsetX) / kSubpixelSteps;
+    const float oy     = static_cast<float>(offsetY) / kSubpixelSteps;
+    const int   width  = std::max(radius.width(), thickness) + (offsetX ? 1 : 0);
+    const int   height = std::max(radius.height(), thickness) + (offsetY ? 1 : 0);
+
+    // The rect is made large enough that only the corner we want lands in the mask.
+    const float extent = static_cast<float>((2 * kMaxCornerSize) + 2);
+    const bool  bLeft  = (corner == TopLeft) || (corner == BottomLeft);
+    const bool  bTop   = (corner == TopLeft) || (corner == TopRight);
+    const FloatRect outerRect(bLeft ? ox : (width - ox - extent), bTop ? oy : (height - oy - extent), extent, extent);
+
+    FloatSize outerRadii[4];
+    outerRadii[corner] = FloatSize(radius);
+
+    Vector<EA::Raster::PointF> points;
+    Vector<int> contourSizes;
+    Path::createRoundedRectangle(outerRect, outerRadii[TopLeft], outerRadii[TopRight], outerRadii[BottomLeft], outerRadii[BottomRight]).flatten(points, contourSizes);
+
+    // A border's corner has the inner edge of the border cut out of it, with the radius reduced by the thickness.
+    if (thickness) {
+        FloatRect innerRect(outerRect);
+        innerRect.inflate(static_cast<float>(-thickness));
+
+        FloatSize innerRadii[4];
+        innerRadii[corner] = FloatSize(static_cast<float>(std::max(radius.width() - thickness, 0)), static_cast<float>(std::max(radius.height() - thickness, 0)));
+
+        Path::createRoundedRectangle(innerRect, innerRadii[TopLeft], innerRadii[TopRight], innerRadii[BottomLeft], innerRadii[BottomRight]).flatten(points, contourSizes);
+    }
+
+    uint8_t* const pCoverage = WTF::fastNewArray<uint8_t>(width * height);
+    memset(pCoverage, 0, width * height);
+
+    MaskSpanContext context = { pCoverage, width };
+    EA::Raster::RasterizePath(points.data(), contourSizes.data(), contourSizes.size(), EA::Raster::kFillRuleEvenOdd, true, 
+                              EA::Raster::Rect(0, 0, width, height), maskSpan, &context);
+
+    Entry* const pEntry = WTF::fastNew<Entry>();
+    pEntry->mMask.mpCoverage = pCoverage;
+    pEntry->mMask.mWidth     = width;
+    pEntry->mMask.mHeight    = height;
+    pEntry->mSize            = width * height;
+
+    return pEntry;
+}
+
+
+void CornerMaskCache::clear()
+{
+    prune(0);
+}
+
+
+void CornerMaskCache::setCapacity(unsigned capacity)
+{
+    m_capacity = capacity;
+    prune(m_capacity);
+}
+
+
+// Removes the entry from the LRU list.
+void CornerMaskCache::unlink(Entry* pEntry)
+{
+    if (pEntry->mpPrev)
+        pEntry->mpPrev->mpNext = pEntry->mpNext;
+    else
+        m_pHead = pEntry->mpNext;
+
+    if (pEntry->mpNext)
+        pEntry->mpNext->mpPrev = pEntry->mpPrev;
+    else
+        m_pTail = pEntry->mpPrev;
+
+    pEntry->mpPrev = 0;
+    pEntry->mpNext = 0;
+}
+
+
+void CornerMaskCache::prune(unsigned targetSize)
+{
+    while ((m_size > targetSize) && m_pTail) {
+        Entry* const pEntry = m_pTail;
+
+        unlink(pEntry);
+        m_entries.remove(pEntry->mKey);
+
+        EAW_ASSERT(m_size >= pEntry->mSize);
+        m_size -= pEntry->mSize;
+
+        WTF::fastDeleteArray<uint8_t>(const_cast<uint8_t*>(pEntry->mMask.mpCoverage));
+        WTF::fastDelete<Entry>(pEntry);
+    }
+}
+
+} // namespace
@@ -0,0 +1,105 @@
+/*
+Copyright (C) 2010 Electronic Arts, Inc.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of Electronic Arts, Inc. ("EA") nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS AND ITS CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ELECTRONIC ARTS OR ITS CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+// BCCornerMaskCacheEA.h
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef CornerMaskCache_h
+#define CornerMaskCache_h
+
+#include <wtf/FastAllocBase.h>
+#include <wtf/HashMap.h>
+#include "BALBase.h"
+#include "FloatSize.h"
+#include "IntSize.h"
+
+
+namespace WKAL {
+
+    // Keeps the anti-aliased coverage of rounded rect corners, so that rounded fills and borders 
+    // can be drawn as straight rect fills plus one mask blit per corner.
+    // A mask covers the box of max(radius, thickness) pixels at its corner of the rect, plus one pixel 
+    // when the rect edges sit at a subpixel offset within the box. Masks are built with the path 
+    // rasterizer the first time they are asked for, and the least recently used ones are evicted 
+    // once the cache goes over its byte budget.
+    class CornerMaskCache : public WTF::FastAllocBase {
+    public:
+        enum Corner {
+            TopLeft,
+            TopRight,
+            BottomLeft,
+            BottomRight
+        };
+
+        struct Mask {
+            const uint8_t* mpCoverage;  // mWidth * mHeight coverage values, rows packed.
+            int            mWidth;
+            int            mHeight;
+        };
+
+        CornerMaskCache();
+        ~CornerMaskCache();
+
+        // Returns the mask of a corner with the given radii. A thickness of 0 means the corner of a fill, 
+        // otherwise it is the corner of a border that wide. offset is how far the rect's edges sit inside 
+        // the box, from 0 to 1; it is rounded to a quarter pixel.
+        // Returns NULL for corners too large to cache, which should be drawn as paths.
+        const Mask* get(Corner corner, const IntSize& radius, int thickness, const FloatSize& offset = FloatSize());
+
+        // Removes all the masks.
+        void clear();
+
+        void setCapacity(unsigned capacity);
+        unsigned capacity() const { return m_capacity; }
+        unsigned size() const { return m_size; }
+
+    private:
+        struct Entry;
+
+        Entry* create(Corner corner, const IntSize& radius, int thickness, int offsetX, int offsetY);
+        void unlink(Entry* pEntry);
+        void prune(unsigned targetSize);
+
+        typedef HashMap<unsigned long long, Entry*> EntryMap;
+
+        EntryMap m_entries;
+        Entry*   m_pHead;       // Most recently used.
+        Entry*   m_pTail;       // Least recently used.
+        unsigned m_capacity;    // In bytes
+        unsigned m_size;        // In bytes
+    };
+
+    // Returns the global corner mask cache.
+    CornerMaskCache* cornerMaskCache();
+
+} // namespace
+
+
+
+#endif  // CornerMaskCache_h
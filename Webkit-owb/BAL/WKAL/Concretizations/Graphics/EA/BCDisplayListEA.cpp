@@ -0,0 +1,650 @@
+/*
+Copyright (C) 2010 Electronic Arts, Inc.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of Electronic Arts, Inc. ("EA") nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS AND ITS CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ELECTRONIC ARTS OR ITS CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+// BCDisplayListEA.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "BCDisplayListEA.h"
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <EARaster/EARasterColor.h>
+#include <EAWebKit/EAWebKit.h>
+#include <EAWebKit/internal/EAWebKitAssert.h>
+
+
+namespace WKAL {
+
+// Replay splits the recorded area in square tiles of this size.
+static const int kTileSize = 128;
+
+// Commands are padded to this so that the next one stays aligned for its pointers.
+static const size_t kCommandAlignment = 8;
+
+enum CommandType {
+    kCommandFillRect,
+    kCommandFillRectSolid,
+    kCommandRectangle,
+    kCommandLine,
+    kCommandEllipse,
+    kCommandFillPath,
+    kCommandFillPathGradient,
+    kCommandBlit,
+    kCommandBlitScaled,
+    kCommandMaskA8
+};
+
+
+struct DisplayList::Command {
+    int                 mType;
+    unsigned            mSize;          // In bytes, including the data that follows the command.
+    EA::Raster::Rect    mBounds;        // The pixels the command can touch. Tiles that don't overlap it skip it.
+    EA::Raster::Rect    mClipRect;      // The target's clip rect when the command was recorded.
+    EA::Raster::ClipRegion* mpClipRegion;   // And its clip region, AddRef'd, if it had one.
+    EA::Raster::RGBA32  mColor;
+};
+
+struct RectCommand : public DisplayList::Command {
+    EA::Raster::Rect    mRect;
+};
+
+// Rectangle outlines and lines use both points, ellipses use the center and the radii.
+struct PointsCommand : public DisplayList::Command {
+    int                 mX1, mY1, mX2, mY2;
+};
+
+// The points are mDataOffset bytes from the start of the command, followed by the size of each contour.
+struct PathCommand : public DisplayList::Command {
+    unsigned            mDataOffset;
+    int                 mPointCount;
+    int                 mContourCount;
+    EA::Raster::FillRule mFillRule;
+    bool                mbAntialias;
+
+    const EA::Raster::PointF* points() const { return reinterpret_cast<const EA::Raster::PointF*>(reinterpret_cast<const char*>(this) + mDataOffset); }
+    const int* contourSizes() const { return reinterpret_cast<const int*>(points() + mPointCount); }
+};
+
+// The gradient's color ramp is copied right after the command, as the Gradient can change or go away before the replay.
+struct GradientPathCommand : public PathCommand {
+    EA::Raster::GradientFill mGradient;     // mpRamp is pointed at the copy when replayed.
+};
+
+struct BlitCommand : public DisplayList::Command {
+    EA::Raster::Surface* mpSource;      // AddRef'd
+    EA::Raster::Rect    mRectSource;
+    EA::Raster::Rect    mRectDest;
+    EA::Raster::Rect    mDestClipRect;
+    bool                mbRectSource;   // Whether the matching rect was given.
+    bool                mbRectDest;
+    bool                mbDestClipRect;
+    bool                mbAdditive;
+    int                 mOpacity;
+};
+
+// Scaled blits always have both rects.
+struct ScaledBlitCommand : public BlitCommand {
+    EA::Raster::ScaleFilter mFilter;
+};
+
+// The mask rows come after the command, packed with a stride of mWidth.
+struct MaskCommand : public DisplayList::Command {
+    int                 mX, mY;
+    int                 mWidth, mHeight;
+    int                 mOpacity;
+};
+
+struct DisplayList::TileJob {
+    const DisplayList*  mpList;
+    EA::Raster::Rect    mArea;          // The recorded area, expanded to whole tiles.
+    int                 mTilesX;
+};
+
+
+static void UniteRect(EA::Raster::Rect& r, const EA::Raster::Rect& other)
+{
+    if ((r.w <= 0) || (r.h <= 0)) {
+        r = other;
+        return;
+    }
+
+    const int x1 = std::min(r.x, other.x);
+    const int y1 = std::min(r.y, other.y);
+    const int x2 = std::max(r.x + r.w, other.x + other.w);
+    const int y2 = std::max(r.y + r.h, other.y + other.h);
+
+    r = EA::Raster::Rect(x1, y1, x2 - x1, y2 - y1);
+}
+
+
+// Returns the rect formed by two inclusive corners.
+static EA::Raster::Rect CornersToRect(int x1, int y1, int x2, int y2)
+{
+    return EA::Raster::Rect(std::min(x1, x2), std::min(y1, y2), abs(x2 - x1) + 1, abs(y2 - y1) + 1);
+}
+
+
+DisplayList::DisplayList(EA::Raster::Surface* pTarget)
+    : m_pTarget(pTarget)
+    , m_commandCount(0)
+    , m_bounds(0, 0, 0, 0)
+{
+}
+
+
+DisplayList::~DisplayList()
+{
+    clear();
+}
+
+
+// Appends a command of the given size, which includes the data that follows it. 
+// Returns NULL if rect lands outside of the target's current clip rect, in which case there is nothing to record.
+DisplayList::Command* DisplayList::append(int type, size_t size, const EA::Raster::Rect& rect)
+{
+    const EA::Raster::Rect targetRect(0, 0, m_pTarget->mWidth, m_pTarget->mHeight);
+    EA::Raster::Rect clipRect, bounds;
+
+    if (!EA::Raster::IntersectRect(m_pTarget->mClipRect, targetRect, clipRect) || !EA::Raster::IntersectRect(rect, clipRect, bounds))
+        return 0;
+
+    EA::Raster::ClipRegion* const pClipRegion = m_pTarget->mpClipRegion;
+
+    if (pClipRegion && !EA::Raster::IntersectRect(bounds, pClipRegion->GetBounds(), bounds))
+        return 0;
+
+    size = (size + (kCommandAlignment - 1)) & ~(kCommandAlignment - 1);
+
+    const size_t offset = m_buffer.size();
+    m_buffer.grow(offset + size);
+
+    Command* const pCommand = reinterpret_cast<Command*>(m_buffer.data() + offset);
+    pCommand->mType     = type;
+    pCommand->mSize     = (unsigned)size;
+    pCommand->mBounds   = bounds;
+    pCommand->mClipRect = clipRect;
+    pCommand->mpClipRegion = pClipRegion;
+
+    if (pClipRegion)
+        pClipRegion->AddRef();
+
+    UniteRect(m_bounds, bounds);
+    m_commandCount++;
+
+    return pCommand;
+}
+
+
+void DisplayList::fillRectColor(const EA::Raster::Rect& rect, const EA::Raster::Color& color)
+{
+    RectCommand* const pCommand = static_cast<RectCommand*>(append(kCommandFillRect, sizeof(RectCommand), rect));
+
+    if (pCommand) {
+        pCommand->mColor = color.rgb();
+        pCommand->mRect  = rect;
+    }
+}
+
+
+void DisplayList::fillRectSolidColor(const EA::Raster::Rect& rect, const EA::Raster::Color& color)
+{
+    RectCommand* const pCommand = static_cast<RectCommand*>(append(kCommandFillRectSolid, sizeof(RectCommand), rect));
+
+    if (pCommand) {
+        pCommand->mColor = color.rgb();
+        pCommand->mRect  = rect;
+    }
+}
+
+
+void DisplayList::rectangleColor(int x1, int y1, int x2, int y2, const EA::Raster::Color& color)
+{
+    PointsCommand* const pCommand = static_cast<PointsCommand*>(append(kCommandRectangle, sizeof(PointsCommand), CornersToRect(x1, y1, x2, y2)));
+
+    if (pCommand) {
+        pCommand->mColor = color.rgb();
+        pCommand->mX1 = x1;
+        pCommand->mY1 = y1;
+        pCommand->mX2 = x2;
+        pCommand->mY2 = y2;
+    }
+}
+
+
+void DisplayList::lineColor(int x1, int y1, int x2, int y2, const EA::Raster::Color& color)
+{
+    PointsCommand* const pCommand = static_cast<PointsCommand*>(append(kCommandLine, sizeof(PointsCommand), CornersToRect(x1, y1, x2, y2)));
+
+    if (pCommand) {
+        pCommand->mColor = color.rgb();
+        pCommand->mX1 = x1;
+        pCommand->mY1 = y1;
+        pCommand->mX2 = x2;
+        pCommand->mY2 = y2;
+    }
+}
+
+
+void DisplayList::ellipseColor(int x, int y, int rx, int ry, const EA::Raster::Color& color)
+{
+    PointsCommand* const pCommand = static_cast<PointsCommand*>(append(kCommandEllipse, sizeof(PointsCommand), CornersToRect(x - rx, y - ry, x + rx, y + ry)));
+
+    if (pCommand) {
+        pCommand->mColor = color.rgb();
+        pCommand->mX1 = x;
+        pCommand->mY1 = y;
+        pCommand->mX2 = rx;
+        pCommand->mY2 = ry;
+    }
+}
+
+
+// Appends a path command of commandSize bytes, followed by extraSize bytes for the caller, the points and the contour sizes.
+// Returns NULL if the path has no area within the target's current clip rect.
+DisplayList::Command* DisplayList::appendPath(int type, size_t commandSize, size_t extraSize, const EA::Raster::PointF* pPoints, const int* pContourSizes, int contourCount, 
+                                              EA::Raster::FillRule fillRule, bool bAntialias)
+{
+    int pointCount = 0;
+
+    for (int i = 0; i < contourCount; i++)
+        pointCount += pContourSizes[i];
+
+    if (pointCount < 3)
+        return 0;
+
+    float x1 = pPoints[0].x, y1 = pPoints[0].y, x2 = x1, y2 = y1;
+
+    for (int i = 1; i < pointCount; i++) {
+        x1 = std::min(x1, pPoints[i].x);
+        y1 = std::min(y1, pPoints[i].y);
+        x2 = std::max(x2, pPoints[i].x);
+        y2 = std::max(y2, pPoints[i].y);
+    }
+
+    // Paths can reach far outside of the target, so the bounds are limited to it.
+    const float width  = static_cast<float>(m_pTarget->mWidth);
+    const float height = static_cast<float>(m_pTarget->mHeight);
+
+    if ((x2 < 0) || (y2 < 0) || (x1 > width) || (y1 > height))
+        return 0;
+
+    const EA::Raster::Rect bounds = CornersToRect(static_cast<int>(floorf(std::max(x1, 0.f))), static_cast<int>(floorf(std::max(y1, 0.f))),
+                                                  static_cast<int>(ceilf(std::min(x2, width))), static_cast<int>(ceilf(std::min(y2, height))));
+
+    const size_t dataOffset = commandSize + extraSize;
+    PathCommand* const pCommand = static_cast<PathCommand*>(append(type, dataOffset + (pointCount * sizeof(EA::Raster::PointF)) + (contourCount * sizeof(int)), bounds));
+
+    if (pCommand) {
+        EA::Raster::PointF* const pCommandPoints = reinterpret_cast<EA::Raster::PointF*>(reinterpret_cast<char*>(pCommand) + dataOffset);
+
+        pCommand->mDataOffset   = (unsigned)dataOffset;
+        pCommand->mPointCount   = pointCount;
+        pCommand->mContourCount = contourCount;
+        pCommand->mFillRule     = fillRule;
+        pCommand->mbAntialias   = bAntialias;
+        memcpy(pCommandPoints, pPoints, pointCount * sizeof(EA::Raster::PointF));
+        memcpy(pCommandPoints + pointCount, pContourSizes, contourCount * sizeof(int));
+    }
+
+    return pCommand;
+}
+
+
+void DisplayList::fillPathColor(const EA::Raster::PointF* pPoints, const int* pContourSizes, int contourCount, const EA::Raster::Color& color, EA::Raster::FillRule fillRule, bool bAntialias)
+{
+    Command* const pCommand = appendPath(kCommandFillPath, sizeof(PathCommand), 0, pPoints, pContourSizes, contourCount, fillRule, bAntialias);
+
+    if (pCommand)
+        pCommand->mColor = color.rgb();
+}
+
+
+void DisplayList::fillPathGradient(const EA::Raster::PointF* pPoints, const int* pContourSizes, int contourCount, const EA::Raster::GradientFill& gradient, EA::Raster::FillRule fillRule, bool bAntialias)
+{
+    const size_t rampSize = EA::Raster::kGradientRampSize * sizeof(uint32_t);
+    GradientPathCommand* const pCommand = static_cast<GradientPathCommand*>(appendPath(kCommandFillPathGradient, sizeof(GradientPathCommand), rampSize, 
+                                                                                       pPoints, pContourSizes, contourCount, fillRule, bAntialias));
+
+    if (pCommand) {
+        pCommand->mColor    = 0;
+        pCommand->mGradient = gradient;
+        memcpy(pCommand + 1, gradient.mpRamp, rampSize);
+    }
+}
+
+
+void DisplayList::blit(EA::Raster::Surface* pSource, const EA::Raster::Rect* pRectSource, const EA::Raster::Rect* pRectDest, const EA::Raster::Rect* pDestClipRect, bool additive, int opacity)
+{
+    EAW_ASSERT(pSource && (pSource != m_pTarget));
+
+    if (opacity <= 0)
+        return;
+
+    // Blits don't scale, so the destination size is the source size.
+    EA::Raster::Rect rect(pRectDest ? pRectDest->x : 0, 
+                          pRectDest ? pRectDest->y : 0,
+                          pRectSource ? pRectSource->w : pSource->mWidth,
+                          pRectSource ? pRectSource->h : pSource->mHeight);
+
+    if (pDestClipRect && !EA::Raster::IntersectRect(rect, *pDestClipRect, rect))
+        return;
+
+    BlitCommand* const pCommand = static_cast<BlitCommand*>(append(kCommandBlit, sizeof(BlitCommand), rect));
+
+    if (pCommand) {
+        pSource->AddRef();
+
+        pCommand->mpSource      = pSource;
+        pCommand->mbRectSource  = (pRectSource != 0);
+        pCommand->mbRectDest    = (pRectDest != 0);
+        pCommand->mbDestClipRect = (pDestClipRect != 0);
+        pCommand->mbAdditive    = additive;
+        pCommand->mOpacity      = opacity;
+
+        if (pRectSource)
+            pCommand->mRectSource = *pRectSource;
+        if (pRectDest)
+            pCommand->mRectDest = *pRectDest;
+        if (pDestClipRect)
+            pCommand->mDestClipRect = *pDestClipRect;
+    }
+}
+
+
+void DisplayList::blitScaled(EA::Raster::Surface* pSource, const EA::Raster::Rect& rectSource, const EA::Raster::Rect& rectDest, const EA::Raster::Rect* pDestClipRect, EA::Raster::ScaleFilter filter, bool additive, int opacity)
+{
+    EAW_ASSERT(pSource && (pSource != m_pTarget));
+
+    if (opacity <= 0)
+        return;
+
+    EA::Raster::Rect rect(rectDest);
+
+    if (pDestClipRect && !EA::Raster::IntersectRect(rect, *pDestClipRect, rect))
+        return;
+
+    ScaledBlitCommand* const pCommand = static_cast<ScaledBlitCommand*>(append(kCommandBlitScaled, sizeof(ScaledBlitCommand), rect));
+
+    if (pCommand) {
+        pSource->AddRef();
+
+        pCommand->mpSource      = pSource;
+        pCommand->mRectSource   = rectSource;
+        pCommand->mRectDest     = rectDest;
+        pCommand->mbRectSource  = true;
+        pCommand->mbRectDest    = true;
+        pCommand->mbDestClipRect = (pDestClipRect != 0);
+        pCommand->mbAdditive    = additive;
+        pCommand->mOpacity      = opacity;
+        pCommand->mFilter       = filter;
+
+        if (pDestClipRect)
+            pCommand->mDestClipRect = *pDestClipRect;
+    }
+}
+
+
+void DisplayList::blitMaskA8(const uint8_t* pMask, int maskWidth, int maskHeight, int maskStride, int x, int y, const EA::Raster::Color& color, int opacity)
+{
+    if ((maskWidth <= 0) || (maskHeight <= 0) || (opacity <= 0))
+        return;
+
+    // The coverage is copied, as glyph cache textures can change before the replay.
+    MaskCommand* const pCommand = static_cast<MaskCommand*>(append(kCommandMaskA8, sizeof(MaskCommand) + (maskWidth * maskHeight), EA::Raster::Rect(x, y, maskWidth, maskHeight)));
+
+    if (pCommand) {
+        uint8_t* pCoverage = reinterpret_cast<uint8_t*>(pCommand + 1);
+
+        pCommand->mColor   = color.rgb();
+        pCommand->mX       = x;
+        pCommand->mY       = y;
+        pCommand->mWidth   = maskWidth;
+        pCommand->mHeight  = maskHeight;
+        pCommand->mOpacity = opacity;
+
+        for (int row = 0; row < maskHeight; row++, pMask += maskStride, pCoverage += maskWidth)
+            memcpy(pCoverage, pMask, maskWidth);
+    }
+}
+
+
+void DisplayList::replay()
+{
+    if (isEmpty())
+        return;
+
+	NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeDrawRaster, EA::WebKit::kVProcessStatusStarted);
+
+    const char* const pEnd = m_buffer.data() + m_buffer.size();
+
+    // The blit function is cached in the source surface. Set it up here, so the tiles only read it.
+    for (const char* p = m_buffer.data(); p < pEnd; p += reinterpret_cast<const Command*>(p)->mSize) {
+        const Command* const pCommand = reinterpret_cast<const Command*>(p);
+
+        if ((pCommand->mType == kCommandBlit) || (pCommand->mType == kCommandBlitScaled)) {
+            EA::Raster::Surface* const pSource = static_cast<const BlitCommand*>(pCommand)->mpSource;
+
+            if ((pSource->mpBlitDest != m_pTarget) || !pSource->mpBlitFunction)
+                EA::Raster::SetupBlitFunction(pSource, m_pTarget);
+        }
+    }
+
+    // Blits go straight to the target with an explicit clip rect, so its own clip must not get in the way.
+    const EA::Raster::Rect        savedClipRect   = m_pTarget->mClipRect;
+    EA::Raster::ClipRegion* const pSavedClipRegion = m_pTarget->mpClipRegion;
+    m_pTarget->SetClipRect(NULL);
+    m_pTarget->mpClipRegion = 0;
+
+    TileJob job;
+    job.mpList  = this;
+    job.mArea.x = m_bounds.x - (m_bounds.x % kTileSize);
+    job.mArea.y = m_bounds.y - (m_bounds.y % kTileSize);
+    job.mArea.w = (m_bounds.x + m_bounds.w) - job.mArea.x;
+    job.mArea.h = (m_bounds.y + m_bounds.h) - job.mArea.y;
+    job.mTilesX = (job.mArea.w + kTileSize - 1) / kTileSize;
+
+    const int tilesY   = (job.mArea.h + kTileSize - 1) / kTileSize;
+    const int jobCount = job.mTilesX * tilesY;
+
+    EA::WebKit::EAWebKitRasterJobDispatcher pDispatcher = EA::WebKit::GetRasterJobDispatcher();
+
+    if (pDispatcher && (jobCount > 1))
+        pDispatcher(replayTileJob, &job, jobCount);
+    else {
+        for (int i = 0; i < jobCount; i++)
+            replayTileJob(&job, i);
+    }
+
+    m_pTarget->mClipRect = savedClipRect;
+    m_pTarget->mpClipRegion = pSavedClipRegion;
+
+    clear();
+
+	NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeDrawRaster, EA::WebKit::kVProcessStatusEnded);
+}
+
+
+// Runs on the dispatcher's worker threads. 
+void DisplayList::replayTileJob(void* pContext, int jobIndex)
+{
+    const TileJob&             job     = *static_cast<const TileJob*>(pContext);
+    EA::Raster::Surface* const pTarget = job.mpList->m_pTarget;
+
+    const EA::Raster::Rect tileRect(job.mArea.x + ((jobIndex % job.mTilesX) * kTileSize), 
+                                    job.mArea.y + ((jobIndex / job.mTilesX) * kTileSize),
+                                    kTileSize, kTileSize);
+    EA::Raster::Rect clippedTileRect;
+
+    if (!EA::Raster::IntersectRect(tileRect, job.mArea, clippedTileRect))
+        return;
+
+    // Each tile draws through its own surface over the target's pixels, so it has its own clip rect.
+    EA::Raster::Surface tileView;
+    tileView.Set(pTarget->mpData, pTarget->mWidth, pTarget->mHeight, pTarget->mStride, pTarget->mPixelFormat.mPixelFormatType, false, false);
+    tileView.mPixelFormat = pTarget->mPixelFormat;
+
+    job.mpList->replayTile(clippedTileRect, tileView);
+}
+
+
+struct ClippedBlit {
+    const BlitCommand*   mpBlit;
+    EA::Raster::Surface* mpTarget;
+};
+
+// The target can't carry a clip region for the tiles, so blits are split up by the command's region instead.
+static void ReplayClippedBlit(void* pContext, const EA::Raster::Rect& clipRect, int coverage)
+{
+    const ClippedBlit& clippedBlit = *static_cast<const ClippedBlit*>(pContext);
+    const BlitCommand* const pBlit = clippedBlit.mpBlit;
+    const int opacity = (coverage == 255) ? pBlit->mOpacity : (((pBlit->mOpacity * coverage) + 255) >> 8);
+
+    if (pBlit->mType == kCommandBlitScaled)
+        EA::Raster::BlitScaled(pBlit->mpSource, &pBlit->mRectSource, clippedBlit.mpTarget, &pBlit->mRectDest, &clipRect, 
+                               static_cast<const ScaledBlitCommand*>(pBlit)->mFilter, pBlit->mbAdditive, opacity);
+    else
+        EA::Raster::Blit(pBlit->mpSource, pBlit->mbRectSource ? &pBlit->mRectSource : 0, clippedBlit.mpTarget, 
+                         pBlit->mbRectDest ? &pBlit->mRectDest : 0, &clipRect, pBlit->mbAdditive, opacity);
+}
+
+
+void DisplayList::replayTile(const EA::Raster::Rect& tileRect, EA::Raster::Surface& tileView) const
+{
+    EA::Raster::RasterScratch scratch;     // Shared by the path fills of this tile.
+
+    const char* const pEnd = m_buffer.data() + m_buffer.size();
+
+    for (const char* p = m_buffer.data(); p < pEnd; p += reinterpret_cast<const Command*>(p)->mSize) {
+        const Command* const pCommand = reinterpret_cast<const Command*>(p);
+        EA::Raster::Rect     clipRect;
+
+        if (!EA::Raster::IntersectRect(pCommand->mBounds, tileRect, clipRect) || !EA::Raster::IntersectRect(pCommand->mClipRect, tileRect, clipRect))
+            continue;
+
+        tileView.mClipRect = clipRect;
+        tileView.mpClipRegion = pCommand->mpClipRegion;
+
+        const EA::Raster::Color color(pCommand->mColor);
+
+        switch (pCommand->mType) {
+            case kCommandFillRect:
+                EA::Raster::FillRectColor(&tileView, &static_cast<const RectCommand*>(pCommand)->mRect, color);
+                break;
+
+            case kCommandFillRectSolid:
+                EA::Raster::FillRectSolidColor(&tileView, &static_cast<const RectCommand*>(pCommand)->mRect, color);
+                break;
+
+            case kCommandRectangle: {
+                const PointsCommand* const pPoints = static_cast<const PointsCommand*>(pCommand);
+                EA::Raster::RectangleColor(&tileView, pPoints->mX1, pPoints->mY1, pPoints->mX2, pPoints->mY2, color);
+                break;
+            }
+
+            case kCommandLine: {
+                const PointsCommand* const pPoints = static_cast<const PointsCommand*>(pCommand);
+                EA::Raster::LineColor(&tileView, pPoints->mX1, pPoints->mY1, pPoints->mX2, pPoints->mY2, color);
+                break;
+            }
+
+            case kCommandEllipse: {
+                const PointsCommand* const pPoints = static_cast<const PointsCommand*>(pCommand);
+                EA::Raster::EllipseColor(&tileView, pPoints->mX1, pPoints->mY1, pPoints->mX2, pPoints->mY2, color);
+                break;
+            }
+
+            case kCommandFillPath: {
+                const PathCommand* const pPath = static_cast<const PathCommand*>(pCommand);
+                EA::Raster::FillPathColor(&tileView, pPath->points(), pPath->contourSizes(), pPath->mContourCount, 
+                                          color, pPath->mFillRule, pPath->mbAntialias, &scratch);
+                break;
+            }
+
+            case kCommandFillPathGradient: {
+                const GradientPathCommand* const pPath = static_cast<const GradientPathCommand*>(pCommand);
+                EA::Raster::GradientFill gradient(pPath->mGradient);
+                gradient.mpRamp = reinterpret_cast<const uint32_t*>(pPath + 1);
+                EA::Raster::FillPathGradient(&tileView, pPath->points(), pPath->contourSizes(), pPath->mContourCount, 
+                                             gradient, pPath->mFillRule, pPath->mbAntialias, &scratch);
+                break;
+            }
+
+            case kCommandBlit:
+            case kCommandBlitScaled: {
+                // Blits go to the target itself, as that is what the source's blit function was set up for.
+                const BlitCommand* const pBlit = static_cast<const BlitCommand*>(pCommand);
+
+                if (pBlit->mbDestClipRect && !EA::Raster::IntersectRect(pBlit->mDestClipRect, clipRect, clipRect))
+                    break;
+
+                ClippedBlit clippedBlit = { pBlit, m_pTarget };
+
+                if (pBlit->mpClipRegion)
+                    pBlit->mpClipRegion->ForEachRect(clipRect, ReplayClippedBlit, &clippedBlit);
+                else
+                    ReplayClippedBlit(&clippedBlit, clipRect, 255);
+                break;
+            }
+
+            case kCommandMaskA8: {
+                const MaskCommand* const pMask = static_cast<const MaskCommand*>(pCommand);
+                EA::Raster::BlitMaskA8(reinterpret_cast<const uint8_t*>(pMask + 1), pMask->mWidth, pMask->mHeight, pMask->mWidth, 
+                                       &tileView, pMask->mX, pMask->mY, color, pMask->mOpacity);
+                break;
+            }
+
+            default:
+                EAW_ASSERT(false);
+                break;
+        }
+    }
+}
+
+
+void DisplayList::clear()
+{
+    const char* const pEnd = m_buffer.data() + m_buffer.size();
+
+    for (const char* p = m_buffer.data(); p < pEnd; p += reinterpret_cast<const Command*>(p)->mSize) {
+        const Command* const pCommand = reinterpret_cast<const Command*>(p);
+
+        if ((pCommand->mType == kCommandBlit) || (pCommand->mType == kCommandBlitScaled))
+            static_cast<const BlitCommand*>(pCommand)->mpSource->Release();
+        if (pCommand->mpClipRegion)
+            pCommand->mpClipRegion->Release();
+    }
+
+    m_buffer.shrink(0);
+    m_commandCount = 0;
+    m_bounds = EA::Raster::Rect(0, 0, 0, 0);
+}
+
+} // namespace
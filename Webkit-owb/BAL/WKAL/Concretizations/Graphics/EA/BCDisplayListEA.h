@@ -0,0 +1,97 @@
+/*
+Copyright (C) 2010 Electronic Arts, Inc.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of Electronic Arts, Inc. ("EA") nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS AND ITS CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ELECTRONIC ARTS OR ITS CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+// BCDisplayListEA.h
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef DisplayList_h
+#define DisplayList_h
+
+#include <wtf/FastAllocBase.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
+#include "BALBase.h"
+#include "EARaster.h"
+
+
+namespace WKAL {
+
+    // Records the raster operations of a paint so that they can be rasterized later, split in 
+    // screen tiles that can be replayed concurrently on the application's worker threads.
+    // Each command captures the target's clip rect and clip region at the time it was recorded.
+    // Surfaces that get blitted are AddRef'd until the list is replayed or cleared, so a temporary 
+    // surface can be destroyed by its creator right after being recorded.
+    class DisplayList : Noncopyable, public WTF::FastAllocBase {
+    public:
+        struct Command;     // The commands are defined in the .cpp file.
+
+        DisplayList(EA::Raster::Surface* pTarget);
+        ~DisplayList();
+
+        EA::Raster::Surface* target() const { return m_pTarget; }
+        bool isEmpty() const { return m_commandCount == 0; }
+
+        // These match the EA::Raster functions of the same name, minus the destination surface.
+        void fillRectColor(const EA::Raster::Rect& rect, const EA::Raster::Color& color);
+        void fillRectSolidColor(const EA::Raster::Rect& rect, const EA::Raster::Color& color);
+        void rectangleColor(int x1, int y1, int x2, int y2, const EA::Raster::Color& color);
+        void lineColor(int x1, int y1, int x2, int y2, const EA::Raster::Color& color);
+        void ellipseColor(int x, int y, int rx, int ry, const EA::Raster::Color& color);
+        void fillPathColor(const EA::Raster::PointF* pPoints, const int* pContourSizes, int contourCount, const EA::Raster::Color& color, EA::Raster::FillRule fillRule, bool bAntialias);
+        void fillPathGradient(const EA::Raster::PointF* pPoints, const int* pContourSizes, int contourCount, const EA::Raster::GradientFill& gradient, EA::Raster::FillRule fillRule, bool bAntialias);
+        void blit(EA::Raster::Surface* pSource, const EA::Raster::Rect* pRectSource, const EA::Raster::Rect* pRectDest, const EA::Raster::Rect* pDestClipRect, bool additive, int opacity);
+        void blitScaled(EA::Raster::Surface* pSource, const EA::Raster::Rect& rectSource, const EA::Raster::Rect& rectDest, const EA::Raster::Rect* pDestClipRect, EA::Raster::ScaleFilter filter, bool additive, int opacity);
+        void blitMaskA8(const uint8_t* pMask, int maskWidth, int maskHeight, int maskStride, int x, int y, const EA::Raster::Color& color, int opacity);
+
+        // Rasterizes everything recorded so far into the target and empties the list.
+        // The tiles are handed to the raster job dispatcher if the application installed one.
+        void replay();
+
+        // Empties the list without rasterizing it.
+        void clear();
+
+    private:
+        struct TileJob;
+
+        Command* append(int type, size_t size, const EA::Raster::Rect& bounds);
+        Command* appendPath(int type, size_t commandSize, size_t extraSize, const EA::Raster::PointF* pPoints, const int* pContourSizes, int contourCount, EA::Raster::FillRule fillRule, bool bAntialias);
+        void replayTile(const EA::Raster::Rect& tileRect, EA::Raster::Surface& tileView) const;
+        static void replayTileJob(void* pContext, int jobIndex);
+
+        EA::Raster::Surface* m_pTarget;
+        Vector<char>         m_buffer;          // The commands, back to back.
+        unsigned             m_commandCount;
+        EA::Raster::Rect     m_bounds;          // Union of the bounds of all the commands.
+    };
+
+} // namespace
+
+
+
+#endif  // DisplayList_h
@@ -37,6 +37,8 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Gradient.h"
 #include "CSSParser.h"
 #include "GraphicsContext.h"
+#include <EARaster/EARaster.h>
+#include <wtf/FastAllocBase.h>
 #include <stdio.h>
 
 
@@ -45,18 +47,26 @@ namespace WKAL {
 
 void Gradient::platformDestroy()
 {
-    //OWB_PRINTF("Gradient::platformDestroy\n");
-    BalNotImplemented();
+    // The stops changed or the gradient is going away, so the ramp gets rebuilt on next use.
+    WTF::fastDeleteArray<uint32_t>(m_gradient);
+    m_gradient = 0;
 }
 
 
 PlatformGradient Gradient::platformGradient()
 {
-    //OWB_PRINTF("Gradient::platformGradient\n");
     if (m_gradient)
         return m_gradient;
 
-    BalNotImplemented();
+    m_gradient = WTF::fastNewArray<uint32_t>(EA::Raster::kGradientRampSize);
+
+    for (int i = 0; i < EA::Raster::kGradientRampSize; ++i) {
+        float r, g, b, a;
+        getColor(static_cast<float>(i) / (EA::Raster::kGradientRampSize - 1), &r, &g, &b, &a);
+
+        m_gradient[i] = (static_cast<uint32_t>(a * 255 + 0.5f) << 24) | (static_cast<uint32_t>(r * 255 + 0.5f) << 16) |
+                        (static_cast<uint32_t>(g * 255 + 0.5f) << 8)  |  static_cast<uint32_t>(b * 255 + 0.5f);
+    }
 
     return m_gradient;
 }
@@ -64,15 +74,8 @@ PlatformGradient Gradient::platformGradient()
 
 void Gradient::fill(GraphicsContext* pContext, const FloatRect& rect)
 {
-    //OWB_PRINTF("Gradient::platformGradient\n");
-    BalNotImplemented();
-    
-    // 11/11/09 CSidhall Temp - fill for graphic glitch. The destination buffer is probably the problem and 
-    // should be cleaned but should work down here too by forcing a 0 fill.
-    if(pContext) {
-        Color bgColor(0,0,0,0);
-        pContext->fillRect(IntRect(rect), bgColor, true);
-    }
+    if (pContext)
+        pContext->fillRect(rect, *this);
 }
 
 } //namespace
@@ -57,6 +57,13 @@ namespace WKAL {
 
         void getColor(float value, float* r, float* g, float* b, float* a) const;
 
+        bool isRadial() const { return m_radial; }
+        const FloatPoint& p0() const { return m_p0; }
+        const FloatPoint& p1() const { return m_p1; }
+        float r0() const { return m_radial ? m_r0 : 0; }
+        float r1() const { return m_radial ? m_r1 : 0; }
+
+        // The color ramp, built the first time it is needed and kept until the stops change.
         PlatformGradient platformGradient();
 
         struct ColorStop: public WTF::FastAllocBase {
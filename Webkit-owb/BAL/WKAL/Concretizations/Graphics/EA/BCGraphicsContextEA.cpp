@@ -40,13 +40,17 @@
 #include "GraphicsContext.h"
 
 #include "AffineTransform.h"
+#include "CornerMaskCache.h"
 #include "FloatRect.h"
 #include "Font.h"
+#include "Gradient.h"
 #include "ImageBuffer.h"
 #include "IntRect.h"
 #include "NotImplemented.h"
 #include "Path.h"
+#include "ShadowCache.h"
 #include "SimpleFontData.h"
+#include <algorithm>
 #include <math.h>
 #include <stdio.h>
 #include <wtf/MathExtras.h>
@@ -71,6 +75,144 @@ using std::max;
 namespace WKAL {
 
 
+static EA::Raster::Color rasterColor(const Color& color)
+{
+    return EA::Raster::Color(color.red(), color.green(), color.blue(), color.alpha());
+}
+
+// The raster description of a gradient given in the context's coordinates.
+static EA::Raster::GradientFill gradientFill(Gradient& gradient, const IntSize& origin)
+{
+    EA::Raster::GradientFill fill;
+
+    fill.mType     = gradient.isRadial() ? EA::Raster::kGradientTypeRadial : EA::Raster::kGradientTypeLinear;
+    fill.mP0       = EA::Raster::PointF(gradient.p0().x() + origin.width(), gradient.p0().y() + origin.height());
+    fill.mP1       = EA::Raster::PointF(gradient.p1().x() + origin.width(), gradient.p1().y() + origin.height());
+    fill.mR0       = gradient.r0();
+    fill.mR1       = gradient.r1();
+    fill.mpRamp    = gradient.platformGradient();
+    fill.mOpacity  = 255;
+
+    return fill;
+}
+
+static void appendPathElement(void* info, const PathElement* element)
+{
+    Path& path = *static_cast<Path*>(info);
+    const FloatPoint* points = element->points;
+
+    switch (element->type) {
+        case PathElementMoveToPoint:
+            path.moveTo(points[0]);
+            break;
+        case PathElementAddLineToPoint:
+            path.addLineTo(points[0]);
+            break;
+        case PathElementAddQuadCurveToPoint:
+            path.addQuadCurveTo(points[0], points[1]);
+            break;
+        case PathElementAddCurveToPoint:
+            path.addBezierCurveTo(points[0], points[1], points[2]);
+            break;
+        case PathElementCloseSubpath:
+            path.closeSubpath();
+            break;
+    }
+}
+
+// Appends a polygon to a set of polygons that is to be filled with the non-zero rule. Polygons that 
+// overlap have to go around in the same direction or they would cancel out, so this one gets reversed if needed.
+static void appendStrokePolygon(Vector<EA::Raster::PointF>& outline, Vector<int>& outlineSizes, EA::Raster::PointF* pPoints, int count)
+{
+    float area = 0;
+    for (int i = 0; i < count; i++) {
+        const EA::Raster::PointF& a = pPoints[i];
+        const EA::Raster::PointF& b = pPoints[(i + 1) % count];
+        area += (a.x * b.y) - (b.x * a.y);
+    }
+
+    if (area > 0)
+        std::reverse(pPoints, pPoints + count);
+
+    outline.append(pPoints, count);
+    outlineSizes.append(count);
+}
+
+// Outlines the stroke of flattened contours with butt caps and bevel joins, as a quad 
+// for each segment and a triangle on each side of each join, to be filled with the non-zero rule.
+static void outlineStroke(const Vector<EA::Raster::PointF>& points, const Vector<int>& contourSizes, const Vector<bool>& closed, float width, 
+                          Vector<EA::Raster::PointF>& outline, Vector<int>& outlineSizes)
+{
+    const float halfWidth = width / 2;
+    const EA::Raster::PointF* pContour = points.data();
+
+    for (size_t c = 0; c < contourSizes.size(); pContour += contourSizes[c++]) {
+        const int n = contourSizes[c];
+        const int segmentCount = closed[c] ? n : (n - 1);
+        bool hasPrevious = false;
+        EA::Raster::PointF previousNormal;
+
+        // A closed contour joins its last segment back to its first one, so that one gets visited twice.
+        for (int i = 0; i < segmentCount + (closed[c] ? 1 : 0); i++) {
+            const EA::Raster::PointF& a = pContour[i % n];
+            const EA::Raster::PointF& b = pContour[(i + 1) % n];
+            const float dx = b.x - a.x;
+            const float dy = b.y - a.y;
+            const float length = sqrtf((dx * dx) + (dy * dy));
+
+            if (!length)
+                continue;
+
+            const EA::Raster::PointF normal(-dy / length * halfWidth, dx / length * halfWidth);
+
+            if (hasPrevious) {
+                EA::Raster::PointF outer[3] = { a, EA::Raster::PointF(a.x + previousNormal.x, a.y + previousNormal.y), EA::Raster::PointF(a.x + normal.x, a.y + normal.y) };
+                EA::Raster::PointF inner[3] = { a, EA::Raster::PointF(a.x - previousNormal.x, a.y - previousNormal.y), EA::Raster::PointF(a.x - normal.x, a.y - normal.y) };
+                appendStrokePolygon(outline, outlineSizes, outer, 3);
+                appendStrokePolygon(outline, outlineSizes, inner, 3);
+            }
+
+            if (i < segmentCount) {
+                EA::Raster::PointF quad[4] = { EA::Raster::PointF(a.x + normal.x, a.y + normal.y), EA::Raster::PointF(b.x + normal.x, b.y + normal.y), 
+                                               EA::Raster::PointF(b.x - normal.x, b.y - normal.y), EA::Raster::PointF(a.x - normal.x, a.y - normal.y) };
+                appendStrokePolygon(outline, outlineSizes, quad, 4);
+            }
+
+            previousNormal = normal;
+            hasPrevious = true;
+        }
+    }
+}
+
+static void outlinePathStroke(const Path& path, float width, Vector<EA::Raster::PointF>& outline, Vector<int>& outlineSizes)
+{
+    Vector<EA::Raster::PointF> points;
+    Vector<int> contourSizes;
+    Vector<bool> closed;
+    path.flatten(points, contourSizes, &closed);
+
+    outlineStroke(points, contourSizes, closed, width, outline, outlineSizes);
+}
+
+static void strokePathColor(GraphicsContextPlatformPrivate* pData, const Path& path, float width, const EA::Raster::Color& color, bool bAntialias)
+{
+    Vector<EA::Raster::PointF> outline;
+    Vector<int> outlineSizes;
+    outlinePathStroke(path, width, outline, outlineSizes);
+
+    pData->fillPathColor(outline.data(), outlineSizes.data(), outlineSizes.size(), color, EA::Raster::kFillRuleNonZero, bAntialias);
+}
+
+static void strokePathGradient(GraphicsContextPlatformPrivate* pData, const Path& path, float width, const EA::Raster::GradientFill& gradient, bool bAntialias)
+{
+    Vector<EA::Raster::PointF> outline;
+    Vector<int> outlineSizes;
+    outlinePathStroke(path, width, outline, outlineSizes);
+
+    pData->fillPathGradient(outline.data(), outlineSizes.data(), outlineSizes.size(), gradient, EA::Raster::kFillRuleNonZero, bAntialias);
+}
+
+
 GraphicsContext::GraphicsContext(PlatformGraphicsContext* cr)
     : m_common(createGraphicsContextPrivate())
     , m_data(new GraphicsContextPlatformPrivate)
@@ -81,6 +223,10 @@ GraphicsContext::GraphicsContext(PlatformGraphicsContext* cr)
 
 GraphicsContext::~GraphicsContext()
 {
+    // Layers left open still get drawn, and their surfaces go back to the pool.
+    while (!m_data->layers.isEmpty())
+        endTransparencyLayer();
+
      destroyGraphicsContextPrivate(m_common);
      delete m_data;
 }
@@ -94,26 +240,54 @@ AffineTransform GraphicsContext::getCTM() const
 
 PlatformGraphicsContext* GraphicsContext::platformContext() const
 {
+    // The caller is going to draw into the surface itself, so what was recorded has to be there first.
+    if (m_data->displayList)
+        m_data->displayList->replay();
+
     return m_data->surface;
 }
 
 
 PlatformGraphicsContext* GraphicsContext::setPlatformContext(PlatformGraphicsContext* p)
 {
+    // The display list only records for the surface it was made for.
+    if (m_data->displayList) {
+        m_data->displayList->replay();
+        m_data->displayList = 0;
+    }
+
     PlatformGraphicsContext* pPrev = m_data->surface;
     m_data->surface = p;
     return pPrev;
 }
 
+
+void GraphicsContext::setDisplayList(DisplayList* pDisplayList)
+{
+    ASSERT(!pDisplayList || (pDisplayList->target() == m_data->surface));
+
+    if (m_data->displayList && (m_data->displayList != pDisplayList))
+        m_data->displayList->replay();
+
+    m_data->displayList = pDisplayList;
+}
+
+
+DisplayList* GraphicsContext::displayList() const
+{
+    return m_data->displayList;
+}
+
 void GraphicsContext::savePlatformState()
 {
     if (paintingDisabled())
         return;
 
-    // 2/11/09 CSidhall - Save clip rect 
-    m_common->state.setClipRectRestore(m_data->surface->mClipRect);    
-  
-    m_common->stack.append(m_common->state);
+    const GraphicsContextPlatformPrivate::ClipState clipState = { m_data->surface->mClipRect, m_data->clipRegion };
+
+    if (clipState.mpClipRegion)
+        clipState.mpClipRegion->AddRef();
+    m_data->clipStack.append(clipState);
 }
 
 void GraphicsContext::restorePlatformState()
@@ -121,20 +295,53 @@ void GraphicsContext::restorePlatformState()
     if (paintingDisabled())
         return;
 
-    if (m_common->stack.isEmpty()) {
+    if (m_data->clipStack.isEmpty()) {
         DS_WAR("ERROR void BCGraphicsContext::restore() stack is empty");
         return;
     }
 
-    // 2/11/09 CSidhall - Restore the clip rect 
-    m_data->surface->mClipRect = m_common->state.getClipRectRestore();
+    const GraphicsContextPlatformPrivate::ClipState& clipState = m_data->clipStack.last();
+    m_data->setClip(clipState.mClipRect, clipState.mpClipRegion);
+    m_data->clipStack.removeLast();
+}
+
+// Returns a copy of the clip region to clip further, or a new one made from the clip rect if there is none yet.
+// The region becomes the clip with applyClipRegion; the one in use can't change, as a display list can have it.
+static EA::Raster::ClipRegion* copyClipRegion(GraphicsContextPlatformPrivate* pData)
+{
+    if (pData->clipRegion)
+        return EA::Raster::CreateClipRegion(*pData->clipRegion);
 
-    m_common->state = m_common->stack.last();
-    m_common->stack.removeLast();
+    const EA::Raster::Rect surfaceRect(0, 0, pData->surface->mWidth, pData->surface->mHeight);
+    EA::Raster::Rect clipRect;
 
-    // CS - Removed this as it does not truly restore the previous clip
-    // clip(clippingRect);
+    if (!EA::Raster::IntersectRect(pData->surface->mClipRect, surfaceRect, clipRect))
+        clipRect = EA::Raster::Rect(0, 0, 0, 0);
 
+    return EA::Raster::CreateClipRegion(clipRect);
+}
+
+static void applyClipRegion(GraphicsContextPlatformPrivate* pData, EA::Raster::ClipRegion* pRegion)
+{
+    pData->setClip(pRegion->GetBounds(), pRegion);
+}
+
+static void clipToPath(GraphicsContextPlatformPrivate* pData, const Path& path, bool bOutside, bool bAntialias)
+{
+    Vector<EA::Raster::PointF> points;
+    Vector<int> contourSizes;
+    const EA::Raster::FillRule fillRule = (path.windingRule() == RULE_EVENODD) ? EA::Raster::kFillRuleEvenOdd : EA::Raster::kFillRuleNonZero;
+
+    path.flatten(points, contourSizes);
+
+    EA::Raster::ClipRegion* const pRegion = copyClipRegion(pData);
+
+    if (bOutside)
+        pRegion->ClipOutPath(points.data(), contourSizes.data(), contourSizes.size(), fillRule, bAntialias, &pData->rasterScratch);
+    else
+        pRegion->ClipToPath(points.data(), contourSizes.data(), contourSizes.size(), fillRule, bAntialias, &pData->rasterScratch);
+
+    applyClipRegion(pData, pRegion);
 }
 
 
@@ -144,8 +351,6 @@ void GraphicsContext::drawRect(const IntRect& rect)
     if (paintingDisabled())
         return;
 
-    EA::Raster::Surface* pSurface = m_data->surface;
-
     EA::Raster::Rect dstRect;
     dstRect.x = rect.x() + origin().width();
     dstRect.y = rect.y() + origin().height();
@@ -154,17 +359,8 @@ void GraphicsContext::drawRect(const IntRect& rect)
 
     if (fillColor().alpha())
     {
-        if (!m_data->layers.isEmpty())
-        {
-            const EA::Raster::Color rectFillColor(fillColor().red(), fillColor().green(), fillColor().blue(), static_cast<int>(fillColor().alpha() * m_data->layers.last()));
-
-            EA::Raster::FillRectColor(pSurface, &dstRect, rectFillColor);
-        }
-        else
-        {
-            const EA::Raster::Color rectFillColor(fillColor().rgb());
-            EA::Raster::FillRectColor(pSurface, &dstRect, rectFillColor);
-        }
+        const EA::Raster::Color rectFillColor(fillColor().rgb());
+        m_data->fillRectColor(dstRect, rectFillColor);
     }
 
     if (strokeStyle() != NoStroke)
@@ -173,24 +369,11 @@ void GraphicsContext::drawRect(const IntRect& rect)
         const int            x = o.width();
         const int            y = o.height();
 
-        if (!m_data->layers.isEmpty())
-        {
-            EA::Raster::RectangleRGBA(pSurface,
-                                      (rect.x() + x), 
-                                      (rect.y() + y),
-                                      (rect.x() + x  + rect.width() - 1), 
-                                      (rect.y() + y + rect.height() - 1),
-                                      strokeColor().red(), strokeColor().green(), strokeColor().blue(), static_cast<int>(strokeColor().alpha() * m_data->layers.last()));
-        }
-        else
-        {
-            EA::Raster::RectangleRGBA(pSurface,
-                                      (rect.x() + x), 
-                                      (rect.y() + y),
-                                      (rect.x() + x  + rect.width() - 1), 
-                                      (rect.y() + y + rect.height() - 1),
-                                      strokeColor().red(), strokeColor().green(), strokeColor().blue(), strokeColor().alpha());
-        }
+        m_data->rectangleColor((rect.x() + x), 
+                               (rect.y() + y),
+                               (rect.x() + x  + rect.width() - 1), 
+                               (rect.y() + y + rect.height() - 1),
+                               EA::Raster::Color(strokeColor().red(), strokeColor().green(), strokeColor().blue(), strokeColor().alpha()));
     }
 }
 
@@ -213,32 +396,19 @@ void GraphicsContext::drawLine(const IntPoint& point1, const IntPoint& point2)
     IntPoint p2(point2 + origin());
     Color    color = strokeColor();
 
-    int alpha;
-
-    if (!m_data->layers.isEmpty())
-        alpha = static_cast<int>(strokeColor().alpha() * m_data->layers.last());
-    else
-        alpha = strokeColor().alpha();
+    const int alpha = strokeColor().alpha();
 
     if (p1.y() == p2.y())
     {
-        EA::Raster::LineRGBA(m_data->surface,
-                             p1.x()    , p1.y(),
-                             p2.x() - 1, p2.y(),
-                             color.red(),
-                             color.green(),
-                             color.blue(),
-                             alpha);
+        m_data->lineColor(p1.x()    , p1.y(),
+                          p2.x() - 1, p2.y(),
+                          EA::Raster::Color(color.red(), color.green(), color.blue(), alpha));
     }
     else
     {
-        EA::Raster::LineRGBA(m_data->surface,
-                             p1.x(), p1.y(),
-                             p2.x(), p2.y(),
-                             color.red(),
-                             color.green(),
-                             color.blue(),
-                             alpha);
+        m_data->lineColor(p1.x(), p1.y(),
+                          p2.x(), p2.y(),
+                          EA::Raster::Color(color.red(), color.green(), color.blue(), alpha));
     }
 }
 
@@ -265,27 +435,18 @@ void GraphicsContext::drawEllipse(const IntRect& rect)
 
     Color color = strokeColor();
 
-    int alpha;
-
-    if (!m_data->layers.isEmpty())
-        alpha = static_cast<int>(strokeColor().alpha() * m_data->layers.last());
-    else
-        alpha = strokeColor().alpha();
+    const int alpha = strokeColor().alpha();
 
-    EA::Raster::EllipseRGBA(m_data->surface, 
-                            (int)(rect.x() + origin().width() + xRadius),
-                            (int)(rect.y() + origin().height() + yRadius),
-                            (int)(xRadius),
-                            (int)(yRadius),
-                            color.red(),
-                            color.green(),
-                            color.blue(),
-                            alpha);
+    m_data->ellipseColor((int)(rect.x() + origin().width() + xRadius),
+                         (int)(rect.y() + origin().height() + yRadius),
+                         (int)(xRadius),
+                         (int)(yRadius),
+                         EA::Raster::Color(color.red(), color.green(), color.blue(), alpha));
 }
 
 
 // TODO: draw points instead of lines for nicer circles
-inline void drawArc(EA::Raster::Surface* pSurface, const WebCore::Color color, int zone, int xc, int yc, float& x0, float& y0, float x1, float y1, bool doSwap = true)
+inline void drawArc(GraphicsContextPlatformPrivate* pData, const WebCore::Color color, int zone, int xc, int yc, float& x0, float& y0, float x1, float y1, bool doSwap = true)
 {
     // Mean First draw => will not draw just a point.
     if (x0 != x1)
@@ -293,43 +454,27 @@ inline void drawArc(EA::Raster::Surface* pSurface, const WebCore::Color color, i
         switch(zone)
         {
             case 0:
-                EA::Raster::LineRGBA(pSurface,
-                            static_cast<int>(xc + ceilf(x0)), static_cast<int>(yc - ceilf(y0)),
+                pData->lineColor(static_cast<int>(xc + ceilf(x0)), static_cast<int>(yc - ceilf(y0)),
                             static_cast<int>(xc + ceilf(x1)), static_cast<int>(yc - ceilf(y1)),
-                            color.red(),
-                            color.green(),
-                            color.blue(),
-                            color.alpha());
+                            EA::Raster::Color(color.rgb()));
                 break;
 
             case 1:
-                EA::Raster::LineRGBA(pSurface,
-                            static_cast<int>(xc - ceilf(y0)), static_cast<int>(yc - ceilf(x0)),
+                pData->lineColor(static_cast<int>(xc - ceilf(y0)), static_cast<int>(yc - ceilf(x0)),
                             static_cast<int>(xc - ceilf(y1)), static_cast<int>(yc - ceilf(x1)),
-                            color.red(),
-                            color.green(),
-                            color.blue(),
-                            color.alpha());
+                            EA::Raster::Color(color.rgb()));
                 break;
 
             case 2:
-                EA::Raster::LineRGBA(pSurface,
-                            static_cast<int>(xc - ceilf(x0)), static_cast<int>(yc + ceilf(y0)),
+                pData->lineColor(static_cast<int>(xc - ceilf(x0)), static_cast<int>(yc + ceilf(y0)),
                             static_cast<int>(xc - ceilf(x1)), static_cast<int>(yc + ceilf(y1)),
-                            color.red(),
-                            color.green(),
-                            color.blue(),
-                            color.alpha());
+                            EA::Raster::Color(color.rgb()));
                 break;
 
             case 3:
-                EA::Raster::LineRGBA(pSurface,
-                            static_cast<int>(xc + ceilf(y0)), static_cast<int>(yc + ceilf(x0)),
+                pData->lineColor(static_cast<int>(xc + ceilf(y0)), static_cast<int>(yc + ceilf(x0)),
                             static_cast<int>(xc + ceilf(y1)), static_cast<int>(yc + ceilf(x1)),
-                            color.red(),
-                            color.green(),
-                            color.blue(),
-                            color.alpha());
+                            EA::Raster::Color(color.rgb()));
                 break;
         }
 
@@ -342,7 +487,7 @@ inline void drawArc(EA::Raster::Surface* pSurface, const WebCore::Color color, i
 }
 
 
-void drawArc(EA::Raster::Surface* pSurface, const IntRect rect, uint16_t startAngle, uint16_t angleSpan, const WebCore::Color color)
+void drawArc(GraphicsContextPlatformPrivate* pData, const IntRect rect, uint16_t startAngle, uint16_t angleSpan, const WebCore::Color color)
 {
     //
     //        |y          (This diagram is supposed to be a circle).
@@ -380,7 +525,7 @@ void drawArc(EA::Raster::Surface* pSurface, const IntRect rect, uint16_t startAn
         for (x1 = xalpha0; x1 >= xalpha1; x1--)
         {
             y1 = sqrt(pow((float)r, 2.f) - pow(x1, 2.f));
-            drawArc(pSurface, color, z0, xc, yc, x0, y0, x1, y1);
+            drawArc(pData, color, z0, xc, yc, x0, y0, x1, y1);
         }
     }
     else if ((z1 - z0) == 1)
@@ -396,7 +541,7 @@ void drawArc(EA::Raster::Surface* pSurface, const IntRect rect, uint16_t startAn
             for (x1 = r; x1 >= xalpha1; x1--)
             {
                 y1 = sqrt(pow(r, 2.f) - pow(x1, 2.f));
-                drawArc(pSurface, color, z1, xc, yc, x0, y0, x1, y1);
+                drawArc(pData, color, z1, xc, yc, x0, y0, x1, y1);
             }
 
             x0 = xalpha0;
@@ -405,7 +550,7 @@ void drawArc(EA::Raster::Surface* pSurface, const IntRect rect, uint16_t startAn
             for (x1 = xalpha0; x1 >= 0; x1--)
             {
                 y1 = sqrt(pow((float)r, 2.f) - pow(x1, 2.f));
-                drawArc(pSurface, color, z0, xc, yc, x0, y0, x1, y1);
+                drawArc(pData, color, z0, xc, yc, x0, y0, x1, y1);
             }
         }
         else
@@ -422,12 +567,12 @@ void drawArc(EA::Raster::Surface* pSurface, const IntRect rect, uint16_t startAn
                 y1 = sqrt(pow((float)r, 2.f) - pow(x1, 2.f));
 
                 if (x1 < xalpha1)
-                    drawArc(pSurface, color, z0, xc, yc, x0, y0, x1, y1);
+                    drawArc(pData, color, z0, xc, yc, x0, y0, x1, y1);
                 else if (x1 > xalpha0)
-                    drawArc(pSurface, color, z1, xc, yc, x0, y0, x1, y1);
+                    drawArc(pData, color, z1, xc, yc, x0, y0, x1, y1);
                 else {
-                    drawArc(pSurface, color, z0, xc, yc, x0, y0, x1, y1, false);
-                    drawArc(pSurface, color, z1, xc, yc, x0, y0, x1, y1);
+                    drawArc(pData, color, z0, xc, yc, x0, y0, x1, y1, false);
+                    drawArc(pData, color, z1, xc, yc, x0, y0, x1, y1);
                 }
             }
         }
@@ -443,15 +588,15 @@ void drawArc(EA::Raster::Surface* pSurface, const IntRect rect, uint16_t startAn
             y1 = sqrt(pow((float)r, 2.f) - pow(x1, 2.f));
 
             if ((z1 - z0) >= 3)
-                drawArc(pSurface, color, z1 - 2, xc, yc, x0, y0, x1, y1, false);
+                drawArc(pData, color, z1 - 2, xc, yc, x0, y0, x1, y1, false);
 
             if (x1 < xalpha1)
-                drawArc(pSurface, color, z1 % 3, xc, yc, x0, y0, x1, y1, false);
+                drawArc(pData, color, z1 % 3, xc, yc, x0, y0, x1, y1, false);
 
             if (x1 < xalpha0)
-                drawArc(pSurface, color, z0, xc, yc, x0, y0, x1, y1, false);
+                drawArc(pData, color, z0, xc, yc, x0, y0, x1, y1, false);
 
-            drawArc(pSurface, color, z1 - 1, xc, yc, x0, y0, x1, y1);
+            drawArc(pData, color, z1 - 1, xc, yc, x0, y0, x1, y1);
         }
     }
 }
@@ -475,12 +620,7 @@ void GraphicsContext::strokeArc(const IntRect& rect, int startAngle, int angleSp
     int     a0       = (startAngle) / 90;
   //int     a1       = (startAngle + angleSpan) / 90;
 
-    int alpha;
-
-    if (!m_data->layers.isEmpty())
-        alpha = static_cast<int>(strokeColor().alpha() * m_data->layers.last());
-    else
-        alpha = strokeColor().alpha();
+    const int alpha = strokeColor().alpha();
 
     WebCore::Color color(strokeColor().red(), strokeColor().green(), strokeColor().blue(), alpha);
 
@@ -494,7 +634,7 @@ void GraphicsContext::strokeArc(const IntRect& rect, int startAngle, int angleSp
                 rectWork.setY(rect.y() + origin().height() + i);
                 rectWork.setWidth(rect.width() - i);
                 rectWork.setHeight(rect.height() - i);
-                drawArc(m_data->surface, rectWork, startAngle, angleSpan, color);
+                drawArc(m_data, rectWork, startAngle, angleSpan, color);
             }
             break;
 
@@ -505,7 +645,7 @@ void GraphicsContext::strokeArc(const IntRect& rect, int startAngle, int angleSp
                 rectWork.setY(rect.y() + origin().height() + i);
                 rectWork.setWidth(rect.width() - i*2);
                 rectWork.setHeight(rect.height() - i*2);
-                drawArc(m_data->surface, rectWork, startAngle, angleSpan, color);
+                drawArc(m_data, rectWork, startAngle, angleSpan, color);
             }
             break;
 
@@ -517,7 +657,7 @@ void GraphicsContext::strokeArc(const IntRect& rect, int startAngle, int angleSp
                 rectWork.setX(rect.x() + origin().width() + i);
                 rectWork.setWidth(rect.width() - i);
                 rectWork.setHeight(rect.height() - i);
-                drawArc(m_data->surface, rectWork, startAngle, angleSpan, color);
+                drawArc(m_data, rectWork, startAngle, angleSpan, color);
             }
             break;
 
@@ -528,7 +668,7 @@ void GraphicsContext::strokeArc(const IntRect& rect, int startAngle, int angleSp
                 rectWork.setY(rect.y() + origin().height() + i);
                 rectWork.setWidth(rect.width() - i*2);
                 rectWork.setHeight(rect.height() - i*2);
-                drawArc(m_data->surface, rectWork, startAngle, angleSpan, color);
+                drawArc(m_data, rectWork, startAngle, angleSpan, color);
             }
             break;
     }
@@ -543,40 +683,214 @@ void GraphicsContext::drawConvexPolygon(size_t npoints, const FloatPoint* points
     if (npoints <= 1)
         return;
 
-    // To do: Make this use local memory for the common cases. Use our own allocator otherwise.
-    int* vx = WTF::fastNewArray<int> (npoints);
-    int* vy = WTF::fastNewArray<int> (npoints);
-    int  x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+    Vector<EA::Raster::PointF, 16> vertices(npoints);
+    const IntSize& o = origin();
 
     for(size_t i=0; i < npoints; i++)
     {
-        vx[i] = static_cast<int16_t>(points[i].x() + origin().width());
-        vy[i] = static_cast<int16_t>(points[i].y() + origin().height());
-        x1 = min(x1, vx[i]);
-        y1 = min(y1, vy[i]);
-        x2 = max(x2, vx[i]);
-        y2 = max(y2, vy[i]);
+        vertices[i].x = points[i].x() + o.width();
+        vertices[i].y = points[i].y() + o.height();
     }
 
-    int alpha;
+    const int alpha = strokeColor().alpha();
+
+    Color color = fillColor();
+    const int count = static_cast<int>(npoints);
+
+    m_data->fillPathColor(vertices.data(), &count, 1, EA::Raster::Color(color.red(), color.green(), color.blue(), alpha), EA::Raster::kFillRuleNonZero, shouldAntialias);
+}
+
+
+// Shadows are the coverage of what is drawn, blurred and offset, blended under it in the shadow color.
+// Blurred masks come from the shadow cache.
 
-    if (!m_data->layers.isEmpty())
-        alpha = static_cast<int>(strokeColor().alpha() * m_data->layers.last());
+// The color of the shadow of something drawn with the given alpha.
+static EA::Raster::Color shadowColor(const Color& color, int alpha)
+{
+    return EA::Raster::Color(color.red(), color.green(), color.blue(), (color.alpha() * alpha) / 255);
+}
+
+struct PathCoverageContext {
+    const Vector<EA::Raster::PointF>* mpPoints;     // Relative to the shape's origin.
+    const Vector<int>*                mpContourSizes;
+    EA::Raster::FillRule              mFillRule;
+    bool                              mbAntialias;
+    IntSize                           mSize;
+};
+
+struct CoverageSpanContext {
+    uint8_t* mpCoverage;
+    int      mStride;
+};
+
+static void coverageSpan(void* pContext, int x, int y, int length, const uint8_t* pCoverage)
+{
+    const CoverageSpanContext& context = *static_cast<const CoverageSpanContext*>(pContext);
+    uint8_t* const pRow = context.mpCoverage + (y * context.mStride) + x;
+
+    if (pCoverage)
+        memcpy(pRow, pCoverage, length);
     else
-        alpha = strokeColor().alpha();
+        memset(pRow, 0xff, length);
+}
 
-    Color color = fillColor();
+static void drawPathCoverage(void* pContext, uint8_t* pCoverage, int stride)
+{
+    const PathCoverageContext& context = *static_cast<const PathCoverageContext*>(pContext);
+    CoverageSpanContext spanContext = { pCoverage, stride };
+
+    EA::Raster::RasterizePath(context.mpPoints->data(), context.mpContourSizes->data(), context.mpContourSizes->size(), context.mFillRule, context.mbAntialias, 
+                              EA::Raster::Rect(0, 0, context.mSize.width(), context.mSize.height()), coverageSpan, &spanContext);
+}
+
+// Draws the shadow of a path in surface coordinates.
+static void drawPathShadow(GraphicsContextPlatformPrivate* pData, const Path& path, const IntSize& offset, int blur, const EA::Raster::Color& color, bool bAntialias)
+{
+    if (!color.alpha())
+        return;
+
+    const IntRect bounds(enclosingIntRect(path.boundingRect()));
+
+    Path shapePath(path);
+    shapePath.translate(FloatSize(-bounds.x(), -bounds.y()));
+
+    PathCoverageContext context;
+    Vector<EA::Raster::PointF> points;
+    Vector<int> contourSizes;
 
-    EA::Raster::FilledPolygonRGBA(m_data->surface, vx, vy, npoints,
-                                   color.red(),
-                                   color.green(),
-                                   color.blue(),
-                                   alpha);
-    WTF::fastDeleteArray<int> (vx);
-    WTF::fastDeleteArray<int> (vy);
+    shapePath.flatten(points, contourSizes);
+    context.mpPoints       = &points;
+    context.mpContourSizes = &contourSizes;
+    context.mFillRule      = (path.windingRule() == RULE_EVENODD) ? EA::Raster::kFillRuleEvenOdd : EA::Raster::kFillRuleNonZero;
+    context.mbAntialias    = bAntialias;
+    context.mSize          = bounds.size();
 
+    unsigned long long key = ShadowCache::kInitialKey;
+    key = ShadowCache::addToKey(key, points.data(), points.size() * sizeof(EA::Raster::PointF));
+    key = ShadowCache::addToKey(key, contourSizes.data(), contourSizes.size() * sizeof(int));
+    key = ShadowCache::addToKey(key, &context.mFillRule, sizeof(context.mFillRule));
+    key = ShadowCache::addToKey(key, &context.mbAntialias, sizeof(context.mbAntialias));
+
+    const ShadowCache::Mask* const pMask = shadowCache()->get(key, bounds.size(), blur, drawPathCoverage, &context);
+
+    if (pMask)
+        pData->blitMaskA8(pMask->mpCoverage, pMask->mWidth, pMask->mHeight, pMask->mWidth, 
+                          bounds.x() + offset.width() - pMask->mExtent, bounds.y() + offset.height() - pMask->mExtent, color);
 }
 
+struct RoundedRectCoverageContext {
+    IntSize        mSize;
+    const IntSize* mpRadii;     // In CornerMaskCache::Corner order.
+};
+
+static void drawRoundedRectCoverage(void* pContext, uint8_t* pCoverage, int stride)
+{
+    const RoundedRectCoverageContext& context = *static_cast<const RoundedRectCoverageContext*>(pContext);
+    const IntSize* const pRadii = context.mpRadii;
+
+    if (pRadii[0].isEmpty() && pRadii[1].isEmpty() && pRadii[2].isEmpty() && pRadii[3].isEmpty()) {
+        for (int y = 0; y < context.mSize.height(); y++)
+            memset(pCoverage + (y * stride), 0xff, context.mSize.width());
+        return;
+    }
+
+    Vector<EA::Raster::PointF> points;
+    Vector<int> contourSizes;
+    CoverageSpanContext spanContext = { pCoverage, stride };
+
+    Path::createRoundedRectangle(FloatRect(0, 0, context.mSize.width(), context.mSize.height()), pRadii[0], pRadii[1], pRadii[2], pRadii[3]).flatten(points, contourSizes);
+    EA::Raster::RasterizePath(points.data(), contourSizes.data(), contourSizes.size(), EA::Raster::kFillRuleNonZero, true, 
+                              EA::Raster::Rect(0, 0, context.mSize.width(), context.mSize.height()), coverageSpan, &spanContext);
+}
+
+// A piece of a stretched rect shadow mask along one axis. A piece with a mask length of 1 and a 
+// larger dest length is the middle of the mask, stretched.
+struct ShadowSlice {
+    int mMaskStart;
+    int mMaskLength;
+    int mDest;
+    int mDestLength;
+
+    bool isStretched() const { return mMaskLength != mDestLength; }
+};
+
+// Slices one axis of a mask of maskLength for a shadow of destLength, with the middle at middle.
+static int sliceShadowMask(int maskLength, int destLength, int middle, int dest, ShadowSlice* pSlices)
+{
+    if (maskLength == destLength) {
+        const ShadowSlice whole = { 0, maskLength, dest, destLength };
+        pSlices[0] = whole;
+        return 1;
+    }
+
+    const int stretch = destLength - maskLength + 1;
+    const ShadowSlice start  = { 0, middle, dest, middle };
+    const ShadowSlice center = { middle, 1, dest + middle, stretch };
+    const ShadowSlice end    = { middle + 1, maskLength - middle - 1, dest + middle + stretch, maskLength - middle - 1 };
+
+    pSlices[0] = start;
+    pSlices[1] = center;
+    pSlices[2] = end;
+    return 3;
+}
+
+static EA::Raster::Color modulateColor(const EA::Raster::Color& color, int coverage)
+{
+    return EA::Raster::Color(color.red(), color.green(), color.blue(), ((color.alpha() * coverage) + 127) / 255);
+}
+
+// Draws the shadow of a rounded rect in surface coordinates; the radii are in CornerMaskCache::Corner order.
+// Along the straight parts of a rect its blurred coverage doesn't change, so the mask is made for the 
+// smallest rect whose middle row and column are past the reach of the corners. The mask's corners are 
+// blitted as they are, the middle column is filled a row at a time, and the middle row is blitted 
+// repeatedly by giving it a stride of 0.
+static void drawRoundedRectShadow(GraphicsContextPlatformPrivate* pData, const IntRect& rect, const IntSize* pRadii, int blur, const EA::Raster::Color& color)
+{
+    if (!color.alpha() || rect.isEmpty())
+        return;
+
+    const int extent = EA::Raster::GetBlurExtent(blur);
+    const int left   = max(pRadii[CornerMaskCache::TopLeft].width(), pRadii[CornerMaskCache::BottomLeft].width());
+    const int right  = max(pRadii[CornerMaskCache::TopRight].width(), pRadii[CornerMaskCache::BottomRight].width());
+    const int top    = max(pRadii[CornerMaskCache::TopLeft].height(), pRadii[CornerMaskCache::TopRight].height());
+    const int bottom = max(pRadii[CornerMaskCache::BottomLeft].height(), pRadii[CornerMaskCache::BottomRight].height());
+
+    RoundedRectCoverageContext context;
+    context.mSize   = IntSize(min(rect.width(), left + right + (2 * extent) + 1), min(rect.height(), top + bottom + (2 * extent) + 1));
+    context.mpRadii = pRadii;
+
+    unsigned long long key = ShadowCache::kInitialKey;
+    key = ShadowCache::addToKey(key, pRadii, 4 * sizeof(IntSize));
+
+    const ShadowCache::Mask* const pMask = shadowCache()->get(key, context.mSize, blur, drawRoundedRectCoverage, &context);
+
+    if (!pMask)
+        return;
+
+    ShadowSlice columns[3];
+    ShadowSlice rows[3];
+    const int columnCount = sliceShadowMask(pMask->mWidth, rect.width() + (2 * extent), left + (2 * extent), rect.x() - extent, columns);
+    const int rowCount    = sliceShadowMask(pMask->mHeight, rect.height() + (2 * extent), top + (2 * extent), rect.y() - extent, rows);
+
+    for (int r = 0; r < rowCount; r++) {
+        const ShadowSlice& row = rows[r];
+
+        for (int c = 0; c < columnCount; c++) {
+            const ShadowSlice& column = columns[c];
+            const uint8_t* const pCoverage = pMask->mpCoverage + (row.mMaskStart * pMask->mWidth) + column.mMaskStart;
+
+            if (column.isStretched()) {
+                for (int y = 0; y < row.mMaskLength; y++) {
+                    const int coverage = pCoverage[y * pMask->mWidth];
+
+                    if (coverage)
+                        pData->fillRectColor(EA::Raster::Rect(column.mDest, row.mDest + y, column.mDestLength, row.isStretched() ? row.mDestLength : 1), modulateColor(color, coverage));
+                }
+            } else
+                pData->blitMaskA8(pCoverage, column.mDestLength, row.mDestLength, row.isStretched() ? 0 : pMask->mWidth, column.mDest, row.mDest, color);
+        }
+    }
+}
 
 void GraphicsContext::fillRect(const IntRect& rectWK, const Color& color, bool solidFill)
 {
@@ -586,19 +900,29 @@ void GraphicsContext::fillRect(const IntRect& rectWK, const Color& color, bool s
     const IntSize&   o = origin();
     EA::Raster::Rect rect(rectWK.x() + o.width(), rectWK.y() + o.height(), rectWK.width(), rectWK.height());
 
-    EA::Raster::Surface* const pSurface = m_data->surface;
     // 7/23/09 CSidhall - Added a solid fill option to force a full clear
     if(solidFill)
     {
-        EA::Raster::FillRectSolidColor(pSurface, &rect, color);
+        m_data->fillRectSolidColor(rect, color);
     }
     else if (color.alpha())
     {
         // To do: What really want to do is modify the alpha of 'color' in place instead of create temporary.
-        const int            alpha = m_data->layers.isEmpty() ? strokeColor().alpha() : static_cast<int>(strokeColor().alpha() * m_data->layers.last());
+        const int            alpha = strokeColor().alpha();
         const EA::Raster::Color c(color.red(), color.green(), color.blue(), alpha);
 
-        EA::Raster::FillRectColor(pSurface, &rect, c);
+        IntSize shadowSize;
+        int     shadowBlur;
+        Color   shadow;
+
+        if (getShadow(shadowSize, shadowBlur, shadow)) {
+            const IntSize noRadii[4];
+            IntRect shadowRect(rectWK);
+            shadowRect.move(o + shadowSize);
+            drawRoundedRectShadow(m_data, shadowRect, noRadii, shadowBlur, shadowColor(shadow, alpha));
+        }
+
+        m_data->fillRectColor(rect, c);
     }
 }
 
@@ -608,24 +932,46 @@ void GraphicsContext::fillRect(const FloatRect& rect, const Color& color)
     fillRect(IntRect(rect), color);
 }
 
+void GraphicsContext::fillRect(const FloatRect& rect, Gradient& gradient)
+{
+    if (paintingDisabled())
+        return;
+
+    Path path;
+    path.addRect(rect);
+    path.translate(origin());
+    m_data->fillPathGradient(path, gradientFill(gradient, origin()), m_common->state.shouldAntialias);
+}
+
 
+// Clipping narrows the current clip, which save() and restore() bring back. 
+// Pixel aligned rects only change the clip rect until there is a clip region.
 void GraphicsContext::clip(const FloatRect& rect)
 {
     if (paintingDisabled())
         return;
 
-    if (rect.isEmpty())
-        m_data->surface->SetClipRect(NULL);
-    else
-    {
-        float x = rect.x() + origin().width();
-        x = (x > 0) ? x : 0;
+    const IntRect intRect(enclosingIntRect(rect));
+
+    if (FloatRect(intRect) != rect) {
+        Path path;
+        path.addRect(rect);
+        clip(path);
+        return;
+    }
+
+    const EA::Raster::Rect dstRect(intRect.x() + origin().width(), intRect.y() + origin().height(), intRect.width(), intRect.height());
 
-        float y = rect.y() + origin().height();
-        y = (y > 0) ? y : 0;
+    if (m_data->clipRegion) {
+        EA::Raster::ClipRegion* const pRegion = copyClipRegion(m_data);
+        pRegion->ClipToRect(dstRect);
+        applyClipRegion(m_data, pRegion);
+    } else {
+        EA::Raster::Rect clipRect;
 
-        const EA::Raster::Rect dstRect((int)x, (int)y, (int)rect.width(), (int)rect.height());
-        m_data->surface->SetClipRect(&dstRect);
+        if (!EA::Raster::IntersectRect(dstRect, m_data->surface->mClipRect, clipRect))
+            clipRect = EA::Raster::Rect(0, 0, 0, 0);
+        m_data->surface->SetClipRect(&clipRect);
     }
 }
 
@@ -680,7 +1026,7 @@ void GraphicsContext::drawFocusRing(const Color& color)
     focusInfo.mFocusRect.h -= 1;
     focusInfo.mFocusRect.w -= 1;
     focusInfo.mSuggestedColor.setRGB(color.rgb());
-    focusInfo.mpSurface = m_data->surface;
+    focusInfo.mpSurface = platformContext(); // The application can draw the ring itself.
     if(pVN != NULL)
     {
         useDefaultFocusRingDraw = !pVN->DrawFocusRing(focusInfo);
@@ -766,44 +1112,150 @@ void GraphicsContext::concatCTM(const AffineTransform& transform)
     NotImplemented();
 }
 
+// Clips to the ring of the given thickness just inside the ellipse in rect.
 void GraphicsContext::addInnerRoundedRectClip(const IntRect& rect, int thickness)
 {
-    NotImplemented();
+    if (paintingDisabled())
+        return;
+
+    Path path;
+    path.addEllipse(FloatRect(rect));
+    path.addEllipse(FloatRect(rect.x() + thickness, rect.y() + thickness, rect.width() - (thickness * 2), rect.height() - (thickness * 2)));
+    path.setWindingRule(RULE_EVENODD);
+    clip(path);
 }
 
+// Clips by the alpha of the buffer's pixels, with the buffer at the rect's position.
 void GraphicsContext::clipToImageBuffer(const FloatRect& rect, const ImageBuffer* imageBuffer)
 {
-    if (paintingDisabled())
+    if (paintingDisabled() || !imageBuffer)
         return;
 
-    notImplemented();
+    const EA::Raster::Surface* const pBuffer = imageBuffer->surface();
+
+    if (!pBuffer || !pBuffer->mpData || (pBuffer->mPixelFormat.mBytesPerPixel != 4))
+        return;
+
+    const int width  = pBuffer->mWidth;
+    const int height = pBuffer->mHeight;
+    const uint32_t aMask  = pBuffer->mPixelFormat.mAMask;
+    const uint8_t  aShift = pBuffer->mPixelFormat.mAShift;
+
+    Vector<uint8_t> mask(width * height);
+
+    for (int y = 0; y < height; y++) {
+        const uint32_t* const pRow = reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(pBuffer->mpData) + (y * pBuffer->mStride));
+
+        for (int x = 0; x < width; x++)
+            mask[(y * width) + x] = aMask ? static_cast<uint8_t>((pRow[x] & aMask) >> aShift) : 255;
+    }
+
+    EA::Raster::ClipRegion* const pRegion = copyClipRegion(m_data);
+    pRegion->ClipToMask(mask.data(), width, height, width, static_cast<int>(floorf(rect.x())) + origin().width(), static_cast<int>(floorf(rect.y())) + origin().height());
+    applyClipRegion(m_data, pRegion);
 }
 
+// The fills draw the shadow from the state, so there is nothing else to set up.
 void GraphicsContext::setPlatformShadow(IntSize const&, int, Color const&)
 {
-    notImplemented();
 }
 
 void GraphicsContext::clearPlatformShadow()
 {
-    notImplemented();
 }
 
+// Layer surfaces are scratch surfaces, as a page tends to open layers of the same few sizes on every paint.
+// Returns a surface of width x height, cleared to transparent. Its alpha builds up as things are drawn into
+// it, so that where they overlap the layer blends onto the target as they would have one after the other.
+static EA::Raster::Surface* acquireLayerSurface(int width, int height)
+{
+    EA::Raster::Surface* const pSurface = EA::Raster::AcquirePooledSurface(width, height, EA::Raster::kPixelFormatTypeARGB);
+
+    if (pSurface) {
+        const EA::Raster::Rect rect(0, 0, width, height);
+        EA::Raster::FillRectSolidColor(pSurface, &rect, EA::Raster::Color(0, 0, 0, 0));
+        pSurface->mSurfaceFlags |= EA::Raster::kFlagAccumulateAlpha;
+    }
+
+    return pSurface;
+}
+
+// Starts drawing into an offscreen layer the size of the current clip, so that what is drawn until 
+// endTransparencyLayer gets blended as a whole with the given opacity. Overlapping parts don't show 
+// through each other as they would if each were drawn with the opacity.
 void GraphicsContext::beginTransparencyLayer(float opacity)
 {
     if (paintingDisabled())
         return;
-    m_data->layers.append(opacity);
-    m_data->beginTransparencyLayer();
+
+    // The layer gets blended directly into the surface, so what was recorded so far has to be there first.
+    if (m_data->displayList)
+        m_data->displayList->replay();
+
+    EA::Raster::Surface* const pSurface = m_data->surface;
+    const EA::Raster::Rect surfaceRect(0, 0, pSurface->mWidth, pSurface->mHeight);
+
+    GraphicsContextPlatformPrivate::TransparencyLayer layer;
+    layer.mpSurface     = pSurface;
+    layer.mpClipRegion  = m_data->clipRegion;
+    layer.mpDisplayList = m_data->displayList;
+    layer.mOpacity      = opacity;
+
+    // The clip rect is the bounds of the clip region, if there is one.
+    if (!EA::Raster::IntersectRect(pSurface->mClipRect, surfaceRect, layer.mBounds))
+        layer.mBounds = EA::Raster::Rect(0, 0, 0, 0);
+
+    EA::Raster::Surface* const pLayerSurface = acquireLayerSurface(max(layer.mBounds.w, 1), max(layer.mBounds.h, 1));
+
+    // Without a layer surface, the layer is drawn straight into the target. It still gets an entry,
+    // so that each endTransparencyLayer ends the layer its begin started.
+    if (!pLayerSurface) {
+        layer.mpSurface = 0;
+        m_data->layers.append(layer);
+        return;
+    }
+
+    m_data->layers.append(layer);
+    m_data->surface     = pLayerSurface;
+    m_data->clipRegion  = 0;
+    m_data->displayList = 0;
+    m_common->state.origin -= IntSize(layer.mBounds.x, layer.mBounds.y);
+
+    const EA::Raster::Rect layerClipRect(0, 0, layer.mBounds.w, layer.mBounds.h);
+    pLayerSurface->SetClipRect(&layerClipRect);
 }
 
 void GraphicsContext::endTransparencyLayer()
 {
-    if (paintingDisabled())
+    if (paintingDisabled() || m_data->layers.isEmpty())
         return;
 
+    const GraphicsContextPlatformPrivate::TransparencyLayer layer = m_data->layers.last();
+    EA::Raster::Surface* const pLayerSurface = m_data->surface;
+
     m_data->layers.removeLast();
-    m_data->endTransparencyLayer();
+
+    // A layer that didn't get a surface left the target as it was.
+    if (!layer.mpSurface)
+        return;
+
+    // A clip made in the layer that wasn't restored.
+    if (m_data->clipRegion)
+        m_data->clipRegion->Release();
+
+    m_data->surface     = layer.mpSurface;
+    m_data->clipRegion  = layer.mpClipRegion;
+    m_data->displayList = layer.mpDisplayList;
+    m_common->state.origin += IntSize(layer.mBounds.x, layer.mBounds.y);
+
+    const int opacity = static_cast<int>((layer.mOpacity * 255) + 0.5f);
+
+    if ((opacity > 0) && (layer.mBounds.w > 0) && (layer.mBounds.h > 0)) {
+        const EA::Raster::Rect sourceRect(0, 0, layer.mBounds.w, layer.mBounds.h);
+        EA::Raster::Blit(pLayerSurface, &sourceRect, m_data->surface, &layer.mBounds, NULL, false, min(opacity, 255));
+    }
+
+    EA::Raster::ReleasePooledSurface(pLayerSurface);
 }
 
 void GraphicsContext::clearRect(const FloatRect& rect, bool solidFill)
@@ -823,7 +1275,10 @@ void GraphicsContext::strokeRect(const FloatRect& rect, float width)
     if (paintingDisabled())
         return;
 
-    NotImplemented();
+    Path path;
+    path.addRect(rect);
+    path.translate(origin());
+    strokePathColor(m_data, path, width, rasterColor(strokeColor()), m_common->state.shouldAntialias);
 }
 
 void GraphicsContext::setLineCap(LineCap lineCap)
@@ -868,7 +1323,7 @@ void GraphicsContext::beginPath()
     if (paintingDisabled())
         return;
 
-    NotImplemented();
+    m_data->currentPath.clear();
 }
 
 void GraphicsContext::addPath(const Path& path)
@@ -876,7 +1331,58 @@ void GraphicsContext::addPath(const Path& path)
     if (paintingDisabled())
         return;
 
-    NotImplemented();
+    // The path is kept in surface coordinates, as the origin may change before it gets drawn.
+    Path translatedPath(path);
+    translatedPath.translate(origin());
+
+    if (m_data->currentPath.isEmpty())
+        m_data->currentPath = translatedPath;
+    else {
+        translatedPath.apply(&m_data->currentPath, appendPathElement);
+        m_data->currentPath.setWindingRule(path.windingRule());
+    }
+}
+
+void GraphicsContext::fillPath()
+{
+    if (paintingDisabled())
+        return;
+
+    const EA::Raster::Color color(rasterColor(fillColor()));
+    IntSize shadowSize;
+    int     shadowBlur;
+    Color   shadow;
+
+    if (getShadow(shadowSize, shadowBlur, shadow))
+        drawPathShadow(m_data, m_data->currentPath, shadowSize, shadowBlur, shadowColor(shadow, color.alpha()), m_common->state.shouldAntialias);
+
+    m_data->fillPathColor(m_data->currentPath, color, m_common->state.shouldAntialias);
+}
+
+void GraphicsContext::strokePath()
+{
+    if (paintingDisabled() || (strokeStyle() == NoStroke))
+        return;
+
+    const float width = (strokeThickness() > 0) ? strokeThickness() : 1.0f;
+    strokePathColor(m_data, m_data->currentPath, width, rasterColor(strokeColor()), m_common->state.shouldAntialias);
+}
+
+void GraphicsContext::fillPath(Gradient& gradient)
+{
+    if (paintingDisabled())
+        return;
+
+    m_data->fillPathGradient(m_data->currentPath, gradientFill(gradient, origin()), m_common->state.shouldAntialias);
+}
+
+void GraphicsContext::strokePath(Gradient& gradient)
+{
+    if (paintingDisabled() || (strokeStyle() == NoStroke))
+        return;
+
+    const float width = (strokeThickness() > 0) ? strokeThickness() : 1.0f;
+    strokePathGradient(m_data, m_data->currentPath, width, gradientFill(gradient, origin()), m_common->state.shouldAntialias);
 }
 
 void GraphicsContext::clip(const Path& path)
@@ -884,7 +1390,9 @@ void GraphicsContext::clip(const Path& path)
     if (paintingDisabled())
         return;
 
-    NotImplemented();
+    Path translatedPath(path);
+    translatedPath.translate(origin());
+    clipToPath(m_data, translatedPath, false, m_common->state.shouldAntialias);
 }
 
 void GraphicsContext::clipOut(const Path& path)
@@ -892,7 +1400,9 @@ void GraphicsContext::clipOut(const Path& path)
     if (paintingDisabled())
         return;
 
-    NotImplemented();
+    Path translatedPath(path);
+    translatedPath.translate(origin());
+    clipToPath(m_data, translatedPath, true, m_common->state.shouldAntialias);
 }
 
 void GraphicsContext::rotate(float radians)
@@ -916,7 +1426,9 @@ void GraphicsContext::clipOut(const IntRect& r)
     if (paintingDisabled())
         return;
 
-    NotImplemented();
+    EA::Raster::ClipRegion* const pRegion = copyClipRegion(m_data);
+    pRegion->ClipOutRect(EA::Raster::Rect(r.x() + origin().width(), r.y() + origin().height(), r.width(), r.height()));
+    applyClipRegion(m_data, pRegion);
 }
 
 void GraphicsContext::clipOutEllipseInRect(const IntRect& r)
@@ -924,15 +1436,137 @@ void GraphicsContext::clipOutEllipseInRect(const IntRect& r)
     if (paintingDisabled())
         return;
 
-    NotImplemented();
+    Path path;
+    path.addEllipse(FloatRect(r));
+    clipOut(path);
+}
+
+// Draws a rounded rect, or the border of one if thickness isn't 0, as a cached coverage mask for each 
+// corner and rect fills for the straight parts. The radii are in CornerMaskCache::Corner order.
+// Returns false without drawing anything if the corners overlap or are too large for the cache.
+static bool drawRoundedRectWithCornerMasks(GraphicsContextPlatformPrivate* pData, const IntRect& rect, const IntSize* pRadii, int thickness, const EA::Raster::Color& color)
+{
+    IntSize boxes[4];
+    const CornerMaskCache::Mask* pMasks[4];
+
+    for (int i = 0; i < 4; i++)
+        boxes[i] = IntSize(max(pRadii[i].width(), thickness), max(pRadii[i].height(), thickness));
+
+    if (((boxes[CornerMaskCache::TopLeft].width() + boxes[CornerMaskCache::TopRight].width()) > rect.width()) ||
+        ((boxes[CornerMaskCache::BottomLeft].width() + boxes[CornerMaskCache::BottomRight].width()) > rect.width()) ||
+        ((boxes[CornerMaskCache::TopLeft].height() + boxes[CornerMaskCache::BottomLeft].height()) > rect.height()) ||
+        ((boxes[CornerMaskCache::TopRight].height() + boxes[CornerMaskCache::BottomRight].height()) > rect.height()))
+        return false;
+
+    // The cache holds many times the largest four masks, so getting one can't evict another of these.
+    for (int i = 0; i < 4; i++) {
+        pMasks[i] = 0;
+        if ((boxes[i].width() > 0) && (boxes[i].height() > 0)) {
+            pMasks[i] = cornerMaskCache()->get(static_cast<CornerMaskCache::Corner>(i), pRadii[i], thickness);
+            if (!pMasks[i])
+                return false;
+        }
+    }
+
+    for (int i = 0; i < 4; i++) {
+        if (pMasks[i]) {
+            const CornerMaskCache::Mask& mask = *pMasks[i];
+            const bool bLeft = (i == CornerMaskCache::TopLeft) || (i == CornerMaskCache::BottomLeft);
+            const bool bTop  = (i == CornerMaskCache::TopLeft) || (i == CornerMaskCache::TopRight);
+
+            pData->blitMaskA8(mask.mpCoverage, mask.mWidth, mask.mHeight, mask.mWidth, 
+                              bLeft ? rect.x() : (rect.right() - mask.mWidth), bTop ? rect.y() : (rect.bottom() - mask.mHeight), color);
+        }
+    }
+
+    const IntSize& tl = boxes[CornerMaskCache::TopLeft];
+    const IntSize& tr = boxes[CornerMaskCache::TopRight];
+    const IntSize& bl = boxes[CornerMaskCache::BottomLeft];
+    const IntSize& br = boxes[CornerMaskCache::BottomRight];
+
+    if (thickness) {
+        // The four sides, between the corner boxes.
+        pData->fillRectColor(EA::Raster::Rect(rect.x() + tl.width(), rect.y(), rect.width() - tl.width() - tr.width(), thickness), color);
+        pData->fillRectColor(EA::Raster::Rect(rect.x() + bl.width(), rect.bottom() - thickness, rect.width() - bl.width() - br.width(), thickness), color);
+        pData->fillRectColor(EA::Raster::Rect(rect.x(), rect.y() + tl.height(), thickness, rect.height() - tl.height() - bl.height()), color);
+        pData->fillRectColor(EA::Raster::Rect(rect.right() - thickness, rect.y() + tr.height(), thickness, rect.height() - tr.height() - br.height()), color);
+    } else {
+        // Everything outside of the corner boxes, in bands of rows where the boxes don't change.
+        int rows[6] = { rect.y(), rect.y() + tl.height(), rect.y() + tr.height(), rect.bottom() - bl.height(), rect.bottom() - br.height(), rect.bottom() };
+        std::sort(rows, rows + 6);
+
+        for (int i = 0; i < 5; i++) {
+            const int y = rows[i];
+            if (y == rows[i + 1])
+                continue;
+
+            const int x1 = rect.x() + ((y < (rect.y() + tl.height())) ? tl.width() : 0) + ((y >= (rect.bottom() - bl.height())) ? bl.width() : 0);
+            const int x2 = rect.right() - ((y < (rect.y() + tr.height())) ? tr.width() : 0) - ((y >= (rect.bottom() - br.height())) ? br.width() : 0);
+
+            if (x2 > x1)
+                pData->fillRectColor(EA::Raster::Rect(x1, y, x2 - x1, rows[i + 1] - y), color);
+        }
+    }
+
+    return true;
 }
 
 void GraphicsContext::fillRoundedRect(const IntRect& r, const IntSize& topLeft, const IntSize& topRight, const IntSize& bottomLeft, const IntSize& bottomRight, const Color& color)
 {
-    if (paintingDisabled())
+    if (paintingDisabled() || !color.alpha())
         return;
 
-    NotImplemented();
+    const IntSize radii[4] = { topLeft, topRight, bottomLeft, bottomRight };
+    IntRect rect(r);
+    rect.move(origin());
+
+    IntSize shadowSize;
+    int     shadowBlur;
+    Color   shadow;
+
+    if (getShadow(shadowSize, shadowBlur, shadow)) {
+        IntRect shadowRect(rect);
+        shadowRect.move(shadowSize);
+        drawRoundedRectShadow(m_data, shadowRect, radii, shadowBlur, shadowColor(shadow, rasterColor(color).alpha()));
+    }
+
+    if (m_common->state.shouldAntialias && drawRoundedRectWithCornerMasks(m_data, rect, radii, 0, rasterColor(color)))
+        return;
+
+    Path path = Path::createRoundedRectangle(rect, topLeft, topRight, bottomLeft, bottomRight);
+    m_data->fillPathColor(path, rasterColor(color), m_common->state.shouldAntialias);
+}
+
+void GraphicsContext::strokeRoundedRect(const IntRect& r, const IntSize& topLeft, const IntSize& topRight, const IntSize& bottomLeft, const IntSize& bottomRight, int thickness, const Color& color)
+{
+    if (paintingDisabled() || !color.alpha() || (thickness <= 0))
+        return;
+
+    // A border that meets itself in the middle is a fill.
+    if (((thickness * 2) >= r.width()) || ((thickness * 2) >= r.height())) {
+        fillRoundedRect(r, topLeft, topRight, bottomLeft, bottomRight, color);
+        return;
+    }
+
+    const IntSize radii[4] = { topLeft, topRight, bottomLeft, bottomRight };
+    IntRect rect(r);
+    rect.move(origin());
+
+    if (m_common->state.shouldAntialias && drawRoundedRectWithCornerMasks(m_data, rect, radii, thickness, rasterColor(color)))
+        return;
+
+    // The inner edge follows the outer one with the radii reduced by the thickness.
+    IntRect innerRect(rect);
+    innerRect.inflate(-thickness);
+
+    IntSize innerRadii[4];
+    for (int i = 0; i < 4; i++)
+        innerRadii[i] = IntSize(max(radii[i].width() - thickness, 0), max(radii[i].height() - thickness, 0));
+
+    Path path = Path::createRoundedRectangle(rect, topLeft, topRight, bottomLeft, bottomRight);
+    Path::createRoundedRectangle(innerRect, innerRadii[0], innerRadii[1], innerRadii[2], innerRadii[3]).apply(&path, appendPathElement);
+    path.setWindingRule(RULE_EVENODD);
+    m_data->fillPathColor(path, rasterColor(color), m_common->state.shouldAntialias);
 }
 
 void GraphicsContext::setBalExposeEvent(BalEventExpose* expose)
@@ -953,14 +1587,6 @@ BalDrawable* GraphicsContext::balDrawable() const
     return 0;//GDK_DRAWABLE(m_data->expose->window);
 }
 
-float GraphicsContext::transparencyLayer()
-{
-    if (!m_data->layers.isEmpty())
-        return m_data->layers.last();
-    else
-        return 1.0;
-}
-
 IntPoint GraphicsContext::translatePoint(const IntPoint& point) const
 {
     NotImplemented();
@@ -972,10 +1598,8 @@ void GraphicsContext::setUseAntialiasing(bool enable)
     if (paintingDisabled())
         return;
 
-    // When true, use the default Cairo backend antialias mode (usually this
-    // enables standard 'grayscale' antialiasing); false to explicitly disable
-    // antialiasing. This is the same strategy as used in drawConvexPolygon().
-    //cairo_set_antialias(m_data->cr, enable ? CAIRO_ANTIALIAS_DEFAULT : CAIRO_ANTIALIAS_NONE);
+    // Applies to the path fills and strokes.
+    m_common->state.shouldAntialias = enable;
 }
 
 } // namespace WebCore
@@ -57,8 +57,10 @@ namespace WKAL {
     const int cMisspellingLinePatternGapWidth = 1;
 
     class AffineTransform;
+    class DisplayList;
     class Font;
     class Generator;
+    class Gradient;
     class GraphicsContextPrivate;
     class GraphicsContextPlatformPrivate;
     class ImageBuffer;
@@ -87,6 +89,11 @@ namespace WKAL {
         PlatformGraphicsContext* platformContext() const;
         PlatformGraphicsContext* setPlatformContext(PlatformGraphicsContext*);  // Added by Paul Pedriana for EAWebKit.
 
+        // While a display list is set, drawing is recorded into it instead of going to the surface.
+        // platformContext() replays what was recorded so far, so direct users of the surface stay in order.
+        void setDisplayList(DisplayList*);
+        DisplayList* displayList() const;
+
         const Font& font() const;
         void setFont(const Font&);
         
@@ -115,7 +122,10 @@ namespace WKAL {
         void fillRect(const IntRect&, const Color&, bool solidFill = false);
         void fillRect(const FloatRect&, const Color&);
         void fillRect(const FloatRect&, Generator&);
+        void fillRect(const FloatRect&, Gradient&);
         void fillRoundedRect(const IntRect&, const IntSize& topLeft, const IntSize& topRight, const IntSize& bottomLeft, const IntSize& bottomRight, const Color&);
+        // Draws a border of the given thickness just inside a rounded rect, as with a uniform solid CSS border.
+        void strokeRoundedRect(const IntRect&, const IntSize& topLeft, const IntSize& topRight, const IntSize& bottomLeft, const IntSize& bottomRight, int thickness, const Color&);
         void clearRect(const FloatRect&, bool solidFill = false);
         void strokeRect(const FloatRect&, float lineWidth);
 
@@ -185,6 +195,12 @@ namespace WKAL {
         void beginPath();
         void addPath(const Path&);
 
+        // Fill or stroke the path set up with beginPath and addPath, with the fill or stroke color or with a gradient.
+        void fillPath();
+        void strokePath();
+        void fillPath(Gradient&);
+        void strokePath(Gradient&);
+
         void clip(const Path&);
         void clipOut(const Path&);
 
@@ -204,7 +220,6 @@ namespace WKAL {
         BalDrawable* balDrawable() const;
         BalEventExpose* balExposeEvent() const;
         IntPoint translatePoint(const IntPoint&) const;
-        float transparencyLayer();
 
  private:
         void savePlatformState();
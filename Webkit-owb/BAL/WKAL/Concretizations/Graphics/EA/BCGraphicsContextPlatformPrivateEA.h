@@ -36,8 +36,10 @@
 #include <stdio.h>
 #include <wtf/MathExtras.h>
 #include "BALBase.h"
+#include "Path.h"
 
 #include "EARaster.h"
+#include "BCDisplayListEA.h"
 
 
 
@@ -47,11 +49,33 @@ class GraphicsContextPlatformPrivate : public WKALBase {
 public:
     GraphicsContextPlatformPrivate()
     : surface(0)
+    , displayList(0)
+    , clipRegion(0)
     {
     }
 
     ~GraphicsContextPlatformPrivate()
     {
+        // The surface outlives us, so it can't keep pointing at our region.
+        if (surface && (surface->mpClipRegion == clipRegion))
+            surface->mpClipRegion = 0;
+        if (clipRegion)
+            clipRegion->Release();
+        for (size_t i = 0; i < clipStack.size(); ++i) {
+            if (clipStack[i].mpClipRegion)
+                clipStack[i].mpClipRegion->Release();
+        }
+    }
+
+    // Makes the surface clip to rect and pRegion, taking over the reference to pRegion.
+    void setClip(const EA::Raster::Rect& rect, EA::Raster::ClipRegion* pRegion)
+    {
+        if (clipRegion)
+            clipRegion->Release();
+
+        clipRegion = pRegion;
+        surface->mClipRect = rect;
+        surface->mpClipRegion = pRegion;
     }
 
     void save() {}
@@ -62,11 +86,115 @@ public:
     void rotate(float) {}
     void translate(float, float) {}
     void concatCTM(const AffineTransform&) {}
-    void beginTransparencyLayer() {}
-    void endTransparencyLayer() {}
 
-    Vector<float> layers;
+    // These draw into the surface, or record into the display list while there is one.
+    void fillRectColor(const EA::Raster::Rect& rect, const EA::Raster::Color& color)
+    {
+        if (displayList)
+            displayList->fillRectColor(rect, color);
+        else
+            EA::Raster::FillRectColor(surface, &rect, color);
+    }
+
+    void fillRectSolidColor(const EA::Raster::Rect& rect, const EA::Raster::Color& color)
+    {
+        if (displayList)
+            displayList->fillRectSolidColor(rect, color);
+        else
+            EA::Raster::FillRectSolidColor(surface, &rect, color);
+    }
+
+    void rectangleColor(int x1, int y1, int x2, int y2, const EA::Raster::Color& color)
+    {
+        if (displayList)
+            displayList->rectangleColor(x1, y1, x2, y2, color);
+        else
+            EA::Raster::RectangleColor(surface, x1, y1, x2, y2, color);
+    }
+
+    void lineColor(int x1, int y1, int x2, int y2, const EA::Raster::Color& color)
+    {
+        if (displayList)
+            displayList->lineColor(x1, y1, x2, y2, color);
+        else
+            EA::Raster::LineColor(surface, x1, y1, x2, y2, color);
+    }
+
+    void ellipseColor(int x, int y, int rx, int ry, const EA::Raster::Color& color)
+    {
+        if (displayList)
+            displayList->ellipseColor(x, y, rx, ry, color);
+        else
+            EA::Raster::EllipseColor(surface, x, y, rx, ry, color);
+    }
+
+    void blitMaskA8(const uint8_t* pMask, int maskWidth, int maskHeight, int maskStride, int x, int y, const EA::Raster::Color& color)
+    {
+        if (displayList)
+            displayList->blitMaskA8(pMask, maskWidth, maskHeight, maskStride, x, y, color, 255);
+        else
+            EA::Raster::BlitMaskA8(pMask, maskWidth, maskHeight, maskStride, surface, x, y, color, 255);
+    }
+
+    void fillPathColor(const EA::Raster::PointF* pPoints, const int* pContourSizes, int contourCount, const EA::Raster::Color& color, EA::Raster::FillRule fillRule, bool bAntialias)
+    {
+        if (displayList)
+            displayList->fillPathColor(pPoints, pContourSizes, contourCount, color, fillRule, bAntialias);
+        else
+            EA::Raster::FillPathColor(surface, pPoints, pContourSizes, contourCount, color, fillRule, bAntialias, &rasterScratch);
+    }
+
+    void fillPathColor(const Path& path, const EA::Raster::Color& color, bool bAntialias)
+    {
+        Vector<EA::Raster::PointF> points;
+        Vector<int> contourSizes;
+
+        path.flatten(points, contourSizes);
+        fillPathColor(points.data(), contourSizes.data(), contourSizes.size(), color, (path.windingRule() == RULE_EVENODD) ? EA::Raster::kFillRuleEvenOdd : EA::Raster::kFillRuleNonZero, bAntialias);
+    }
+
+    void fillPathGradient(const EA::Raster::PointF* pPoints, const int* pContourSizes, int contourCount, const EA::Raster::GradientFill& gradient, EA::Raster::FillRule fillRule, bool bAntialias)
+    {
+        if (displayList)
+            displayList->fillPathGradient(pPoints, pContourSizes, contourCount, gradient, fillRule, bAntialias);
+        else
+            EA::Raster::FillPathGradient(surface, pPoints, pContourSizes, contourCount, gradient, fillRule, bAntialias, &rasterScratch);
+    }
+
+    void fillPathGradient(const Path& path, const EA::Raster::GradientFill& gradient, bool bAntialias)
+    {
+        Vector<EA::Raster::PointF> points;
+        Vector<int> contourSizes;
+
+        path.flatten(points, contourSizes);
+        fillPathGradient(points.data(), contourSizes.data(), contourSizes.size(), gradient, (path.windingRule() == RULE_EVENODD) ? EA::Raster::kFillRuleEvenOdd : EA::Raster::kFillRuleNonZero, bAntialias);
+    }
+
     EA::Raster::Surface *surface;
+    DisplayList* displayList;   // Non-null while the paint is recorded instead of drawn.
+    Path currentPath;           // Set up by beginPath and addPath, in surface coordinates.
+    EA::Raster::RasterScratch rasterScratch;
+
+    // The clip when each save() was done, restored by restore(). The regions are AddRef'd.
+    struct ClipState {
+        EA::Raster::Rect mClipRect;
+        EA::Raster::ClipRegion* mpClipRegion;
+    };
+
+    EA::Raster::ClipRegion* clipRegion;     // The surface's clip region, or NULL while the clip is just its clip rect.
+    Vector<ClipState> clipStack;
+
+    // While a transparency layer is open, drawing goes into an offscreen surface the size of the clip, 
+    // with the origin moved to match. Ending the layer blends it into the surface below with its opacity.
+    struct TransparencyLayer {
+        EA::Raster::Surface*    mpSurface;      // The surface below, which keeps its clip while the layer is drawn. NULL if the layer has no surface of its own.
+        EA::Raster::ClipRegion* mpClipRegion;   // Its clipRegion.
+        DisplayList*            mpDisplayList;  // Recording stops for the layer and picks up again after it.
+        EA::Raster::Rect        mBounds;        // Where the layer goes in mpSurface.
+        float                   mOpacity;
+    };
+
+    Vector<TransparencyLayer> layers;
 };
 
 } // namespace WebCore
@@ -45,7 +45,7 @@ namespace WKAL {
             , paintingDisabled(false)
             , shadowBlur(0)
             , origin(0,0)
-            , clipRectRestore(0,0,0,0)
+            , shouldAntialias(true)
         {
         }
 
@@ -60,10 +60,7 @@ namespace WKAL {
         unsigned shadowBlur;
         Color shadowColor;
         IntSize origin;
-        IntRect clipRectRestore;
-        
-        void setClipRectRestore(const IntRect &r) {clipRectRestore = r  ;}
-        const IntRect getClipRectRestore(void) const {return clipRectRestore ;}
+        bool shouldAntialias;
     };
 
     class GraphicsContextPrivate: public WTF::FastAllocBase {
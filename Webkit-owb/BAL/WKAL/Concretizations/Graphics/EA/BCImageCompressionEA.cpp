@@ -35,6 +35,8 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "config.h"
 #include "BCImageCompressionEA.h"
 #include "AlwaysInline.h"
+#include <wtf/FastAllocBase.h>
+#include <wtf/HashMap.h>
 #include <stdlib.h>
 #include <EAWebKit/EAWebKitConfig.h>
 #include <EAWebKit/internal/EAWebKitAssert.h>
@@ -1302,6 +1304,72 @@ int DeCompressYCoCgDXT5( const byte *inBuf, byte *outBuf, const int width, const
     return outByteCount;
 }
 
+/*F*************************************************************************************************/
+/*!
+    \Function    DeCompressYCoCgDXT5Region( const byte *inBuf, byte *outBuf, const int width, const int height, const EA::Raster::Rect& region ) 
+
+    \Description  Same as DeCompressYCoCgDXT5() but only restores the 4x4 blocks that overlap the region
+                  and converts them to ARGB. The rest of outBuf is left untouched.
+
+                  The compressed blocks are stored in rows of (width + 3) / 4 blocks so any block 
+                  can be found directly.
+
+    \Input          const byte *inBuf
+    \Input          byte *outBuf        The full width x height ARGB buffer
+    \Input          const int width
+    \input          const int height 
+    \input          const EA::Raster::Rect& region   Must be within the image
+
+    \Output         int size output in bytes
+        
+    \Version    1.0        10/16/26 Created
+*/
+/*************************************************************************************************F*/
+int DeCompressYCoCgDXT5Region( const byte *inBuf, byte *outBuf, const int width, const int height, const EA::Raster::Rect& region ) 
+{
+    byte colorBlock[64];    // 4x4 texel work space a linear array 
+    int outByteCount =0;
+
+    const int blocksPerRow = (width + 3) >> 2;
+    const int blockX0 = region.x >> 2;
+    const int blockY0 = region.y >> 2;
+    const int blockX1 = (region.x + region.w + 3) >> 2;
+    const int blockY1 = (region.y + region.h + 3) >> 2;
+
+    for( int by = blockY0; by < blockY1; by++ )
+    {
+        const int heightRemain = height - (by << 2);
+        const byte* pCurInBuffer = inBuf + ((by * blocksPerRow) + blockX0) * 16;
+        byte* pOutRow = outBuf + ((by << 2) * width * 4);
+
+        for( int bx = blockX0; bx < blockX1; bx++, pCurInBuffer += 16 )
+        {
+            RestoreLumaAlphaBlock(pCurInBuffer, colorBlock);
+            RestoreChromaBlock(pCurInBuffer, colorBlock);
+
+            const int widthRemain = width - (bx << 2);
+            if( (widthRemain < 4) || (heightRemain < 4) )
+                outByteCount += StoreBlock(colorBlock, width, widthRemain, heightRemain, pOutRow + (bx << 4));
+            else
+                outByteCount += StoreBlock(colorBlock, width, pOutRow + (bx << 4));
+        }
+    }
+
+    // Convert the restored texels row by row, as they are not contiguous in the output.
+    const int x0 = blockX0 << 2;
+    const int y0 = blockY0 << 2;
+    const int x1 = ((blockX1 << 2) < width)  ? (blockX1 << 2) : width;
+    const int y1 = ((blockY1 << 2) < height) ? (blockY1 << 2) : height;
+
+    for( int y = y0; y < y1; y++ )
+    {
+        byte* pRow = outBuf + ((y * width) + x0) * 4;
+        ConvertCoCg_YToRGB( pRow, pRow, x1 - x0, 1 );
+    }
+
+    return outByteCount;
+}
+
 #endif // EAWEBKIT_USE_YCOCGDXT5_COMPRESSION
 
 
@@ -1531,7 +1599,8 @@ int PackAsCompressedImage(EA::Raster::Surface* pImage, bool hasAlpha,  bool allD
     if( (allDataReceived == false) || 
         (IsCompressionActive() == false) ||
         ((pImage->mSurfaceFlags & COMPRESSION_SURFACE_FLAG_CHECK) != 0) || 
-        (pImage->mPixelFormat.mPixelFormatType != EA::Raster::kPixelFormatTypeARGB) ) 
+        ((pImage->mPixelFormat.mPixelFormatType != EA::Raster::kPixelFormatTypeARGB) && 
+         (pImage->mPixelFormat.mPixelFormatType != EA::Raster::kPixelFormatTypePARGB)) ) 
             return 0;
 
     int size = pImage->mHeight * pImage->mWidth;
@@ -1556,13 +1625,53 @@ int PackAsCompressedImage(EA::Raster::Surface* pImage, bool hasAlpha,  bool allD
     return outSize;
 }
 
+// Decompresses pImage into the ARGB surface pARGBImage, which has the same size.
+// If pRegion is not NULL and the image is a YCoCgDXT5, only the blocks overlapping pRegion get decompressed.
+static bool UnpackInto(EA::Raster::Surface* pImage, EA::Raster::Surface* pARGBImage, const EA::Raster::Rect* pRegion)
+{
+    // 11/09/09 CSidhall Added notify start of process to user
+	NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeImageCompressionUnPack, EA::WebKit::kVProcessStatusStarted);
+	    
+    int bufferSize = (pImage->mWidth * pImage->mHeight * pImage->mPixelFormat.mBytesPerPixel);
+    int outSize=0; 
+
+#if EAWEBKIT_USE_RLE_COMPRESSION
+    if( (pImage->mSurfaceFlags & EA::Raster::kFlagCompressedRLE) != 0 )
+        outSize = DecompressFromRLE( pImage->mpData, pARGBImage->mpData, bufferSize);
+#endif
+
+#if EAWEBKIT_USE_YCOCGDXT5_COMPRESSION
+    if( ( (pImage->mSurfaceFlags & EA::Raster::kFlagCompressedYCOCGDXT5) != 0 ) && (outSize == 0) ) {   
+        if(pRegion) {
+            // Only a part of the image so there is no full size to check against.
+            outSize = DeCompressYCoCgDXT5Region( ( byte*) pImage->mpData, (byte* )pARGBImage->mpData, pImage->mWidth, pImage->mHeight, *pRegion ); 
+            bufferSize = outSize;
+        }
+        else {
+            outSize = DeCompressYCoCgDXT5( ( byte*) pImage->mpData, (byte* )pARGBImage->mpData, pImage->mWidth, pImage->mHeight ); 
+            ConvertCoCg_YToRGB( (byte*) pARGBImage->mpData, (byte*) pARGBImage->mpData, pImage->mWidth, pImage->mHeight );
+        }
+    }
+#endif
+    
+	NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeImageCompressionUnPack, EA::WebKit::kVProcessStatusEnded);
+
+    // Normally outSize and bufferSize should be the same or we have a problem with the compress/decompress...
+    if( (outSize != bufferSize) || (outSize == 0) ) {
+        EAW_ASSERT(0);
+        return false;
+    }
+    return true;
+}
+
 /*F*************************************************************************************************/
 /*!
     \Function       UnpackCompressedImage(EA::Raster::Surface* pImage)   
 
     \Description    Decompression if pImage was compressed.   
    
-                    Note: The caller must delete the returned surface after the draw.                    
+                    Note: The returned surface is a scratch surface. The caller must give it back with 
+                    EA::Raster::ReleasePooledSurface after the draw.
                       
     \Input          EA::Raster::Surface* pImage  Output of decompressed image      
   
@@ -1580,42 +1689,248 @@ EA::Raster::Surface* UnpackCompressedImage(EA::Raster::Surface* pImage)
     }
 
     // Allocate a buffer for the decompressed ARGB
-    pARGBImage =  CreateSurface(pImage->mWidth, pImage->mHeight, pImage->mPixelFormat.mPixelFormatType);        
+    pARGBImage = EA::Raster::AcquirePooledSurface(pImage->mWidth, pImage->mHeight, pImage->mPixelFormat.mPixelFormatType);
     if(pARGBImage == NULL) {
         // Not enough mem to decompress the image    
         EAW_ASSERT(0);
         return NULL;
     }
 
-    // 11/09/09 CSidhall Added notify start of process to user
-	NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeImageCompressionUnPack, EA::WebKit::kVProcessStatusStarted);
-	    
-    int bufferSize = (pImage->mWidth * pImage->mHeight * pImage->mPixelFormat.mBytesPerPixel);
-    int outSize=0; 
+    if(!UnpackInto(pImage, pARGBImage, NULL)) {
+        // Remove the surface!
+        EA::Raster::ReleasePooledSurface(pARGBImage);
+        return NULL;
+    }
+    return pARGBImage;
+}
 
-#if EAWEBKIT_USE_RLE_COMPRESSION
-    if( (pImage->mSurfaceFlags & EA::Raster::kFlagCompressedRLE) != 0 )
-        outSize = DecompressFromRLE( pImage->mpData, pARGBImage->mpData, bufferSize);
-#endif
 
-#if EAWEBKIT_USE_YCOCGDXT5_COMPRESSION
-    if( ( (pImage->mSurfaceFlags & EA::Raster::kFlagCompressedYCOCGDXT5) != 0 ) && (outSize == 0) ) {   
-        outSize = DeCompressYCoCgDXT5( ( byte*) pImage->mpData, (byte* )pARGBImage->mpData, pImage->mWidth, pImage->mHeight ); 
-        ConvertCoCg_YToRGB( (byte*) pARGBImage->mpData, (byte*) pARGBImage->mpData, pImage->mWidth, pImage->mHeight );
+//--- Decompressed image cache ---
+
+// Default budget. The user can change it with EA::WebKit::SetRAMCacheBudgets.
+static const unsigned kDefaultUnpackedImageCacheCapacity = 1024 * 1024;
+
+struct UnpackedImage : public WTF::FastAllocBase {
+    const EA::Raster::Surface*  mpImage;        // The compressed image. Only used as a key.
+    EA::Raster::Surface*        mpUnpacked;
+    EA::Raster::Rect            mValidRect;     // The part of mpUnpacked that has been decompressed so far
+    unsigned                    mSize;          // In bytes
+    UnpackedImage*              mpPrev;         // LRU list
+    UnpackedImage*              mpNext;
+};
+
+typedef HashMap<const EA::Raster::Surface*, UnpackedImage*> UnpackedImageMap;
+
+static UnpackedImageMap& unpackedImages()
+{
+    static UnpackedImageMap* pMap = new UnpackedImageMap;
+    return *pMap;
+}
+
+static UnpackedImage*   gpUnpackedHead      = NULL;
+static UnpackedImage*   gpUnpackedTail      = NULL;
+static unsigned         gUnpackedSize       = 0;
+static unsigned         gUnpackedCapacity   = kDefaultUnpackedImageCacheCapacity;
+
+
+static bool IsEmptyRect(const EA::Raster::Rect& r)
+{
+    return (r.w <= 0) || (r.h <= 0);
+}
+
+
+static bool ContainsRect(const EA::Raster::Rect& outer, const EA::Raster::Rect& inner)
+{
+    return IsEmptyRect(inner) || 
+           ((inner.x >= outer.x) && (inner.y >= outer.y) && 
+            ((inner.x + inner.w) <= (outer.x + outer.w)) && ((inner.y + inner.h) <= (outer.y + outer.h)));
+}
+
+
+static void UnionRect(const EA::Raster::Rect& a, const EA::Raster::Rect& b, EA::Raster::Rect& result)
+{
+    if(IsEmptyRect(a)) 
+        result = b;
+    else if(IsEmptyRect(b)) 
+        result = a;
+    else {
+        const int x0 = (a.x < b.x) ? a.x : b.x;
+        const int y0 = (a.y < b.y) ? a.y : b.y;
+        const int x1 = ((a.x + a.w) > (b.x + b.w)) ? (a.x + a.w) : (b.x + b.w);
+        const int y1 = ((a.y + a.h) > (b.y + b.h)) ? (a.y + a.h) : (b.y + b.h);
+        result = EA::Raster::Rect(x0, y0, x1 - x0, y1 - y0);
     }
-#endif
-    
-	NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeImageCompressionUnPack, EA::WebKit::kVProcessStatusEnded);
+}
 
-    // Normally outSize and bufferSize should be the same or we have a problem with the compress/decompress...
-    if( (outSize != bufferSize) || (outSize == 0) ) {
-        EAW_ASSERT(0);
-        
-        // Remove the surface!
-        EA::Raster::DestroySurface(pARGBImage);
+
+static void UnlinkUnpackedImage(UnpackedImage* pEntry)
+{
+    if(pEntry->mpPrev)
+        pEntry->mpPrev->mpNext = pEntry->mpNext;
+    else
+        gpUnpackedHead = pEntry->mpNext;
+
+    if(pEntry->mpNext)
+        pEntry->mpNext->mpPrev = pEntry->mpPrev;
+    else
+        gpUnpackedTail = pEntry->mpPrev;
+}
+
+
+static void LinkUnpackedImageAtHead(UnpackedImage* pEntry)
+{
+    pEntry->mpPrev = NULL;
+    pEntry->mpNext = gpUnpackedHead;
+    if(gpUnpackedHead)
+        gpUnpackedHead->mpPrev = pEntry;
+    else
+        gpUnpackedTail = pEntry;
+    gpUnpackedHead = pEntry;
+}
+
+
+static void DestroyUnpackedImage(UnpackedImage* pEntry)
+{
+    UnlinkUnpackedImage(pEntry);
+    unpackedImages().remove(pEntry->mpImage);
+
+    EAW_ASSERT(gUnpackedSize >= pEntry->mSize);
+    gUnpackedSize -= pEntry->mSize;
+
+    EA::Raster::DestroySurface(pEntry->mpUnpacked);
+    WTF::fastDelete<UnpackedImage>(pEntry);
+}
+
+
+// Evicts from the tail. The most recently used image is never evicted, as the caller is still using it.
+static void PruneUnpackedImages(unsigned targetSize, bool keepHead)
+{
+    while((gUnpackedSize > targetSize) && gpUnpackedTail && !(keepHead && (gpUnpackedTail == gpUnpackedHead)))
+        DestroyUnpackedImage(gpUnpackedTail);
+}
+
+
+/*F*************************************************************************************************/
+/*!
+    \Function       GetUnpackedImage(EA::Raster::Surface* pImage, const EA::Raster::Rect* pRect)   
+
+    \Description    Returns a decompressed copy of pImage if it was compressed. 
+                    Copies are kept in a small LRU cache so an image that gets redrawn (scrolling, 
+                    animations elsewhere on the page) does not get decompressed on every draw.
+                    
+                    If pRect is not NULL, only the part of the image within pRect is guaranteed to be 
+                    decompressed. YCoCgDXT5 images then only decode the 4x4 blocks needed for it. 
+                    RLE images can only be decoded as a whole.
+
+                    Note: The cache owns the returned surface. It must not be destroyed by the caller and 
+                    is only valid until the next call into the cache.
+                      
+    \Input          EA::Raster::Surface* pImage        The compressed image
+    \Input          const EA::Raster::Rect* pRect      The part of the image that is needed, NULL for all.
+  
+    \Output         EA::Raster::Surface* The decompressed image, NULL if pImage was not compressed or on failure.
+
+    \Version    1.0        10/16/26 Created
+*/
+/*************************************************************************************************F*/
+EA::Raster::Surface* GetUnpackedImage(EA::Raster::Surface* pImage, const EA::Raster::Rect* pRect)
+{
+    if( (pImage->mSurfaceFlags & (EA::Raster::kFlagCompressedRLE | EA::Raster::kFlagCompressedYCOCGDXT5 )) == 0 ) {
         return NULL;
     }
-    return pARGBImage;
+
+    const EA::Raster::Rect fullRect(0, 0, pImage->mWidth, pImage->mHeight);
+    EA::Raster::Rect neededRect(fullRect);
+    if(pRect && !EA::Raster::IntersectRect(*pRect, fullRect, neededRect))
+        neededRect = EA::Raster::Rect(0, 0, 0, 0);
+
+    UnpackedImage* pEntry = NULL;
+    UnpackedImageMap::iterator it = unpackedImages().find(pImage);
+
+    if(it != unpackedImages().end()) {
+        pEntry = it->second;
+        if(pEntry != gpUnpackedHead) {
+            UnlinkUnpackedImage(pEntry);
+            LinkUnpackedImageAtHead(pEntry);
+        }
+
+        if(ContainsRect(pEntry->mValidRect, neededRect))
+            return pEntry->mpUnpacked;
+    }
+    else {
+        EA::Raster::Surface* pARGBImage = CreateSurface(pImage->mWidth, pImage->mHeight, pImage->mPixelFormat.mPixelFormatType);        
+        if(pARGBImage == NULL) {
+            // Not enough mem to decompress the image    
+            EAW_ASSERT(0);
+            return NULL;
+        }
+
+        pEntry = WTF::fastNew<UnpackedImage>();
+        pEntry->mpImage    = pImage;
+        pEntry->mpUnpacked = pARGBImage;
+        pEntry->mValidRect = EA::Raster::Rect(0, 0, 0, 0);
+        pEntry->mSize      = pARGBImage->mHeight * pARGBImage->mStride;
+        LinkUnpackedImageAtHead(pEntry);
+        unpackedImages().add(pImage, pEntry);
+        gUnpackedSize += pEntry->mSize;
+
+        if(IsEmptyRect(neededRect))
+            return pEntry->mpUnpacked;
+    }
+
+    // Decode the bounding box of what we already have and what is now needed, so the valid part stays a single rect.
+    EA::Raster::Rect decodeRect;
+    UnionRect(pEntry->mValidRect, neededRect, decodeRect);
+
+    const bool bRegion = pRect && ((pImage->mSurfaceFlags & EA::Raster::kFlagCompressedYCOCGDXT5) != 0) && !ContainsRect(decodeRect, fullRect);
+    if(!UnpackInto(pImage, pEntry->mpUnpacked, bRegion ? &decodeRect : NULL)) {
+        DestroyUnpackedImage(pEntry);
+        return NULL;
+    }
+
+    if(bRegion) {
+        // The decode works on whole blocks, so the valid rect grows to the block boundaries.
+        const int x0 = decodeRect.x & ~3;
+        const int y0 = decodeRect.y & ~3;
+        const int x1 = (decodeRect.x + decodeRect.w + 3) & ~3;
+        const int y1 = (decodeRect.y + decodeRect.h + 3) & ~3;
+        pEntry->mValidRect = EA::Raster::Rect(x0, y0, ((x1 < fullRect.w) ? x1 : fullRect.w) - x0, ((y1 < fullRect.h) ? y1 : fullRect.h) - y0);
+    }
+    else
+        pEntry->mValidRect = fullRect;
+
+    PruneUnpackedImages(gUnpackedCapacity, true);
+
+    return pEntry->mpUnpacked;
+}
+
+
+// Drops the decompressed copy of an image. This needs to be called before a compressed image is destroyed,
+// as a new image could otherwise get allocated at the same address and pick up the stale copy.
+void RemoveUnpackedImage(const EA::Raster::Surface* pImage)
+{
+    UnpackedImageMap::iterator it = unpackedImages().find(pImage);
+    if(it != unpackedImages().end())
+        DestroyUnpackedImage(it->second);
+}
+
+
+void SetUnpackedImageCacheCapacity(unsigned capacity)
+{
+    gUnpackedCapacity = capacity;
+    PruneUnpackedImages(gUnpackedCapacity, false);
+}
+
+
+unsigned GetUnpackedImageCacheCapacity(void)
+{
+    return gUnpackedCapacity;
+}
+
+
+void ClearUnpackedImageCache(void)
+{
+    PruneUnpackedImages(0, false);
 }
 
 
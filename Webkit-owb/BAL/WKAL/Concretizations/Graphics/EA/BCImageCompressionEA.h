@@ -42,7 +42,15 @@ namespace WKAL {
     namespace BCImageCompressionEA {
 
     int PackAsCompressedImage(EA::Raster::Surface* pImage, bool hasAlpha,  bool allDataReceived);
-    EA::Raster::Surface* UnpackCompressedImage(EA::Raster::Surface* pImage);
+    EA::Raster::Surface* UnpackCompressedImage(EA::Raster::Surface* pImage);    // Returns a scratch surface, for EA::Raster::ReleasePooledSurface.
+
+    // Cached decompression for drawing. The returned surface is owned by the cache and is only valid 
+    // until the next call into it. If pRect is not NULL, only that part of the image is guaranteed to be decompressed.
+    EA::Raster::Surface* GetUnpackedImage(EA::Raster::Surface* pImage, const EA::Raster::Rect* pRect = NULL);
+    void RemoveUnpackedImage(const EA::Raster::Surface* pImage);
+    void SetUnpackedImageCacheCapacity(unsigned capacity);
+    unsigned GetUnpackedImageCacheCapacity(void);
+    void ClearUnpackedImageCache(void);
 
     // Status of Compression
     bool IsCompressionActive(void);
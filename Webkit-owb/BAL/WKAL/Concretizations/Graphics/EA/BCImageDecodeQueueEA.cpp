@@ -0,0 +1,222 @@
+/*
+Copyright (C) 2010 Electronic Arts, Inc.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of Electronic Arts, Inc. ("EA") nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS AND ITS CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ELECTRONIC ARTS OR ITS CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+// BCImageDecodeQueueEA.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "BCImageDecodeQueueEA.h"
+#include "BitmapImage.h"
+#include "ImageDecoder.h"
+#include <wtf/Threading.h>
+#include <EAWebKit/EAWebKit.h>
+#include <EAWebKit/EAWebKitView.h>
+#include <EAWebKit/internal/EAWebKitAssert.h>
+
+#if PLATFORM(PS3)
+    #include <ppu_intrinsics.h>
+#endif
+
+
+namespace WKAL {
+
+// How often finished jobs are looked for while there are some in flight, in seconds.
+static const double kPollInterval = 1.0 / 60.0;
+
+// Where a job is. Only the worker moves it on, and only the main thread reads it.
+enum JobState {
+    kJobQueued,
+    kJobRunning,
+    kJobFinished
+};
+
+
+struct ImageDecodeQueue::Job : public WTF::FastAllocBase {
+    BitmapImage*                    mpOwner;        // 0 once cancelled.
+    ImageDecoder*                   mpDecoder;
+    EA::WebKit::ViewProcessInfo     mProcessInfo;   // Reports the decode as a kVProcessTypeImageDecoder job.
+    int volatile                    mState;         // See JobState. Written with a barrier before it, see setJobState.
+    bool                            mStartReported; // Whether the main thread has sent kVProcessStatusStarted.
+};
+
+
+// Orders the memory accesses before the barrier against those after it, for all processors.
+// The worker's decoder writes have to be seen before its kJobFinished is, and the main thread
+// mustn't read the decoder before it has seen kJobFinished. WTF::Mutex can't be used for this,
+// as it does nothing in this port.
+static inline void memoryBarrier()
+{
+#if PLATFORM(PS3)
+    __lwsync();
+#elif COMPILER(MSVC)
+    MemoryBarrier();
+#elif COMPILER(GCC)
+    __sync_synchronize();
+#endif
+}
+
+
+// Runs on the dispatcher's threads. The barrier releases what was written before the new state.
+static inline void setJobState(int volatile* pState, int state)
+{
+    memoryBarrier();
+    *pState = state;
+}
+
+
+// Runs on the main thread. The barrier acquires what was written before the state that was read.
+static inline int getJobState(const int volatile* pState)
+{
+    const int state = *pState;
+    memoryBarrier();
+    return state;
+}
+
+
+ImageDecodeQueue* imageDecodeQueue()
+{
+    static ImageDecodeQueue* pQueue = new ImageDecodeQueue;
+    return pQueue;
+}
+
+
+ImageDecodeQueue::ImageDecodeQueue()
+    : m_pollTimer(this, &ImageDecodeQueue::pollTimerFired)
+    , m_nextJobId(1)
+{
+}
+
+
+ImageDecodeQueue::~ImageDecodeQueue()
+{
+    // Running jobs can't be stopped, so they and their decoders are left to the workers.
+    for (size_t i = 0; i < m_jobs.size(); ++i) {
+        if (getJobState(&m_jobs[i]->mState) == kJobFinished) {
+            delete m_jobs[i]->mpDecoder;
+            WTF::fastDelete(m_jobs[i]);
+        }
+    }
+}
+
+
+bool ImageDecodeQueue::isEnabled()
+{
+    return EA::WebKit::GetImageDecodeJobDispatcher() != 0;
+}
+
+
+void ImageDecodeQueue::add(BitmapImage* pOwner, ImageDecoder* pDecoder, unsigned frameBytes)
+{
+    EA::WebKit::EAWebKitImageDecodeJobDispatcher pDispatcher = EA::WebKit::GetImageDecodeJobDispatcher();
+    EAW_ASSERT(pOwner && pDecoder && pDispatcher && !contains(pOwner));
+
+    Job* pJob = WTF::fastNew<Job>();
+    pJob->mpOwner = pOwner;
+    pJob->mpDecoder = pDecoder;
+    pJob->mProcessInfo = EA::WebKit::ViewProcessInfo(EA::WebKit::kVProcessTypeImageDecoder, EA::WebKit::kVProcessStatusNone);
+    pJob->mProcessInfo.mJobId = m_nextJobId++;
+    pJob->mProcessInfo.mSize = (int)frameBytes;
+    pJob->mState = kJobQueued;
+    pJob->mStartReported = false;
+    m_jobs.append(pJob);
+
+    if (!m_pollTimer.isActive())
+        m_pollTimer.startRepeating(kPollInterval);
+
+    pDispatcher(decodeJob, pJob);
+}
+
+
+bool ImageDecodeQueue::contains(const BitmapImage* pOwner) const
+{
+    for (size_t i = 0; i < m_jobs.size(); ++i) {
+        if (m_jobs[i]->mpOwner == pOwner)
+            return true;
+    }
+    return false;
+}
+
+
+void ImageDecodeQueue::cancel(const BitmapImage* pOwner)
+{
+    for (size_t i = 0; i < m_jobs.size(); ++i) {
+        if (m_jobs[i]->mpOwner == pOwner)
+            m_jobs[i]->mpOwner = 0;
+    }
+}
+
+
+// Runs on the dispatcher's threads. The application hears about the job from pollTimerFired, 
+// as its view notifications are only ever sent on the main thread.
+void ImageDecodeQueue::decodeJob(void* pContext)
+{
+    Job* const pJob = static_cast<Job*>(pContext);
+
+    setJobState(&pJob->mState, kJobRunning);
+    pJob->mpDecoder->frameBufferAtIndex(0);
+
+    // The main thread takes the job over as soon as it sees this.
+    setJobState(&pJob->mState, kJobFinished);
+}
+
+
+void ImageDecodeQueue::pollTimerFired(Timer<ImageDecodeQueue>*)
+{
+    for (size_t i = 0; i < m_jobs.size(); ) {
+        Job* const pJob = m_jobs[i];
+        const int state = getJobState(&pJob->mState);
+
+        if ((state != kJobQueued) && !pJob->mStartReported) {
+            pJob->mStartReported = true;
+            NOTIFY_PROCESS_STATUS(pJob->mProcessInfo, EA::WebKit::kVProcessStatusStarted);
+        }
+
+        if (state != kJobFinished) {
+            ++i;
+            continue;
+        }
+
+        NOTIFY_PROCESS_STATUS(pJob->mProcessInfo, EA::WebKit::kVProcessStatusEnded);
+
+        // Out of the list before the image hears about it, as that can add a new job.
+        m_jobs.remove(i);
+
+        if (pJob->mpOwner)
+            pJob->mpOwner->decodeJobComplete(pJob->mpDecoder);
+        else
+            delete pJob->mpDecoder;
+
+        WTF::fastDelete(pJob);
+    }
+
+    if (m_jobs.isEmpty())
+        m_pollTimer.stop();
+}
+
+} // namespace
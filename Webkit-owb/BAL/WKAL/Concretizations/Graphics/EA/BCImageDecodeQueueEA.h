@@ -0,0 +1,88 @@
+/*
+Copyright (C) 2010 Electronic Arts, Inc.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of Electronic Arts, Inc. ("EA") nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS AND ITS CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ELECTRONIC ARTS OR ITS CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+// BCImageDecodeQueueEA.h
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ImageDecodeQueue_h
+#define ImageDecodeQueue_h
+
+#include <wtf/FastAllocBase.h>
+#include <wtf/Vector.h>
+#include "BALBase.h"
+#include "Timer.h"
+
+
+namespace WKAL {
+
+    class BitmapImage;
+    class ImageDecoder;
+
+    // Runs image decodes on the threads of the application's image decode dispatcher 
+    // (see EA::WebKit::SetImageDecodeJobDispatcher), so that a large image doesn't stall the 
+    // paint that first draws it. Only the job's decoder is touched off the main thread. 
+    // A timer polls the jobs on the main thread and hands each finished decoder back to its image.
+    class ImageDecodeQueue : public WTF::FastAllocBase {
+    public:
+        ImageDecodeQueue();
+        ~ImageDecodeQueue();
+
+        // Whether an application dispatcher is installed, without which nothing can be queued.
+        static bool isEnabled();
+
+        // Starts decoding the first frame of pDecoder for pOwner. The queue owns pDecoder until
+        // it is handed back through BitmapImage::decodeJobComplete.
+        void add(BitmapImage* pOwner, ImageDecoder* pDecoder, unsigned frameBytes);
+
+        // Whether pOwner has a decode in flight.
+        bool contains(const BitmapImage* pOwner) const;
+
+        // Drops the decode of pOwner. A job that is already running still finishes, but its decoder 
+        // gets thrown away then.
+        void cancel(const BitmapImage* pOwner);
+
+    private:
+        struct Job;
+
+        static void decodeJob(void* pContext);
+        void pollTimerFired(Timer<ImageDecodeQueue>*);
+
+        Vector<Job*>            m_jobs;
+        Timer<ImageDecodeQueue> m_pollTimer;
+        int                     m_nextJobId;
+    };
+
+    // Returns the global image decode queue.
+    ImageDecodeQueue* imageDecodeQueue();
+
+} // namespace
+
+
+
+#endif  // ImageDecodeQueue_h
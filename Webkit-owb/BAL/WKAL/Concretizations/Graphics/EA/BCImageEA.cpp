@@ -39,6 +39,7 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "FloatRect.h"
 #include "GraphicsContext.h"
 #include "ImageObserver.h"
+#include "ImageDecoder.h"
 #include <math.h>
 #include "EARaster.h"
 #include <EAWebKit/EAWebKit.h>
@@ -46,6 +47,9 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "EARaster.h"
 #include "EARasterColor.h"
 #include "BCImageCompressionEA.h"
+#include "BCScaledImageCacheEA.h"
+#include "BCImageDecodeQueueEA.h"
+#include "BCDisplayListEA.h"
 
 // This function loads resources from WebKit.
 Vector<char> loadResourceIntoArray(const char*);
@@ -65,10 +69,64 @@ static bool IsImageAdditiveBlendingActive(void)
 }
 
 
+// Returns the surface that context draws into. Unlike platformContext(), this doesn't replay 
+// the context's display list, as the image blits get recorded in that same list.
+static EA::Raster::Surface* GetTargetSurface(GraphicsContext* context)
+{
+    DisplayList* const pDisplayList = context->displayList();
+
+    return pDisplayList ? pDisplayList->target() : context->platformContext();
+}
+
+
+// Blits to the context's surface, or records the blit if the context has a display list.
+static void BlitToContext(GraphicsContext* context, EA::Raster::Surface* pSource, const EA::Raster::Rect* pRectSource, 
+                          const EA::Raster::Rect* pRectDest, const EA::Raster::Rect* pDestClipRect, bool additive)
+{
+    DisplayList* const pDisplayList = context->displayList();
+
+    if (pDisplayList)
+        pDisplayList->blit(pSource, pRectSource, pRectDest, pDestClipRect, additive, 255);
+    else
+        EA::Raster::Blit(pSource, pRectSource, context->platformContext(), pRectDest, pDestClipRect, additive);
+}
+
+
+// Resamples rectSource of pSource into rectDest of the context's surface, or records that if the context has a display list.
+static void BlitScaledToContext(GraphicsContext* context, EA::Raster::Surface* pSource, const EA::Raster::Rect& rectSource, 
+                                const EA::Raster::Rect& rectDest, const EA::Raster::Rect* pDestClipRect, bool additive)
+{
+    DisplayList* const pDisplayList = context->displayList();
+
+    if (pDisplayList)
+        pDisplayList->blitScaled(pSource, rectSource, rectDest, pDestClipRect, EA::Raster::kScaleFilterBilinear, additive, 255);
+    else
+        EA::Raster::BlitScaled(pSource, &rectSource, context->platformContext(), &rectDest, pDestClipRect, EA::Raster::kScaleFilterBilinear, additive);
+}
+
+
+// Maps a rect in image coordinates to the pixels of a frame decoded at frameScale of the image size.
+// The far edges round up, as the decoders keep the partial last sample of each row and column.
+static FloatRect MapToFrame(const FloatRect& rect, const FloatSize& frameScale)
+{
+    if ((frameScale.width() == 1.0f) && (frameScale.height() == 1.0f))
+        return rect;
+
+    const float x = rect.x() * frameScale.width();
+    const float y = rect.y() * frameScale.height();
+
+    return FloatRect(x, y, ceilf(rect.right() * frameScale.width()) - x, ceilf(rect.bottom() * frameScale.height()) - y);
+}
+
+
 void FrameData::clear()
 {
     if (m_frame)
     {
+        #if EAWEBKIT_USE_RLE_COMPRESSION || EAWEBKIT_USE_YCOCGDXT5_COMPRESSION
+        BCImageCompressionEA::RemoveUnpackedImage(m_frame);
+        #endif
+
         EA::Raster::DestroySurface(m_frame);
 
         m_frame    = 0;
@@ -94,6 +152,7 @@ BitmapImage::BitmapImage(BalSurface* pSurface, ImageObserver* pObserver)
     , m_decodedSize(0)
     , m_haveFrameCount(true)
     , m_frameCount(1)
+    , m_decodeScaleShift(-1)
 {
     initPlatformData();
 
@@ -110,13 +169,103 @@ BitmapImage::BitmapImage(BalSurface* pSurface, ImageObserver* pObserver)
 }
 
 
-void BitmapImage::draw(GraphicsContext* context, const FloatRect& dst, const FloatRect& src, CompositeOperator op)
+void BitmapImage::updateDecodeScale(float drawScaleX, float drawScaleY)
+{
+    if (!m_source.initialized() || !m_data || !isSizeAvailable())
+        return;
+
+    // The largest power of two reduction that still has a decoded pixel for every dest pixel.
+    const float drawScale = (drawScaleX > drawScaleY) ? drawScaleX : drawScaleY;
+    if (drawScale <= 0.0f)
+        return;
+
+    // Decoders go down to 1/8, which is the smallest libjpeg scales to.
+    int shift = 0;
+    while ((shift < 3) && (drawScale * (2 << shift) <= 1.0f))
+        ++shift;
+
+    // Once decoded, the scale only ever shrinks, so that the largest size drawn so far is what gets kept.
+    if ((m_decodeScaleShift >= 0) && (shift >= m_decodeScaleShift))
+        return;
+    m_decodeScaleShift = shift;
+
+    if (!m_source.setDecodeScaleShift(shift)) {
+        // The decoder is already committed to a smaller size, so start the decode over at the new one.
+        destroyDecodedData(false);
+        if (m_source.decodeScaleShift() != shift) {
+            m_source.clear();
+            m_source.setData(m_data.get(), m_allDataReceived);
+        }
+    }
+}
+
+
+bool BitmapImage::decodeFrameAsynchronously()
+{
+    // Frames smaller than this decode quickly enough to do it while painting.
+    static const unsigned kMinAsyncDecodeBytes = 256 * 1024;
+
+    // Only the first decode of an image goes to the queue. Frames already decoded
+    // from the current decoder share its buffers, so it has to stay.
+    if (m_decodedSize || (m_currentFrame != 0))
+        return false;
+
+    ImageDecodeQueue* const pQueue = imageDecodeQueue();
+    if (pQueue->contains(this))
+        return true;
+
+    // The worker gets all of the data up front, so loading images keep decoding incrementally here.
+    if (!ImageDecodeQueue::isEnabled() || !m_allDataReceived || !m_data || !isSizeAvailable() || (frameBytes() < kMinAsyncDecodeBytes))
+        return false;
+
+    NativeImageSourcePtr pDecoder = m_source.createDetachedDecoder(m_data.get());
+    if (!pDecoder)
+        return false;
+
+    pQueue->add(this, pDecoder, frameBytes());
+    return true;
+}
+
+
+void BitmapImage::decodeJobComplete(NativeImageSourcePtr pDecoder)
+{
+    // The decoder is only any good if nothing got decoded here in the meantime and no draw has 
+    // asked for a larger size since. Otherwise the repaint below starts over.
+    if (!m_decodedSize && (pDecoder->scaleShift() == m_source.decodeScaleShift())) {
+        m_source.adoptDecoder(pDecoder);
+        m_haveFrameCount = false;
+
+        // Cache the decoded frame now. Until m_decodedSize is set, the repaint would queue another decode.
+        frameAtIndex(0);
+    }
+    else
+        delete pDecoder;
+
+    if (imageObserver())
+        imageObserver()->changedInRect(this, rect());
+}
+
+
+FloatSize BitmapImage::nativeImageScale() const
+{
+    const float scale = 1.0f / (1 << m_source.decodeScaleShift());
+    return FloatSize(scale, scale);
+}
+
+
+void BitmapImage::draw(GraphicsContext* context, const FloatRect& dst, const FloatRect& imageSrc, CompositeOperator op)
 {
     // 11/09/09 CSidhall Added notify start of process to user
 	NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeDrawImage, EA::WebKit::kVProcessStatusStarted);
 	
+    if ((imageSrc.width() > 0) && (imageSrc.height() > 0))
+        updateDecodeScale(dst.width() / imageSrc.width(), dst.height() / imageSrc.height());
+
     // CSidhall 1/14/09 Removed pImage as const pointer so it can be replace by a decompressed version when needed
-    EA::Raster::Surface* pImage = frameAtIndex(m_currentFrame);
+    EA::Raster::Surface* pImage = decodeFrameAsynchronously() ? NULL : frameAtIndex(m_currentFrame);
+
+    // The source rect in the pixels of the frame, which is smaller than the image if it was decoded scaled down.
+    const FloatRect src = MapToFrame(imageSrc, nativeImageScale());
 
     if (pImage) // If it's too early we won't have an image yet.
     {
@@ -132,7 +281,7 @@ void BitmapImage::draw(GraphicsContext* context, const FloatRect& dst, const Flo
             else
                 context->setCompositeOperation(op);
 
-            EA::Raster::Surface* cr = context->platformContext();
+            EA::Raster::Surface* cr = GetTargetSurface(context);
             
             float scaleX = dst.width()  / src.width();
             float scaleY = dst.height() / src.height();
@@ -160,75 +309,87 @@ void BitmapImage::draw(GraphicsContext* context, const FloatRect& dst, const Flo
 
             const bool bScaled = (scaleX != 1.0) || (scaleY != 1.0);
 
+            // Scaled copies are keyed by the frame as stored, which may be compressed.
+            EA::Raster::Surface* const pFrame = pImage;
+            EA::Raster::Surface* pZoomedSurface = NULL;
+            bool bDestroyZoomedSurface = false;
+            int zoomedWidth = 0, zoomedHeight = 0;
+
             if (bScaled)
             {
-                srcRect.x = (int)(src.x() * scaleX);  // Note by Paul Pedriana: Is this right? It seems wrong to me. Why is it modifing the source rect x/y?
-                srcRect.y = (int)(src.y() * scaleY);
-                srcRect.w = dstRect.w;
-                srcRect.h = dstRect.h;
+                EA::Raster::ZoomSurfaceSize(pFrame->mWidth, pFrame->mHeight, scaleX, scaleY, &zoomedWidth, &zoomedHeight);
+                pZoomedSurface = scaledImageCache()->get(this, pFrame, zoomedWidth, zoomedHeight);
             }
 
-            // To do: Create scratch surfaces that are used for these operations. 
-
             // CSidhall 1/14//09 Added image decompression.  
             // The actual compression is in BitmapImage::cacheFrame() after an image has been fully loaded
-            // This here just unpacks the full image into an allocated surface (which needs to be removed after the draw).
+            // This here gets the unpacked image from the decompression cache, which owns it.
             #if EAWEBKIT_USE_RLE_COMPRESSION || EAWEBKIT_USE_YCOCGDXT5_COMPRESSION            
             
-            EA::Raster::Surface* pDecompressedImage = BCImageCompressionEA::UnpackCompressedImage(pImage);         
-            
             // Note: we are changing the image pointer here to the decompressed image instead!      
-            if(pDecompressedImage != NULL)
-                pImage = pDecompressedImage;
-           
-            #endif 
-
-            // if (src != dst)  // Note by Paul Pedriana: Is this right? It seems wrong to me. Shouldn't it check for scaleX and scaleY?
-            if (bScaled)
+            if(pZoomedSurface == NULL)
             {
-                if (context->transparencyLayer() == 1.0)
+                EA::Raster::Surface* pDecompressedImage;
+
+                if (bScaled)
+                    pDecompressedImage = BCImageCompressionEA::GetUnpackedImage(pImage);
+                else
                 {
-                    EA::Raster::Surface* const pZoomedSurface = EA::Raster::ZoomSurface(pImage, scaleX, scaleY, 0);
+                    // Unscaled draws only need the source texels that land within the clip rect.
+                    EA::Raster::Rect clipRect, neededRect;
+                    const EA::Raster::Rect surfaceRect(0, 0, cr->mWidth, cr->mHeight);
+
+                    if (!EA::Raster::IntersectRect(cr->mClipRect, surfaceRect, clipRect))
+                        clipRect = EA::Raster::Rect(0, 0, 0, 0);
 
-                    EA::Raster::Blit(pZoomedSurface, &srcRect, cr, &dstRect, NULL, additive);
+                    const EA::Raster::Rect visibleRect(clipRect.x - dstRect.x + srcRect.x, clipRect.y - dstRect.y + srcRect.y, clipRect.w, clipRect.h);
+                    if (!EA::Raster::IntersectRect(srcRect, visibleRect, neededRect))
+                        neededRect = EA::Raster::Rect(0, 0, 0, 0);
 
-                    EA::Raster::DestroySurface(pZoomedSurface);
+                    pDecompressedImage = BCImageCompressionEA::GetUnpackedImage(pImage, &neededRect);
                 }
-                else
-                {
-                    // Note by Paul Pedriana: Why is it applying transparency via a new image when instead it could 
-                    // just do the blit with surface transparency added in? Is that not possible with SDL?
-                    EA::Raster::Surface* const pAlphadSurface = EA::Raster::CreateTransparentSurface(pImage, static_cast<int>(context->transparencyLayer() * 255));
-                    EA::Raster::Surface* const pZoomedSurface = EA::Raster::ZoomSurface(pAlphadSurface, scaleX, scaleY, 0);
 
-                    EA::Raster::Blit(pZoomedSurface, &srcRect, cr, &dstRect, NULL, additive);
+                if(pDecompressedImage != NULL)
+                    pImage = pDecompressedImage;
+            }
+           
+            #endif 
+
+            if (bScaled && !pZoomedSurface)
+            {
+                const unsigned zoomedSize = (unsigned)(zoomedWidth * zoomedHeight * pImage->mPixelFormat.mBytesPerPixel);
 
-                    EA::Raster::DestroySurface(pZoomedSurface);
-                    EA::Raster::DestroySurface(pAlphadSurface);
+                // Animated and partially loaded images change under us, so there is no point keeping their scaled copies.
+                // Everything else gets resampled straight into the target, which needs no temporary surface.
+                if (m_allDataReceived && (frameCount() == 1) && scaledImageCache()->canAdd(zoomedSize))
+                {
+                    pZoomedSurface = EA::Raster::CreateScaledSurface(pImage, zoomedWidth, zoomedHeight, EA::Raster::kScaleFilterBilinear);
+                    bDestroyZoomedSurface = pZoomedSurface && !scaledImageCache()->add(this, pFrame, pZoomedSurface);
                 }
             }
-            else
+
+            if (bScaled)
             {
-                if (context->transparencyLayer() == 1.0)
-                    EA::Raster::Blit(pImage, &srcRect, cr, &dstRect, NULL, additive);
-                else
+                if (pZoomedSurface)
                 {
-                    EA::Raster::Surface* const pAlphadSurface = CreateTransparentSurface(pImage, static_cast<int>(context->transparencyLayer() * 255));
+                    // The zoomed copy is in dest units.
+                    const EA::Raster::Rect zoomedRect((int)(src.x() * scaleX), (int)(src.y() * scaleY), dstRect.w, dstRect.h);
 
-                    EA::Raster::Blit(pAlphadSurface, &srcRect, cr, &dstRect, NULL, additive);
+                    BlitToContext(context, pZoomedSurface, &zoomedRect, &dstRect, NULL, additive);
 
-                    EA::Raster::DestroySurface(pAlphadSurface);
+                    if (bDestroyZoomedSurface)
+                        EA::Raster::DestroySurface(pZoomedSurface);
+                }
+                else
+                {
+                    const EA::Raster::Rect imageRect(0, 0, pImage->mWidth, pImage->mHeight);
+
+                    if (EA::Raster::IntersectRect(srcRect, imageRect, srcRect))
+                        BlitScaledToContext(context, pImage, srcRect, dstRect, NULL, additive);
                 }
             }
-            
-            // CSidhall 1/14//09 Added image decompression. This cleans up the allocated surface.
-            #if EAWEBKIT_USE_RLE_COMPRESSION || EAWEBKIT_USE_YCOCGDXT5_COMPRESSION             
-            
-            // Remove the full ARBG buffer of decompressed data        
-            if(pDecompressedImage != NULL)
-                EA::Raster::DestroySurface(pDecompressedImage);
-            
-            #endif  
+            else
+                BlitToContext(context, pImage, &srcRect, &dstRect, NULL, additive);
 
             startAnimation();
 
@@ -249,13 +410,16 @@ void Image::drawPattern(GraphicsContext* context, const FloatRect& tileRect, con
 
     NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeDrawImagePattern, EA::WebKit::kVProcessStatusStarted);
 	
+    // Tiles are drawn at the pattern transform's scale, so a bitmap needs no more than that decoded.
+    updateDecodeScale((float)patternTransform.a(), (float)patternTransform.d());
+
     // CSidhall - Removed pImage as const pointer so it can be changed for decompression
     EA::Raster::Surface* pImage = nativeImageForCurrentFrame();
 
     if (!pImage) // If it's too early we won't have an image yet.
         return;
 
-    EA::Raster::Surface* const cr = context->platformContext();
+    EA::Raster::Surface* const cr = GetTargetSurface(context);
     context->save();
     
     context->setCompositeOperation(op);
@@ -294,116 +458,83 @@ void Image::drawPattern(GraphicsContext* context, const FloatRect& tileRect, con
 
     context->clip(IntRect(adjDestRect)); // don't draw outside this
 
-    IntRect dest(IntPoint(), IntSize(pImage->mWidth, pImage->mHeight));
-    IntRect src(static_cast<int>(phase.x()), static_cast<int>(phase.y()), static_cast<int>(tileRect.size().width()), static_cast<int>(tileRect.size().height()));
-
-    int xMax = static_cast<int>(destRect.x() + destRect.width());
-    int yMax = static_cast<int>(destRect.y() + destRect.height());
-
-    EA::Raster::Rect srcRect, dstRect;
-
-    srcRect.x = 0;
-    srcRect.y = 0;
-
-    if (0 == src.width())
-        srcRect.w = pImage->mWidth;
-    else
-        srcRect.w = src.width();
-
-    if (0 == src.height())
-        srcRect.h = pImage->mHeight;
-    else
-        srcRect.h = src.height();
-
-    dstRect.x = dest.x();
-    dstRect.y = dest.y();
-    dstRect.w = dest.width();
-    dstRect.h = dest.height();
-
-    // compute ratio of the zoomed part:
-    const double ratioW = (double)dest.width()  / (double)srcRect.w;
-    const double ratioH = (double)dest.height() / (double)srcRect.h;
-
-   // CSidhall 1/14//09 Added image decompression.
-    #if EAWEBKIT_USE_RLE_COMPRESSION || EAWEBKIT_USE_YCOCGDXT5_COMPRESSION            
-    
-    EA::Raster::Surface* pDecompressedImage = BCImageCompressionEA::UnpackCompressedImage(pImage);         
-    
-    // Note: we are changing the image pointer here to the decompressed image!      
-    if(pDecompressedImage != NULL)
-        pImage = pDecompressedImage;
-    
-    #endif 
-
-    EA::Raster::Surface* pSurface = NULL;
-
-    if ((ratioW != 1.0) || (ratioH != 1.0))
+    // The part of the image that makes up one tile.
+    const FloatSize frameScale = nativeImageScale();
+    EA::Raster::Rect tileSrcRect((int)tileRect.x(), (int)tileRect.y(), (int)tileRect.width(), (int)tileRect.height());
+
+    if (0 == tileSrcRect.w)
+        tileSrcRect.w = (int)(pImage->mWidth / frameScale.width());
+    if (0 == tileSrcRect.h)
+        tileSrcRect.h = (int)(pImage->mHeight / frameScale.height());
+
+    // Tiles are laid out from the phase, each one being the tile rect under the pattern transform's scale.
+    const float tileW  = tileSrcRect.w * (float)patternTransform.a();
+    const float tileH  = tileSrcRect.h * (float)patternTransform.d();
+    const float phaseX = phase.x() + (tileSrcRect.x * (float)patternTransform.a()) + origin.width();
+    const float phaseY = phase.y() + (tileSrcRect.y * (float)patternTransform.d()) + origin.height();
+
+    // The same part in the pixels of the frame, which is smaller than the image if it was decoded scaled down.
+    const FloatRect frameTileRect = MapToFrame(FloatRect(tileSrcRect.x, tileSrcRect.y, tileSrcRect.w, tileSrcRect.h), frameScale);
+    EA::Raster::Rect srcRect((int)frameTileRect.x(), (int)frameTileRect.y(), (int)frameTileRect.width(), (int)frameTileRect.height());
+
+    // Only the tiles that touch the visible part of destRect get drawn.
+    const EA::Raster::Rect imageRect(0, 0, pImage->mWidth, pImage->mHeight);
+    const EA::Raster::Rect surfaceRect(0, 0, cr->mWidth, cr->mHeight);
+    const EA::Raster::Rect patternRect((int)floorf(destRect.x() + origin.width()), (int)floorf(destRect.y() + origin.height()), 
+                                       (int)ceilf(destRect.width()), (int)ceilf(destRect.height()));
+    EA::Raster::Rect visibleRect;
+
+    if ((tileW >= 1.0f) && (tileH >= 1.0f) && 
+        EA::Raster::IntersectRect(srcRect, imageRect, srcRect) &&
+        EA::Raster::IntersectRect(cr->mClipRect, surfaceRect, visibleRect) &&
+        EA::Raster::IntersectRect(visibleRect, patternRect, visibleRect))
     {
-        pSurface = EA::Raster::ZoomSurface(pImage, ratioW, ratioH, 0);
+       // CSidhall 1/14//09 Added image decompression.
+        #if EAWEBKIT_USE_RLE_COMPRESSION || EAWEBKIT_USE_YCOCGDXT5_COMPRESSION            
+        
+        EA::Raster::Surface* pDecompressedImage = BCImageCompressionEA::GetUnpackedImage(pImage);         
+        
+        // Note: we are changing the image pointer here to the decompressed image!      
+        if(pDecompressedImage != NULL)
+            pImage = pDecompressedImage;
+        
+        #endif 
 
-        // Adjust offset to the new referentiel (zoomed)
-        srcRect.x = (int)(src.x() * ratioW);
-        srcRect.y = (int)(src.y() * ratioH);
-    }
+        const bool additive = IsImageAdditiveBlendingActive();
+        const bool bScaled  = (tileW != (float)srcRect.w) || (tileH != (float)srcRect.h);
 
-    const bool additive = IsImageAdditiveBlendingActive();
+        // The first tile at or before the visible rect's left and top.
+        const float x0 = phaseX + (floorf((visibleRect.x - phaseX) / tileW) * tileW);
+        const float y0 = phaseY + (floorf((visibleRect.y - phaseY) / tileH) * tileH);
+        const int   x1 = visibleRect.x + visibleRect.w;
+        const int   y1 = visibleRect.y + visibleRect.h;
 
-    // EA/Alex Mole, 12/22/09: Just create the transparent surface once, rather than once per tile
-    // Create a transparency layer if we need one
-    EA::Raster::Surface* pAlphadSurface = NULL;
-    if( context->transparencyLayer() != 1.0 )
-    {
-        if( pSurface )
-        {
-            pAlphadSurface = EA::Raster::CreateTransparentSurface(pSurface, static_cast<int>(context->transparencyLayer() * 255));
-        }
-        else
+        for (int j = 0; ; ++j)
         {
-            pAlphadSurface = EA::Raster::CreateTransparentSurface(pImage, static_cast<int>(context->transparencyLayer() * 255));
-        }
-    }
+            // Tile edges are rounded from their float positions so that neighbouring tiles meet exactly.
+            const int ty  = (int)floorf(y0 + (j * tileH) + 0.5f);
+            const int tyn = (int)floorf(y0 + ((j + 1) * tileH) + 0.5f);
 
-    // Now decide on which surface we want to blit
-    EA::Raster::Surface* pSurfaceToBlit = pAlphadSurface;
-    if( !pSurfaceToBlit )
-    {
-        pSurfaceToBlit = pSurface;
-    }
-    if( !pSurfaceToBlit )
-    {
-        pSurfaceToBlit = pImage;
-    }
+            if (ty >= y1)
+                break;
 
-    for (int x = static_cast<int>(phase.x()); x <= xMax; x += pImage->mWidth)
-    {
-        for (int y = static_cast<int>(phase.y()); y <= yMax; y += pImage->mHeight)
-        {
-            dest.setLocation(IntPoint(x, y) + context->origin());
-            
-            dstRect.x = dest.x();
-            dstRect.y = dest.y();
-            dstRect.w = dest.width();
-            dstRect.h = dest.height();
-
-            EA::Raster::Blit(pSurfaceToBlit, &srcRect, cr, &dstRect, &clipRect, additive);
-        }
-    }
+            for (int i = 0; ; ++i)
+            {
+                const int tx  = (int)floorf(x0 + (i * tileW) + 0.5f);
+                const int txn = (int)floorf(x0 + ((i + 1) * tileW) + 0.5f);
 
-    if( pAlphadSurface )
-    {
-        EA::Raster::DestroySurface( pAlphadSurface );
-    }
+                if (tx >= x1)
+                    break;
 
-    if(pSurface)
-        EA::Raster::DestroySurface(pSurface);
+                const EA::Raster::Rect dstRect(tx, ty, txn - tx, tyn - ty);
 
-       #if EAWEBKIT_USE_RLE_COMPRESSION || EAWEBKIT_USE_YCOCGDXT5_COMPRESSION             
-        
-        // Remove the full ARBG buffer of decompressed data        
-        if(pDecompressedImage != NULL)
-            EA::Raster::DestroySurface(pDecompressedImage);
-        
-        #endif
+                if (!bScaled)
+                    BlitToContext(context, pImage, &srcRect, &dstRect, &clipRect, additive);
+                else if ((dstRect.w > 0) && (dstRect.h > 0))
+                    BlitScaledToContext(context, pImage, srcRect, dstRect, &clipRect, additive);
+            }
+        }
+    }
 
     context->restore();
 
@@ -421,6 +552,8 @@ void BitmapImage::initPlatformData()
 
 void BitmapImage::invalidatePlatformData()
 {
+    // The scaled copies of our frames are going away with the frames.
+    scaledImageCache()->remove(this, true);
 }
 
 
@@ -441,6 +574,22 @@ void BitmapImage::checkForSolidColor()
         // CS - Removed pSurface pointer as const so can change it for decompressed versions
         EA::Raster::Surface* pSurface = frameAtIndex(0);
 
+        // An image that is transparent all over, like a spacer, draws nothing at any size. Only complete frames have alpha rows.
+        if(pSurface && pSurface->mpAlphaRows)
+        {
+            bool bTransparent = true;
+
+            for(int y = 0; bTransparent && (y < pSurface->mHeight); ++y)
+                bTransparent = pSurface->mpAlphaRows[y].mbTransparent;
+
+            if(bTransparent)
+            {
+                m_solidColor   = Color(Color::transparent);
+                m_isSolidColor = true;
+                return;
+            }
+        }
+
        // CSidhall 1/15//09 Added image decompression support here in case image is compressed already
         #if EAWEBKIT_USE_RLE_COMPRESSION || EAWEBKIT_USE_YCOCGDXT5_COMPRESSION            
         
@@ -474,6 +623,7 @@ void BitmapImage::checkForSolidColor()
             int r, g, b, a;
             EA::Raster::ConvertColor(color, pSurface->mPixelFormat, r, g, b, a);
             m_solidColor.setRGB( EA::Raster::makeRGBA(r, g, b, a) );
+            m_isSolidColor = true;
         }
             
         // CSidhall 1/14/09 Added image decompression
@@ -481,7 +631,7 @@ void BitmapImage::checkForSolidColor()
         
         // Remove the full ARBG buffer of decompressed data        
         if(pDecompressedImage != NULL)
-            EA::Raster::DestroySurface(pDecompressedImage);
+            EA::Raster::ReleasePooledSurface(pDecompressedImage);
         
         #endif
     }
@@ -99,6 +99,8 @@ ImageDecoder* createDecoder(const Vector<char>& data)
 
 ImageSource::ImageSource()
     : m_decoder(0)
+    , m_decodeScaleShift(0)
+    , m_streamingAnimation(false)
 {
 }
 
@@ -124,8 +126,13 @@ void ImageSource::setData(SharedBuffer* data, bool allDataReceived)
     // This method will examine the data and instantiate an instance of the appropriate decoder plugin.
     // If insufficient bytes are available to determine the image type, no decoder plugin will be
     // made.
-    if (!m_decoder)
+    if (!m_decoder) {
         m_decoder = createDecoder(data->buffer());
+        if (m_decoder) {
+            m_decoder->setScaleShift(m_decodeScaleShift);
+            m_decoder->setStreamingAnimation(m_streamingAnimation);
+        }
+    }
 
     if (!m_decoder)
         return;
@@ -149,6 +156,65 @@ IntSize ImageSource::size() const
     return m_decoder->size();
 }
 
+int ImageSource::decodeScaleShift() const
+{
+    if (!m_decoder)
+        return m_decodeScaleShift;
+
+    return m_decoder->scaleShift();
+}
+
+bool ImageSource::setDecodeScaleShift(int shift)
+{
+    m_decodeScaleShift = shift;
+
+    if (!m_decoder)
+        return true;
+
+    return m_decoder->setScaleShift(shift);
+}
+
+IntSize ImageSource::frameSize() const
+{
+    if (!m_decoder)
+        return IntSize();
+
+    return m_decoder->scaledSize();
+}
+
+NativeImageSourcePtr ImageSource::createDetachedDecoder(SharedBuffer* data) const
+{
+    ImageDecoder* decoder = createDecoder(data->buffer());
+    if (!decoder)
+        return 0;
+
+    decoder->setScaleShift(decodeScaleShift());
+    decoder->setStreamingAnimation(m_streamingAnimation);
+    decoder->setDecodingOffMainThread(true);
+    decoder->setData(data, true);
+    return decoder;
+}
+
+void ImageSource::setStreamingAnimation(bool streaming)
+{
+    m_streamingAnimation = streaming;
+
+    if (m_decoder)
+        m_decoder->setStreamingAnimation(streaming);
+}
+
+bool ImageSource::streamingAnimation() const
+{
+    return m_decoder && m_decoder->streamingAnimation();
+}
+
+void ImageSource::adoptDecoder(NativeImageSourcePtr decoder)
+{
+    delete m_decoder;
+    m_decoder = decoder;
+    m_decoder->setDecodingOffMainThread(false);
+}
+
 int ImageSource::repetitionCount()
 {
     if (!m_decoder)
@@ -187,7 +253,7 @@ NativeImagePtr ImageSource::createFrameAtIndex(size_t index)
         return 0;
 
     void* p = buffer->bytes().data();
-    int   w = size().width();
+    int   w = frameSize().width();
     int   h = buffer->height();
 
     // This version will use (share) the decoder buffer directly instead of making another copy.
@@ -200,7 +266,26 @@ NativeImagePtr ImageSource::createFrameAtIndex(size_t index)
         copyBuffer = false;
     else
         copyBuffer = true;
-    pSurface = EA::Raster::CreateSurface(p, w, h, w * 4, EA::Raster::kPixelFormatTypeARGB, copyBuffer, false);
+    // The decoders premultiply the color by the alpha (see RGBA32Buffer::setRGBA), so the blits can use the cheaper premultiplied blend.
+    pSurface = EA::Raster::CreateSurface(p, w, h, w * 4, EA::Raster::kPixelFormatTypePARGB, copyBuffer, false);
+
+    // Once a frame is complete, tell the blits where it is opaque so they can copy those pixels instead of blending them.
+    if (pSurface && (buffer->status() == RGBA32Buffer::FrameComplete)) {
+        const Vector<RGBA32Buffer::RowAlpha>& rowAlpha = buffer->rowAlpha();
+
+        if (!buffer->hasAlpha())
+            pSurface->mSurfaceFlags |= EA::Raster::kFlagDisableAlpha;
+        else if (rowAlpha.size() >= (size_t)h) {
+            Vector<EA::Raster::AlphaRow> alphaRows(h);
+            for (int y = 0; y < h; ++y) {
+                alphaRows[y].mOpaqueBegin = rowAlpha[y].opaqueBegin;
+                alphaRows[y].mOpaqueEnd = rowAlpha[y].opaqueEnd;
+                alphaRows[y].mbTransparent = rowAlpha[y].transparent;
+            }
+            pSurface->SetAlphaRows(alphaRows.data());
+        }
+    }
+
     return pSurface;
 }
 
@@ -216,6 +301,15 @@ bool ImageSource::frameIsCompleteAtIndex(size_t index)
 }
 
 
+IntRect ImageSource::frameUpdateRectAtIndex(size_t index) const
+{
+    if (!m_decoder)
+        return IntRect();
+
+    return m_decoder->frameUpdateRect(index);
+}
+
+
 float ImageSource::frameDurationAtIndex(size_t index)
 {
     if (!m_decoder)
@@ -70,6 +70,7 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace WKAL {
 
+class IntRect;
 class IntSize;
 class SharedBuffer;
 
@@ -93,6 +94,26 @@ public:
 
     bool isSizeAvailable();
     IntSize size() const;
+
+    // Decoding scaled down to 1/(2^shift) of size() in each direction, for images that are drawn
+    // much smaller than their intrinsic size.  The scale can't change once the decoder has started
+    // on the first frame; setDecodeScaleShift returns false then, and the new scale applies after
+    // clear().  decodeScaleShift() is the scale the frames are actually decoded at.
+    int decodeScaleShift() const;
+    bool setDecodeScaleShift(int shift);
+    IntSize frameSize() const; // The size of the decoded frames.
+
+    // Makes a decoder for all of data at this source's decode scale, which belongs to the caller
+    // rather than this source so it can run on another thread.  Returns 0 for unknown formats.
+    NativeImageSourcePtr createDetachedDecoder(SharedBuffer* data) const;
+
+    // Streaming keeps only the pixels needed for the next frame of an animation in the decoder, at the
+    // cost of decoding it again on each loop. Decoders that can't stream ignore it.
+    void setStreamingAnimation(bool streaming);
+    bool streamingAnimation() const;
+
+    // Replaces the decoder with one made by createDetachedDecoder. The source takes ownership.
+    void adoptDecoder(NativeImageSourcePtr decoder);
     
     int repetitionCount();
     
@@ -103,6 +124,7 @@ public:
     float frameDurationAtIndex(size_t);
     bool frameHasAlphaAtIndex(size_t); // Whether or not the frame actually used any alpha.
     bool frameIsCompleteAtIndex(size_t); // Whether or not the frame is completely decoded.
+    IntRect frameUpdateRectAtIndex(size_t) const; // The part of the image that changes from the previous frame.
   
     // 7/14/09 CSidhall - Added for memory shrink and prune
     void resizeDecoderBufferAtIndex(int index, int size);
@@ -110,6 +132,8 @@ public:
 
 private:
     NativeImageSourcePtr m_decoder;
+    int m_decodeScaleShift;
+    bool m_streamingAnimation;
 };
 
 }
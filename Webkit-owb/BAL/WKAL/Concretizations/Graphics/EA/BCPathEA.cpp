@@ -39,136 +39,440 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "NotImplemented.h"
 #include "PlatformString.h"
 
+#include <algorithm>
 #include <math.h>
 #include <wtf/MathExtras.h>
+#include <EARaster/EARaster.h>
+
+using std::min;
+using std::max;
 
 namespace WKAL {
 
+// Curves get flattened into enough lines to stay within this many pixels of the curve.
+static const float kFlatteningTolerance = 0.1f;
+
+// Most curves need less, but this bounds what a huge curve can cost.
+static const int kMaxCurveSegments = 256;
+
+static int pointCount(PathElementType type)
+{
+    switch (type) {
+        case PathElementMoveToPoint:
+        case PathElementAddLineToPoint:
+            return 1;
+        case PathElementAddQuadCurveToPoint:
+            return 2;
+        case PathElementAddCurveToPoint:
+            return 3;
+        default:
+            return 0;
+    }
+}
+
+// After a close the current point goes back to the start of the subpath.
+static bool currentPoint(const PathStorage& path, FloatPoint& point)
+{
+    if (path.types.isEmpty())
+        return false;
+
+    if (path.types.last() != PathElementCloseSubpath) {
+        point = path.points.last();
+        return true;
+    }
+
+    size_t p = path.points.size();
+    for (size_t i = path.types.size(); i--; ) {
+        p -= pointCount(path.types[i]);
+        if (path.types[i] == PathElementMoveToPoint) {
+            point = path.points[p];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// The error of a curve split in n lines is under (max second difference of its points) * k / n^2, 
+// with k being 1/4 for quadratic curves and 3/4 for cubic ones.
+static int curveSegmentCount(float secondDifference, float k)
+{
+    const int n = static_cast<int>(ceilf(sqrtf(secondDifference * k / kFlatteningTolerance)));
+    return max(1, min(n, kMaxCurveSegments));
+}
+
+static float distance(float x, float y)
+{
+    return sqrtf(x * x + y * y);
+}
+
 Path::Path()
-//    : m_path(new CairoPath())
+    : m_path(new PathStorage)
+    , m_rule(RULE_NONZERO)
 {
-    //OWB_PRINTF("Path::Path\n");
 }
 
 Path::~Path()
 {
-    //OWB_PRINTF("Path::~Path\n");
-    //delete m_path;
+    delete m_path;
 }
 
 Path::Path(const Path& other)
-//    : m_path(new CairoPath())
+    : m_path(new PathStorage(*other.m_path))
+    , m_rule(other.m_rule)
 {
-    //OWB_PRINTF("Path::Path copy\n");
 }
 
 Path& Path::operator=(const Path& other)
 {
-    //OWB_PRINTF("Path::operator=\n");
     if (&other == this)
         return *this;
 
-    clear();
+    *m_path = *other.m_path;
+    m_rule = other.m_rule;
 
     return *this;
 }
 
 void Path::clear()
 {
-    //OWB_PRINTF("Path::clear\n");
+    m_path->types.shrink(0);
+    m_path->points.shrink(0);
 }
 
 bool Path::isEmpty() const
 {
-    //OWB_PRINTF("Path::isEmpty\n");
-    return true;
+    return m_path->types.isEmpty();
 }
 
 void Path::translate(const FloatSize& p)
 {
-    //OWB_PRINTF("Path::translate\n");
+    for (size_t i = 0; i < m_path->points.size(); ++i)
+        m_path->points[i] += p;
 }
 
 void Path::moveTo(const FloatPoint& p)
 {
-    //OWB_PRINTF("Path::moveTo\n");
+    // Consecutive moves only leave the last one.
+    if (!m_path->types.isEmpty() && (m_path->types.last() == PathElementMoveToPoint)) {
+        m_path->points.last() = p;
+        return;
+    }
+
+    m_path->types.append(PathElementMoveToPoint);
+    m_path->points.append(p);
 }
 
 void Path::addLineTo(const FloatPoint& p)
 {
-    //OWB_PRINTF("Path::addLineTo\n");
+    // Without a current point a line just starts the subpath, as with cairo_line_to.
+    if (isEmpty()) {
+        moveTo(p);
+        return;
+    }
+
+    m_path->types.append(PathElementAddLineToPoint);
+    m_path->points.append(p);
 }
 
 void Path::addRect(const FloatRect& rect)
 {
-    //OWB_PRINTF("Path::addRect\n");
+    moveTo(rect.location());
+    addLineTo(FloatPoint(rect.right(), rect.y()));
+    addLineTo(FloatPoint(rect.right(), rect.bottom()));
+    addLineTo(FloatPoint(rect.x(), rect.bottom()));
+    closeSubpath();
 }
 
-/*
- * inspired by libsvg-cairo
- */
 void Path::addQuadCurveTo(const FloatPoint& controlPoint, const FloatPoint& point)
 {
-    //OWB_PRINTF("Path::addQuadCurveTo\n");
+    if (isEmpty())
+        moveTo(controlPoint);
+
+    m_path->types.append(PathElementAddQuadCurveToPoint);
+    m_path->points.append(controlPoint);
+    m_path->points.append(point);
 }
 
 void Path::addBezierCurveTo(const FloatPoint& controlPoint1, const FloatPoint& controlPoint2, const FloatPoint& controlPoint3)
 {
-    //OWB_PRINTF("Path::addBezierCurveTo\n");
+    if (isEmpty())
+        moveTo(controlPoint1);
 
+    m_path->types.append(PathElementAddCurveToPoint);
+    m_path->points.append(controlPoint1);
+    m_path->points.append(controlPoint2);
+    m_path->points.append(controlPoint3);
 }
 
+// Same as cairo_arc and cairo_arc_negative: the angles are in radians, clockwise on screen 
+// unless anticlockwise is set, and a line joins the current point to the start of the arc.
 void Path::addArc(const FloatPoint& p, float r, float sa, float ea, bool anticlockwise)
 {
-    //OWB_PRINTF("Path::addArc\n");
+    float sweep = ea - sa;
+
+    if (!anticlockwise && (sweep < 0))
+        sweep = fmodf(sweep, 2 * piFloat) + 2 * piFloat;
+    else if (anticlockwise && (sweep > 0))
+        sweep = fmodf(sweep, 2 * piFloat) - 2 * piFloat;
+    sweep = max(-2 * piFloat, min(sweep, 2 * piFloat));
+
+    const FloatPoint start(p.x() + r * cosf(sa), p.y() + r * sinf(sa));
+    if (isEmpty())
+        moveTo(start);
+    else
+        addLineTo(start);
+
+    // Each quarter circle or less is one cubic curve.
+    const int segments = max(1, static_cast<int>(ceilf(fabsf(sweep) / (piFloat / 2) - 0.001f)));
+    const float step = sweep / segments;
+    const float k = 4.0f / 3.0f * tanf(step / 4);
+
+    float a0 = sa;
+    for (int i = 0; i < segments; ++i) {
+        const float a1 = a0 + step;
+        const float cos0 = cosf(a0), sin0 = sinf(a0);
+        const float cos1 = cosf(a1), sin1 = sinf(a1);
+
+        addBezierCurveTo(FloatPoint(p.x() + r * (cos0 - k * sin0), p.y() + r * (sin0 + k * cos0)),
+                         FloatPoint(p.x() + r * (cos1 + k * sin1), p.y() + r * (sin1 - k * cos1)),
+                         FloatPoint(p.x() + r * cos1, p.y() + r * sin1));
+        a0 = a1;
+    }
 }
 
+// The canvas arcTo: a line from the current point towards p1 that turns towards p2 
+// along an arc of the given radius, tangent to both lines.
 void Path::addArcTo(const FloatPoint& p1, const FloatPoint& p2, float radius)
 {
-    //OWB_PRINTF("Path::addArcTo\n");
-    // FIXME: cairo_arc_to not yet in cairo see cairo.h
-    // cairo_arc_to(m_cr, p1.x(), p1.y(), p2.x(), p2.y());
-    notImplemented();
+    FloatPoint p0;
+    if (!currentPoint(*m_path, p0)) {
+        moveTo(p1);
+        return;
+    }
+
+    const float d1x = p0.x() - p1.x(), d1y = p0.y() - p1.y();
+    const float d2x = p2.x() - p1.x(), d2y = p2.y() - p1.y();
+    const float length1 = distance(d1x, d1y);
+    const float length2 = distance(d2x, d2y);
+    const float cross = d1x * d2y - d1y * d2x;
+
+    if ((radius <= 0) || !length1 || !length2 || (fabsf(cross) <= 0.0001f * length1 * length2)) {
+        addLineTo(p1);
+        return;
+    }
+
+    const float angle = acosf(max(-1.0f, min((d1x * d2x + d1y * d2y) / (length1 * length2), 1.0f)));
+    const float tangentDistance = radius / tanf(angle / 2);
+    const float centerDistance = radius / sinf(angle / 2);
+    const float bx = d1x / length1 + d2x / length2;
+    const float by = d1y / length1 + d2y / length2;
+    const float bisectorLength = distance(bx, by);
+
+    const FloatPoint center(p1.x() + bx / bisectorLength * centerDistance, p1.y() + by / bisectorLength * centerDistance);
+    const FloatPoint t1(p1.x() + d1x / length1 * tangentDistance, p1.y() + d1y / length1 * tangentDistance);
+    const FloatPoint t2(p1.x() + d2x / length2 * tangentDistance, p1.y() + d2y / length2 * tangentDistance);
+
+    addArc(center, radius, atan2f(t1.y() - center.y(), t1.x() - center.x()), atan2f(t2.y() - center.y(), t2.x() - center.x()), cross > 0);
 }
 
 void Path::addEllipse(const FloatRect& rect)
 {
-    //OWB_PRINTF("Path::addEllipse\n");
+    // Control point distance for approximating a quarter ellipse with a cubic curve.
+    const float kappa = 0.5522847498f;
+
+    const float cx = rect.x() + rect.width() / 2;
+    const float cy = rect.y() + rect.height() / 2;
+    const float rx = rect.width() / 2;
+    const float ry = rect.height() / 2;
+
+    moveTo(FloatPoint(cx + rx, cy));
+    addBezierCurveTo(FloatPoint(cx + rx, cy + ry * kappa), FloatPoint(cx + rx * kappa, cy + ry), FloatPoint(cx, cy + ry));
+    addBezierCurveTo(FloatPoint(cx - rx * kappa, cy + ry), FloatPoint(cx - rx, cy + ry * kappa), FloatPoint(cx - rx, cy));
+    addBezierCurveTo(FloatPoint(cx - rx, cy - ry * kappa), FloatPoint(cx - rx * kappa, cy - ry), FloatPoint(cx, cy - ry));
+    addBezierCurveTo(FloatPoint(cx + rx * kappa, cy - ry), FloatPoint(cx + rx, cy - ry * kappa), FloatPoint(cx + rx, cy));
+    closeSubpath();
 }
 
 void Path::closeSubpath()
 {
-    //OWB_PRINTF("Path::closeSubpath\n");
+    if (!isEmpty() && (m_path->types.last() != PathElementCloseSubpath))
+        m_path->types.append(PathElementCloseSubpath);
 }
 
 FloatRect Path::boundingRect() const
 {
-    //OWB_PRINTF("Path::boundingRect\n");
-    return FloatRect();
+    // Includes the control points, as CGPathGetBoundingBox does.
+    const Vector<FloatPoint>& points = m_path->points;
+    if (points.isEmpty())
+        return FloatRect();
+
+    float x1 = points[0].x(), y1 = points[0].y(), x2 = x1, y2 = y1;
+    for (size_t i = 1; i < points.size(); ++i) {
+        x1 = min(x1, points[i].x());
+        y1 = min(y1, points[i].y());
+        x2 = max(x2, points[i].x());
+        y2 = max(y2, points[i].y());
+    }
+
+    return FloatRect(x1, y1, x2 - x1, y2 - y1);
 }
 
 bool Path::contains(const FloatPoint& point, WindRule rule) const
 {
-    //OWB_PRINTF("Path::contains\n");
-    return false;
+    Vector<EA::Raster::PointF> points;
+    Vector<int> contourSizes;
+    flatten(points, contourSizes);
+
+    // Winding number of the point, from the edges crossing the horizontal line through it.
+    const float px = point.x(), py = point.y();
+    int winding = 0;
+    const EA::Raster::PointF* pContour = points.data();
+
+    for (size_t c = 0; c < contourSizes.size(); pContour += contourSizes[c++]) {
+        const int n = contourSizes[c];
+
+        for (int i = 0; i < n; ++i) {
+            const EA::Raster::PointF& a = pContour[i];
+            const EA::Raster::PointF& b = pContour[(i + 1) < n ? (i + 1) : 0];
+            const float side = (b.x - a.x) * (py - a.y) - (px - a.x) * (b.y - a.y);
+
+            if (a.y <= py) {
+                if ((b.y > py) && (side > 0))
+                    ++winding;
+            } else if ((b.y <= py) && (side < 0))
+                --winding;
+        }
+    }
+
+    return (rule == RULE_EVENODD) ? (winding & 1) : (winding != 0);
+}
+
+void Path::flatten(Vector<EA::Raster::PointF>& points, Vector<int>& contourSizes, Vector<bool>* pClosed) const
+{
+    const Vector<PathElementType>& types = m_path->types;
+    const FloatPoint* p = m_path->points.data();
+    size_t contourStart = points.size();
+    FloatPoint current;
+    FloatPoint start;
+
+    for (size_t i = 0; i <= types.size(); ++i) {
+        const PathElementType type = (i < types.size()) ? types[i] : PathElementMoveToPoint;
+
+        // A move or close ends the contour. Single points don't make one.
+        if ((type == PathElementMoveToPoint) || (type == PathElementCloseSubpath)) {
+            if (points.size() - contourStart >= 2) {
+                contourSizes.append(static_cast<int>(points.size() - contourStart));
+                contourStart = points.size();
+                if (pClosed)
+                    pClosed->append(type == PathElementCloseSubpath);
+            } else
+                points.shrink(contourStart);
+        } else if (points.size() == contourStart)
+            points.append(EA::Raster::PointF(current.x(), current.y()));
+
+        if (i == types.size())
+            break;
+
+        switch (type) {
+            case PathElementMoveToPoint:
+                current = start = p[0];
+                points.append(EA::Raster::PointF(current.x(), current.y()));
+                break;
+
+            case PathElementAddLineToPoint:
+                current = p[0];
+                points.append(EA::Raster::PointF(current.x(), current.y()));
+                break;
+
+            case PathElementAddQuadCurveToPoint: {
+                const float ddx = current.x() - 2 * p[0].x() + p[1].x();
+                const float ddy = current.y() - 2 * p[0].y() + p[1].y();
+                const int n = curveSegmentCount(distance(ddx, ddy), 0.25f);
+
+                for (int j = 1; j <= n; ++j) {
+                    const float t = static_cast<float>(j) / n, u = 1 - t;
+                    points.append(EA::Raster::PointF(u * u * current.x() + 2 * u * t * p[0].x() + t * t * p[1].x(),
+                                                     u * u * current.y() + 2 * u * t * p[0].y() + t * t * p[1].y()));
+                }
+                current = p[1];
+                break;
+            }
+
+            case PathElementAddCurveToPoint: {
+                const float dd1 = distance(current.x() - 2 * p[0].x() + p[1].x(), current.y() - 2 * p[0].y() + p[1].y());
+                const float dd2 = distance(p[0].x() - 2 * p[1].x() + p[2].x(), p[0].y() - 2 * p[1].y() + p[2].y());
+                const int n = curveSegmentCount(max(dd1, dd2), 0.75f);
+
+                for (int j = 1; j <= n; ++j) {
+                    const float t = static_cast<float>(j) / n, u = 1 - t;
+                    const float a = u * u * u, b = 3 * u * u * t, c = 3 * u * t * t, d = t * t * t;
+                    points.append(EA::Raster::PointF(a * current.x() + b * p[0].x() + c * p[1].x() + d * p[2].x(),
+                                                     a * current.y() + b * p[0].y() + c * p[1].y() + d * p[2].y()));
+                }
+                current = p[2];
+                break;
+            }
+
+            case PathElementCloseSubpath:
+                current = start;
+                break;
+        }
+
+        p += pointCount(type);
+    }
 }
 
 void Path::apply(void* info, PathApplierFunction function) const
 {
-    //OWB_PRINTF("Path::apply\n");
+    PathElement element;
+    FloatPoint points[3];
+    element.points = points;
+
+    const FloatPoint* p = m_path->points.data();
+    for (size_t i = 0; i < m_path->types.size(); ++i) {
+        const int count = pointCount(m_path->types[i]);
+        for (int j = 0; j < count; ++j)
+            points[j] = *p++;
+
+        element.type = m_path->types[i];
+        function(info, &element);
+    }
 }
 
 void Path::transform(const AffineTransform& trans)
 {
-    //OWB_PRINTF("Path::transform\n");
+    for (size_t i = 0; i < m_path->points.size(); ++i)
+        m_path->points[i] = trans.mapPoint(m_path->points[i]);
 }
 
 String Path::debugString() const
 {
-    //OWB_PRINTF("Path::debugString\n");
     String string = "";
-    
-    return string;
+
+    const FloatPoint* p = m_path->points.data();
+    for (size_t i = 0; i < m_path->types.size(); ++i) {
+        switch (m_path->types[i]) {
+            case PathElementMoveToPoint:
+                string += String::format("M%.2f,%.2f ", p[0].x(), p[0].y());
+                break;
+            case PathElementAddLineToPoint:
+                string += String::format("L%.2f,%.2f ", p[0].x(), p[0].y());
+                break;
+            case PathElementAddQuadCurveToPoint:
+                string += String::format("Q%.2f,%.2f,%.2f,%.2f ", p[0].x(), p[0].y(), p[1].x(), p[1].y());
+                break;
+            case PathElementAddCurveToPoint:
+                string += String::format("C%.2f,%.2f,%.2f,%.2f,%.2f,%.2f ", p[0].x(), p[0].y(), p[1].x(), p[1].y(), p[2].x(), p[2].y());
+                break;
+            case PathElementCloseSubpath:
+                string += "Z ";
+                break;
+        }
+        p += pointCount(m_path->types[i]);
+    }
+
+    return string.stripWhiteSpace();
 }
 
 } // namespace WebCore
@@ -36,12 +36,19 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define Path_h
 
 #include <wtf/FastAllocBase.h>
+#include <wtf/Vector.h>
 #include "BALBase.h"
+#include "FloatPoint.h"
+
+namespace EA {
+    namespace Raster {
+        struct PointF;
+    }
+}
 
 namespace WKAL {
 
     class AffineTransform;
-    class FloatPoint;
     class FloatSize;
     class FloatRect;
     class String;
@@ -66,6 +73,13 @@ namespace WKAL {
 
     typedef void (*PathApplierFunction) (void* info, const PathElement*);
 
+    // The elements of a path, in order. The points of each element (one for a move or a line, two 
+    // for a quadratic curve, three for a cubic curve and none for a close) follow each other in points.
+    struct PathStorage: public WTF::FastAllocBase {
+        Vector<PathElementType> types;
+        Vector<FloatPoint> points;
+    };
+
     class Path : public WKALBase {
     public:
         Path();
@@ -114,6 +128,10 @@ namespace WKAL {
         void apply(void* info, PathApplierFunction) const;
         void transform(const AffineTransform&);
 
+        // Flattens the curves into lines and appends the subpaths as contours for EA::Raster::RasterizePath.
+        // If pClosed is given, it gets whether each subpath was explicitly closed, as stroking needs to know.
+        void flatten(Vector<EA::Raster::PointF>& points, Vector<int>& contourSizes, Vector<bool>* pClosed = 0) const;
+
     private:
         PlatformPath* m_path;
         WindRule m_rule;
@@ -0,0 +1,258 @@
+/*
+Copyright (C) 2010 Electronic Arts, Inc.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of Electronic Arts, Inc. ("EA") nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS AND ITS CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ELECTRONIC ARTS OR ITS CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+// BCScaledImageCacheEA.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "BCScaledImageCacheEA.h"
+#include "BitmapImage.h"
+#include "ImageObserver.h"
+#include <EAWebKit/internal/EAWebKitAssert.h>
+
+
+namespace WKAL {
+
+// Default budget. The user can change it with EA::WebKit::SetRAMCacheBudgets.
+static const unsigned kDefaultScaledImageCacheCapacity = 2 * 1024 * 1024;
+
+// A single scaled copy won't be allowed to use more than this fraction of the budget,
+// so one large image can't flush everything else out.
+static const unsigned kMaxEntryCapacityDivisor = 4;
+
+
+struct ScaledImageCache::Entry : public WTF::FastAllocBase {
+    const BitmapImage*          mpOwner;
+    const EA::Raster::Surface*  mpFrame;            // The frame this was scaled from. Only used as a key.
+    EA::Raster::Surface*        mpScaledSurface;
+    unsigned                    mSize;              // In bytes
+    Entry*                      mpPrev;             // LRU list
+    Entry*                      mpNext;
+    Entry*                      mpNextForOwner;     // The other scaled copies of the same image
+};
+
+
+ScaledImageCache* scaledImageCache()
+{
+    static ScaledImageCache* pCache = new ScaledImageCache;
+    return pCache;
+}
+
+
+ScaledImageCache::ScaledImageCache()
+    : m_pHead(0)
+    , m_pTail(0)
+    , m_capacity(kDefaultScaledImageCacheCapacity)
+    , m_size(0)
+{
+}
+
+
+ScaledImageCache::~ScaledImageCache()
+{
+    clear();
+}
+
+
+EA::Raster::Surface* ScaledImageCache::get(const BitmapImage* pOwner, const EA::Raster::Surface* pFrame, int width, int height)
+{
+    OwnerMap::iterator it = m_owners.find(pOwner);
+    if (it == m_owners.end())
+        return 0;
+
+    for (Entry* pEntry = it->second; pEntry; pEntry = pEntry->mpNextForOwner) {
+        if ((pEntry->mpFrame == pFrame) && (pEntry->mpScaledSurface->mWidth == width) && (pEntry->mpScaledSurface->mHeight == height)) {
+            // Move to the front of the LRU list.
+            if (pEntry != m_pHead) {
+                pEntry->mpPrev->mpNext = pEntry->mpNext;
+                if (pEntry->mpNext)
+                    pEntry->mpNext->mpPrev = pEntry->mpPrev;
+                else
+                    m_pTail = pEntry->mpPrev;
+
+                pEntry->mpPrev = 0;
+                pEntry->mpNext = m_pHead;
+                m_pHead->mpPrev = pEntry;
+                m_pHead = pEntry;
+            }
+            return pEntry->mpScaledSurface;
+        }
+    }
+
+    return 0;
+}
+
+
+bool ScaledImageCache::canAdd(unsigned size) const
+{
+    return size && (size <= (m_capacity / kMaxEntryCapacityDivisor));
+}
+
+
+bool ScaledImageCache::add(const BitmapImage* pOwner, const EA::Raster::Surface* pFrame, EA::Raster::Surface* pScaledSurface)
+{
+    EAW_ASSERT(pOwner && pFrame && pScaledSurface);
+
+    const unsigned size = pScaledSurface->mHeight * pScaledSurface->mStride;
+    if (!canAdd(size))
+        return false;
+
+    Entry* pEntry = WTF::fastNew<Entry>();
+    pEntry->mpOwner = pOwner;
+    pEntry->mpFrame = pFrame;
+    pEntry->mpScaledSurface = pScaledSurface;
+    pEntry->mSize = size;
+
+    // Insert at the front of the LRU list.
+    pEntry->mpPrev = 0;
+    pEntry->mpNext = m_pHead;
+    if (m_pHead)
+        m_pHead->mpPrev = pEntry;
+    else
+        m_pTail = pEntry;
+    m_pHead = pEntry;
+
+    // And at the front of the image's list.
+    std::pair<OwnerMap::iterator, bool> result = m_owners.add(pOwner, pEntry);
+    if (result.second)
+        pEntry->mpNextForOwner = 0;
+    else {
+        pEntry->mpNextForOwner = result.first->second;
+        result.first->second = pEntry;
+    }
+
+    m_size += size;
+    if (pOwner->imageObserver())
+        pOwner->imageObserver()->decodedSizeChanged(pOwner, (int)size);
+
+    prune(m_capacity);
+    return true;
+}
+
+
+void ScaledImageCache::remove(const BitmapImage* pOwner, bool notifyObserver)
+{
+    OwnerMap::iterator it = m_owners.find(pOwner);
+    if (it == m_owners.end())
+        return;
+
+    Entry* pEntry = it->second;
+    m_owners.remove(it);
+
+    while (pEntry) {
+        Entry* const pNextForOwner = pEntry->mpNextForOwner;
+
+        // Already out of the owner map, so only the LRU list needs fixing.
+        if (pEntry->mpPrev)
+            pEntry->mpPrev->mpNext = pEntry->mpNext;
+        else
+            m_pHead = pEntry->mpNext;
+
+        if (pEntry->mpNext)
+            pEntry->mpNext->mpPrev = pEntry->mpPrev;
+        else
+            m_pTail = pEntry->mpPrev;
+
+        destroy(pEntry, notifyObserver);
+        pEntry = pNextForOwner;
+    }
+}
+
+
+void ScaledImageCache::clear()
+{
+    prune(0);
+}
+
+
+void ScaledImageCache::setCapacity(unsigned capacity)
+{
+    m_capacity = capacity;
+    prune(m_capacity);
+}
+
+
+// Removes the entry from both the LRU list and its image's list.
+void ScaledImageCache::unlink(Entry* pEntry)
+{
+    if (pEntry->mpPrev)
+        pEntry->mpPrev->mpNext = pEntry->mpNext;
+    else
+        m_pHead = pEntry->mpNext;
+
+    if (pEntry->mpNext)
+        pEntry->mpNext->mpPrev = pEntry->mpPrev;
+    else
+        m_pTail = pEntry->mpPrev;
+
+    OwnerMap::iterator it = m_owners.find(pEntry->mpOwner);
+    EAW_ASSERT(it != m_owners.end());
+
+    if (it->second == pEntry) {
+        if (pEntry->mpNextForOwner)
+            it->second = pEntry->mpNextForOwner;
+        else
+            m_owners.remove(it);
+    }
+    else {
+        Entry* pPrevForOwner = it->second;
+        while (pPrevForOwner->mpNextForOwner != pEntry)
+            pPrevForOwner = pPrevForOwner->mpNextForOwner;
+        pPrevForOwner->mpNextForOwner = pEntry->mpNextForOwner;
+    }
+}
+
+
+// The entry needs to be unlinked first, as notifying the observer can call back into the cache.
+void ScaledImageCache::destroy(Entry* pEntry, bool notifyObserver)
+{
+    const BitmapImage* const pOwner = pEntry->mpOwner;
+    const unsigned           size   = pEntry->mSize;
+
+    EA::Raster::DestroySurface(pEntry->mpScaledSurface);
+    WTF::fastDelete<Entry>(pEntry);
+
+    EAW_ASSERT(m_size >= size);
+    m_size -= size;
+
+    if (notifyObserver && pOwner->imageObserver())
+        pOwner->imageObserver()->decodedSizeChanged(pOwner, -(int)size);
+}
+
+
+void ScaledImageCache::prune(unsigned targetSize)
+{
+    while ((m_size > targetSize) && m_pTail) {
+        Entry* const pEntry = m_pTail;
+        unlink(pEntry);
+        destroy(pEntry, true);
+    }
+}
+
+} // namespace
@@ -0,0 +1,101 @@
+/*
+Copyright (C) 2010 Electronic Arts, Inc.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of Electronic Arts, Inc. ("EA") nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS AND ITS CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ELECTRONIC ARTS OR ITS CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+// BCScaledImageCacheEA.h
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ScaledImageCache_h
+#define ScaledImageCache_h
+
+#include <wtf/FastAllocBase.h>
+#include <wtf/HashMap.h>
+#include "BALBase.h"
+#include "EARaster.h"
+
+
+namespace WKAL {
+
+    class BitmapImage;
+
+    // Keeps scaled copies of image frames around so that images drawn at a size other than their 
+    // natural size (CSS thumbnails for example) don't get rescaled on every draw.
+    // The cache has a global byte budget and evicts the least recently used copies first.
+    // The bytes used by an image's scaled copies are reported to its ImageObserver, so they 
+    // show up in the RAM cache live size and get freed when the RAM cache destroys the image's 
+    // decoded data.
+    class ScaledImageCache : public WTF::FastAllocBase {
+    public:
+        ScaledImageCache();
+        ~ScaledImageCache();
+
+        // Returns the scaled copy of pFrame at the given size or NULL if there is none.
+        EA::Raster::Surface* get(const BitmapImage* pOwner, const EA::Raster::Surface* pFrame, int width, int height);
+
+        // Whether a scaled copy of this many bytes is allowed in the cache. 
+        // Copies that would take a large part of the budget are not cached.
+        bool canAdd(unsigned size) const;
+
+        // Adds a scaled copy of pFrame. The cache takes ownership of pScaledSurface if this returns true. 
+        bool add(const BitmapImage* pOwner, const EA::Raster::Surface* pFrame, EA::Raster::Surface* pScaledSurface);
+
+        // Removes all the scaled copies of an image. 
+        // The image observer should not be notified if the image is getting destroyed.
+        void remove(const BitmapImage* pOwner, bool notifyObserver);
+
+        // Removes all the scaled copies of all images.
+        void clear();
+
+        void setCapacity(unsigned capacity);
+        unsigned capacity() const { return m_capacity; }
+        unsigned size() const { return m_size; }
+
+    private:
+        struct Entry;
+
+        void unlink(Entry* pEntry);
+        void destroy(Entry* pEntry, bool notifyObserver);
+        void prune(unsigned targetSize);
+
+        typedef HashMap<const BitmapImage*, Entry*> OwnerMap;
+
+        OwnerMap m_owners;      // The first entry of each image. The rest are chained through Entry::mpNextForOwner.
+        Entry*   m_pHead;       // Most recently used.
+        Entry*   m_pTail;       // Least recently used.
+        unsigned m_capacity;    // In bytes
+        unsigned m_size;        // In bytes
+    };
+
+    // Returns the global scaled image cache.
+    ScaledImageCache* scaledImageCache();
+
+} // namespace
+
+
+
+#endif  // ScaledImageCache_h
@@ -0,0 +1,208 @@
+/*
+Copyright (C) 2010 Electronic Arts, Inc.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of Electronic Arts, Inc. ("EA") nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS AND ITS CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ELECTRONIC ARTS OR ITS CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+// BCShadowCacheEA.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "BCShadowCacheEA.h"
+#include <string.h>
+#include <EARaster/EARaster.h>
+#include <EAWebKit/internal/EAWebKitAssert.h>
+
+
+namespace WKAL {
+
+static const unsigned kDefaultShadowCacheCapacity = 1024 * 1024;
+
+
+struct ShadowCache::Entry : public WTF::FastAllocBase {
+    unsigned long long  mKey;
+    Mask                mMask;
+    unsigned            mSize;      // In bytes
+    Entry*              mpPrev;     // LRU list
+    Entry*              mpNext;
+};
+
+
+ShadowCache* shadowCache()
+{
+    static ShadowCache* pCache = new ShadowCache;
+    return pCache;
+}
+
+
+// This is the 64 bit FNV-1a hash.
+unsigned long long ShadowCache::addToKey(unsigned long long key, const void* pData, size_t size)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(pData);
+
+    for (size_t i = 0; i < size; i++) {
+        key ^= p[i];
+        key *= 1099511628211ULL;
+    }
+
+    return key;
+}
+
+
+ShadowCache::ShadowCache()
+    : m_pHead(0)
+    , m_pTail(0)
+    , m_capacity(kDefaultShadowCacheCapacity)
+    , m_size(0)
+{
+}
+
+
+ShadowCache::~ShadowCache()
+{
+    clear();
+}
+
+
+const ShadowCache::Mask* ShadowCache::get(unsigned long long key, const IntSize& size, int blur, DrawFunction pDraw, void* pContext)
+{
+    if ((size.width() <= 0) || (size.height() <= 0))
+        return 0;
+
+    const int params[3] = { size.width(), size.height(), blur };
+    key = addToKey(key, params, sizeof(params));
+
+    // The hash table reserves 0 and all ones, which these can't be.
+    key = (key >> 2) | (1ULL << 63);
+
+    EntryMap::iterator it = m_entries.find(key);
+    Entry* pEntry;
+
+    if (it != m_entries.end()) {
+        pEntry = it->second;
+
+        // Move to the front of the LRU list.
+        if (pEntry != m_pHead) {
+            unlink(pEntry);
+
+            pEntry->mpNext = m_pHead;
+            m_pHead->mpPrev = pEntry;
+            m_pHead = pEntry;
+        }
+    } else {
+        pEntry = create(size, blur, pDraw, pContext);
+        pEntry->mKey = key;
+
+        // Make room first, so the new mask isn't the one that gets evicted.
+        prune((m_capacity > pEntry->mSize) ? (m_capacity - pEntry->mSize) : 0);
+
+        pEntry->mpPrev = 0;
+        pEntry->mpNext = m_pHead;
+        if (m_pHead)
+            m_pHead->mpPrev = pEntry;
+        else
+            m_pTail = pEntry;
+        m_pHead = pEntry;
+
+        m_entries.set(key, pEntry);
+        m_size += pEntry->mSize;
+    }
+
+    return &pEntry->mMask;
+}
+
+
+ShadowCache::Entry* ShadowCache::create(const IntSize& size, int blur, DrawFunction pDraw, void* pContext)
+{
+    const int extent = EA::Raster::GetBlurExtent(blur);
+    const int width  = size.width() + (2 * extent);
+    const int height = size.height() + (2 * extent);
+
+    uint8_t* const pCoverage = WTF::fastNewArray<uint8_t>(width * height);
+    memset(pCoverage, 0, width * height);
+
+    pDraw(pContext, pCoverage + (extent * width) + extent, width);
+    EA::Raster::BlurMaskA8(pCoverage, width, height, width, blur);
+
+    Entry* const pEntry = WTF::fastNew<Entry>();
+    pEntry->mMask.mpCoverage = pCoverage;
+    pEntry->mMask.mWidth     = width;
+    pEntry->mMask.mHeight    = height;
+    pEntry->mMask.mExtent    = extent;
+    pEntry->mSize            = width * height;
+
+    return pEntry;
+}
+
+
+void ShadowCache::clear()
+{
+    prune(0);
+}
+
+
+void ShadowCache::setCapacity(unsigned capacity)
+{
+    m_capacity = capacity;
+    prune(m_capacity);
+}
+
+
+// Removes the entry from the LRU list.
+void ShadowCache::unlink(Entry* pEntry)
+{
+    if (pEntry->mpPrev)
+        pEntry->mpPrev->mpNext = pEntry->mpNext;
+    else
+        m_pHead = pEntry->mpNext;
+
+    if (pEntry->mpNext)
+        pEntry->mpNext->mpPrev = pEntry->mpPrev;
+    else
+        m_pTail = pEntry->mpPrev;
+
+    pEntry->mpPrev = 0;
+    pEntry->mpNext = 0;
+}
+
+
+void ShadowCache::prune(unsigned targetSize)
+{
+    while ((m_size > targetSize) && m_pTail) {
+        Entry* const pEntry = m_pTail;
+
+        unlink(pEntry);
+        m_entries.remove(pEntry->mKey);
+
+        EAW_ASSERT(m_size >= pEntry->mSize);
+        m_size -= pEntry->mSize;
+
+        WTF::fastDeleteArray<uint8_t>(const_cast<uint8_t*>(pEntry->mMask.mpCoverage));
+        WTF::fastDelete<Entry>(pEntry);
+    }
+}
+
+} // namespace
@@ -0,0 +1,102 @@
+/*
+Copyright (C) 2010 Electronic Arts, Inc.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of Electronic Arts, Inc. ("EA") nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS AND ITS CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ELECTRONIC ARTS OR ITS CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+// BCShadowCacheEA.h
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ShadowCache_h
+#define ShadowCache_h
+
+#include <wtf/FastAllocBase.h>
+#include <wtf/HashMap.h>
+#include "BALBase.h"
+#include "IntSize.h"
+
+
+namespace WKAL {
+
+    // Keeps blurred shadow masks, so that the shadows of things that don't change are blurred once 
+    // instead of on every paint. A mask is the coverage of a shape, blurred with EA::Raster::BlurMaskA8.
+    // The shadow color is applied when the mask is blitted, so it isn't part of what a mask depends on.
+    // The least recently used masks are evicted once the cache goes over its byte budget.
+    class ShadowCache : public WTF::FastAllocBase {
+    public:
+        struct Mask {
+            const uint8_t* mpCoverage;  // mWidth * mHeight coverage values, rows packed.
+            int            mWidth;
+            int            mHeight;
+            int            mExtent;     // How far the blur spreads; the shape's origin is at (mExtent, mExtent) in the mask.
+        };
+
+        // Draws the coverage of a shape, with pCoverage pointing at the shape's origin. The mask is cleared beforehand.
+        typedef void (*DrawFunction)(void* pContext, uint8_t* pCoverage, int stride);
+
+        // Shapes are told apart by a 64 bit key, which is everything describing the shape passed through addToKey.
+        static const unsigned long long kInitialKey = 14695981039346656037ULL;
+        static unsigned long long addToKey(unsigned long long key, const void* pData, size_t size);
+
+        ShadowCache();
+        ~ShadowCache();
+
+        // Returns the mask of the shape with the given key and size, blurred with the given radius. 
+        // pDraw is called to draw the shape if the mask isn't in the cache. The mask stays valid until 
+        // the next call. One larger than the whole cache is kept alone until the next one is added.
+        const Mask* get(unsigned long long key, const IntSize& size, int blur, DrawFunction pDraw, void* pContext);
+
+        // Removes all the masks.
+        void clear();
+
+        void setCapacity(unsigned capacity);
+        unsigned capacity() const { return m_capacity; }
+        unsigned size() const { return m_size; }
+
+    private:
+        struct Entry;
+
+        Entry* create(const IntSize& size, int blur, DrawFunction pDraw, void* pContext);
+        void unlink(Entry* pEntry);
+        void prune(unsigned targetSize);
+
+        typedef HashMap<unsigned long long, Entry*> EntryMap;
+
+        EntryMap m_entries;
+        Entry*   m_pHead;       // Most recently used.
+        Entry*   m_pTail;       // Least recently used.
+        unsigned m_capacity;    // In bytes
+        unsigned m_size;        // In bytes
+    };
+
+    // Returns the global shadow cache.
+    ShadowCache* shadowCache();
+
+} // namespace
+
+
+
+#endif  // ShadowCache_h
@@ -0,0 +1,368 @@
+/*
+Copyright (C) 2010 Electronic Arts, Inc.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of Electronic Arts, Inc. ("EA") nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS AND ITS CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ELECTRONIC ARTS OR ITS CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+// BCTiledBackingStoreEA.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "BCTiledBackingStoreEA.h"
+#include "GraphicsContext.h"
+#include "BCDisplayListEA.h"
+#include "SystemTime.h"
+#include <limits.h>
+#include <algorithm>
+
+
+namespace WKAL {
+
+static const int kTileSize = 256;
+
+
+// Rounds towards negative infinity, unlike integer division.
+static inline int tileIndex(int position)
+{
+    return (position >= 0) ? (position / kTileSize) : (((position + 1) / kTileSize) - 1);
+}
+
+
+// Returns the Manhattan distance between the nearest points of two rects, or 0 if they intersect.
+static int rectDistance(const IntRect& a, const IntRect& b)
+{
+    const int dx = std::max(0, std::max(a.x() - b.right(), b.x() - a.right()));
+    const int dy = std::max(0, std::max(a.y() - b.bottom(), b.y() - a.bottom()));
+
+    return dx + dy;
+}
+
+
+static inline int sign(int value)
+{
+    return (value > 0) - (value < 0);
+}
+
+
+TiledBackingStore::TiledBackingStore(TiledBackingStoreClient* pClient, int maxBytes, EA::Raster::PixelFormatType pixelFormat)
+    : m_client(pClient)
+    , m_maxBytes(maxBytes)
+    , m_pixelFormat(pixelFormat)
+{
+}
+
+
+TiledBackingStore::~TiledBackingStore()
+{
+    for (size_t i = 0; i < m_tiles.size(); ++i)
+        EA::Raster::DestroySurface(m_tiles[i].mpSurface);
+}
+
+
+// The budget never goes below what it takes to cover the visible area, as that gets drawn anyway.
+unsigned TiledBackingStore::maxTiles() const
+{
+    const unsigned pixelBytes   = ((m_pixelFormat == EA::Raster::kPixelFormatTypeRGB565) || (m_pixelFormat == EA::Raster::kPixelFormatTypeARGB4444)) ? 2 : 4;
+    const unsigned budgetTiles  = (unsigned)m_maxBytes / (kTileSize * kTileSize * pixelBytes);
+    const unsigned visibleTiles = (((m_visibleRect.width() + kTileSize - 1) / kTileSize) + 1) * (((m_visibleRect.height() + kTileSize - 1) / kTileSize) + 1);
+
+    return std::max(budgetTiles, visibleTiles);
+}
+
+
+IntRect TiledBackingStore::tileRect(const IntPoint& coordinate) const
+{
+    return IntRect(coordinate.x() * kTileSize, coordinate.y() * kTileSize, kTileSize, kTileSize);
+}
+
+
+// Returns the range of tile coordinates that rect touches.
+IntRect TiledBackingStore::tileCoverage(const IntRect& rect) const
+{
+    if (rect.isEmpty())
+        return IntRect();
+
+    const int x0 = tileIndex(rect.x());
+    const int y0 = tileIndex(rect.y());
+    const int x1 = tileIndex(rect.right() - 1);
+    const int y1 = tileIndex(rect.bottom() - 1);
+
+    return IntRect(x0, y0, (x1 - x0) + 1, (y1 - y0) + 1);
+}
+
+
+// The area that is worth keeping painted: the visible area plus a tile all around, 
+// and the next viewport in the direction of the last scroll.
+IntRect TiledBackingStore::coverRect() const
+{
+    IntRect ahead(m_visibleRect);
+    ahead.move(m_scrollDirection.width() * m_visibleRect.width(), m_scrollDirection.height() * m_visibleRect.height());
+
+    IntRect rect(m_visibleRect);
+    rect.unite(ahead);
+    rect.inflate(kTileSize);
+    rect.intersect(IntRect(IntPoint(), m_contentsSize));
+
+    return rect;
+}
+
+
+TiledBackingStore::Tile* TiledBackingStore::findTile(const IntPoint& coordinate)
+{
+    for (size_t i = 0; i < m_tiles.size(); ++i) {
+        if (m_tiles[i].mCoordinate == coordinate)
+            return &m_tiles[i];
+    }
+
+    return 0;
+}
+
+
+// Makes a new tile, all dirty. If the tiles are over budget, the tile furthest from the visible 
+// area goes, as long as it is outside keepRect. Returns NULL if nothing can go or if out of memory.
+TiledBackingStore::Tile* TiledBackingStore::createTile(const IntPoint& coordinate, const IntRect& keepRect)
+{
+    if (m_tiles.size() >= maxTiles()) {
+        int furthest         = -1;
+        int furthestDistance = -1;
+
+        for (size_t i = 0; i < m_tiles.size(); ++i) {
+            const IntRect rect(tileRect(m_tiles[i].mCoordinate));
+
+            if (!rect.intersects(keepRect)) {
+                const int distance = rectDistance(rect, m_visibleRect);
+
+                if (distance > furthestDistance) {
+                    furthest         = (int)i;
+                    furthestDistance = distance;
+                }
+            }
+        }
+
+        if (furthest < 0)
+            return 0;
+
+        // The surface isn't reused, as a display list can still have it recorded for a blit.
+        EA::Raster::DestroySurface(m_tiles[furthest].mpSurface);
+        m_tiles.remove(furthest);
+    }
+
+    EA::Raster::Surface* const pSurface = EA::Raster::CreateSurface(kTileSize, kTileSize, m_pixelFormat);
+
+    if (!pSurface)
+        return 0;
+
+    // Tiles replace what is under them, including any transparent parts.
+    pSurface->mSurfaceFlags |= EA::Raster::kFlagDisableAlpha;
+
+    Tile tile;
+    tile.mCoordinate = coordinate;
+    tile.mpSurface   = pSurface;
+    tile.mDirtyRect  = tileRect(coordinate);
+    m_tiles.append(tile);
+
+    return &m_tiles.last();
+}
+
+
+void TiledBackingStore::paintTile(Tile& tile)
+{
+    const IntRect bounds(tileRect(tile.mCoordinate));
+    const IntRect dirtyRect(tile.mDirtyRect);
+
+    tile.mDirtyRect = IntRect();
+
+    // Painting leaves the tile's clip rect set, so it is reset before clearing.
+    const EA::Raster::Rect clearRect(dirtyRect.x() - bounds.x(), dirtyRect.y() - bounds.y(), dirtyRect.width(), dirtyRect.height());
+    tile.mpSurface->SetClipRect(NULL);
+    EA::Raster::FillRectSolidColor(tile.mpSurface, &clearRect, EA::Raster::Color(0));
+
+    GraphicsContext context(tile.mpSurface);
+    context.translate(-bounds.x(), -bounds.y());
+    context.clip(dirtyRect);
+
+    m_client->paintTileContents(&context, dirtyRect);
+}
+
+
+void TiledBackingStore::setContentsSize(const IntSize& size)
+{
+    if (size == m_contentsSize)
+        return;
+
+    m_contentsSize = size;
+
+    // Tiles that are entirely beyond the contents aren't going to be needed.
+    const IntRect contentsRect(IntPoint(), size);
+
+    for (size_t i = m_tiles.size(); i-- > 0; ) {
+        if (!tileRect(m_tiles[i].mCoordinate).intersects(contentsRect)) {
+            EA::Raster::DestroySurface(m_tiles[i].mpSurface);
+            m_tiles.remove(i);
+        }
+    }
+}
+
+
+void TiledBackingStore::setVisibleRect(const IntRect& rect)
+{
+    if (!m_visibleRect.isEmpty() && (rect.location() != m_visibleRect.location())) {
+        const IntSize delta(rect.location() - m_visibleRect.location());
+        m_scrollDirection = IntSize(sign(delta.width()), sign(delta.height()));
+    }
+
+    m_visibleRect = rect;
+}
+
+
+void TiledBackingStore::invalidate(const IntRect& rect)
+{
+    for (size_t i = 0; i < m_tiles.size(); ++i) {
+        IntRect dirtyRect(tileRect(m_tiles[i].mCoordinate));
+        dirtyRect.intersect(rect);
+
+        if (!dirtyRect.isEmpty())
+            m_tiles[i].mDirtyRect.unite(dirtyRect);
+    }
+}
+
+
+void TiledBackingStore::invalidateAll()
+{
+    for (size_t i = 0; i < m_tiles.size(); ++i)
+        m_tiles[i].mDirtyRect = tileRect(m_tiles[i].mCoordinate);
+}
+
+
+void TiledBackingStore::paint(GraphicsContext* context, const IntRect& rect)
+{
+    const IntRect coverage(tileCoverage(rect));
+    const IntSize origin(context->origin());
+
+    for (int y = coverage.y(); y < coverage.bottom(); ++y) {
+        for (int x = coverage.x(); x < coverage.right(); ++x) {
+            const IntPoint coordinate(x, y);
+            const IntRect  bounds(tileRect(coordinate));
+            IntRect        part(bounds);
+
+            part.intersect(rect);
+
+            Tile* pTile = findTile(coordinate);
+            if (!pTile)
+                pTile = createTile(coordinate, rect);
+
+            if (!pTile) {
+                // No room for the tile, so this part gets painted the usual way.
+                context->save();
+                context->clip(part);
+                m_client->paintTileContents(context, part);
+                context->restore();
+                continue;
+            }
+
+            if (!pTile->mDirtyRect.isEmpty())
+                paintTile(*pTile);
+
+            const EA::Raster::Rect srcRect(part.x() - bounds.x(), part.y() - bounds.y(), part.width(), part.height());
+            const EA::Raster::Rect dstRect(part.x() + origin.width(), part.y() + origin.height(), part.width(), part.height());
+
+            if (DisplayList* const pDisplayList = context->displayList())
+                pDisplayList->blit(pTile->mpSurface, &srcRect, &dstRect, NULL, false, 255);
+            else
+                EA::Raster::Blit(pTile->mpSurface, &srcRect, context->platformContext(), &dstRect, NULL, false, 255);
+        }
+    }
+}
+
+
+// Picks the tile to paint next: dirty or missing tiles in the cover rect, those that are 
+// visible or ahead of the scroll first, and then by distance from the visible area.
+bool TiledBackingStore::findTileToPaintAhead(IntPoint& coordinate)
+{
+    const IntRect cover(coverRect());
+    const IntRect coverage(tileCoverage(cover));
+
+    IntRect ahead(m_visibleRect);
+    ahead.move(m_scrollDirection.width() * m_visibleRect.width(), m_scrollDirection.height() * m_visibleRect.height());
+
+    const int behindPenalty = std::max(m_visibleRect.width(), m_visibleRect.height());
+    int       bestScore     = INT_MAX;
+
+    for (int y = coverage.y(); y < coverage.bottom(); ++y) {
+        for (int x = coverage.x(); x < coverage.right(); ++x) {
+            const IntPoint coordinate2(x, y);
+            const Tile*    pTile = findTile(coordinate2);
+
+            if (pTile && pTile->mDirtyRect.isEmpty())
+                continue;
+
+            const IntRect rect(tileRect(coordinate2));
+            int           score = rectDistance(rect, m_visibleRect);
+
+            if (!rect.intersects(m_visibleRect) && !rect.intersects(ahead))
+                score += behindPenalty;
+
+            if (score < bestScore) {
+                bestScore  = score;
+                coordinate = coordinate2;
+            }
+        }
+    }
+
+    return (bestScore != INT_MAX);
+}
+
+
+bool TiledBackingStore::paintAhead(double timeLimit)
+{
+    if (m_visibleRect.isEmpty())
+        return false;
+
+    const double startTime = WebCore::currentTime();
+    bool         painted   = false;
+    IntPoint     coordinate;
+
+    while (findTileToPaintAhead(coordinate)) {
+        Tile* pTile = findTile(coordinate);
+
+        // Tiles in the cover rect don't make room for each other, so this stops once the budget is used up.
+        if (!pTile)
+            pTile = createTile(coordinate, coverRect());
+
+        if (!pTile)
+            break;
+
+        paintTile(*pTile);
+        painted = true;
+
+        if ((WebCore::currentTime() - startTime) >= timeLimit)
+            break;
+    }
+
+    return painted;
+}
+
+} // namespace
@@ -0,0 +1,110 @@
+/*
+Copyright (C) 2010 Electronic Arts, Inc.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of Electronic Arts, Inc. ("EA") nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS AND ITS CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ELECTRONIC ARTS OR ITS CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+// BCTiledBackingStoreEA.h
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TiledBackingStore_h
+#define TiledBackingStore_h
+
+#include <wtf/FastAllocBase.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
+#include "IntRect.h"
+#include "BALBase.h"
+#include "EARaster.h"
+
+
+namespace WKAL {
+
+    class GraphicsContext;
+
+    class TiledBackingStoreClient {
+    public:
+        virtual ~TiledBackingStoreClient() { }
+
+        // Paints the contents in rect, which is in contents coordinates. 
+        virtual void paintTileContents(GraphicsContext*, const IntRect& rect) = 0;
+    };
+
+
+    // Keeps the contents of a scroll view in fixed size tiles, including tiles beyond the visible
+    // area, so that scrolling mostly composites tiles that are already painted. Invalidated parts
+    // of the tiles get repainted when they are next drawn, or ahead of time by paintAhead().
+    // Tiles are kept within a byte budget, evicting the ones furthest from the visible area first.
+    class TiledBackingStore : Noncopyable, public WTF::FastAllocBase {
+    public:
+        // Tiles are in pixelFormat, which is normally that of the view they get drawn to.
+        TiledBackingStore(TiledBackingStoreClient* pClient, int maxBytes, EA::Raster::PixelFormatType pixelFormat);
+        ~TiledBackingStore();
+
+        void setContentsSize(const IntSize&);
+        void setVisibleRect(const IntRect&);
+
+        void invalidate(const IntRect&);
+        void invalidateAll();
+
+        // Draws rect from the tiles into the context, painting whatever of them isn't up to date.
+        void paint(GraphicsContext*, const IntRect& rect);
+
+        // Paints tiles around the visible area, ahead of the scroll direction first, until 
+        // the time limit (in seconds) is used up. At least one tile is painted if any needs it.
+        // Returns true if any tile was painted.
+        bool paintAhead(double timeLimit);
+
+    private:
+        struct Tile {
+            IntPoint             mCoordinate;   // In tiles.
+            EA::Raster::Surface* mpSurface;
+            IntRect              mDirtyRect;    // In contents coordinates.
+        };
+
+        unsigned maxTiles() const;
+        IntRect tileRect(const IntPoint& coordinate) const;
+        IntRect tileCoverage(const IntRect& rect) const;
+        IntRect coverRect() const;
+        Tile*   findTile(const IntPoint& coordinate);
+        Tile*   createTile(const IntPoint& coordinate, const IntRect& keepRect);
+        void    paintTile(Tile& tile);
+        bool    findTileToPaintAhead(IntPoint& coordinate);
+
+        TiledBackingStoreClient*    m_client;
+        Vector<Tile>                m_tiles;
+        int                         m_maxBytes;
+        EA::Raster::PixelFormatType m_pixelFormat;
+        IntSize                     m_contentsSize;
+        IntRect                     m_visibleRect;
+        IntSize                     m_scrollDirection;  // Sign of the last scroll along each axis.
+    };
+
+} // namespace
+
+
+
+#endif  // TiledBackingStore_h
@@ -41,6 +41,8 @@
 #include "EARaster.h"
 #include <EAWebKit/EAWebKitConfig.h>
 #include "../EA/BCImageCompressionEA.h"
+#include "../EA/BCScaledImageCacheEA.h"
+#include "../EA/BCImageDecodeQueueEA.h"
 #include "cache.h"
 #include "ImageDecoder.h"
 namespace WKAL {
@@ -55,6 +57,10 @@ namespace WKAL {
 // which the user can set up on startup and which defaults to something like we have here.
 const unsigned cLargeAnimationCutoff = 5242880 * 4;
 
+// Animations whose frames take more than this decoded are streamed by decoders that can: only the frame
+// being shown is kept, and the decoder keeps what it needs to make the next one.
+const unsigned cStreamingAnimationCutoff = 1024 * 1024;
+
 
 BitmapImage::BitmapImage(ImageObserver* observer)
     : Image(observer)
@@ -72,28 +78,36 @@ BitmapImage::BitmapImage(ImageObserver* observer)
     , m_decodedSize(0)
     , m_haveFrameCount(false)
     , m_frameCount(0)
+    , m_decodeScaleShift(-1)
 {
     initPlatformData();
 }
 
 BitmapImage::~BitmapImage()
 {
+    // Our observer may already be going away, so drop our scaled copies without telling it.
+    scaledImageCache()->remove(this, false);
+    imageDecodeQueue()->cancel(this);
     invalidatePlatformData();
     stopAnimation();
 }
 
 void BitmapImage::destroyDecodedData(bool incremental)
 {
+    // A decode in flight would bring back what is being freed here.
+    if (!incremental)
+        imageDecodeQueue()->cancel(this);
+
     // Destroy the cached images and release them.
     if (m_frames.size()) {
         int sizeChange = 0;
-        int frameSize = m_size.width() * m_size.height() * 4;
+        int frameSize = frameBytes();
         for (unsigned i = incremental ? m_frames.size() - 1 : 0; i < m_frames.size(); i++) {
             if (m_frames[i].m_frame) {
 
                 // 1/15/08 CSidhall Note: Added special size adjustment for compressed texture cases
                 // Some animated textures can have frames compressed with different systems and different sizes.
-                EA::Raster::Surface* pImage = frameAtIndex(m_currentFrame);
+                EA::Raster::Surface* pImage = m_frames[i].m_frame;
                 if( (pImage != NULL) && (pImage->mCompressedSize != 0) ) {
                     sizeChange -= pImage->mCompressedSize;
                 }
@@ -143,6 +157,26 @@ void BitmapImage::cacheFrame(size_t index)
     if (m_frames.size() < numFrames)
         m_frames.grow(numFrames);
 
+    if (numFrames > 1 && !m_source.streamingAnimation() && (numFrames * frameBytes()) > cStreamingAnimationCutoff)
+        m_source.setStreamingAnimation(true);
+
+    // A streamed animation holds only the frame being shown.
+    if (m_source.streamingAnimation()) {
+        int sizeChange = 0;
+        for (size_t i = 0; i < m_frames.size(); i++) {
+            if ((i != index) && m_frames[i].m_frame) {
+                sizeChange -= m_frames[i].m_frame->mCompressedSize ? m_frames[i].m_frame->mCompressedSize : frameBytes();
+                m_frames[i].clear();
+            }
+        }
+
+        if (sizeChange) {
+            m_decodedSize += sizeChange;
+            if (imageObserver())
+                imageObserver()->decodedSizeChanged(this, sizeChange);
+        }
+    }
+
     m_frames[index].m_frame = m_source.createFrameAtIndex(index);
     if(!m_frames[index].m_frame)
         return;                 // 7/9/09 CSidhall - We failed to allocate so exit without crashing
@@ -154,7 +188,7 @@ void BitmapImage::cacheFrame(size_t index)
         m_frames[index].m_duration = m_source.frameDurationAtIndex(index);
     m_frames[index].m_hasAlpha = m_source.frameHasAlphaAtIndex(index);
     
-    int sizeChange = m_frames[index].m_frame ? m_size.width() * m_size.height() * 4 : 0;
+    int sizeChange = m_frames[index].m_frame ? frameBytes() : 0;
     if (sizeChange) {
         m_decodedSize += sizeChange;
         if (imageObserver())
@@ -204,6 +238,13 @@ IntSize BitmapImage::size() const
     return m_size;
 }
 
+unsigned BitmapImage::frameBytes() const
+{
+    // Images decoded scaled down hold fewer pixels than size().
+    const IntSize frameSize = m_source.initialized() ? m_source.frameSize() : size();
+    return frameSize.width() * frameSize.height() * 4;
+}
+
 bool BitmapImage::dataChanged(bool allDataReceived)
 {
     destroyDecodedData(true);
@@ -316,7 +357,7 @@ void BitmapImage::resetAnimation()
     const size_t frameCount_ = frameCount();
 
     // For extremely large animations, when the animation is reset, we just throw everything away.
-    if ((frameCount_ * frameSize) > cLargeAnimationCutoff)
+    if (!m_source.streamingAnimation() && (frameCount_ * frameSize) > cLargeAnimationCutoff)
         destroyDecodedData();
 }
 
@@ -345,21 +386,22 @@ void BitmapImage::advanceAnimation(Timer<BitmapImage>* timer)
         m_currentFrame = 0;
     }
 
-    // Notify our observer that the animation has advanced.
-    imageObserver()->animationAdvanced(this);
-
     // For large animated images, go ahead and throw away frames as we go to save
-    // footprint.
+    // footprint. Streamed animations already hold a single frame.
     const int    frameSize   = m_size.width() * m_size.height() * 4;
     const size_t frameCount_ = frameCount();
 
-    if ((frameCount_ * frameSize) > cLargeAnimationCutoff) {
+    if (!m_source.streamingAnimation() && (frameCount_ * frameSize) > cLargeAnimationCutoff) {
         // Destroy all of our frames and just redecode every time.
         destroyDecodedData();
-
-        // Go ahead and decode the next frame.
-        frameAtIndex(m_currentFrame);
     }
+
+    // Go ahead and decode the next frame, so that our observer only repaints the part
+    // of the image that it changes.
+    if (frameAtIndex(m_currentFrame))
+        imageObserver()->changedInRect(this, m_source.frameUpdateRectAtIndex(m_currentFrame));
+    else
+        imageObserver()->animationAdvanced(this);
     
     // We do not advance the animation explicitly.  We rely on a subsequent draw of the image
     // to force a request for the next frame via startAnimation().  This allows images that move offscreen while
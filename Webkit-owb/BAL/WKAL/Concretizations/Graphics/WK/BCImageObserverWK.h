@@ -34,6 +34,7 @@
 namespace WKAL {
 
 class Image;
+class IntRect;
 
 // Interface for notification about changes to an image, including decoding,
 // drawing, and animating.
@@ -46,6 +47,10 @@ public:
 
     virtual bool shouldPauseAnimation(const Image*) = 0;
     virtual void animationAdvanced(const Image*) = 0;
+
+    // The pixels of rect (in image coordinates) changed without a data or animation change,
+    // e.g. because a decode that was running elsewhere completed.
+    virtual void changedInRect(const Image*, const IntRect&) = 0;
 };
 
 }
@@ -33,6 +33,7 @@
 
 #include <wtf/FastAllocBase.h>
 #include "Color.h"
+#include "FloatSize.h"
 #include "GraphicsTypes.h"
 #include "ImageSource.h"
 #include <wtf/RefPtr.h>
@@ -187,6 +188,11 @@ protected:
     virtual Color solidColor() const { return Color(); }
     
     virtual void startAnimation() { }
+
+    // Called before drawing with the scale from image to dest, so images can decode no larger than drawn.
+    virtual void updateDecodeScale(float /*drawScaleX*/, float /*drawScaleY*/) { }
+    // The scale from image coordinates to the pixels of nativeImageForCurrentFrame().
+    virtual FloatSize nativeImageScale() const { return FloatSize(1.0f, 1.0f); }
     
     virtual void drawPattern(GraphicsContext*, const FloatRect& srcRect, const AffineTransform& patternTransform,
                              const FloatPoint& phase, CompositeOperator, const FloatRect& destRect);
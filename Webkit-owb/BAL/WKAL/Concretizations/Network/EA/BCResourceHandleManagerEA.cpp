@@ -66,6 +66,7 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "HTTPParsers.h"
 #include "Base64.h"
 #include "Timer.h"
+#include "SharedTimer.h"
 #include <ctype.h>
 #include <errno.h>
 #include <wtf/Vector.h>
@@ -814,6 +815,13 @@ int ResourceHandleManager::ProcessTHJobs()
 	
     for(JobInfoList::iterator it = m_JobInfoList.begin(); it != m_JobInfoList.end(); ++it)
     {
+        // Once the tick's deadline has passed, the jobs not yet run are moved to the front to run first on the next pass.
+        if((it != m_JobInfoList.begin()) && tickDeadlinePassed())
+        {
+            m_JobInfoList.splice(m_JobInfoList.begin(), m_JobInfoList, it, m_JobInfoList.end());
+            break;
+        }
+
         JobInfo& jobInfo = *it;
 		//If a job is synchronous, make sure that its AsyncJobPaused flag is set to false. 
 		//If the job is asynchronous, dont bother. Just pass the true to the assert macro.
@@ -48,9 +48,19 @@ int screenDepth(Widget* widget)
     return widget->containingWindow()->mPixelFormat.mBytesPerPixel * 8;
 }
 
-int screenDepthPerComponent(Widget*)
+int screenDepthPerComponent(Widget* widget)
 {
-    return 8;  // We assume A8R8G8B8 (or similar)
+    ASSERT(widget->containingWindow());
+
+    // The fewest bits that any of red, green and blue get.
+    switch (widget->containingWindow()->mPixelFormat.mPixelFormatType) {
+        case EA::Raster::kPixelFormatTypeRGB565:
+            return 5;
+        case EA::Raster::kPixelFormatTypeARGB4444:
+            return 4;
+        default:
+            return 8;
+    }
 }
 
 bool screenIsMonochrome(Widget* /*widget*/)
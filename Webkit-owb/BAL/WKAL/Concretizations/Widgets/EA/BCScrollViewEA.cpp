@@ -40,12 +40,14 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Frame.h"
 #include "FrameView.h"
 #include "GraphicsContext.h"
+#include "DisplayList.h"
 #include "IntRect.h"
 #include "PlatformMouseEvent.h"
 #include "PlatformWheelEvent.h"
 #include "PlatformScrollBar.h"
 #include "Page.h"
 #include "RenderLayer.h"
+#include "TiledBackingStore.h"
 #include "EARaster.h"
 #include <EAWebKit/internal/EAWebKitAssert.h>
 #include <EAWebKit/EAWebKitView.h>
@@ -74,7 +76,7 @@ protected:
 
 
 
-class ScrollView::ScrollViewPrivate : public ScrollbarClient, public WTF::FastAllocBase
+class ScrollView::ScrollViewPrivate : public ScrollbarClient, public TiledBackingStoreClient, public WTF::FastAllocBase
 {
 public:
     ScrollViewPrivate(ScrollView* _view)
@@ -86,12 +88,14 @@ public:
         , inUpdateScrollbars(false)
         , horizontalAdjustment(0)
         , verticalAdjustment(0)
+        , tiledBackingStore(0)
     {}
 
     ~ScrollViewPrivate()
     {
         setHasHorizontalScrollbar(false);
         setHasVerticalScrollbar(false);
+        delete tiledBackingStore;
     }
 
     void scrollBackingStore(const IntSize& scrollDelta);
@@ -105,6 +109,9 @@ public:
 
     static void adjustmentChanged(BalAdjustment*, void *);
 
+    TiledBackingStore* tiles();
+    virtual void paintTileContents(GraphicsContext*, const IntRect&);
+
     ScrollView* view;
     bool hasStaticBackground;
     bool scrollbarsSuppressed;
@@ -119,6 +126,7 @@ public:
     HashSet<Widget*> children;
     BalAdjustment* horizontalAdjustment;
     BalAdjustment* verticalAdjustment;
+    TiledBackingStore* tiledBackingStore;
 };
 
 
@@ -188,22 +196,30 @@ void ScrollView::ScrollViewPrivate::scrollBackingStore(const IntSize& scrollDelt
     IntRect updateRect = clipRect;
     updateRect.intersect(scrollViewRect);
 
-    //FIXME update here?
-
-    if (!hasStaticBackground) // The main frame can just blit the WebView window
-       // FIXME: Find a way to blit subframes without blitting overlapping content
-       view->scrollBackingStore(-scrollDelta.width(), -scrollDelta.height(), scrollViewRect, clipRect);
-    else  {
-       // We need to go ahead and repaint the entire backing store.  Do it now before moving the
-       // plugins.
-       view->addToDirtyRegion(updateRect);
-       view->updateBackingStore();
+    // Only the main frame can shift its pixels in the backing store, as subframes can have content
+    // drawn over them, and fixed position content (static background) must not move with the page.
+    if (!hasStaticBackground && !view->parent()) {
+        view->scrollBackingStore(-scrollDelta.width(), -scrollDelta.height(), scrollViewRect, clipRect);
+        view->geometryChanged();
+
+        // The scrollbars are outside the scrolled rect, so we repaint those on their own instead 
+        // of updating the whole view.
+        if (hBar)
+            view->addToDirtyRegion(view->convertToContainingWindow(hBar->frameGeometry()));
+        if (vBar)
+            view->addToDirtyRegion(view->convertToContainingWindow(vBar->frameGeometry()));
+        view->SetDirty(true);
+        return;
     }
 
+    // We need to go ahead and repaint the entire backing store.  Do it now before moving the
+    // plugins.
+    view->addToDirtyRegion(updateRect);
+    view->updateBackingStore();
+
     view->geometryChanged();
 
-    // Now update the window (which should do nothing but a blit of the backing store's updateRect and so should
-    // be very fast).
+    // Now update the window.
     view->update();
 }
 
@@ -255,6 +271,29 @@ void ScrollView::ScrollViewPrivate::valueChanged(Scrollbar* bar)
 }
 
 
+// Returns the tiled backing store if the view's parameters ask for one, creating it on first use.
+// Only the main frame keeps tiles, and not with fixed position content (static background), 
+// as that would need every tile repainted on every scroll.
+TiledBackingStore* ScrollView::ScrollViewPrivate::tiles()
+{
+    if (tiledBackingStore || view->parent() || hasStaticBackground || !view->containingWindow())
+        return tiledBackingStore;
+
+    EA::WebKit::View* pView = static_cast<EA::WebKit::View*>(view->containingWindow()->mpUserData);
+
+    if (pView && pView->GetSurfaceParameters().mbTiledBackingStore)
+        tiledBackingStore = new TiledBackingStore(this, pView->GetSurfaceParameters().mTiledBackingStoreSize, pView->GetSurfaceParameters().mPixelFormat);
+
+    return tiledBackingStore;
+}
+
+
+void ScrollView::ScrollViewPrivate::paintTileContents(GraphicsContext* context, const IntRect& rect)
+{
+    static_cast<const FrameView*>(view)->frame()->paint(context, rect);
+}
+
+
 IntRect ScrollView::ScrollViewPrivate::windowClipRect() const
 {
     return static_cast<const FrameView*>(view)->windowClipRect(false);
@@ -326,6 +365,7 @@ void ScrollView::updateContents(const IntRect& updateRect, bool /*now*/)
 
     // Cache the dirty spot.
     addToDirtyRegion(containingWindowRect);
+    invalidateTiles(updateRect);
 
     if (/*now && */ containingWindow())
     {
@@ -344,6 +384,11 @@ void ScrollView::update()
     //OWB_PRINTF("update documentDirtyRect x=%d y=%d w=%d h=%d\n", documentDirtyRect.x(), documentDirtyRect.y(), documentDirtyRect.width(), documentDirtyRect.height());
     addToDirtyRegion(documentDirtyRect);
 
+    if (parent())
+        invalidateTiles(enclosingIntRect(visibleContentRect()));
+    else if (m_data->tiledBackingStore)
+        m_data->tiledBackingStore->invalidateAll();
+
     //updateView(containingWindow(), frameGeometry());
     SetDirty(true);
 }
@@ -480,6 +525,12 @@ void ScrollView::setScrollbarsMode(ScrollbarMode newMode)
 void ScrollView::setStaticBackground(bool flag)
 {
     m_data->hasStaticBackground = flag;
+
+    // Fixed position content doesn't work with tiles, so they go until it is gone.
+    if (flag && m_data->tiledBackingStore) {
+        delete m_data->tiledBackingStore;
+        m_data->tiledBackingStore = 0;
+    }
 }
 
 void ScrollView::setFrameGeometry(const IntRect& newGeometry)
@@ -524,8 +575,12 @@ void ScrollView::scrollRectIntoViewRecursively(const IntRect& r)
 
 bool ScrollView::inWindow() const
 {
-    NotImplemented();
-    return true;
+    // The containing window is the surface of the View, which knows whether the application shows it.
+    if (!containingWindow())
+        return true;
+
+    EA::WebKit::View* pView = static_cast<EA::WebKit::View*>(containingWindow()->mpUserData);
+    return !pView || pView->IsVisible();
 }
 
 void ScrollView::wheelEvent(PlatformWheelEvent& e)
@@ -769,8 +824,15 @@ void ScrollView::paint(GraphicsContext* context, const IntRect& rect)
 
     //OWB_PRINTF("this = %p documentDirtyRect x=%d y=%d w=%d h=%d\n", this, documentDirtyRect.x(), documentDirtyRect.y(), documentDirtyRect.width(), documentDirtyRect.height());
 
-    WebCore::Frame* pFrame = static_cast<const FrameView*>(this)->frame();
-    pFrame->paint(context, documentDirtyRect);
+    if (TiledBackingStore* pTiles = m_data->tiles()) {
+        pTiles->setContentsSize(IntSize(contentsWidth(), contentsHeight()));
+        pTiles->setVisibleRect(enclosingIntRect(visibleContentRect()));
+        pTiles->paint(context, documentDirtyRect);
+    }
+    else {
+        WebCore::Frame* pFrame = static_cast<const FrameView*>(this)->frame();
+        pFrame->paint(context, documentDirtyRect);
+    }
 
     context->restore();
 
@@ -823,10 +885,18 @@ void ScrollView::paint(GraphicsContext* context, const IntRect& rect)
 
         //OWB_PRINTF("this = %p updateView rect = %d %d %d %d => r %d %d %d %d\n", this, rect.x(), rect.y(), rect.width(), rect.height(), r.x(), r.y(), r.width(), r.height());
 
-        if(!r.isEmpty())
+        // Subframes painted into a tile of the main frame have nothing to report.
+        DisplayList* const pDisplayList = context->displayList();
+        EA::Raster::Surface* const pTarget = pDisplayList ? pDisplayList->target() : context->platformContext();
+
+        if(!r.isEmpty() && (pTarget == containingWindow()))
         {
             EA::Raster::Surface* const pSurface = containingWindow();
 
+            // The view gets reported as updated, so what was recorded of the paint has to be drawn by now.
+            if (context->displayList())
+                context->displayList()->replay();
+
             updateView(pSurface, r);
         }
     }
@@ -895,6 +965,47 @@ bool ScrollView::scroll(ScrollDirection direction, ScrollGranularity granularity
     return false;
 }
 
+// Marks the tiles under updateRect, which is in this view's contents coordinates, as needing a repaint.
+// Unlike the dirty region this includes what is outside the view.
+void ScrollView::invalidateTiles(const IntRect& updateRect)
+{
+    ScrollView* pRoot = this;
+    while (pRoot->parent())
+        pRoot = pRoot->parent();
+
+    if (TiledBackingStore* pTiles = pRoot->m_data->tiledBackingStore) {
+        if (pRoot == this)
+            pTiles->invalidate(updateRect);
+        else
+            pTiles->invalidate(pRoot->windowToContents(contentsToWindow(updateRect)));
+    }
+}
+
+
+// Paints tiles beyond the view while there is nothing else to paint. See TiledBackingStore::paintAhead.
+bool ScrollView::paintTilesAhead(double timeLimit)
+{
+    if (parent() || IsDirty())
+        return false;
+
+    TiledBackingStore* const pTiles = m_data->tiles();
+    if (!pTiles)
+        return false;
+
+    FrameView* const pFrameView = static_cast<FrameView*>(this);
+    pFrameView->layoutIfNeededRecursive();
+
+    // Layout can dirty the view, which then gets painted first.
+    if (IsDirty())
+        return false;
+
+    pTiles->setContentsSize(IntSize(contentsWidth(), contentsHeight()));
+    pTiles->setVisibleRect(enclosingIntRect(visibleContentRect()));
+
+    return pTiles->paintAhead(timeLimit);
+}
+
+
 void ScrollView::addToDirtyRegion(const IntRect& containingWindowRect)
 {
     ASSERT(isFrameView());
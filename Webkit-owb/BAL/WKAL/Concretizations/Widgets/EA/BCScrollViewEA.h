@@ -141,6 +141,8 @@ namespace WKAL {
         virtual void setFrameGeometry(const IntRect&);
 
         void addToDirtyRegion(const IntRect&);
+        void invalidateTiles(const IntRect&);
+        bool paintTilesAhead(double timeLimit);
         void scrollBackingStore(int dx, int dy, const IntRect& scrollViewRect, const IntRect& clipRect);
         void updateBackingStore();
 
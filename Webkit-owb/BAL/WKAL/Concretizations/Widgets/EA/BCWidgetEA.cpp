@@ -197,8 +197,11 @@ void Widget::invalidateRect(const IntRect& rect)
         return;
 
     if (!parent()) {
-        if (isFrameView())
-            static_cast<FrameView*>(this)->addToDirtyRegion(rect);
+        if (isFrameView()) {
+            FrameView* frameView = static_cast<FrameView*>(this);
+            frameView->addToDirtyRegion(rect);
+            frameView->invalidateTiles(frameView->windowToContents(rect));
+        }
         return;
     }
 
@@ -211,6 +214,7 @@ void Widget::invalidateRect(const IntRect& rect)
 
     IntRect windowRect = convertToContainingWindow(rect);
     outermostView->addToDirtyRegion(windowRect);
+    outermostView->invalidateTiles(outermostView->windowToContents(windowRect));
 }
 
 IntPoint Widget::convertToContainingWindow(const IntPoint& point) const
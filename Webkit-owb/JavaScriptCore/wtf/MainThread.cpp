@@ -78,6 +78,31 @@ void dispatchFunctionsFromMainThread()
         queueCopy[i].function(queueCopy[i].context);
 }
 
+void dispatchFunctionsFromMainThread(bool (*shouldYield)())
+{
+    ASSERT(isMainThread());
+    ASSERT(shouldYield);
+
+    if (callbacksPaused)
+        return;
+
+    FunctionQueue queueCopy;
+    {
+        MutexLocker locker(functionQueueMutex());
+        queueCopy.swap(functionQueue());
+    }
+
+    for (unsigned i = 0; i < queueCopy.size(); ++i) {
+        queueCopy[i].function(queueCopy[i].context);
+
+        if ((i + 1 < queueCopy.size()) && shouldYield()) {
+            MutexLocker locker(functionQueueMutex());
+            functionQueue().insert(0, queueCopy.data() + i + 1, queueCopy.size() - (i + 1));
+            break;
+        }
+    }
+}
+
 void callOnMainThread(MainThreadFunction* function, void* context)
 {
     ASSERT(function);
@@ -45,6 +45,10 @@ void initializeMainThread();
 void dispatchFunctionsFromMainThread();
 void scheduleDispatchFunctionsOnMainThread();
 
+// Like dispatchFunctionsFromMainThread, but stops once shouldYield returns true after a function.
+// The functions not yet called stay queued, ahead of any queued since.
+void dispatchFunctionsFromMainThread(bool (*shouldYield)());
+
 } // namespace WTF
 
 using WTF::callOnMainThread;
@@ -591,8 +591,11 @@ void CanvasRenderingContext2D::fill()
     }
     cairo_restore(cr);
 #elif PLATFORM(BAL)
-   //FIXME
-   notImplemented();
+    // FIXME: Patterns. Until they are supported a pattern style draws nothing, rather than the last color set.
+    if (state().m_fillStyle->canvasGradient())
+        c->fillPath(state().m_fillStyle->canvasGradient()->gradient());
+    else if (!state().m_fillStyle->pattern())
+        c->fillPath();
 #endif
 
 #if ENABLE(DASHBOARD_SUPPORT)
@@ -659,8 +662,11 @@ void CanvasRenderingContext2D::stroke()
     }
     cairo_restore(cr);
 #elif PLATFORM(BAL)
-    //FIXME
-    notImplemented();
+    // FIXME: Patterns. Until they are supported a pattern style draws nothing, rather than the last color set.
+    if (state().m_strokeStyle->canvasGradient())
+        c->strokePath(state().m_strokeStyle->canvasGradient()->gradient());
+    else if (!state().m_strokeStyle->pattern())
+        c->strokePath();
 #endif
 
 #if ENABLE(DASHBOARD_SUPPORT)
@@ -753,8 +759,11 @@ void CanvasRenderingContext2D::fillRect(float x, float y, float width, float hei
     cairo_fill(cr);
     cairo_restore(cr);
 #elif PLATFORM(BAL)
-    //FIXME
-    notImplemented();
+    // FIXME: Patterns. Until they are supported a pattern style draws nothing, rather than the last color set.
+    if (state().m_fillStyle->canvasGradient())
+        c->fillRect(rect, state().m_fillStyle->canvasGradient()->gradient());
+    else if (!state().m_fillStyle->pattern())
+        c->fillRect(rect, c->fillColor());
 #endif
 }
 
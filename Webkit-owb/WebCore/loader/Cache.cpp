@@ -87,6 +87,8 @@ Cache::Cache()
 , m_liveSize(0)
 , m_deadSize(0)
 , m_maxUsedSize(0)
+, m_decodedImageCapacity(0)
+, m_liveDecodedImageSize(0)
 {
 }
 
@@ -404,6 +406,61 @@ bool Cache::pruneLiveImages(unsigned additionalSize)
     return false;
 }
 
+void Cache::pruneDecodedImages()
+{
+    if (!m_pruneEnabled || !m_decodedImageCapacity || m_liveDecodedImageSize <= m_decodedImageCapacity)
+        return;
+
+    unsigned targetSize = static_cast<unsigned>(m_decodedImageCapacity * cTargetPrunePercentage);
+    double currentTime = Frame::currentPaintTimeStamp();
+    if (!currentTime)
+        currentTime = WebCore::currentTime();
+
+    // The first pass only takes images that are nowhere near a viewport (offscreen or in a hidden view), the 
+    // second one takes any image that has not been drawn for a while. Both start from the tail, since this 
+    // is the least recently drawn. The encoded data is kept, so the images decode again when next drawn.
+    for (int pass = 0; pass < 2; ++pass) {
+        CachedResource* current = m_liveDecodedResources.m_tail;
+        while (current) {
+            CachedResource* prev = current->m_prevInLiveResourcesList;
+            if (current->isImage() && current->isLoaded() && current->decodedSize()) {
+                CachedImage* pCachedImage = static_cast<CachedImage*>(current);
+                Image* pImage = pCachedImage->image();
+
+                if (pass) {
+                    // Check to see if the remaining resources are too new to prune.
+                    if ((currentTime - current->m_lastDecodedAccessTime) < cMinDelayBeforeLiveDecodedPrune)
+                        return;
+                } else if (pCachedImage->isNearViewport()) {
+                    current = prev;
+                    continue;
+                }
+
+                if (pImage->isBitmapImage() && static_cast<BitmapImage*>(pImage)->imagePruneLockStatus()) {
+                    current = prev;
+                    continue;
+                }
+
+                // This removes us from m_liveDecodedResources.
+                current->destroyDecodedData();
+
+                if (m_liveDecodedImageSize <= targetSize)
+                    return;
+            }
+            current = prev;
+        }
+    }
+}
+
+void Cache::adjustLiveDecodedImageSize(CachedResource* resource, int delta)
+{
+    if (!resource->isImage())
+        return;
+
+    ASSERT(delta >= 0 || ((int)m_liveDecodedImageSize + delta >= 0));
+    m_liveDecodedImageSize += delta;
+}
+
 bool Cache::pruneDeadImages(unsigned additionalSize)
 {
     if (!m_pruneEnabled)
@@ -494,6 +551,12 @@ void Cache::setCapacities(unsigned minDeadBytes, unsigned maxDeadBytes, unsigned
     prune();
 }
 
+void Cache::setDecodedImageCapacity(unsigned bytes)
+{
+    m_decodedImageCapacity = bytes;
+    pruneDecodedImages();
+}
+
 void Cache::remove(CachedResource* resource)
 {
     // The resource may have already been removed by someone other than our caller,
@@ -664,6 +727,7 @@ void Cache::removeFromLiveDecodedResourcesList(CachedResource* resource)
     if (!resource->m_inLiveDecodedResourcesList)
         return;
     resource->m_inLiveDecodedResourcesList = false;
+    adjustLiveDecodedImageSize(resource, -static_cast<int>(resource->decodedSize()));
 
 #ifndef NDEBUG
     // Verify that we are in fact in this list.
@@ -702,6 +766,7 @@ void Cache::insertInLiveDecodedResourcesList(CachedResource* resource)
     // Make sure we aren't in the list already.
     ASSERT(!resource->m_nextInLiveResourcesList && !resource->m_prevInLiveResourcesList && !resource->m_inLiveDecodedResourcesList);
     resource->m_inLiveDecodedResourcesList = true;
+    adjustLiveDecodedImageSize(resource, resource->decodedSize());
 
     resource->m_nextInLiveResourcesList = m_liveDecodedResources.m_head;
     if (m_liveDecodedResources.m_head)
@@ -155,6 +155,12 @@ public:
     //  - totalBytes: The maximum number of bytes that the cache should consume overall.
     void setCapacities(unsigned minDeadBytes, unsigned maxDeadBytes, unsigned totalBytes);
 
+    // Sets the number of bytes that the decoded data of live images should consume, on top of the limits
+    // above. Images that are not near the viewport of a shown view are the first to lose their decoded
+    // data when it is exceeded. 0 disables the limit.
+    void setDecodedImageCapacity(unsigned bytes);
+    unsigned decodedImageCapacity() const { return m_decodedImageCapacity; }
+
     // Turn the cache on and off.  Disabling the cache will remove all resources from the cache.  They may
     // still live on if they are referenced by some Web page though.
     void setDisabled(bool);
@@ -200,6 +206,11 @@ public:
     bool pruneLiveImages(unsigned additionalSize);
     bool pruneDeadImages(unsigned additionalSize);
 
+    // Flushes decoded data from live images until the decoded image capacity is met, starting with the
+    // images that are not near a viewport. This is done after each top level paint.
+    void pruneDecodedImages();
+    void adjustLiveDecodedImageSize(CachedResource*, int delta);
+
 private:
     Cache();
   
@@ -237,6 +248,9 @@ private:
     unsigned m_deadSize; // The number of bytes currently consumed by "dead" resources in the cache.
     unsigned m_maxUsedSize; // Keep track of the largest size used
 
+    unsigned m_decodedImageCapacity;
+    unsigned m_liveDecodedImageSize; // The number of bytes of decoded data held by the images in m_liveDecodedResources.
+
     // Size-adjusted and popularity-aware LRU list collection for cache objects.  This collection can hold
     // more resources than the cached resource map, since it can also hold "stale" muiltiple versions of objects that are
     // waiting to die when the clients referencing them go away.
@@ -340,10 +340,31 @@ bool CachedImage::shouldPauseAnimation(const Image* image)
     return true;
 }
 
+bool CachedImage::isNearViewport()
+{
+    CachedResourceClientWalker w(m_clients);
+    while (CachedResourceClient* c = w.next()) {
+        if (c->willRenderImageNearViewport(this))
+            return true;
+    }
+
+    return false;
+}
+
 void CachedImage::animationAdvanced(const Image* image)
 {
     if (image == m_image)
         notifyObservers();
 }
 
+void CachedImage::changedInRect(const Image* image, const IntRect& rect)
+{
+    if (image != m_image)
+        return;
+
+    CachedResourceClientWalker w(m_clients);
+    while (CachedResourceClient* c = w.next())
+        c->imageChangedInRect(this, rect);
+}
+
 } //namespace WebCore
@@ -88,7 +88,11 @@ public:
     virtual void didDraw(const Image*);
 
     virtual bool shouldPauseAnimation(const Image*);
+
+    // Whether any client is showing the image within or near the visible part of its view.
+    bool isNearViewport();
     virtual void animationAdvanced(const Image*);
+    virtual void changedInRect(const Image*, const IntRect&);
 
     static void staticFinalize();        // 3/26/09 CS - Added to remove leak.
     static BitmapImage* s_pNullImage; 
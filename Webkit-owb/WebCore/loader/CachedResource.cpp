@@ -163,6 +163,11 @@ void CachedResource::setDecodedSize(unsigned size)
     // queue.
     if (inCache())
         cache()->removeFromLRUList(this);
+
+    // Insertion in or removal from the live decoded list below counts the new size, so only a resource
+    // staying in it needs the delta.
+    if (m_inLiveDecodedResourcesList)
+        cache()->adjustLiveDecodedImageSize(this, delta);
     
     m_decodedSize = size;
    
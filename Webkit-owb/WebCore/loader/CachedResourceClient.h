@@ -58,6 +58,10 @@ namespace WebCore {
         // Called whenever a frame of an image changes, either because we got more data from the network or
         // because we are animating.
         virtual void imageChanged(CachedImage*) { };
+
+        // Called instead of imageChanged when only a rect of the image (in the image's own coordinates) differs
+        // from what was last drawn, as when an animation advances to a frame that covers part of the image.
+        virtual void imageChangedInRect(CachedImage* image, const IntRect&) { imageChanged(image); }
         
         // Called to find out if this client wants to actually display the image.  Used to tell when we
         // can halt animation.  Content nodes that hold image refs for example would not render the image,
@@ -65,6 +69,10 @@ namespace WebCore {
         // e.g., in the b/f cache or in a background tab).
         virtual bool willRenderImage(CachedImage*) { return false; }
 
+        // Same as willRenderImage, but also requires the client to be within or near the visible part of its
+        // view. The cache drops the decoded data of images that no client answers yes for first.
+        virtual bool willRenderImageNearViewport(CachedImage*) { return false; }
+
         virtual void setCSSStyleSheet(const String& /*URL*/, const String& /*charset*/, const CachedCSSStyleSheet*) { }
         virtual void setXSLStyleSheet(const String& /*URL*/, const String& /*sheet*/) { }
 
@@ -38,6 +38,7 @@
 #include "CSSComputedStyleDeclaration.h"
 #include "CSSProperty.h"
 #include "CSSPropertyNames.h"
+#include "Cache.h"
 #include "CachedCSSStyleSheet.h"
 #include "DOMWindow.h"
 #include "DocLoader.h"
@@ -1391,8 +1392,11 @@ void Frame::paint(GraphicsContext* p, const IntRect& rect)
     } else
         LOG_ERROR("called Frame::paint with nil renderer");
         
-    if (isTopLevelPainter)
+    if (isTopLevelPainter) {
+        // Now that what is near the viewport has been drawn, drop decoded images that are not.
+        cache()->pruneDecodedImages();
         s_currentPaintTimeStamp = 0;
+    }
 }
 
 void Frame::setPaintRestriction(PaintRestriction pr)
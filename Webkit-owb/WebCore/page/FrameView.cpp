@@ -731,6 +731,8 @@ void FrameView::repaintRectangle(const IntRect& r, bool immediate)
             else if (d->m_repaintCount < cRepaintRectUnionThreshold)
                 d->m_repaintRects.append(r);
         }
+        else
+            invalidateTiles(r); // Offscreen, but it may be held in a tile.
         return;
     }
     
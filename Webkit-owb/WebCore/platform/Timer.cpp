@@ -354,6 +354,15 @@ void TimerBase::fireTimers(double fireTime, const Vector<TimerBase*>& firingTime
         // Catch the case where the timer asked timers to fire in a nested event loop.
         if (!timersReadyToFire)
             break;
+
+        // Once the tick's deadline has passed, the timers that are left go back in the heap to fire next time.
+        if (tickDeadlinePassed()) {
+            for (int j = i + 1; j != size; ++j) {
+                if (timersReadyToFire->contains(firingTimers[j]))
+                    firingTimers[j]->setNextFireTime(fireTime);
+            }
+            break;
+        }
     }
 }
 
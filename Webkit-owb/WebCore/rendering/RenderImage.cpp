@@ -302,6 +302,32 @@ void RenderImage::imageChanged(WrappedImagePtr newImage)
         repaintRectangle(contentBox());
 }
 
+void RenderImage::imageChangedInRect(CachedImage* image, const IntRect& rect)
+{
+    if (documentBeingDestroyed())
+        return;
+
+    // Only a plain repaint of the image can be limited to the rect. A size change, alt text or box
+    // decorations that draw the image go through imageChanged.
+    if (image != m_cachedImage || errorOccurred() || hasBoxDecorations() || imageSize(style()->effectiveZoom()) != intrinsicSize()) {
+        imageChanged(image);
+        return;
+    }
+
+    // The image is stretched over the content box.
+    const IntSize size = m_cachedImage->image()->size();
+    if (size.isEmpty())
+        return;
+
+    const IntRect box = contentBox();
+    const float scaleX = static_cast<float>(box.width()) / size.width();
+    const float scaleY = static_cast<float>(box.height()) / size.height();
+    IntRect repaintRect = enclosingIntRect(FloatRect(box.x() + rect.x() * scaleX, box.y() + rect.y() * scaleY,
+                                                     rect.width() * scaleX, rect.height() * scaleY));
+    repaintRect.intersect(box);
+    repaintRectangle(repaintRect);
+}
+
 void RenderImage::resetAnimation()
 {
     if (m_cachedImage) {
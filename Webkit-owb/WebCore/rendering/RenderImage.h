@@ -47,6 +47,7 @@ public:
     virtual int minimumReplacedHeight() const;
 
     virtual void imageChanged(WrappedImagePtr);
+    virtual void imageChangedInRect(CachedImage*, const IntRect&);
     
     bool setImageSizeForAltText(CachedImage* newImage = 0);
 
@@ -1344,6 +1344,20 @@ void RenderObject::paintBorder(GraphicsContext* graphicsContext, int tx, int ty,
         static_cast<unsigned>(h) >= static_cast<unsigned>(topRight.height()) + static_cast<unsigned>(bottomRight.height()))
         renderRadii = true;
 
+#if PLATFORM(BAL)
+    // A uniform solid rounded border is drawn in one go from cached corner masks rather than clipped arcs.
+    if (renderRadii && renderTop && renderLeft && renderRight && renderBottom &&
+        (ts == SOLID) && (bs == SOLID) && (ls == SOLID) && (rs == SOLID) &&
+        (tc == bc) && (tc == lc) && (tc == rc) &&
+        (style->borderTopWidth() == style->borderBottomWidth()) &&
+        (style->borderTopWidth() == style->borderLeftWidth()) &&
+        (style->borderTopWidth() == style->borderRightWidth())) {
+        graphicsContext->strokeRoundedRect(IntRect(tx, ty, w, h), topLeft, topRight, bottomLeft, bottomRight,
+                                           style->borderTopWidth(), tc.isValid() ? tc : style->color());
+        return;
+    }
+#endif
+
     // Clip to the rounded rectangle.
     if (renderRadii) {
         graphicsContext->save();
@@ -3000,6 +3014,18 @@ bool RenderObject::willRenderImage(CachedImage*)
     return !document()->inPageCache() && document()->view()->inWindow();
 }
 
+bool RenderObject::willRenderImageNearViewport(CachedImage* image)
+{
+    if (!willRenderImage(image))
+        return false;
+
+    // The viewport is expanded by its own size on each side, so that images about to be scrolled in stay decoded.
+    IntRect viewport = enclosingIntRect(document()->view()->visibleContentRect());
+    viewport.inflateX(viewport.width());
+    viewport.inflateY(viewport.height());
+    return viewport.intersects(absoluteBoundingBoxRect());
+}
+
 int RenderObject::maximalOutlineSize(PaintPhase p) const
 {
     if (p != PaintPhaseOutline && p != PaintPhaseSelfOutline && p != PaintPhaseChildOutlines)
@@ -883,6 +883,7 @@ public:
     virtual void imageChanged(CachedImage* image);
     virtual void imageChanged(WrappedImagePtr data) { };
     virtual bool willRenderImage(CachedImage*);
+    virtual bool willRenderImageNearViewport(CachedImage*);
 
     virtual void selectionStartEnd(int& spos, int& epos) const;
 
@@ -37,6 +37,7 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "FrameView.h"
 #include "Frame.h"
 #include "GraphicsContext.h"
+#include "DisplayList.h"
 #include "Page.h"
 #include "EventHandler.h"
 #include "FocusController.h"
@@ -49,6 +50,8 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "PopupMenu.h"
 #include "CString.h"
 #include "FileIO.h"
+#include "SharedTimer.h"
+#include <EAWebKit/EAWebKit.h>
 #include <EAWebKit/EAWebKitInput.h>
 #include "BAL/Includes/FakedDeepsee.h"
 
@@ -56,6 +59,10 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 using namespace WebCore;
 
 
+// Height of the bands dirty rects are painted in when the tick has a deadline.
+static const int kPaintSliceHeight = 64;
+
+
 void WebViewPrivate::onExpose(BalEventExpose eventExpose)
 {
     //OWB_PRINTF("WebViewPrivate::onExpose\n");
@@ -73,11 +80,45 @@ void WebViewPrivate::onExpose(BalEventExpose eventExpose)
 
     GraphicsContext ctx(m_webView->viewWindow());
     ctx.setBalExposeEvent(&eventExpose);
-    if (frame->contentRenderer() && frame->view() && !m_webView->dirtyRegion().isEmpty()) {
+    if (frame->contentRenderer() && frame->view() && !m_webView->dirtyRects().isEmpty()) {
         frame->view()->layoutIfNeededRecursive();
-        IntRect dirty = m_webView->dirtyRegion();
-        frame->view()->paint(&ctx, dirty);
+
+        // With a raster job dispatcher the paint is recorded and then rasterized in tiles on the application's threads.
+        DisplayList displayList(m_webView->viewWindow());
+        if (EA::WebKit::GetRasterJobDispatcher())
+            ctx.setDisplayList(&displayList);
+
+        // Paint each dirty rect on its own so each one gets reported as a separate view update.
+        // We work off a copy as the paint can add to the dirty region.
+        const Vector<IntRect> dirtyRects(m_webView->dirtyRects());
+        Vector<IntRect> unpaintedRects;
+        bool painted = false;
+
+        for (size_t i = 0; i < dirtyRects.size(); ++i) {
+            const IntRect& dirtyRect = dirtyRects[i];
+            const int sliceHeight = tickDeadline() ? kPaintSliceHeight : dirtyRect.height();
+
+            for (int y = dirtyRect.y(); y < dirtyRect.bottom(); y += sliceHeight) {
+                // Once the tick's deadline has passed, what is left gets painted on the next tick.
+                if (painted && tickDeadlinePassed()) {
+                    unpaintedRects.append(IntRect(dirtyRect.x(), y, dirtyRect.width(), dirtyRect.bottom() - y));
+                    break;
+                }
+
+                frame->view()->paint(&ctx, IntRect(dirtyRect.x(), y, dirtyRect.width(), std::min(sliceHeight, dirtyRect.bottom() - y)));
+                painted = true;
+            }
+        }
+
         m_webView->clearDirtyRegion();
+        for (size_t i = 0; i < unpaintedRects.size(); ++i)
+            m_webView->addToDirtyRegion(unpaintedRects[i]);
+        if (!unpaintedRects.isEmpty())
+            frame->view()->SetDirty(true);
+
+        // The replay is not bounded by the deadline; what was recorded above has to make it to the surface.
+        displayList.replay();
+        ctx.setDisplayList(0);
     }
 }
 
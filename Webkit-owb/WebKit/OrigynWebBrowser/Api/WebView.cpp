@@ -105,6 +105,8 @@
 #include <SimpleFontData.h>
 #include <TypingCommand.h>
 #include <EAText/EAText.h>
+#include <EARaster/EARaster.h>
+#include <stdlib.h>
 
 #include <collector.h>
 #include <lookup.h>
@@ -653,10 +655,7 @@ void WebView::deleteBackingStore()
         m_deleteBackingStoreTimerActive = false;
     }
     m_backingStoreBitmap.clear();
-    m_backingStoreDirtyRegion.setX(0);
-    m_backingStoreDirtyRegion.setY(0);
-    m_backingStoreDirtyRegion.setWidth(0);
-    m_backingStoreDirtyRegion.setHeight(0);
+    clearDirtyRegion();
 
     m_backingStoreSize.setX(0);
     m_backingStoreSize.setY(0);
@@ -694,36 +693,138 @@ bool WebView::ensureBackingStore()
     return false;
 }
 
+// Max number of disjoint rects tracked in the dirty region before the closest ones get merged.
+static const size_t kMaxDirtyRects = 8;
+
+static inline int dirtyRectArea(const IntRect& rect)
+{
+    return rect.width() * rect.height();
+}
+
+// Returns the extra area that would be painted if the two rects were merged into their union.
+static inline int dirtyRectMergeCost(const IntRect& a, const IntRect& b)
+{
+    IntRect united(a);
+    united.unite(b);
+    IntRect overlap(a);
+    overlap.intersect(b);
+    return dirtyRectArea(united) - (dirtyRectArea(a) + dirtyRectArea(b) - dirtyRectArea(overlap));
+}
+
 void WebView::addToDirtyRegion(const IntRect& dirtyRect)
 {
-    m_backingStoreDirtyRegion.unite(dirtyRect);
+    if (dirtyRect.isEmpty())
+        return;
+
+    IntRect newRect(dirtyRect);
+
+    // Fold in any rect that overlaps the new one or sits close enough that painting them
+    // together wastes less than a quarter of their own area. Merging grows the new rect
+    // so the scan restarts each time to keep the list disjoint.
+    size_t i = 0;
+    while (i < m_backingStoreDirtyRects.size()) {
+        const IntRect& rect = m_backingStoreDirtyRects[i];
+        if (rect.contains(newRect))
+            return;
+
+        const int mergeCost = dirtyRectMergeCost(rect, newRect);
+        if (rect.intersects(newRect) || ((mergeCost * 4) <= (dirtyRectArea(rect) + dirtyRectArea(newRect)))) {
+            newRect.unite(rect);
+            m_backingStoreDirtyRects.remove(i);
+            i = 0;
+        }
+        else
+            ++i;
+    }
+
+    if (m_backingStoreDirtyRects.size() < kMaxDirtyRects) {
+        m_backingStoreDirtyRects.append(newRect);
+        return;
+    }
+
+    // The list is full: merge the new rect with whichever rect wastes the least area.
+    // The union can overlap other rects so it goes back through the merge pass.
+    size_t best = 0;
+    int bestCost = dirtyRectMergeCost(m_backingStoreDirtyRects[0], newRect);
+    for (i = 1; i < m_backingStoreDirtyRects.size(); ++i) {
+        const int cost = dirtyRectMergeCost(m_backingStoreDirtyRects[i], newRect);
+        if (cost < bestCost) {
+            bestCost = cost;
+            best = i;
+        }
+    }
+    newRect.unite(m_backingStoreDirtyRects[best]);
+    m_backingStoreDirtyRects.remove(best);
+    addToDirtyRegion(newRect);
 }
 
+// Returns the bounding box of the dirty region. Use dirtyRects() to get the individual rects.
 IntRect WebView::dirtyRegion()
 {
-    return m_backingStoreDirtyRegion;
+    IntRect bounds;
+    for (size_t i = 0; i < m_backingStoreDirtyRects.size(); ++i)
+        bounds.unite(m_backingStoreDirtyRects[i]);
+    return bounds;
 }
 
 void WebView::clearDirtyRegion()
 {
-    m_backingStoreDirtyRegion.setX(0);
-    m_backingStoreDirtyRegion.setY(0);
-    m_backingStoreDirtyRegion.setWidth(0);
-    m_backingStoreDirtyRegion.setHeight(0);
+    m_backingStoreDirtyRects.clear();
 }
 
+// Scrolls by shifting what is already drawn in the backing store, so that only the strips which
+// scrolled into view need to be painted by WebCore. The caller only comes here when the content
+// can be shifted as-is (no fixed position elements).
 void WebView::scrollBackingStore(FrameView* frameView, int dx, int dy, const IntRect& scrollViewRect, const IntRect& clipRect)
 {
-    /*printf("scrollViewRect dx=%d dy=%d scrollview x=%d y=%d w=%d h=%d clip x=%d y=%d w=%d h=%d\n", dx, dy, scrollViewRect.x(), scrollViewRect.y(), scrollViewRect.width(), scrollViewRect.height(), clipRect.x(), clipRect.y(), clipRect.width(), clipRect.height());
-    
-    IntSize offsetIntSize = m_page->mainFrame()->view()->scrollOffset();
-    //OWB_PRINTF("offsetIntSize w=%d h=%d\n", offsetIntSize.width(), offsetIntSize.height());*/
-    //frameView->scrollBackingStore(dx, dy, scrollViewRect, clipRect);
+    IntRect updateRect = clipRect;
+    updateRect.intersect(scrollViewRect);
+    if (updateRect.isEmpty() || (!dx && !dy))
+        return;
+
+    // If nothing that is drawn stays in view, just repaint it all.
+    if (!m_viewWindow || (abs(dx) >= updateRect.width()) || (abs(dy) >= updateRect.height())) {
+        addToDirtyRegion(updateRect);
+        return;
+    }
+
+    const EA::Raster::Rect scrollRect(updateRect.x(), updateRect.y(), updateRect.width(), updateRect.height());
+    if (EA::Raster::ScrollSurface(m_viewWindow, &scrollRect, dx, dy) != 0) {
+        addToDirtyRegion(updateRect);
+        return;
+    }
+
+    // Dirty rects that are still pending moved along with the content, so the shifted copy needs
+    // a repaint too. The original position stays dirty as well.
+    const Vector<IntRect> dirtyRects(m_backingStoreDirtyRects);
+    for (size_t i = 0; i < dirtyRects.size(); ++i) {
+        IntRect movedRect(dirtyRects[i]);
+        movedRect.intersect(updateRect);
+        movedRect.move(dx, dy);
+        movedRect.intersect(updateRect);
+        addToDirtyRegion(movedRect);
+    }
+
+    // The newly exposed strips.
+    if (dx > 0)
+        addToDirtyRegion(IntRect(updateRect.x(), updateRect.y(), dx, updateRect.height()));
+    else if (dx < 0)
+        addToDirtyRegion(IntRect(updateRect.right() + dx, updateRect.y(), -dx, updateRect.height()));
+
+    if (dy > 0)
+        addToDirtyRegion(IntRect(updateRect.x(), updateRect.y(), updateRect.width(), dy));
+    else if (dy < 0)
+        addToDirtyRegion(IntRect(updateRect.x(), updateRect.bottom() + dy, updateRect.width(), -dy));
+
+    // The shifted pixels changed on the surface so the view needs to hear about them. The strips
+    // get reported when they are painted.
+    if (frameView)
+        frameView->updateView(m_viewWindow, updateRect);
 }
 
 void WebView::updateBackingStore(FrameView* frameView)
 {
-    //frameView->updateBackingStore();
+    // Nothing to do here, as the dirty region gets painted straight into the view surface from onExpose.
 }
 
 void WebView::selectionChanged() 
@@ -279,6 +279,7 @@ public:
     bool ensureBackingStore();
     void addToDirtyRegion(const WebCore::IntRect&);
     WebCore::IntRect dirtyRegion();
+    const Vector<WebCore::IntRect>& dirtyRects() const { return m_backingStoreDirtyRects; }
     void clearDirtyRegion();
     void scrollBackingStore(WebCore::FrameView*, int dx, int dy, const WebCore::IntRect& scrollViewRect, const WebCore::IntRect& clipRect);
     void updateBackingStore(WebCore::FrameView*);
@@ -382,7 +383,9 @@ protected:
     
     OwnPtr<WebCore::Image> m_backingStoreBitmap;
     WebCore::IntPoint m_backingStoreSize;
-    WebCore::IntRect m_backingStoreDirtyRegion;
+    // The dirty region is kept as a short list of disjoint rects so that small updates in
+    // opposite corners of the view don't get merged into a near full view repaint.
+    Vector<WebCore::IntRect> m_backingStoreDirtyRects;
 
     DefaultPolicyDelegate* m_policyDelegate;
     DefaultDownloadDelegate* m_downloadDelegate;
@@ -54,6 +54,7 @@ namespace EA
         // Forward declarations
         class Surface;
         class Color;
+        class ClipRegion;
 
 
         // Typedefs
@@ -79,7 +80,10 @@ namespace EA
             kPixelFormatTypeRGBA,       // 32 bit 0xRRGGBBAA, byte order in memory depends on endian-ness. For little endian it is A, B, G, R; for big endian it is R, G, B, A. 
             kPixelFornatTypeXRGB,       // 32 bit 0xXXRRGGBB, byte order in memory depends on endian-ness. The X means the data is unused or can be considered to be always 0xff.
             kPixelFormatTypeRGBX,       // 32 bit 0xRRGGBBXX, byte order in memory depends on endian-ness. The X means the data is unused or can be considered to be always 0xff.
-            kPixelFormatTypeRGB         // 24 bit 0xRRGGBB, byte order in memory is always R, G, B.
+            kPixelFormatTypeRGB,        // 24 bit 0xRRGGBB, byte order in memory is always R, G, B.
+            kPixelFormatTypeRGB565,     // 16 bit 0bRRRRRGGGGGGBBBBB, stored as a native endian uint16_t.
+            kPixelFormatTypeARGB4444,   // 16 bit 0xARGB, stored as a native endian uint16_t. As with ARGB, the color isn't premultiplied by the alpha.
+            kPixelFormatTypePARGB       // 32 bit 0xAARRGGBB like ARGB, but with the color premultiplied by the alpha. This is the format of decoded images. It is meant as a blit source; the primitives don't draw into it.
         };
 
 
@@ -108,7 +112,9 @@ namespace EA
             kFlagIgnoreCompressRLE         = 0x08, // This image did not compress so ignore it for compression -CS Added 1/ 15/09
             kFlagIgnoreCompressYCOCGDXT5   = 0x10, // This image did not compress so ignore it for duplicate compression
             kFlagCompressedRLE             = 0x20, // Set when image was compressed using RLE
-            kFlagCompressedYCOCGDXT5       = 0x40  // Set when image was compressed using RLE
+            kFlagCompressedYCOCGDXT5       = 0x40, // Set when image was compressed using RLE
+            kFlagPooled                    = 0x80, // The surface came from AcquirePooledSurface and goes back with ReleasePooledSurface.
+            kFlagAccumulateAlpha           = 0x100 // Blends into this ARGB surface build up its alpha as source-over does instead of keeping the dest alpha. For surfaces that are later blended as a whole, such as transparency layers.
         };
 
 
@@ -126,6 +132,7 @@ namespace EA
             int      mnDHeight;
             int      mnDSkip;
             bool     mDoAdditiveBlend; // If true, will do additive alpha blending instead of normal alpha blending
+            int      mnOpacity;     // 0-255. The source alpha is multiplied by this. Only the opacity blit functions use it.
         };
 
         typedef void (*BlitFunctionType)(const BlitInfo& blitInfo);
@@ -133,7 +140,8 @@ namespace EA
 
         enum DrawFlags
         {
-            kDrawFlagIdenticalFormats = 0x01    // The source and dest surfaces of a surface to surface operation are of identical format.
+            kDrawFlagIdenticalFormats = 0x01,   // The source and dest surfaces of a surface to surface operation are of identical format.
+            kDrawFlagAccumulateAlpha  = 0x02    // The blit function was set up for a dest with kFlagAccumulateAlpha.
         };
 
         struct Point
@@ -210,6 +218,19 @@ namespace EA
         EARASTER_API void EARectToIntRect(const EA::Raster::Rect& in, WKAL::IntRect& out);
 
 
+        // AlphaRow
+        //
+        // Where a row of a surface with an alpha channel is opaque, for Surface::mpAlphaRows. 
+        // Blits without opacity copy the opaque run instead of blending it and skip transparent rows.
+        //
+        struct AlphaRow
+        {
+            int  mOpaqueBegin;      // The widest run of opaque pixels in the row, which covers x from mOpaqueBegin
+            int  mOpaqueEnd;        // up to but not including mOpaqueEnd. They are equal if there is none.
+            bool mbTransparent;     // Every pixel of the row has an alpha of 0.
+        };
+
+
         // Surface
         //
         // This class implements a single rectangular 2D pixel surface. 
@@ -230,6 +251,7 @@ namespace EA
             bool Resize(int width, int height, bool bCopyData);
             void FreeData();
             void SetClipRect(const Rect* pRect);
+            bool SetAlphaRows(const AlphaRow* pRows);   // Copies mHeight rows, or removes them if pRows is NULL. The pixel data mustn't change while they are set.
 
         protected:
             void InitMembers();
@@ -250,6 +272,9 @@ namespace EA
             Surface*            mpBlitDest;     // The last surface blitted to. Allows us to cache blit calculations.
             int                 mDrawFlags;     // See enum DrawFlags.
             BlitFunctionType    mpBlitFunction; // The blitting function currently used to blit to mpBlitDest.
+            // Members added since go from here on, so that the ones above keep their offsets.
+            ClipRegion*         mpClipRegion;   // If set, fills and blits are further restricted to this region. Not owned.
+            AlphaRow*           mpAlphaRows;    // If set, mHeight rows telling blits where the surface is opaque. Freed with the pixel data.
         };
 
 
@@ -275,6 +300,32 @@ namespace EA
         EARASTER_API Surface*    CreateSurface(void* pData, int width, int height, int stride, PixelFormatType pft, bool bCopyData, bool bTakeOwnership);
         EARASTER_API void        DestroySurface(Surface* pSurface);
 
+        // Scratch surfaces
+        // For temporaries that only live for a draw, such as transparency layers and decompressed images.
+        // Released surfaces are kept for reuse in size classes that round each dimension up by less than 
+        // a quarter, so a pooled buffer also serves slightly smaller requests. An acquired surface is laid 
+        // out like one from CreateSurface, but its pixels are undefined. A surface that is still referenced 
+        // elsewhere when released (e.g. recorded in a display list) isn't pooled but freed with its last reference.
+        // None of this is thread-safe.
+        struct SurfacePoolStats
+        {
+            int      mInUseCount;       // Surfaces acquired and not released yet.
+            int      mPooledCount;      // Surfaces kept for reuse.
+            uint32_t mInUseSize;        // In bytes.
+            uint32_t mPooledSize;       // In bytes.
+            uint32_t mHighWaterSize;    // In bytes. The largest mInUseSize + mPooledSize seen since the last ResetSurfacePoolHighWater.
+            uint32_t mAcquireCount;     // Number of AcquirePooledSurface calls.
+            uint32_t mReuseCount;       // Number of those that were served from the pool.
+        };
+
+        EARASTER_API Surface*    AcquirePooledSurface(int width, int height, PixelFormatType pft);
+        EARASTER_API void        ReleasePooledSurface(Surface* pSurface);
+        EARASTER_API void        SetSurfacePoolCapacity(uint32_t size);    // In bytes. Defaults to 4 MB. 0 disables pooling.
+        EARASTER_API uint32_t    GetSurfacePoolCapacity();
+        EARASTER_API void        TrimSurfacePool(uint32_t size);           // Frees the least recently released surfaces until at most size bytes are pooled.
+        EARASTER_API void        GetSurfacePoolStats(SurfacePoolStats& stats);
+        EARASTER_API void        ResetSurfacePoolHighWater();
+
         // Color conversion
         EARASTER_API void        ConvertColor(NativeColor c, PixelFormatType cFormat, Color& result);
         EARASTER_API void        ConvertColor(int r, int g, int b, int a, Color& result);
@@ -352,11 +403,188 @@ namespace EA
         EARASTER_API int   FilledPolygonColor  (Surface* pSurface, const int* vx, const int* vy, int n, const Color& color);
         EARASTER_API int   FilledPolygonRGBA   (Surface* pSurface, const int* vx, const int* vy, int n, int r, int g, int b, int a);
         EARASTER_API int   TexturedPolygon     (Surface* pSurface, const int* vx, const int* vy, int n, Surface* pTexture,int texture_dx,int texture_dy);
+        // The filled polygons go through RasterizePath and are safe to use from any thread. The polyInts and
+        // polyAllocated parameters of the MT versions are no longer used and are only kept for compatibility.
         EARASTER_API int   FilledPolygonColorMT(Surface* pSurface, const int* vx, const int* vy, int n, const Color& color, int** polyInts, int* polyAllocated);
         EARASTER_API int   FilledPolygonRGBAMT (Surface* pSurface, const int* vx, const int* vy, int n, int r, int g, int b, int a, int** polyInts, int* polyAllocated);
         EARASTER_API int   TexturedPolygonMT   (Surface* pSurface, const int* vx, const int* vy, int n, Surface* pTexture, int texture_dx, int texture_dy, int** polyInts, int* polyAllocated);
 
 
+        ///////////////////////////////////////////////////////////////////////
+        // Path rasterization
+        ///////////////////////////////////////////////////////////////////////
+
+        // A path is passed as one or more contours of float points, each of which implicitly closes 
+        // back to its first point. Curves need to be flattened into lines by the caller.
+        // Pixel (x, y) covers the area from (x, y) to (x + 1, y + 1), so its center is at (x + 0.5, y + 0.5).
+
+        enum FillRule
+        {
+            kFillRuleNonZero,
+            kFillRuleEvenOdd
+        };
+
+        struct PointF
+        {
+            float x;
+            float y;
+
+            PointF() : x(0.f), y(0.f) {}
+            PointF(float xNew, float yNew) : x(xNew), y(yNew) {}
+        };
+
+        // Receives the covered spans of a path, row by row and left to right.
+        // pCoverage has length coverage values (0-255), or is NULL if the span is fully covered.
+        typedef void (*SpanFunction)(void* pContext, int x, int y, int length, const uint8_t* pCoverage);
+
+        // Scratch memory for RasterizePath. The rasterizer has no state of its own, so it can run on 
+        // several threads at once as long as each uses its own scratch. Keeping one around between 
+        // calls saves reallocating the buffers every time.
+        class EARASTER_API RasterScratch
+        {
+        public:
+            RasterScratch();
+           ~RasterScratch();
+
+            void Reset();   // Frees the buffers.
+
+            struct Edge;    // Defined in EARasterPath.cpp.
+
+            Edge*    mpEdges;
+            Edge**   mpActiveEdges;
+            int      mEdgeCapacity;
+            float*   mpCells;       // Coverage accumulation for one row; kept zeroed between uses.
+            uint8_t* mpCoverage;
+            int      mCellCapacity;
+
+        private:
+            RasterScratch(const RasterScratch&);
+            RasterScratch& operator=(const RasterScratch&);
+        };
+
+        // Scan converts the contours and calls pSpanFunction with the covered spans within clipRect.
+        // With bAntialias the coverage is the exact area of each pixel that is inside the path; 
+        // without it a pixel is fully in or out depending on its center.
+        // If pScratch is NULL, a temporary scratch is used.
+        // Returns 0 if OK or -1 if the scratch memory could not be allocated.
+        EARASTER_API int RasterizePath(const PointF* pPoints, const int* pContourSizes, int contourCount, FillRule fillRule, bool bAntialias, 
+                                       const Rect& clipRect, SpanFunction pSpanFunction, void* pContext, RasterScratch* pScratch = NULL);
+
+        // Fills the contours with color, blended by coverage, clipped to the surface's clip rect.
+        // Returns 0 if OK or a negative error code.
+        EARASTER_API int FillPathColor(Surface* pSurface, const PointF* pPoints, const int* pContourSizes, int contourCount, const Color& color, 
+                                       FillRule fillRule = kFillRuleNonZero, bool bAntialias = true, RasterScratch* pScratch = NULL);
+
+
+        ///////////////////////////////////////////////////////////////////////
+        // Clipping
+        ///////////////////////////////////////////////////////////////////////
+
+        // A clip shape that is more than a rect, for Surface::mpClipRegion. 
+        // While all of its edges are on pixel boundaries it is kept as a list of spans for each row, 
+        // with runs of identical rows sharing their spans. Clipping to anti-aliased shapes turns 
+        // it into a coverage mask over its bounds, which goes back to spans if the result allows it.
+        // A region is reference counted and shouldn't be changed once a surface uses it, as display 
+        // lists hold on to it until they are replayed; clipping further is done on a copy.
+        class EARASTER_API ClipRegion
+        {
+        public:
+            struct Span { int mX1, mX2; };                  // Covers x from mX1 up to but not including mX2.
+            struct Row  { int mFirstSpan, mSpanCount; };    // The spans of a row, in mpSpans.
+
+            // Receives the parts of a rect that are inside the region, with their coverage (1-255).
+            typedef void (*RectFunction)(void* pContext, const Rect& rect, int coverage);
+
+            ClipRegion(const Rect& rect);
+            ClipRegion(const ClipRegion& region);
+           ~ClipRegion();
+
+            int  AddRef();
+            int  Release();
+
+            const Rect& GetBounds() const { return mBounds; }
+            bool IsEmpty() const { return (mBounds.w <= 0) || (mBounds.h <= 0); }
+            bool IsMask() const { return mpCoverage != NULL; }
+
+            void ClipToRect(const Rect& rect);
+            void ClipOutRect(const Rect& rect);
+            int  ClipToPath(const PointF* pPoints, const int* pContourSizes, int contourCount, FillRule fillRule, bool bAntialias, RasterScratch* pScratch = NULL);
+            int  ClipOutPath(const PointF* pPoints, const int* pContourSizes, int contourCount, FillRule fillRule, bool bAntialias, RasterScratch* pScratch = NULL);
+            void ClipToMask(const uint8_t* pMask, int maskWidth, int maskHeight, int maskStride, int x, int y);
+
+            // Calls pRectFunction with the parts of rect inside the region: bands of rows with the same spans, 
+            // or runs of pixels with the same coverage within each row for a mask.
+            void ForEachRect(const Rect& rect, RectFunction pRectFunction, void* pContext) const;
+
+            // Calls pSpanFunction with the parts of the span inside the region, with the coverage combined.
+            void ClipSpan(int x, int y, int length, const uint8_t* pCoverage, SpanFunction pSpanFunction, void* pContext) const;
+
+            // For clipping RasterizePath output: pass ClipSpanFunction as the span function and a SpanClipper as its context.
+            struct SpanClipper { const ClipRegion* mpClipRegion; SpanFunction mpSpanFunction; void* mpContext; };
+            static void ClipSpanFunction(void* pSpanClipper, int x, int y, int length, const uint8_t* pCoverage);
+
+        protected:
+            int  ClipToPathInternal(const PointF* pPoints, const int* pContourSizes, int contourCount, FillRule fillRule, bool bAntialias, bool bOutside, RasterScratch* pScratch);
+            void GetRowCoverage(int y, int x, int length, uint8_t* pCoverage) const;
+            void SetSpans(const Row* pRows, int rowCount, const Span* pSpans, int spanCount, int y);
+            void SetCoverage(uint8_t* pCoverage, const Rect& bounds);
+            void FreeData();
+
+            Rect        mBounds;        // Nothing outside of this is in the region.
+            int         mRefCount;      // CreateClipRegion returns a region with a mRefCount of 1.
+            Row*        mpRows;         // mBounds.h rows, while the region is spans.
+            Span*       mpSpans;
+            int         mSpanCount;
+            uint8_t*    mpCoverage;     // mBounds.w x mBounds.h coverage values, once the region is a mask.
+
+        private:
+            ClipRegion& operator=(const ClipRegion&);
+        };
+
+        // These return a region with a reference count of 1, to be released with ClipRegion::Release.
+        EARASTER_API ClipRegion* CreateClipRegion(const Rect& rect);
+        EARASTER_API ClipRegion* CreateClipRegion(const ClipRegion& region);
+
+
+        ///////////////////////////////////////////////////////////////////////
+        // Gradients
+        ///////////////////////////////////////////////////////////////////////
+
+        // A gradient is drawn by mapping each pixel center to an offset from 0 to 1 and looking 
+        // the color up in a ramp of kGradientRampSize ARGB colors, sampled evenly over that range.
+        // Offsets before 0 and after 1 use the first and last colors.
+
+        const int kGradientRampSize = 256;
+
+        enum GradientType
+        {
+            kGradientTypeLinear,    // The offset goes from 0 at mP0 to 1 at mP1, along the line between them.
+            kGradientTypeRadial     // The offset goes from 0 on the circle (mP0, mR0) to 1 on the circle (mP1, mR1).
+        };
+
+        struct GradientFill
+        {
+            GradientType    mType;
+            PointF          mP0;
+            PointF          mP1;
+            float           mR0;
+            float           mR1;
+            const uint32_t* mpRamp;     // kGradientRampSize 0xAARRGGBB colors. Not owned.
+            int             mOpacity;   // 0-255, multiplied into the ramp alpha.
+
+            GradientFill() : mType(kGradientTypeLinear), mR0(0.f), mR1(0.f), mpRamp(NULL), mOpacity(255) {}
+        };
+
+        // Writes the colors of length pixels of the gradient, starting at pixel (x, y). 
+        // Pixels the gradient doesn't cover, as outside of a radial gradient's cone, get 0.
+        EARASTER_API void GenerateGradientSpan(const GradientFill& gradient, int x, int y, int length, uint32_t* pColors);
+
+        // Fills the contours with the gradient, blended by coverage, clipped to the surface's clip rect.
+        // Returns 0 if OK or a negative error code.
+        EARASTER_API int FillPathGradient(Surface* pSurface, const PointF* pPoints, const int* pContourSizes, int contourCount, const GradientFill& gradient, 
+                                          FillRule fillRule = kFillRuleNonZero, bool bAntialias = true, RasterScratch* pScratch = NULL);
+
+
         ///////////////////////////////////////////////////////////////////////
         // Resampling
         ///////////////////////////////////////////////////////////////////////
@@ -400,13 +628,32 @@ namespace EA
         // If pDestClipRect is non-NULL, the output is further clipped to pDestClipRect.
         // pDestClipRect is not quite the same as pRectDest, as it's sometimes 
         // useful to blit a source rect to a dest rect but have it clip to another rect.
+        // If opacity is less than 255, the source alpha is multiplied by opacity / 255 as it is 
+        // blitted. This is the same as blitting the result of CreateTransparentSurface, without the copy.
         // Returns 0 if OK or a negative error code.
-        EARASTER_API int Blit(Surface* pSource, const Rect* pRectSource, Surface* pDest, const Rect* pRectDest, const Rect* pDestClipRect = NULL, const bool additiveBlend = false);
+        EARASTER_API int Blit(Surface* pSource, const Rect* pRectSource, Surface* pDest, const Rect* pRectDest, const Rect* pDestClipRect = NULL, const bool additiveBlend = false, int opacity = 255);
 
         // Does a 1:1 blit from pSource to pDest with the assumption that pRectSource and 
         // pRectDest are already clipped to pSource and pDest, respectively.
         // Returns 0 if OK or a negative error code.
-        EARASTER_API int BlitNoClip(Surface* pSource, const Rect* pRectSource, Surface* pDest, const Rect* pRectDest, const bool additiveBlend = false);
+        EARASTER_API int BlitNoClip(Surface* pSource, const Rect* pRectSource, Surface* pDest, const Rect* pRectDest, const bool additiveBlend = false, int opacity = 255);
+
+        enum ScaleFilter
+        {
+            kScaleFilterNearest,    // Each dest pixel takes the source pixel under its center.
+            kScaleFilterBilinear,   // Interpolates the 4 source pixels around the center. Downscales of more than 2x use kScaleFilterBox.
+            kScaleFilterBox         // Averages the source pixels under each dest pixel.
+        };
+
+        // Blits pRectSource in pSource stretched to pRectDest in pDest, resampling straight into the 
+        // dest without an intermediate surface and without allocating. pRectSource must be within pSource 
+        // and the source must be 32 bit. Clipping, blending and opacity work as with Blit, which this 
+        // calls if the rects are the same size. Returns 0 if OK or a negative error code.
+        EARASTER_API int BlitScaled(Surface* pSource, const Rect* pRectSource, Surface* pDest, const Rect* pRectDest, const Rect* pDestClipRect = NULL, 
+                                    ScaleFilter filter = kScaleFilterBilinear, const bool additiveBlend = false, int opacity = 255);
+
+        // Creates a width x height copy of pSource, resampled as BlitScaled does. The source must be 32 bit.
+        EARASTER_API Surface* CreateScaledSurface(Surface* pSource, int width, int height, ScaleFilter filter);
 
         //////////////////////////////////////////////////////////////////////////
         /// Blit a repeating pattern.
@@ -447,6 +694,40 @@ namespace EA
         ///       of the dividing line between left edge and center.)
         EARASTER_API int BlitEdgeTiled(Surface* pSource, const Rect* pRectSource, Surface* pDest, const Rect* pRectDest, const Rect* pRectSourceCenter);
 
+        // Shifts the contents of pRect within pSurface by dx/dy pixels in place, as is needed 
+        // when scrolling a view. Pixels shifted outside of pRect are lost and the exposed strips 
+        // are left as-is for the caller to repaint. If pRect is NULL, the entire surface is used.
+        // The copy is overlap safe and ignores alpha blending.
+        // Returns 0 if OK or a negative error code.
+        EARASTER_API int ScrollSurface(Surface* pSurface, const Rect* pRect, int dx, int dy);
+
+        // Blends color into pDest through an 8 bit coverage mask, such as a glyph in the glyph cache texture. 
+        // Each dest pixel gets blended with an alpha of color.alpha() * coverage * opacity (each scaled to [0,1]).
+        // x and y are where the top-left of the mask goes in pDest. The blend is clipped to pDest's clip rect.
+        // This avoids building an ARGB copy of the mask just to blit it.
+        // Returns 0 if OK or a negative error code.
+        EARASTER_API int BlitMaskA8(const uint8_t* pMask, int maskWidth, int maskHeight, int maskStride, Surface* pDest, int x, int y, const Color& color, int opacity = 255);
+
+        // Blends count 0xAARRGGBB colors into the row at x, y of a 16 bit (RGB565 or ARGB4444) surface. pColors advances 
+        // by colorStep per pixel, so a step of 0 blends a single color. Each color's alpha is multiplied by opacity, and by 
+        // the matching pCoverage value if pCoverage isn't NULL. With bDither the colors are ordered dithered down to the 
+        // 16 bit format, which hides the banding of gradients and images. There is no clipping; the row must be within the surface.
+        EARASTER_API void BlendRow16(Surface* pSurface, int x, int y, int count, const uint32_t* pColors, int colorStep, const uint8_t* pCoverage, int opacity, bool bDither);
+
+        // Same as BlendRow16, but for an ARGB surface with kFlagAccumulateAlpha. The dest alpha builds up as 
+        // a + dA * (1 - a) and the colors are weighted to match, so the row ends up as if it had been 
+        // drawn over whatever the surface is later blended onto.
+        EARASTER_API void BlendRowAccumulateAlpha(Surface* pSurface, int x, int y, int count, const uint32_t* pColors, int colorStep, const uint8_t* pCoverage, int opacity);
+
+        // Blurs an 8 bit coverage mask in place, as is done for shadows. The blur is three box blurs in 
+        // each direction, which is close to a Gaussian blur with a standard deviation of radius / 2.
+        // The coverage spreads by GetBlurExtent(radius) pixels each way, so the mask needs that much 
+        // empty space around what is drawn in it.
+        EARASTER_API void BlurMaskA8(uint8_t* pMask, int width, int height, int stride, int radius);
+
+        // Returns how many pixels BlurMaskA8 spreads coverage by on each side for the given radius.
+        EARASTER_API int GetBlurExtent(int radius);
+
         // Sets up the blit function needed to blit pSource to pDest.
         // Normally you don't need to call this function, as the Surface class and Blit 
         // functions will do it automatically.
@@ -672,6 +953,90 @@ namespace EA
 			virtual RGBA32 makeRGB(int32_t r, int32_t g, int32_t b) = 0;
 			virtual RGBA32 makeRGBA(int32_t r, int32_t g, int32_t b, int32_t a) = 0;
 
+
+			///////////////////////////////////////////////////////////////////////
+			// Functions added since
+			///////////////////////////////////////////////////////////////////////
+
+			// These are declared from here on, so that the slots above stay where applications 
+			// built against earlier versions of this interface expect them.
+
+			// Shifts the contents of pRect within pSurface by dx/dy pixels in place, as is needed 
+			// when scrolling a view. Pixels shifted outside of pRect are lost and the exposed strips 
+			// are left as-is for the caller to repaint. If pRect is NULL, the entire surface is used.
+			// The copy is overlap safe and ignores alpha blending.
+			// Returns 0 if OK or a negative error code.
+			virtual int ScrollSurface(Surface* pSurface, const Rect* pRect, int dx, int dy) = 0;
+
+			// Same as Blit and BlitNoClip, but the source alpha is multiplied by opacity / 255 as it is blitted.
+			// This is the same as blitting the result of CreateTransparentSurface, without the copy.
+			// They aren't overloads of Blit and BlitNoClip, as some compilers put overloaded virtual 
+			// functions next to each other in the vtable, wherever they are declared.
+			virtual int BlitWithOpacity(Surface* pSource, const Rect* pRectSource, Surface* pDest, const Rect* pRectDest, const Rect* pDestClipRect, const bool additiveBlend, int opacity) = 0;
+			virtual int BlitNoClipWithOpacity(Surface* pSource, const Rect* pRectSource, Surface* pDest, const Rect* pRectDest, const bool additiveBlend, int opacity) = 0;
+
+			// Blends color into pDest through an 8 bit coverage mask, such as a glyph in the glyph cache texture. 
+			// Each dest pixel gets blended with an alpha of color.alpha() * coverage * opacity (each scaled to [0,1]).
+			// x and y are where the top-left of the mask goes in pDest. The blend is clipped to pDest's clip rect.
+			// This avoids building an ARGB copy of the mask just to blit it.
+			// Returns 0 if OK or a negative error code.
+			virtual int BlitMaskA8(const uint8_t* pMask, int maskWidth, int maskHeight, int maskStride, Surface* pDest, int x, int y, const Color& color, int opacity = 255) = 0;
+
+			// Path rasterization
+			virtual int   RasterizePath(const PointF* pPoints, const int* pContourSizes, int contourCount, FillRule fillRule, bool bAntialias, const Rect& clipRect, SpanFunction pSpanFunction, void* pContext, RasterScratch* pScratch = NULL) = 0;
+			virtual int   FillPathColor(Surface* pSurface, const PointF* pPoints, const int* pContourSizes, int contourCount, const Color& color, FillRule fillRule = kFillRuleNonZero, bool bAntialias = true, RasterScratch* pScratch = NULL) = 0;
+
+			// Gradients
+			virtual void  GenerateGradientSpan(const GradientFill& gradient, int x, int y, int length, uint32_t* pColors) = 0;
+			virtual int   FillPathGradient(Surface* pSurface, const PointF* pPoints, const int* pContourSizes, int contourCount, const GradientFill& gradient, FillRule fillRule = kFillRuleNonZero, bool bAntialias = true, RasterScratch* pScratch = NULL) = 0;
+
+			// Clipping
+			virtual ClipRegion* CreateClipRegion(const Rect& rect) = 0;
+			virtual ClipRegion* CreateClipRegion(const ClipRegion& region) = 0;
+
+			// Blurs an 8 bit coverage mask in place, as is done for shadows. The blur is three box blurs in 
+			// each direction, which is close to a Gaussian blur with a standard deviation of radius / 2.
+			// The coverage spreads by GetBlurExtent(radius) pixels each way, so the mask needs that much 
+			// empty space around what is drawn in it.
+			virtual void BlurMaskA8(uint8_t* pMask, int width, int height, int stride, int radius) = 0;
+
+			// Returns how many pixels BlurMaskA8 spreads coverage by on each side for the given radius.
+			virtual int GetBlurExtent(int radius) = 0;
+
+			// Scratch surfaces
+			// For temporaries that only live for a draw, such as transparency layers and decompressed images.
+			// Released surfaces are kept for reuse in size classes that round each dimension up by less than 
+			// a quarter, so a pooled buffer also serves slightly smaller requests. An acquired surface is laid 
+			// out like one from CreateSurface, but its pixels are undefined. A surface that is still referenced 
+			// elsewhere when released (e.g. recorded in a display list) isn't pooled but freed with its last reference.
+			// None of this is thread-safe.
+			virtual Surface*    AcquirePooledSurface(int width, int height, PixelFormatType pft) = 0;
+			virtual void        ReleasePooledSurface(Surface* pSurface) = 0;
+			virtual void        SetSurfacePoolCapacity(uint32_t size) = 0;    // In bytes. Defaults to 4 MB. 0 disables pooling.
+			virtual uint32_t    GetSurfacePoolCapacity() = 0;
+			virtual void        TrimSurfacePool(uint32_t size) = 0;           // Frees the least recently released surfaces until at most size bytes are pooled.
+			virtual void        GetSurfacePoolStats(SurfacePoolStats& stats) = 0;
+			virtual void        ResetSurfacePoolHighWater() = 0;
+
+			// Blits pRectSource in pSource stretched to pRectDest in pDest, resampling straight into the 
+			// dest without an intermediate surface and without allocating. pRectSource must be within pSource 
+			// and the source must be 32 bit. Clipping, blending and opacity work as with BlitWithOpacity, 
+			// which this calls if the rects are the same size. Returns 0 if OK or a negative error code.
+			virtual int BlitScaled(Surface* pSource, const Rect* pRectSource, Surface* pDest, const Rect* pRectDest, const Rect* pDestClipRect = NULL, 
+								   ScaleFilter filter = kScaleFilterBilinear, const bool additiveBlend = false, int opacity = 255) = 0;
+
+			// Creates a width x height copy of pSource, resampled as BlitScaled does. The source must be 32 bit.
+			virtual Surface* CreateScaledSurface(Surface* pSource, int width, int height, ScaleFilter filter) = 0;
+
+			// Blends count 0xAARRGGBB colors into the row at x, y of a 16 bit (RGB565 or ARGB4444) surface. pColors advances 
+			// by colorStep per pixel, so a step of 0 blends a single color. Each color's alpha is multiplied by opacity, and by 
+			// the matching pCoverage value if pCoverage isn't NULL. With bDither the colors are ordered dithered down to the 
+			// 16 bit format, which hides the banding of gradients and images. There is no clipping; the row must be within the surface.
+			virtual void BlendRow16(Surface* pSurface, int x, int y, int count, const uint32_t* pColors, int colorStep, const uint8_t* pCoverage, int opacity, bool bDither) = 0;
+
+			// Same as BlendRow16, but for an ARGB surface with kFlagAccumulateAlpha, whose alpha builds up as source-over does.
+			virtual void BlendRowAccumulateAlpha(Surface* pSurface, int x, int y, int count, const uint32_t* pColors, int colorStep, const uint8_t* pCoverage, int opacity) = 0;
+
 		};
 
 
@@ -789,6 +1154,32 @@ namespace EA
 			virtual RGBA32 makeRGB(int32_t r, int32_t g, int32_t b);
 			virtual RGBA32 makeRGBA(int32_t r, int32_t g, int32_t b, int32_t a);
 
+			// Functions added since, in the order IEARaster declares them.
+			virtual int ScrollSurface(Surface* pSurface, const Rect* pRect, int dx, int dy);
+			virtual int BlitWithOpacity(Surface* pSource, const Rect* pRectSource, Surface* pDest, const Rect* pRectDest, const Rect* pDestClipRect, const bool additiveBlend, int opacity);
+			virtual int BlitNoClipWithOpacity(Surface* pSource, const Rect* pRectSource, Surface* pDest, const Rect* pRectDest, const bool additiveBlend, int opacity);
+			virtual int BlitMaskA8(const uint8_t* pMask, int maskWidth, int maskHeight, int maskStride, Surface* pDest, int x, int y, const Color& color, int opacity = 255);
+			virtual int   RasterizePath(const PointF* pPoints, const int* pContourSizes, int contourCount, FillRule fillRule, bool bAntialias, const Rect& clipRect, SpanFunction pSpanFunction, void* pContext, RasterScratch* pScratch = NULL);
+			virtual int   FillPathColor(Surface* pSurface, const PointF* pPoints, const int* pContourSizes, int contourCount, const Color& color, FillRule fillRule = kFillRuleNonZero, bool bAntialias = true, RasterScratch* pScratch = NULL);
+			virtual void  GenerateGradientSpan(const GradientFill& gradient, int x, int y, int length, uint32_t* pColors);
+			virtual int   FillPathGradient(Surface* pSurface, const PointF* pPoints, const int* pContourSizes, int contourCount, const GradientFill& gradient, FillRule fillRule = kFillRuleNonZero, bool bAntialias = true, RasterScratch* pScratch = NULL);
+			virtual ClipRegion* CreateClipRegion(const Rect& rect);
+			virtual ClipRegion* CreateClipRegion(const ClipRegion& region);
+			virtual void BlurMaskA8(uint8_t* pMask, int width, int height, int stride, int radius);
+			virtual int GetBlurExtent(int radius);
+			virtual Surface*    AcquirePooledSurface(int width, int height, PixelFormatType pft);
+			virtual void        ReleasePooledSurface(Surface* pSurface);
+			virtual void        SetSurfacePoolCapacity(uint32_t size);
+			virtual uint32_t    GetSurfacePoolCapacity();
+			virtual void        TrimSurfacePool(uint32_t size);
+			virtual void        GetSurfacePoolStats(SurfacePoolStats& stats);
+			virtual void        ResetSurfacePoolHighWater();
+			virtual int BlitScaled(Surface* pSource, const Rect* pRectSource, Surface* pDest, const Rect* pRectDest, const Rect* pDestClipRect = NULL, 
+								   ScaleFilter filter = kScaleFilterBilinear, const bool additiveBlend = false, int opacity = 255);
+			virtual Surface* CreateScaledSurface(Surface* pSource, int width, int height, ScaleFilter filter);
+			virtual void BlendRow16(Surface* pSurface, int x, int y, int count, const uint32_t* pColors, int colorStep, const uint8_t* pCoverage, int opacity, bool bDither);
+			virtual void BlendRowAccumulateAlpha(Surface* pSurface, int x, int y, int count, const uint32_t* pColors, int colorStep, const uint8_t* pCoverage, int opacity);
+
 		};
 
 
@@ -132,6 +132,24 @@ namespace EA
 
 			}
 		};
+
+		// Budgets for caches beyond the RAM cache. They are kept out of RAMCacheInfo, as applications built 
+		// against earlier versions of it pass a struct that ends at mRAMCacheMaxUsedSize.
+		struct RAMCacheBudgets
+		{
+            uint32_t     mScaledImageCacheSize; // In bytes. Budget for scaled copies of images drawn at other than their natural size. 0 disables it.
+            uint32_t     mUnpackedImageCacheSize; // In bytes. Budget for decompressed copies of compressed images. The last drawn image is always kept.
+            uint32_t     mSurfacePoolSize;      // In bytes. Budget for idle scratch surfaces (transparency layers, decompressed images) kept for reuse.
+            uint32_t     mDecodedImageCacheSize; // In bytes. Budget for the decoded pixels of images in use by pages. Images away from the viewport, or in hidden views, are dropped first and decoded again when drawn. 0, the default, disables it.
+
+			RAMCacheBudgets()
+				: mScaledImageCacheSize(2 * 1024 * 1024)
+				, mUnpackedImageCacheSize(1024 * 1024)
+				, mSurfacePoolSize(4 * 1024 * 1024)
+				, mDecodedImageCacheSize(0)
+			{
+			}
+		};
  
 		struct DiskCacheInfo
         {
@@ -156,6 +174,8 @@ namespace EA
 
         EAWEBKIT_API void SetRAMCacheUsage(const RAMCacheInfo& ramCacheInfo);
 		EAWEBKIT_API void GetRAMCacheUsage(RAMCacheInfo& ramCacheInfo);
+		EAWEBKIT_API void SetRAMCacheBudgets(const RAMCacheBudgets& ramCacheBudgets);
+		EAWEBKIT_API void GetRAMCacheBudgets(RAMCacheBudgets& ramCacheBudgets);
 		EAWEBKIT_API bool SetDiskCacheUsage(const DiskCacheInfo& diskCacheInfo); //Returns a bool that Indicates if Cache directory is successfully created.
 		EAWEBKIT_API void GetDiskCacheUsage(DiskCacheInfo& ramCacheInfo);
 		EAWEBKIT_API void PurgeCache(bool bPurgeRAMCache, bool bPurgeFontCache, bool bPurgeDiskCache);
@@ -244,6 +264,28 @@ namespace EA
 		typedef double (*EAWebKitTimerCallback)();
 		EAWEBKIT_API void SetHighResolutionTimer(EAWebKitTimerCallback timer); //A resolution of at least milliseconds is expected.
 
+		//EAWebKit itself does not create threads. If the application installs a raster job dispatcher, view painting
+		//is recorded and then rasterized in screen tiles that are handed to the dispatcher as independent jobs.
+		//The dispatcher is expected to run pJob(pContext, i) for every i in [0, jobCount) on any threads it likes,
+		//and must return only after all the jobs have completed. The jobs only touch the view surface.
+		//Without a dispatcher (the default), painting rasterizes immediately on the calling thread.
+		//Note that profiling process notifications (kVProcessTypeDrawRaster etc.) can then come from the worker threads.
+		typedef void (*EAWebKitRasterJobFunction)(void* pContext, int jobIndex);
+		typedef void (*EAWebKitRasterJobDispatcher)(EAWebKitRasterJobFunction pJob, void* pContext, int jobCount);
+		EAWEBKIT_API void SetRasterJobDispatcher(EAWebKitRasterJobDispatcher dispatcher);
+		EAWEBKIT_API EAWebKitRasterJobDispatcher GetRasterJobDispatcher();
+
+		//If the application installs an image decode dispatcher, large images that have finished loading are decoded
+		//on the application's threads instead of while painting. The dispatcher is expected to run pJob(pContext) once
+		//on any thread it likes and to return without waiting for it. The image draws nothing until its decode is done;
+		//a later View::Tick() picks up the result and repaints the image. The allocator must be thread safe then.
+		//Without a dispatcher (the default), images decode on the calling thread while painting.
+		//The kVProcessTypeImageDecoder notifications of these decodes are sent on the main thread, once it sees them start and end.
+		typedef void (*EAWebKitImageDecodeJobFunction)(void* pContext);
+		typedef void (*EAWebKitImageDecodeJobDispatcher)(EAWebKitImageDecodeJobFunction pJob, void* pContext);
+		EAWEBKIT_API void SetImageDecodeJobDispatcher(EAWebKitImageDecodeJobDispatcher dispatcher);
+		EAWEBKIT_API EAWebKitImageDecodeJobDispatcher GetImageDecodeJobDispatcher();
+
 
 
         ///////////////////////////////////////////////////////////////////////
@@ -384,7 +426,7 @@ namespace EA
 			// The user can tweak this size and may be get around by using a smaller size that fits their need. If the size is too small, some JavaScript code may not execute. This would fire an assert in the debug builds.
 			uint32_t			mJavaScriptStackSize;		
             bool                mEnableSmoothText;					// Defaults to false.  If enable, this allows software anti-alisasing on all text. 
-            bool                mbEnableImageAdditiveAlphaBlending; // Defaults to false. If enabled, does additive alpha blending for images. Most other browsers seem to use additive. 
+            bool                mbEnableImageAdditiveAlphaBlending; // Defaults to false. If enabled, does additive alpha blending for images. Decoded images are premultiplied, so the normal blend already matches other browsers; additive only differs by rounding. 
             bool				mbEnableProfiling;					//Defaults to false. 
             bool				mbEnableGammaCorrection;			//Defaults to true. When false, it speeds up png image decoding by avoiding gamma range checking.
 			bool				mbEnableJavaScriptDebugOutput;		// Defaults to false. If enabled, this will print the results of console.log and any javascript errors/exceptions to TTY
@@ -568,6 +610,15 @@ namespace EA
 			{
 
 			}
+
+			// Functions added since are declared from here on, so that the slots above stay where
+			// applications built against earlier versions of this interface expect them.
+			virtual void SetRAMCacheBudgets(const RAMCacheBudgets& ramCacheBudgets) = 0;
+			virtual void GetRAMCacheBudgets(RAMCacheBudgets& ramCacheBudgets) = 0;
+			virtual void SetRasterJobDispatcher(EAWebKitRasterJobDispatcher dispatcher) = 0;
+			virtual EAWebKitRasterJobDispatcher GetRasterJobDispatcher() = 0;
+			virtual void SetImageDecodeJobDispatcher(EAWebKitImageDecodeJobDispatcher dispatcher) = 0;
+			virtual EAWebKitImageDecodeJobDispatcher GetImageDecodeJobDispatcher() = 0;
 		};
 	}
 }
@@ -683,6 +734,13 @@ namespace EA
 			{
 
 			}
+
+			virtual void SetRAMCacheBudgets(const RAMCacheBudgets& ramCacheBudgets);
+			virtual void GetRAMCacheBudgets(RAMCacheBudgets& ramCacheBudgets);
+			virtual void SetRasterJobDispatcher(EAWebKitRasterJobDispatcher dispatcher);
+			virtual EAWebKitRasterJobDispatcher GetRasterJobDispatcher();
+			virtual void SetImageDecodeJobDispatcher(EAWebKitImageDecodeJobDispatcher dispatcher);
+			virtual EAWebKitImageDecodeJobDispatcher GetImageDecodeJobDispatcher();
 		};
 
 
@@ -562,6 +562,17 @@ namespace EA
             ViewParameters();
         };
 
+        // How the view surface is backed. Set with View::SetSurfaceParameters before InitView. These are kept out of 
+        // ViewParameters, as applications built against earlier versions of it pass a smaller struct.
+        struct EAWEBKIT_API ViewSurfaceParameters
+        {
+            bool  mbTiledBackingStore;              // Defaults to false. Keeps the page painted in tiles beyond the view, pre-rendered in Tick in the direction of scrolling.
+            int   mTiledBackingStoreSize;           // Defaults to 8MB. Memory budget for the tiles, in bytes. Never less than what it takes to cover the view.
+            EA::Raster::PixelFormatType mPixelFormat;   // Defaults to kPixelFormatTypeARGB. The format of the view surface and its tiles. kPixelFormatTypeRGB565 and kPixelFormatTypeARGB4444 halve their memory and blit bandwidth, at the cost of color depth.
+
+            ViewSurfaceParameters();
+        };
+
 		// Directions : JumpUp, JumpDown, JumpLeft, JumpRight
 		enum JumpDirection
 		{
@@ -655,6 +666,15 @@ namespace EA
             // Returns true if the surface was changed.
             virtual bool Tick();
 
+            // Same as Tick, but stops work once deadline (an EA::WebKit::GetTime() value) has passed and 
+            // resumes it on the next tick. Main thread functions, timers, transport jobs and painting yield 
+            // between units of work; painting is done in bands of the dirty rects. Each of them still does 
+            // at least one unit per tick so nothing starves, and a layout is never interrupted.
+            // With a raster job dispatcher installed, the deadline only bounds how much gets recorded: 
+            // what was recorded is always rasterized before returning, so the tick can run past it.
+            // A deadline of 0 means no limit.
+            bool TickWithDeadline(double deadline);
+
             // This is called by our WebKit-level code whenever an area of the
             // view has been redrawn. It does any internal housekeeping and then
             // calls the user-installed ViewNotification. View updates should go
@@ -811,6 +831,27 @@ namespace EA
 			virtual void UnregisterJavascriptMethod(const char* name);
 			virtual void UnregisterJavascriptProperty(const char* name);
 			virtual void RebindJavascript();
+
+            // Virtual functions added since are declared from here on, so that the slots above stay where 
+            // applications built against earlier versions of View expect them.
+
+            ///////////////////////////////
+            // Surface
+            ///////////////////////////////
+
+            // Must be called before InitView, as the view surface and its tiles are set up there.
+            virtual void SetSurfaceParameters(const ViewSurfaceParameters& sp);
+            virtual const ViewSurfaceParameters& GetSurfaceParameters() { return mViewSurfaceParameters; }
+
+            ///////////////////////////////
+            // Visibility
+            ///////////////////////////////
+
+            // Tells the view whether the application is currently showing it. Hidden views (such as background
+            // tabs) don't animate, and their decoded images are the first ones dropped once decoded images
+            // go over RAMCacheBudgets::mDecodedImageCacheSize. Views start out visible.
+            virtual void SetVisible(bool bVisible);
+            virtual bool IsVisible() const;
      		
 
         private:
@@ -850,6 +891,10 @@ namespace EA
 			BalObject*							mJavascriptBindingObject;
 			const char*							mJavascriptBindingObjectName;
 
+            // Members added since go from here on, so that the ones above keep their offsets.
+            ViewSurfaceParameters				mViewSurfaceParameters;
+            bool								mbVisible;
+
         };
 
     } // namespace WebKit
@@ -872,6 +917,13 @@ namespace EA
 			mbRedrawScrollbarOnCursorHover(false)
 		{
 		}
+
+		inline ViewSurfaceParameters::ViewSurfaceParameters()
+			: mbTiledBackingStore(false),
+			mTiledBackingStoreSize(8 * 1024 * 1024),
+			mPixelFormat(EA::Raster::kPixelFormatTypeARGB)
+		{
+		}
 	}
 }
 
@@ -89,7 +89,7 @@ int Surface::Release()
     if(mRefCount > 1)
         return --mRefCount;
 
-    DestroySurface(this);
+    WTF::fastDelete<Surface>(this);
     return 0;
 }
 
@@ -103,7 +103,7 @@ void Surface::InitMembers()
     mHeight        = 0;
     mStride        = 0;
     mLockCount     = 0;
-    mRefCount      = 0;
+    mRefCount      = 1;  // Owned by the creator.
     mpUserData     = NULL;
     mCompressedSize = 0;
 
@@ -115,6 +115,8 @@ void Surface::InitMembers()
     mpBlitDest     = 0;
     mDrawFlags     = 0;
     mpBlitFunction = NULL;
+    mpClipRegion   = NULL;
+    mpAlphaRows    = NULL;
 }
 
 
@@ -125,12 +127,15 @@ void Surface::SetPixelFormat(PixelFormatType pft)
 
     if (pft == kPixelFormatTypeRGB)
         mPixelFormat.mBytesPerPixel = 3;
+    else if ((pft == kPixelFormatTypeRGB565) || (pft == kPixelFormatTypeARGB4444))
+        mPixelFormat.mBytesPerPixel = 2;
     else
         mPixelFormat.mBytesPerPixel = 4;
 
     switch (pft)
     {
         case kPixelFormatTypeARGB:
+        case kPixelFormatTypePARGB:
             mPixelFormat.mRMask  = 0x00ff0000;
             mPixelFormat.mGMask  = 0x0000ff00;
             mPixelFormat.mBMask  = 0x000000ff;
@@ -184,6 +189,29 @@ void Surface::SetPixelFormat(PixelFormatType pft)
             mPixelFormat.mBShift = 8;
             mPixelFormat.mAShift = 0;
             break;
+
+        // The 16 bit masks and shifts are for the packed fields; ConvertColor expands them to 8 bits.
+        case kPixelFormatTypeRGB565:
+            mPixelFormat.mRMask  = 0x0000f800;
+            mPixelFormat.mGMask  = 0x000007e0;
+            mPixelFormat.mBMask  = 0x0000001f;
+            mPixelFormat.mAMask  = 0x00000000;
+            mPixelFormat.mRShift = 11;
+            mPixelFormat.mGShift = 5;
+            mPixelFormat.mBShift = 0;
+            mPixelFormat.mAShift = 0;
+            break;
+
+        case kPixelFormatTypeARGB4444:
+            mPixelFormat.mRMask  = 0x00000f00;
+            mPixelFormat.mGMask  = 0x000000f0;
+            mPixelFormat.mBMask  = 0x0000000f;
+            mPixelFormat.mAMask  = 0x0000f000;
+            mPixelFormat.mRShift = 8;
+            mPixelFormat.mGShift = 4;
+            mPixelFormat.mBShift = 0;
+            mPixelFormat.mAShift = 12;
+            break;
     }
 }
 
@@ -293,6 +321,9 @@ void Surface::FreeData()
         mpData = NULL;
     }
 
+    WTF::fastDeleteArray<AlphaRow>(mpAlphaRows);
+    mpAlphaRows   = NULL;
+
     mSurfaceFlags = 0; // Or maybe just mSurfaceFlags &= ~kFlagOtherOwner;
     mWidth        = 0;
     mHeight       = 0;
@@ -312,13 +343,36 @@ void Surface::SetClipRect(const Rect* pRect)
 }
 
 
+bool Surface::SetAlphaRows(const AlphaRow* pRows)
+{
+    if(!pRows)
+    {
+        WTF::fastDeleteArray<AlphaRow>(mpAlphaRows);
+        mpAlphaRows = NULL;
+        return true;
+    }
+
+    if(!mpAlphaRows)
+    {
+        if(mHeight <= 0)
+            return false;
+
+        mpAlphaRows = WTF::fastNewArray<AlphaRow>(mHeight);
+
+        if(!mpAlphaRows)
+            return false;
+    }
+
+    memcpy(mpAlphaRows, pRows, mHeight * sizeof(AlphaRow));
+    return true;
+}
+
+
 Surface* CreateSurface()
 {
     
+    // The new surface starts out with the creator's reference.
     Surface* pSurface = WTF::fastNew<Surface>();
-   
-    if(pSurface)
-        pSurface->AddRef();
 
     return pSurface;
 }
@@ -330,7 +384,7 @@ Surface* CreateSurface(int width, int height, PixelFormatType pft)
 
     if(pNewSurface)
     {
-        // Note that pNewSurface is already AddRef'd.
+        // Note that pNewSurface already holds the creator's reference.
         pNewSurface->SetPixelFormat(pft);
 
         if(!pNewSurface->Resize(width, height, false))
@@ -350,7 +404,7 @@ Surface* CreateSurface(Surface* pSurface)
 
     if(pNewSurface)
     {
-        // Note that pNewSurface is already AddRef'd.
+        // Note that pNewSurface already holds the creator's reference.
         if(!pNewSurface->Set(pSurface))
         {
             DestroySurface(pNewSurface);
@@ -368,7 +422,7 @@ Surface* CreateSurface(void* pData, int width, int height, int stride, PixelForm
 
     if(pNewSurface)
     {
-        // Note that pNewSurface is already AddRef'd.
+        // Note that pNewSurface already holds the creator's reference.
         if(!pNewSurface->Set(pData, width, height, stride, pft, bCopyData, bTakeOwnership))
         {
             DestroySurface(pNewSurface);
@@ -380,9 +434,12 @@ Surface* CreateSurface(void* pData, int width, int height, int stride, PixelForm
 }
 
 
+// This drops the creator's reference, so a surface that is still referenced elsewhere 
+// (e.g. recorded in a display list) is deleted only once that reference is released too.
 void DestroySurface(Surface* pSurface)
 {
-    WTF::fastDelete<Surface>(pSurface);
+    if(pSurface)
+        pSurface->Release();
 
 }
 
@@ -435,7 +492,8 @@ EARASTER_API bool WritePPMFile(const char* pPath, Surface* pSurface, bool bAlpha
 
     if(fp)
     {
-        const bool bARGB = (pSurface->mPixelFormat.mPixelFormatType == EA::Raster::kPixelFormatTypeARGB);
+        const bool bARGB = (pSurface->mPixelFormat.mPixelFormatType == EA::Raster::kPixelFormatTypeARGB) || 
+                           (pSurface->mPixelFormat.mPixelFormatType == EA::Raster::kPixelFormatTypePARGB);
 
         fprintf(fp, "P3\n");
         fprintf(fp, "# %s\n", pPath);
@@ -539,6 +597,41 @@ namespace EA
 			 EA::Raster::DestroySurface(pSurface);
 		 }
 
+		 Surface* EARasterConcrete::AcquirePooledSurface(int width, int height, PixelFormatType pft)
+		 {
+			 return EA::Raster::AcquirePooledSurface(width, height, pft);
+		 }
+
+		 void EARasterConcrete::ReleasePooledSurface(Surface* pSurface)
+		 {
+			 EA::Raster::ReleasePooledSurface(pSurface);
+		 }
+
+		 void EARasterConcrete::SetSurfacePoolCapacity(uint32_t size)
+		 {
+			 EA::Raster::SetSurfacePoolCapacity(size);
+		 }
+
+		 uint32_t EARasterConcrete::GetSurfacePoolCapacity()
+		 {
+			 return EA::Raster::GetSurfacePoolCapacity();
+		 }
+
+		 void EARasterConcrete::TrimSurfacePool(uint32_t size)
+		 {
+			 EA::Raster::TrimSurfacePool(size);
+		 }
+
+		 void EARasterConcrete::GetSurfacePoolStats(SurfacePoolStats& stats)
+		 {
+			 EA::Raster::GetSurfacePoolStats(stats);
+		 }
+
+		 void EARasterConcrete::ResetSurfacePoolHighWater()
+		 {
+			 EA::Raster::ResetSurfacePoolHighWater();
+		 }
+
 		// Color conversion
 		 void EARasterConcrete::ConvertColor(NativeColor c, PixelFormatType cFormat, Color& result)
 		 {
@@ -821,6 +914,30 @@ namespace EA
 			 return -1;
 			 //return EA::Raster::TexturedPolygonMT(pSurface, vx, vy,  n, pTexture,  texture_dx,  texture_dy, polyInts, polyAllocated);
 		 }
+		 int EARasterConcrete::RasterizePath(const PointF* pPoints, const int* pContourSizes, int contourCount, FillRule fillRule, bool bAntialias, const Rect& clipRect, SpanFunction pSpanFunction, void* pContext, RasterScratch* pScratch)
+		 {
+			 return EA::Raster::RasterizePath(pPoints, pContourSizes, contourCount, fillRule, bAntialias, clipRect, pSpanFunction, pContext, pScratch);
+		 }
+		 int EARasterConcrete::FillPathColor(Surface* pSurface, const PointF* pPoints, const int* pContourSizes, int contourCount, const Color& color, FillRule fillRule, bool bAntialias, RasterScratch* pScratch)
+		 {
+			 return EA::Raster::FillPathColor(pSurface, pPoints, pContourSizes, contourCount, color, fillRule, bAntialias, pScratch);
+		 }
+		 ClipRegion* EARasterConcrete::CreateClipRegion(const Rect& rect)
+		 {
+			 return EA::Raster::CreateClipRegion(rect);
+		 }
+		 ClipRegion* EARasterConcrete::CreateClipRegion(const ClipRegion& region)
+		 {
+			 return EA::Raster::CreateClipRegion(region);
+		 }
+		 void EARasterConcrete::GenerateGradientSpan(const GradientFill& gradient, int x, int y, int length, uint32_t* pColors)
+		 {
+			 EA::Raster::GenerateGradientSpan(gradient, x, y, length, pColors);
+		 }
+		 int EARasterConcrete::FillPathGradient(Surface* pSurface, const PointF* pPoints, const int* pContourSizes, int contourCount, const GradientFill& gradient, FillRule fillRule, bool bAntialias, RasterScratch* pScratch)
+		 {
+			 return EA::Raster::FillPathGradient(pSurface, pPoints, pContourSizes, contourCount, gradient, fillRule, bAntialias, pScratch);
+		 }
 
 
 		///////////////////////////////////////////////////////////////////////
@@ -871,6 +988,26 @@ namespace EA
 			 return EA::Raster::BlitNoClip(pSource, pRectSource, pDest, pRectDest, additiveBlend);
 		 }
 
+		 int EARasterConcrete::BlitWithOpacity(Surface* pSource, const Rect* pRectSource, Surface* pDest, const Rect* pRectDest, const Rect* pDestClipRect, const bool additiveBlend, int opacity)
+		 {
+			 return EA::Raster::Blit(pSource, pRectSource, pDest, pRectDest, pDestClipRect, additiveBlend, opacity);
+		 }
+
+		 int EARasterConcrete::BlitNoClipWithOpacity(Surface* pSource, const Rect* pRectSource, Surface* pDest, const Rect* pRectDest, const bool additiveBlend, int opacity)
+		 {
+			 return EA::Raster::BlitNoClip(pSource, pRectSource, pDest, pRectDest, additiveBlend, opacity);
+		 }
+
+		 int EARasterConcrete::BlitScaled(Surface* pSource, const Rect* pRectSource, Surface* pDest, const Rect* pRectDest, const Rect* pDestClipRect, ScaleFilter filter, const bool additiveBlend, int opacity)
+		 {
+			 return EA::Raster::BlitScaled(pSource, pRectSource, pDest, pRectDest, pDestClipRect, filter, additiveBlend, opacity);
+		 }
+
+		 Surface* EARasterConcrete::CreateScaledSurface(Surface* pSource, int width, int height, ScaleFilter filter)
+		 {
+			 return EA::Raster::CreateScaledSurface(pSource, width, height, filter);
+		 }
+
 		 int EARasterConcrete::BlitTiled(Surface* pSource, const Rect* pRectSource, Surface* pDest, const Rect* pRectDest, int offsetX, int offsetY)
 		 {
 			 return EA::Raster::BlitTiled(pSource, pRectSource, pDest, pRectDest, offsetX, offsetY);
@@ -881,6 +1018,36 @@ namespace EA
 			 return EA::Raster::BlitEdgeTiled(pSource, pRectSource, pDest, pRectDest, pRectSourceCenter);
 		 }
 
+		 int EARasterConcrete::ScrollSurface(Surface* pSurface, const Rect* pRect, int dx, int dy)
+		 {
+			 return EA::Raster::ScrollSurface(pSurface, pRect, dx, dy);
+		 }
+
+		 int EARasterConcrete::BlitMaskA8(const uint8_t* pMask, int maskWidth, int maskHeight, int maskStride, Surface* pDest, int x, int y, const Color& color, int opacity)
+		 {
+			 return EA::Raster::BlitMaskA8(pMask, maskWidth, maskHeight, maskStride, pDest, x, y, color, opacity);
+		 }
+
+		 void EARasterConcrete::BlendRow16(Surface* pSurface, int x, int y, int count, const uint32_t* pColors, int colorStep, const uint8_t* pCoverage, int opacity, bool bDither)
+		 {
+			 EA::Raster::BlendRow16(pSurface, x, y, count, pColors, colorStep, pCoverage, opacity, bDither);
+		 }
+
+		 void EARasterConcrete::BlendRowAccumulateAlpha(Surface* pSurface, int x, int y, int count, const uint32_t* pColors, int colorStep, const uint8_t* pCoverage, int opacity)
+		 {
+			 EA::Raster::BlendRowAccumulateAlpha(pSurface, x, y, count, pColors, colorStep, pCoverage, opacity);
+		 }
+
+		 void EARasterConcrete::BlurMaskA8(uint8_t* pMask, int width, int height, int stride, int radius)
+		 {
+			 EA::Raster::BlurMaskA8(pMask, width, height, stride, radius);
+		 }
+
+		 int EARasterConcrete::GetBlurExtent(int radius)
+		 {
+			 return EA::Raster::GetBlurExtent(radius);
+		 }
+
 		 bool EARasterConcrete::SetupBlitFunction(Surface* pSource, Surface* pDest)
 		 {
 			 return EA::Raster::SetupBlitFunction(pSource, pDest);
@@ -61,6 +61,7 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdio.h>
 #include <assert.h>
 #include <EAWebKit/EAWebKitView.h>
+#include <wtf/FastAllocBase.h>
 #ifndef MMX_ASMBLIT
     #if defined(_MSC_VER) && defined(_M_IX86) && !defined(_WIN64)
         #define MMX_ASMBLIT 1
@@ -89,6 +90,24 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     #endif
 #endif
 
+// SSE2 is always there on x86-64, and on 32 bit x86 if the compiler was told it can use it.
+#ifndef SSE2_BLIT
+    #if defined(_M_X64) || defined(_M_AMD64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+        #define SSE2_BLIT 1
+    #else
+        #define SSE2_BLIT 0
+    #endif
+#endif
+
+// AVX2 needs a compiler which knows the intrinsics. Whether the CPU has it is checked at runtime.
+#ifndef AVX2_BLIT
+    #if SSE2_BLIT && ((defined(_MSC_VER) && (_MSC_VER >= 1700)) || defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))))
+        #define AVX2_BLIT 1
+    #else
+        #define AVX2_BLIT 0
+    #endif
+#endif
+
 
 #if GCC_ASMBLIT
     #include "mmx.h"
@@ -99,6 +118,26 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     #include <altivec.h>
 #endif
 
+#if SSE2_BLIT
+    #include <emmintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#endif
+
+#if AVX2_BLIT
+    #include <immintrin.h>
+
+    // GCC and clang only let us use AVX2 intrinsics in functions compiled for AVX2.
+    #if defined(__GNUC__) || defined(__clang__)
+        #define AVX2_TARGET __attribute__((target("avx2")))
+    #else
+        #define AVX2_TARGET
+    #endif
+#endif
+
 
 
 
@@ -116,6 +155,29 @@ static void BlitRGBtoRGBSurfaceAlpha(const BlitInfo& info);
 static void BlitRGBtoRGBPixelAlpha  (const BlitInfo& info);
 static void BlitNtoNSurfaceAlpha    (const BlitInfo& info);
 static void BlitNtoNPixelAlpha      (const BlitInfo& info);
+static void BlitRGBtoRGBOpacity     (const BlitInfo& info);
+static void BlitNtoNOpacity         (const BlitInfo& info);
+static void BlitNto16               (const BlitInfo& info);
+static void BlitUnpackedtoN         (const BlitInfo& info);
+static void BlitPARGBtoRGB          (const BlitInfo& info);
+static void BlitNtoAccumulatedAlpha (const BlitInfo& info);
+
+static bool             AccumulatesAlpha(const Surface* pDest);
+static bool             IsBlitFunctionSetUp(const Surface* pSource, const Surface* pDest);
+static BlitFunctionType GetOpacityBlitFunction(const Surface* pSource, const Surface* pDest);
+static BlitFunctionType GetPremultipliedBlitFunction(const Surface* pSource, const Surface* pDest);
+static bool             BlitAlphaRows(const BlitInfo& info, const Rect& rectSource);
+
+static void BlendPixels16(uint16_t* pDest, PixelFormatType pft, int x, int y, int count, const uint32_t* pColors, int colorStep, 
+                          uint32_t alphaOr, const uint8_t* pCoverage, uint32_t opacity, bool bAdditive, bool bDither);
+static void BlendPixelsAccumulateAlpha(uint32_t* pDest, int count, const uint32_t* pColors, int colorStep, 
+                                       uint32_t alphaOr, const uint8_t* pCoverage, uint32_t opacity);
+
+// Blends one row of pen color through an 8 bit coverage mask. 
+// pen is the RGB of the color in the dest layout and penAlpha is its alpha.
+typedef void (*MaskRowFunctionType)(const uint8_t* pMask, uint32_t* pDst, int width, uint32_t pen, uint32_t penAlpha);
+
+static void BlitMaskA8Row(const uint8_t* pMask, uint32_t* pDst, int width, uint32_t pen, uint32_t penAlpha);
 
 #if MSVC_ASMBLIT
     static void BlitRGBtoRGBSurfaceAlphaMMX   (const BlitInfo& info);
@@ -123,6 +185,26 @@ static void BlitNtoNPixelAlpha      (const BlitInfo& info);
     static void BlitRGBtoRGBPixelAlphaMMX3DNOW(const BlitInfo& info);
 #endif
 
+#if SSE2_BLIT
+    static void BlitRGBtoRGBSurfaceAlphaSSE2(const BlitInfo& info);
+    static void BlitRGBtoRGBPixelAlphaSSE2  (const BlitInfo& info);
+    static void BlitRGBtoRGBOpacitySSE2     (const BlitInfo& info);
+    static void BlitPARGBtoRGBSSE2          (const BlitInfo& info);
+    static void BlitMaskA8RowSSE2(const uint8_t* pMask, uint32_t* pDst, int width, uint32_t pen, uint32_t penAlpha);
+    static void BoxBlurRowSSE2(const uint8_t* pAdd, const uint8_t* pSub, uint16_t* pSums, uint8_t* pDest, int width, uint32_t reciprocal);
+    static void BilinearSpanSSE2(const uint32_t* pRow0, const uint32_t* pRow1, uint32_t fy, const int* pX, const uint16_t* pFx, uint32_t* pDest, int count);
+    static void SumPixelsSSE2(const uint32_t* pPixels, int count, uint32_t* pSums);
+#endif
+
+#if AVX2_BLIT
+    AVX2_TARGET static void BlitRGBtoRGBSurfaceAlphaAVX2(const BlitInfo& info);
+    AVX2_TARGET static void BlitRGBtoRGBPixelAlphaAVX2  (const BlitInfo& info);
+    AVX2_TARGET static void BlitRGBtoRGBOpacityAVX2     (const BlitInfo& info);
+    AVX2_TARGET static void BlitPARGBtoRGBAVX2          (const BlitInfo& info);
+    AVX2_TARGET static void BlitMaskA8RowAVX2(const uint8_t* pMask, uint32_t* pDst, int width, uint32_t pen, uint32_t penAlpha);
+    AVX2_TARGET static void BilinearSpanAVX2(const uint32_t* pRow0, const uint32_t* pRow1, uint32_t fy, const int* pX, const uint16_t* pFx, uint32_t* pDest, int count);
+#endif
+
 #if ALTIVEC_BLIT 
     static void Blit32to32PixelAlphaAltivec    (const BlitInfo& info);
     static void BlitRGBtoRGBPixelAlphaAltivec  (const BlitInfo& info);
@@ -132,18 +214,6 @@ static void BlitNtoNPixelAlpha      (const BlitInfo& info);
 
 
 
-void* revcpy(void* pDst, const void* pSrc, size_t len)
-{
-    const char* pSrc8 = (const char*)pSrc + (len - 1);
-    char*       pDst8 = (char*)      pDst + (len - 1);
-
-    while (len--)
-        *pDst8-- = *pSrc8--;
-
-    return pDst;
-}
-
-
 #if MMX_ASMBLIT
 
     static int CPUIDFeatures()
@@ -220,6 +290,94 @@ void* revcpy(void* pDst, const void* pSrc, size_t len)
 #endif
 
 
+#if SSE2_BLIT
+
+    enum SIMDFeature
+    {
+        kSIMDFeatureChecked = 0x01,
+        kSIMDFeatureSSE2    = 0x02,
+        kSIMDFeatureAVX2    = 0x04
+    };
+
+    static int gSIMDFeatures = 0;
+
+    static void CPUIDQuery(int function, int subFunction, int info[4])
+    {
+        #if defined(_MSC_VER)
+            __cpuidex(info, function, subFunction);
+        #else
+            __cpuid_count(function, subFunction, info[0], info[1], info[2], info[3]);
+        #endif
+    }
+
+    #if AVX2_BLIT
+        // Returns the OS enabled register state (XCR0). AVX needs the OS to save the YMM registers.
+        static uint64_t XGetBV()
+        {
+            #if defined(_MSC_VER)
+                return _xgetbv(0);
+            #else
+                uint32_t eax, edx;
+                __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+                return ((uint64_t)edx << 32) | eax;
+            #endif
+        }
+    #endif
+
+    // The CPU is only queried the first time, after which the result is cached.
+    // It's harmless if two threads race here as they would both store the same value.
+    static int SIMDFeatures()
+    {
+        if(!gSIMDFeatures)
+        {
+            int features = kSIMDFeatureChecked;
+            int info[4];
+
+            CPUIDQuery(0, 0, info);
+            const int maxFunction = info[0];
+
+            if(maxFunction >= 1)
+            {
+                CPUIDQuery(1, 0, info);
+
+                if(info[3] & 0x04000000)
+                    features |= kSIMDFeatureSSE2;
+
+                #if AVX2_BLIT
+                    const bool bOSXSave = (info[2] & 0x08000000) != 0;
+                    const bool bAVX     = (info[2] & 0x10000000) != 0;
+
+                    if(bOSXSave && bAVX && ((XGetBV() & 0x06) == 0x06) && (maxFunction >= 7))
+                    {
+                        CPUIDQuery(7, 0, info);
+
+                        if(info[1] & 0x00000020)
+                            features |= kSIMDFeatureAVX2;
+                    }
+                #endif
+            }
+
+            gSIMDFeatures = features;
+        }
+
+        return gSIMDFeatures;
+    }
+
+    static bool HaveSSE2()
+    {
+        return (SIMDFeatures() & kSIMDFeatureSSE2) != 0;
+    }
+
+    #if AVX2_BLIT
+        static bool HaveAVX2()
+        {
+            return (SIMDFeatures() & kSIMDFeatureAVX2) != 0;
+        }
+    #endif
+
+#endif
+
+
 #if ALTIVEC_BLIT
 
     static bool HaveAltiVec()
@@ -327,6 +485,10 @@ do {                                                \
 } while(0)
 
 
+// Multiplies an alpha value by an opacity, both 0-255. Exact at 0 and 255.
+#define MODULATE_ALPHA(a, opacity) ((((a) * (opacity)) + 255) >> 8)
+
+
 // Additive blend the RGB values of two pixels based on a source alpha value.
 #define ADDITIVE_ALPHA_BLEND(sR, sG, sB, A, dR, dG, dB)     \
 do {                                                        \
@@ -703,1388 +865,4068 @@ EARASTER_API int BlitEdgeTiled(Surface* pSource, const Rect* pRectSource, Surfac
 }
 
 
-EARASTER_API int Blit(Surface* pSource, const Rect* pRectSource, Surface* pDest, const Rect* pRectDest, const Rect* pDestClipRect, const bool additive)
+EARASTER_API int ScrollSurface(Surface* pSurface, const Rect* pRect, int dx, int dy)
 {
-    EAW_ASSERT(pSource && pDest);
-
-    // If the source rectangle is NULL, use the entire source surface.
-    // If the destination rectangle is NULL, use the entire dest surface.
-
-    Rect rectSourceResult;
-    Rect rectDestResult;
-
-    if(ClipForBlit(pSource, pRectSource, pDest, pRectDest, rectSourceResult, rectDestResult))  // If there is anything to draw...
-    {
-        if(pDestClipRect)
-        {
-            // Test left side of clip rect to left side of dest rect.
-            int d = (pDestClipRect->x - rectDestResult.x);
+    EAW_ASSERT(pSurface);
 
-            if(d > 0)
-            {
-                rectDestResult.x   += d;
-                rectDestResult.w   -= d;
-                rectSourceResult.x += d;
-                rectSourceResult.w -= d;
-            }
+    if(!pSurface || !pSurface->mpData)
+        return -1;
 
-            // Test right side of clip rect to right side of dest rect.
-            d = (rectDestResult.x + rectDestResult.w) - (pDestClipRect->x + pDestClipRect->w);
+    Rect rectScroll(0, 0, pSurface->mWidth, pSurface->mHeight);
 
-            if(d > 0)
-            {
-                rectDestResult.w   -= d;
-                rectSourceResult.w -= d;
-            }
+    if(pRect && !IntersectRect(*pRect, rectScroll, rectScroll))
+        return 0;
 
-            // Test top side of clip rect to top side of dest rect.
-            d = (pDestClipRect->y - rectDestResult.y);
+    // If we shift everything out of the rect, there is nothing left to copy.
+    if((abs(dx) >= rectScroll.w) || (abs(dy) >= rectScroll.h) || (!dx && !dy))
+        return 0;
 
-            if(d > 0)
-            {
-                rectDestResult.y   += d;
-                rectDestResult.h   -= d;
-                rectSourceResult.y += d;
-                rectSourceResult.h -= d;
-            }
+    // The part of the rect that remains visible after the shift.
+    const Rect rectSource(rectScroll.x + (dx < 0 ? -dx : 0), rectScroll.y + (dy < 0 ? -dy : 0), rectScroll.w - abs(dx), rectScroll.h - abs(dy));
+    const Rect rectDest(rectSource.x + dx, rectSource.y + dy, rectSource.w, rectSource.h);
 
-            // Test bottom side of clip rect to bottom side of dest rect.
-            d = (rectDestResult.y + rectDestResult.h) - (pDestClipRect->y + pDestClipRect->h);
+    // We call the overlap copy directly instead of going through SetupBlitFunction, as a
+    // surface with alpha would otherwise get blended onto itself.
+	NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeDrawRaster, EA::WebKit::kVProcessStatusStarted);
 
-            if(d > 0)
-            {
-                rectDestResult.h   -= d;
-                rectSourceResult.h -= d;
-            }
+    const int bpp = pSurface->mPixelFormat.mBytesPerPixel;
+    BlitInfo  blitInfo;
 
-            if((rectSourceResult.w <= 0) || (rectSourceResult.h <= 0))
-                return 0;
-        }
+    blitInfo.mpSource  = pSurface;
+    blitInfo.mpSPixels = (uint8_t*)pSurface->mpData + (rectSource.y * pSurface->mStride) + (rectSource.x * bpp);
+    blitInfo.mnSWidth  = rectSource.w;
+    blitInfo.mnSHeight = rectSource.h;
+    blitInfo.mnSSkip   = pSurface->mStride - (rectSource.w * bpp);
 
-        //Nicki Vankoughnett Stomp Fix:  
-        //it appears that it is possible at this piont for the pRectDest to cause us to attempt to draw out
-        //of bounds.  So lets constrain our pRectDest to the pDest surface mWidth and mHeight values.
-        EA::Raster::Rect destSurfaceConstraint(0,0,pDest->mWidth, pDest->mHeight);
-        destSurfaceConstraint.constrainRect(rectDestResult);
-        if(rectDestResult.w <= 0 || rectDestResult.h <= 0)
-            return 0;
+    blitInfo.mpDest    = pSurface;
+    blitInfo.mpDPixels = (uint8_t*)pSurface->mpData + (rectDest.y * pSurface->mStride) + (rectDest.x * bpp);
+    blitInfo.mnDWidth  = rectDest.w;
+    blitInfo.mnDHeight = rectDest.h;
+    blitInfo.mnDSkip   = pSurface->mStride - (rectDest.w * bpp);
+    blitInfo.mDoAdditiveBlend = false;
+    blitInfo.mnOpacity = 255;
+    BlitCopyOverlap(blitInfo);
 
-        return BlitNoClip(pSource, &rectSourceResult, pDest, &rectDestResult, additive);
-    }
+	NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeDrawRaster, EA::WebKit::kVProcessStatusEnded);
 
     return 0;
 }
 
 
-EARASTER_API int BlitNoClip(Surface* pSource, const Rect* pRectSource, Surface* pDest, const Rect* pRectDest, const bool additive)
+// Blends the part rectResult of the mask at x, y into pDest. rectResult is already clipped.
+static void BlitMaskA8Rect(const uint8_t* pMask, int maskStride, Surface* pDest, int x, int y, const Color& color, uint32_t penAlpha, const Rect& rectResult)
 {
-    Rect rectSource; // Used if pRectSource is NULL.
-    Rect rectDest;   // Used if pRectDest is NULL.
+    const PixelFormat& df     = pDest->mPixelFormat;
+    const int          dstbpp = df.mBytesPerPixel;
+    uint8_t*           pRow   = (uint8_t*)pDest->mpData + (rectResult.y * pDest->mStride) + (rectResult.x * dstbpp);
 
-    // See if we need to set up the blit function.
-    // If we add the ability for the source or dest pixel format to change, 
-    // then we'll need to add a change detection mechanism.
-    if((pSource->mpBlitDest != pDest) || !pSource->mpBlitFunction)
+    pMask += ((rectResult.y - y) * maskStride) + (rectResult.x - x);
+
+    if(AccumulatesAlpha(pDest))
     {
-        if(!SetupBlitFunction(pSource, pDest))
-            return -1;
-    }
+        // penAlpha already has the color's alpha in it.
+        const uint32_t pen = 0xff000000 | ((uint32_t)color.red() << 16) | ((uint32_t)color.green() << 8) | (uint32_t)color.blue();
 
-    // 11/09/09 CSidhall Added notify start of process to user
-	NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeDrawRaster, EA::WebKit::kVProcessStatusStarted);
-	
-	if(!pRectSource)
+        for(int row = rectResult.y, rowEnd = rectResult.y + rectResult.h; row < rowEnd; ++row)
+        {
+            BlendRowAccumulateAlpha(pDest, rectResult.x, row, rectResult.w, &pen, 0, pMask, (int)penAlpha);
+
+            pMask += maskStride;
+        }
+    }
+    else if(dstbpp == 2)
     {
-        rectSource.x = 0;
-        rectSource.y = 0;
-        rectSource.w = pSource->mWidth;
-        rectSource.h = pSource->mHeight;
+        // penAlpha already has the color's alpha in it.
+        const uint32_t pen = 0xff000000 | ((uint32_t)color.red() << 16) | ((uint32_t)color.green() << 8) | (uint32_t)color.blue();
 
-        pRectSource = &rectSource;
+        for(int row = rectResult.y, rowEnd = rectResult.y + rectResult.h; row < rowEnd; ++row)
+        {
+            BlendPixels16((uint16_t*)pRow, df.mPixelFormatType, rectResult.x, row, rectResult.w, &pen, 0, 0, pMask, penAlpha, false, false);
+
+            pMask += maskStride;
+            pRow  += pDest->mStride;
+        }
     }
+    else if((dstbpp == 4) && 
+       ((df.mRMask | df.mGMask | df.mBMask) == 0x00ffffff) && 
+       ((df.mAMask == 0xff000000) || (df.mAMask == 0)))
+    {
+        const uint32_t pen = ((uint32_t)color.red() << df.mRShift) | ((uint32_t)color.green() << df.mGShift) | ((uint32_t)color.blue() << df.mBShift);
 
-    if(!pRectDest)
+        MaskRowFunctionType pRowFunction = BlitMaskA8Row;
+
+        #if SSE2_BLIT
+            if(HaveSSE2())
+                pRowFunction = BlitMaskA8RowSSE2;
+        #endif
+
+        #if AVX2_BLIT
+            if(HaveAVX2())
+                pRowFunction = BlitMaskA8RowAVX2;
+        #endif
+
+        for(int h = rectResult.h; h > 0; --h)
+        {
+            pRowFunction(pMask, (uint32_t*)pRow, rectResult.w, pen, penAlpha);
+
+            pMask += maskStride;
+            pRow  += pDest->mStride;
+        }
+    }
+    else
     {
-        rectDest.x = 0;
-        rectDest.y = 0;
-        rectDest.w = pDest->mWidth;     // To do: Define the the behaviour for the case of (pRectSource->w != pRectDest->w).
-        rectDest.h = pDest->mHeight;
+        // General (slow) version for other dest formats.
+        const int penR = color.red();
+        const int penG = color.green();
+        const int penB = color.blue();
 
-        pRectDest = &rectDest;
+        for(int h = rectResult.h; h > 0; --h)
+        {
+            uint8_t* pD = pRow;
+
+            for(int i = 0; i < rectResult.w; ++i, pD += dstbpp)
+            {
+                const int sA = (int)MODULATE_ALPHA((uint32_t)pMask[i], penAlpha);
+
+                if(sA)
+                {
+                    uint32_t pixel;
+                    int      dR, dG, dB, dA;
+
+                    DISEMBLE_RGBA(pD, dstbpp, df, pixel, dR, dG, dB, dA);
+                    if(!dA)
+                    {
+                        // 0 alpha background support               
+                        ASSEMBLE_RGBA(pD, dstbpp, df, penR, penG, penB, sA);
+                    }
+                    else
+                    {
+                        ALPHA_BLEND(penR, penG, penB, sA, dR, dG, dB);
+                        ASSEMBLE_RGBA(pD, dstbpp, df, dR, dG, dB, dA);
+                    }
+                }
+            }
+
+            pMask += maskStride;
+            pRow  += pDest->mStride;
+        }
     }
+}
 
-    //Nicki Vankoughnett:
-    //Avoid any chance of having a dest rect that cannot fit on the dest surface.
-    EAW_ASSERT(pRectDest->x >=  0 && pRectDest->x <= pDest->mWidth);
-    EAW_ASSERT((pRectDest->x + pRectDest->w) >=  0 && (pRectDest->x + pRectDest->w) <= pDest->mWidth);
-    EAW_ASSERT(pRectDest->y >=  0 && pRectDest->y <= pDest->mHeight);    // 3/10/09 CSidhall - Typo fix to mHeight instead of mWidth
-    EAW_ASSERT((pRectDest->y + pRectDest->h) >=  0 && (pRectDest->y + pRectDest->h) <= pDest->mHeight);
 
-    // Blits are done through a BlitFunction pointer. 
-    // The blit function takes a BlitInfo struct to encapsulate all parameters.
-    BlitInfo blitInfo;
+struct ClipMaskContext
+{
+    const uint8_t* mpMask;
+    int            mMaskStride;
+    Surface*       mpDest;
+    int            mX, mY;
+    const Color*   mpColor;
+    uint32_t       mPenAlpha;
+};
 
-    blitInfo.mpSource  = pSource;
-    blitInfo.mpSPixels = (uint8_t*)pSource->mpData + (pRectSource->y * pSource->mStride) + (pRectSource->x * pSource->mPixelFormat.mBytesPerPixel);
-    blitInfo.mnSWidth  = pRectSource->w;
-    blitInfo.mnSHeight = pRectSource->h;
-    blitInfo.mnSSkip   = pSource->mStride - (blitInfo.mnSWidth * pSource->mPixelFormat.mBytesPerPixel);
 
-    blitInfo.mpDest    = pDest;
-    blitInfo.mpDPixels = (uint8_t*)pDest->mpData + (pRectDest->y * pDest->mStride) + (pRectDest->x * pDest->mPixelFormat.mBytesPerPixel);
-    blitInfo.mnDWidth  = pRectDest->w;
-    blitInfo.mnDHeight = pRectDest->h;
-    blitInfo.mnDSkip   = pDest->mStride - (blitInfo.mnDWidth * pDest->mPixelFormat.mBytesPerPixel);
-    blitInfo.mDoAdditiveBlend = additive;
-    pSource->mpBlitFunction(blitInfo);
+static void ClipMaskRect(void* pContext, const Rect& rect, int coverage)
+{
+    const ClipMaskContext& context  = *static_cast<const ClipMaskContext*>(pContext);
+    const uint32_t         penAlpha = (coverage == 255) ? context.mPenAlpha : MODULATE_ALPHA(context.mPenAlpha, (uint32_t)coverage);
+
+    if(penAlpha)
+        BlitMaskA8Rect(context.mpMask, context.mMaskStride, context.mpDest, context.mX, context.mY, *context.mpColor, penAlpha, rect);
+}
+
+
+EARASTER_API int BlitMaskA8(const uint8_t* pMask, int maskWidth, int maskHeight, int maskStride, Surface* pDest, int x, int y, const Color& color, int opacity)
+{
+    EAW_ASSERT(pMask && pDest);
+
+    if(opacity > 255)
+        opacity = 255;
+
+    const uint32_t penAlpha = (opacity > 0) ? MODULATE_ALPHA((uint32_t)color.alpha(), (uint32_t)opacity) : 0;
+
+    if(!penAlpha)
+        return 0;
+
+    // The clip rect is normally already within the surface, but the default one isn't.
+    const Rect rectSurface(0, 0, pDest->mWidth, pDest->mHeight);
+    const Rect rectMask(x, y, maskWidth, maskHeight);
+    Rect       rectClip;
+    Rect       rectResult;
+
+    if(!IntersectRect(rectSurface, pDest->mClipRect, rectClip) || !IntersectRect(rectMask, rectClip, rectResult))
+        return 0;
+
+	NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeDrawRaster, EA::WebKit::kVProcessStatusStarted);
+
+    if(pDest->mpClipRegion)
+    {
+        ClipMaskContext context = { pMask, maskStride, pDest, x, y, &color, penAlpha };
+        pDest->mpClipRegion->ForEachRect(rectResult, ClipMaskRect, &context);
+    }
+    else
+        BlitMaskA8Rect(pMask, maskStride, pDest, x, y, color, penAlpha, rectResult);
 
 	NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeDrawRaster, EA::WebKit::kVProcessStatusEnded);
 
-	return 0;
+    return 0;
 }
 
 
-EARASTER_API bool SetupBlitFunction(Surface* pSource, Surface* pDest)
+// The blur is three box blurs in each direction, which is close to a Gaussian blur. The box sizes 
+// follow the SVG feGaussianBlur spec: d = floor(sigma * 3 * sqrt(2 * pi) / 4 + 0.5), with three boxes 
+// of size d if d is odd, else two of size d shifted half a pixel each way and one of size d + 1.
+// Box sizes are limited so that the sums fit 16 bits, which is a blur radius of about 270.
+static const int kMaxBlurBoxSize = 255;
+
+struct BlurLobe
 {
-    pSource->mpBlitDest     = pDest;
-    pSource->mDrawFlags     = 0;
-    pSource->mpBlitFunction = BlitNtoN;  // Initial default.
+    int mLeft;      // Pixels before the one being blurred that are in the box.
+    int mRight;     // Pixels after.
+};
 
-    const bool bIdenticalFormats = (pSource->mPixelFormat.mPixelFormatType == pDest->mPixelFormat.mPixelFormatType);
-    const bool bSourceHasAlpha   = (pSource->mPixelFormat.mAMask != 0);
-    const bool bDestHasAlpha     = (pDest->mPixelFormat.mAMask != 0);
-    const bool bEnableAlphaBlend = (pSource->mSurfaceFlags & kFlagDisableAlpha) == 0;
-    const bool bSurfaceAlpha     = (pSource->mPixelFormat.mSurfaceAlpha != 0xff);
-    const bool bBlitAlpha        = (bEnableAlphaBlend && (bSourceHasAlpha || bSurfaceAlpha));
+// Fills in the three boxes of a blur of the given radius. Returns how far the blur spreads out each side.
+static int GetBlurLobes(int radius, BlurLobe* pLobes)
+{
+    const float sigma = radius / 2.f;
+    int         d     = (int)floorf((sigma * 3.f * sqrtf(2.f * 3.14159265f) / 4.f) + 0.5f);
 
-    if(bIdenticalFormats)
-        pSource->mDrawFlags |= kDrawFlagIdenticalFormats;
+    if(d > kMaxBlurBoxSize)
+        d = kMaxBlurBoxSize;
 
-    // If we are using a non-alpha copy between identical pixel formats, use a copy blit.
-    if(!bBlitAlpha && bIdenticalFormats)
+    if(d <= 1)
     {
-        pSource->mpBlitFunction = BlitCopy;
+        for(int i = 0; i < 3; ++i)
+            pLobes[i].mLeft = pLobes[i].mRight = 0;
+        return 0;
+    }
 
-        if (pSource == pDest)
-            pSource->mpBlitFunction = BlitCopyOverlap;
+    if(d & 1)
+    {
+        for(int i = 0; i < 3; ++i)
+            pLobes[i].mLeft = pLobes[i].mRight = d / 2;
     }
     else
     {
-        if(bBlitAlpha)
-        {
-            const PixelFormat& sf = pSource->mPixelFormat;
-            const PixelFormat& df = pDest->mPixelFormat;
+        pLobes[0].mLeft = d / 2;       pLobes[0].mRight = (d / 2) - 1;
+        pLobes[1].mLeft = (d / 2) - 1; pLobes[1].mRight = d / 2;
+        pLobes[2].mLeft = d / 2;       pLobes[2].mRight = d / 2;
+    }
 
-            if(sf.mAMask == 0)  // If source doesn't have alpha...
-            {
-                // Per-surface alpha blits
-                switch(df.mBytesPerPixel)
-                {
-                    case 4:
-                    {
-                        if((sf.mRMask == df.mRMask) &&
-                           (sf.mGMask == df.mGMask) &&
-                           (sf.mBMask == df.mBMask) &&
-                           (sf.mBytesPerPixel == 4))
-                        {
-                            #if MMX_ASMBLIT
-                                if(HaveMMX())
-                                {
-                                    pSource->mpBlitFunction = BlitRGBtoRGBSurfaceAlphaMMX;
-                                    break;
-                                }
-                            #endif
+    return pLobes[0].mLeft + pLobes[1].mLeft + pLobes[2].mLeft;
+}
 
-                            if((sf.mRMask | sf.mGMask | sf.mBMask) == 0x00ffffff)
-                            {
-                                #if ALTIVEC_BLIT
-                                    if(HaveAltiVec())
-                                        pSource->mpBlitFunction = BlitRGBtoRGBSurfaceAlphaAltivec;
-                                    else
-                                #endif
-                                        pSource->mpBlitFunction = BlitRGBtoRGBSurfaceAlpha;
-                                break;
-                            }
-                        }
 
-                        #if ALTIVEC_BLIT
-                            if(HaveAltiVec())
-                                pSource->mpBlitFunction = Blit32to32SurfaceAlphaAltivec;
-                            else
-                        #endif
-                                pSource->mpBlitFunction = BlitNtoNSurfaceAlpha;
-                        break;
-                    }
+// Returns the 16 bit fixed point reciprocal of a box size, which is at least 2.
+// BoxAverage(sum, reciprocal) is then sum / size, rounded, and at most 255.
+static uint32_t GetBoxReciprocal(const BlurLobe& lobe)
+{
+    const uint32_t size = (uint32_t)(lobe.mLeft + lobe.mRight + 1);
+    return 65536 / size;
+}
 
-                    case 3:
-                    default:
-                        pSource->mpBlitFunction = BlitNtoNSurfaceAlpha;
-                        break;
-                }
-            }
-            else // Else source has alpha.
-            {
-                // Per-pixel alpha blits
-                switch(df.mBytesPerPixel)
-                {
-                    case 4:
-                        if((sf.mRMask == df.mRMask) && 
-                           (sf.mGMask == df.mGMask) && 
-                           (sf.mBMask == df.mBMask) && 
-                           (sf.mBytesPerPixel == 4))
-                        {
-                            #if MMX_ASMBLIT
-                                if(Have3DNow())
-                                {
-                                    pSource->mpBlitFunction = BlitRGBtoRGBPixelAlphaMMX3DNOW;
-                                    break;
-                                }
+static inline uint8_t BoxAverage(uint32_t sum, uint32_t reciprocal)
+{
+    return (uint8_t)(((sum * reciprocal) + 32768) >> 16);
+}
 
-                                if(HaveMMX())
-                                {
-                                    pSource->mpBlitFunction = BlitRGBtoRGBPixelAlphaMMX;
-                                    break;
-                                }
-                            #endif
 
-                            if(sf.mAMask == 0xff000000)
-                            {
-                                #if ALTIVEC_BLIT
-                                    if(HaveAltiVec())
-                                        pSource->mpBlitFunction = BlitRGBtoRGBPixelAlphaAltivec;
-                                    else
-                                #endif
-                                        pSource->mpBlitFunction = BlitRGBtoRGBPixelAlpha;
+// Box blurs a line of length pixels from pSrc into pDest. Pixels outside of the line count as 0.
+static void BoxBlurLine(const uint8_t* pSrc, uint8_t* pDest, int length, const BlurLobe& lobe, uint32_t reciprocal)
+{
+    uint32_t sum = 0;
 
-                                break;
-                            }
-                        }
+    for(int i = 0; (i < lobe.mRight) && (i < length); ++i)
+        sum += pSrc[i];
 
-                        #if ALTIVEC_BLIT
-                            if(HaveAltiVec())
-                                pSource->mpBlitFunction = Blit32to32PixelAlphaAltivec;
-                            else
-                        #endif
-                                pSource->mpBlitFunction = BlitNtoNPixelAlpha;
-                        break;
+    for(int i = 0; i < length; ++i)
+    {
+        if((i + lobe.mRight) < length)
+            sum += pSrc[i + lobe.mRight];
 
-                    case 3:
-                    default:
-                        pSource->mpBlitFunction = BlitNtoNPixelAlpha;
-                        break;
-                }
-            }
-        }
-        else
-        {
-            // To do: Come up with a better default value.
-            pSource->mpBlitFunction = BlitNtoN;
+        pDest[i] = BoxAverage(sum, reciprocal);
 
-            if(pSource->mpBlitFunction == BlitNtoN)
-            {
-                // Fastpath C fallback: 32bit RGB<->RGBA blit with matching RGB.
-                if ((pSource->mPixelFormat.mBytesPerPixel == 4) && 
-                    (pDest->mPixelFormat.mBytesPerPixel == 4) &&
-                    (pSource->mPixelFormat.mRMask == pDest->mPixelFormat.mRMask) &&
-                    (pSource->mPixelFormat.mGMask == pDest->mPixelFormat.mGMask) &&
-                    (pSource->mPixelFormat.mBMask == pDest->mPixelFormat.mBMask) )
-                {
-                    pSource->mpBlitFunction = Blit4to4MaskAlpha;
-                }
-                else if (bDestHasAlpha)
-                    pSource->mpBlitFunction = BlitNtoNCopyAlpha;
-            }
-        }
+        if((i - lobe.mLeft) >= 0)
+            sum -= pSrc[i - lobe.mLeft];
     }
-
-    return true;
 }
 
 
-// Blits 32 bit RGB <-> RGBA with both surfaces having the same R,G,B fields
-static void Blit4to4MaskAlpha(const BlitInfo& info)
-{
-    const int           width   = info.mnDWidth;
-    int                 height  = info.mnDHeight;
-    const uint32_t*     pSource = (uint32_t*)info.mpSPixels;
-    const int           srcskip = info.mnSSkip;
-    uint32_t*           pDest   = (uint32_t*)info.mpDPixels;
-    const int           dstskip = info.mnDSkip;
-    const PixelFormat&  srcfmt  = info.mpSource->mPixelFormat;
-    const PixelFormat&  dstfmt  = info.mpDest->mPixelFormat;
+// Does one row of a vertical box blur, which keeps a running sum for each column. pAdd is the row 
+// entering the box and pSub the one leaving it after this row.
+typedef void (*BoxBlurRowFunctionType)(const uint8_t* pAdd, const uint8_t* pSub, uint16_t* pSums, uint8_t* pDest, int width, uint32_t reciprocal);
 
-    if (dstfmt.mAMask)
+static void BoxBlurRow(const uint8_t* pAdd, const uint8_t* pSub, uint16_t* pSums, uint8_t* pDest, int width, uint32_t reciprocal)
+{
+    for(int x = 0; x < width; ++x)
     {
-        // RGB->RGBA, SET_ALPHA
-        const uint32_t aMask = (dstfmt.mSurfaceAlpha << dstfmt.mAShift);
+        const uint32_t sum = (uint32_t)pSums[x] + pAdd[x];
 
-        while (height--)
-        {
-            DUFFS_LOOP(
-            {
-                *pDest = *pSource | aMask;
+        pDest[x] = BoxAverage(sum, reciprocal);
+        pSums[x] = (uint16_t)(sum - pSub[x]);
+    }
+}
 
-                ++pSource;
-                ++pDest;
-            }, width);
 
-            pSource = (uint32_t*)((uint8_t*)pSource + srcskip);
-            pDest   = (uint32_t*)((uint8_t*)pDest + dstskip);
-        }
-    }
-    else
+// Box blurs the columns of pSrc into pDest. pZeroRow is width zeros, used for the rows outside of the mask.
+static void BoxBlurColumns(const uint8_t* pSrc, int srcStride, uint8_t* pDest, int destStride, int width, int height, 
+                           const BlurLobe& lobe, uint16_t* pSums, const uint8_t* pZeroRow, BoxBlurRowFunctionType pRowFunction)
+{
+    const uint32_t reciprocal = GetBoxReciprocal(lobe);
+
+    memset(pSums, 0, width * sizeof(uint16_t));
+
+    for(int y = 0; (y < lobe.mRight) && (y < height); ++y)
     {
-        // RGBA->RGB, NO_ALPHA
-        const uint32_t rgbMask = (srcfmt.mRMask | srcfmt.mGMask | srcfmt.mBMask);
+        const uint8_t* pRow = pSrc + (y * srcStride);
 
-        while (height--)
-        {
-            DUFFS_LOOP(
-            {
-                *pDest = *pSource & rgbMask;
+        for(int x = 0; x < width; ++x)
+            pSums[x] = (uint16_t)(pSums[x] + pRow[x]);
+    }
 
-                ++pSource;
-                ++pDest;
-            }, width);
+    for(int y = 0; y < height; ++y)
+    {
+        const uint8_t* pAdd = ((y + lobe.mRight) < height) ? (pSrc + ((y + lobe.mRight) * srcStride)) : pZeroRow;
+        const uint8_t* pSub = ((y - lobe.mLeft) >= 0)      ? (pSrc + ((y - lobe.mLeft) * srcStride))  : pZeroRow;
 
-            pSource = (uint32_t*)((uint8_t*)pSource + srcskip);
-            pDest   = (uint32_t*)((uint8_t*)pDest   + dstskip);
-        }
+        pRowFunction(pAdd, pSub, pSums, pDest + (y * destStride), width, reciprocal);
     }
 }
 
 
-// Non-alpha-blending blit of source and dest of different formats. Generic but slow.
-static void BlitNtoN(const BlitInfo& info)
+EARASTER_API int GetBlurExtent(int radius)
 {
-    const int           width   = info.mnDWidth;
-    int                 height  = info.mnDHeight;
-    const uint8_t*      pSource = info.mpSPixels;
-    const int           srcskip = info.mnSSkip;
-    uint8_t*            pDest   = info.mpDPixels;
-    const int           dstskip = info.mnDSkip;
-    const PixelFormat&  srcfmt  = info.mpSource->mPixelFormat;
-    const int           srcbpp  = srcfmt.mBytesPerPixel;
-    const PixelFormat&  dstfmt  = info.mpDest->mPixelFormat;
-    const int           dstbpp  = dstfmt.mBytesPerPixel;
-    const unsigned      alpha   = (dstfmt.mPixelFormatType == kPixelFormatTypeRGB) ? 0 : srcfmt.mSurfaceAlpha;
+    BlurLobe lobes[3];
+    return (radius > 0) ? GetBlurLobes(radius, lobes) : 0;
+}
 
-    while (height--)
-    {
-        DUFFS_LOOP(
-        {
-            uint32_t pixel;
-            unsigned sR;
-            unsigned sG;
-            unsigned sB;
 
-            DISEMBLE_RGB(pSource, srcbpp, srcfmt, pixel, sR, sG, sB);
-            ASSEMBLE_RGBA(pDest, dstbpp, dstfmt, sR, sG, sB, alpha);
+EARASTER_API void BlurMaskA8(uint8_t* pMask, int width, int height, int stride, int radius)
+{
+    EAW_ASSERT(pMask || !width || !height);
 
-            pSource += srcbpp;
-            pDest   += dstbpp;
-        }, width);
+    BlurLobe lobes[3];
 
-        pSource += srcskip;
-        pDest   += dstskip;
-    }
-}
+    if((radius <= 0) || (width <= 0) || (height <= 0) || !GetBlurLobes(radius, lobes))
+        return;
 
+	NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeDrawRaster, EA::WebKit::kVProcessStatusStarted);
 
-static void BlitNtoNCopyAlpha(const BlitInfo& info)
-{
-    const int           width   = info.mnDWidth;
-    int                 height  = info.mnDHeight;
-    const uint8_t*      pSource = info.mpSPixels;
-    const int           srcskip = info.mnSSkip;
-    uint8_t*            pDest   = info.mpDPixels;
-    const int           dstskip = info.mnDSkip;
-    const PixelFormat&  srcfmt  = info.mpSource->mPixelFormat;
-    const int           srcbpp  = srcfmt.mBytesPerPixel;
-    const PixelFormat&  dstfmt  = info.mpDest->mPixelFormat;
-    const int           dstbpp  = dstfmt.mBytesPerPixel;
+    BoxBlurRowFunctionType pRowFunction = BoxBlurRow;
 
-    // To do: Should map alpha to [0..255] correctly.
-    while (height--)
-    {
-        for (int c = width; c; --c)
-        {
-            uint32_t pixel;
-            unsigned sR, sG, sB, sA;
+    #if SSE2_BLIT
+        if(HaveSSE2())
+            pRowFunction = BoxBlurRowSSE2;
+    #endif
 
-            DISEMBLE_RGBA(pSource, srcbpp, srcfmt, pixel, sR, sG, sB, sA);
-            ASSEMBLE_RGBA(pDest,   dstbpp, dstfmt,        sR, sG, sB, sA);
+    // The vertical passes go a row at a time, ping-ponging between the mask and a copy.
+    // The horizontal passes then go from the copy back into the mask, one line at a time.
+    uint8_t* const  pTemp    = WTF::fastNewArray<uint8_t>(width * (height + 3));
+    uint8_t* const  pZeroRow = pTemp + (width * height);
+    uint8_t* const  pLine    = pZeroRow + width;
+    uint16_t* const pSums    = WTF::fastNewArray<uint16_t>(width);
 
-            pSource += srcbpp;
-            pDest   += dstbpp;
-        }
+    memset(pZeroRow, 0, width);
 
-        pSource += srcskip;
-        pDest   += dstskip;
+    BoxBlurColumns(pMask, stride, pTemp, width,  width, height, lobes[0], pSums, pZeroRow, pRowFunction);
+    BoxBlurColumns(pTemp, width,  pMask, stride, width, height, lobes[1], pSums, pZeroRow, pRowFunction);
+    BoxBlurColumns(pMask, stride, pTemp, width,  width, height, lobes[2], pSums, pZeroRow, pRowFunction);
+
+    for(int y = 0; y < height; ++y)
+    {
+        BoxBlurLine(pTemp + (y * width), pLine, width, lobes[0], GetBoxReciprocal(lobes[0]));
+        BoxBlurLine(pLine, pLine + width, width, lobes[1], GetBoxReciprocal(lobes[1]));
+        BoxBlurLine(pLine + width, pMask + (y * stride), width, lobes[2], GetBoxReciprocal(lobes[2]));
     }
+
+    WTF::fastDeleteArray<uint16_t>(pSums);
+    WTF::fastDeleteArray<uint8_t>(pTemp);
+
+	NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeDrawRaster, EA::WebKit::kVProcessStatusEnded);
 }
 
 
-// Non-alpha-blending blit of equivalent source/dest format.
-static void BlitCopy(const BlitInfo& info)
+///////////////////////////////////////////////////////////////////////
+// Scaled blits
+//
+// The source gets resampled a span of at most kScaleSpanSize dest pixels 
+// at a time into a buffer on the stack, which then goes through the same 
+// blit function as an unscaled blit of the source would. Source positions 
+// are 16.16 fixed point, with pixel centers at + 0.5.
+///////////////////////////////////////////////////////////////////////
+
+static const int kScaleSpanSize = 256;
+
+
+// Blends two pixels, two channels at a time. w is the weight of p1, from 0 to 256.
+static inline uint32_t LerpPixel(uint32_t p0, uint32_t p1, uint32_t w)
 {
-    int            w       = info.mnDWidth * info.mpDest->mPixelFormat.mBytesPerPixel;
-    int            h       = info.mnDHeight;
-    const uint8_t* pSource = info.mpSPixels;
-    uint8_t*       pDest   = info.mpDPixels;
-    const int      srcskip = w + info.mnSSkip;
-    const int      dstskip = w + info.mnDSkip;
+    const uint32_t w0 = 256 - w;
+    const uint32_t rb = ((((p0 & 0x00ff00ff) * w0) + ((p1 & 0x00ff00ff) * w) + 0x00800080) >> 8) & 0x00ff00ff;
+    const uint32_t ag = ((((p0 >> 8) & 0x00ff00ff) * w0) + (((p1 >> 8) & 0x00ff00ff) * w) + 0x00800080) & 0xff00ff00;
 
-    while(h--)
+    return rb | ag;
+}
+
+
+// Does one span of a bilinear scale. pRow0 and pRow1 are the source rows above and below the 
+// dest row and fy is the weight of pRow1. Dest pixel i is between source pixels pX[i] and 
+// pX[i] + 1, with pFx[i] the weight of the latter. Weights go from 0 to 256.
+typedef void (*BilinearSpanFunctionType)(const uint32_t* pRow0, const uint32_t* pRow1, uint32_t fy, const int* pX, const uint16_t* pFx, uint32_t* pDest, int count);
+
+static void BilinearSpan(const uint32_t* pRow0, const uint32_t* pRow1, uint32_t fy, const int* pX, const uint16_t* pFx, uint32_t* pDest, int count)
+{
+    for(int i = 0; i < count; ++i)
     {
-        memcpy(pDest, pSource, w);
+        const int      x = pX[i];
+        const uint32_t a = LerpPixel(pRow0[x],     pRow1[x],     fy);
+        const uint32_t b = LerpPixel(pRow0[x + 1], pRow1[x + 1], fy);
 
-        pSource += srcskip;
-        pDest   += dstskip;
+        pDest[i] = LerpPixel(a, b, pFx[i]);
     }
 }
 
 
-// Non-alpha-blending blit of equivalent source/dest format of a surface to itself.
-static void BlitCopyOverlap(const BlitInfo& info)
+// Adds the channels of count pixels to pSums, in the byte order of the pixels.
+typedef void (*SumPixelsFunctionType)(const uint32_t* pPixels, int count, uint32_t* pSums);
+
+static void SumPixels(const uint32_t* pPixels, int count, uint32_t* pSums)
 {
-    int            w       = info.mnDWidth * info.mpDest->mPixelFormat.mBytesPerPixel;
-    int            h       = info.mnDHeight;
-    const uint8_t* pSource = info.mpSPixels;
-    uint8_t*       pDest   = info.mpDPixels;
-    const int      srcskip = w + info.mnSSkip;
-    const int      dstskip = w + info.mnDSkip;
+    uint32_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
 
-    if (pDest < pSource)
+    for(int i = 0; i < count; ++i)
     {
-        while (h--)
-        {
-            memmove(pDest, pSource, w);
+        const uint32_t p = pPixels[i];
 
-            pSource += srcskip;
-            pDest   += dstskip;
-        }
+        s0 += p & 0xff;
+        s1 += (p >> 8) & 0xff;
+        s2 += (p >> 16) & 0xff;
+        s3 += p >> 24;
     }
-    else
-    {
-        // To do: Find a way to make this use memmove instead of revcpy. This might be possible
-        //        by simply always using the above pathway instead of this one.
-        pSource += ((h - 1) * srcskip);
-        pDest   += ((h - 1) * dstskip);
-
-        while (h--)
-        {
-            revcpy(pDest, pSource, w);
 
-            pSource -= srcskip;
-            pDest   -= dstskip;
-        }
-    }
+    pSums[0] += s0;
+    pSums[1] += s1;
+    pSums[2] += s2;
+    pSums[3] += s3;
 }
 
 
-// fast RGB888->(A)RGB888 blending with surface alpha
-static void BlitRGBtoRGBSurfaceAlpha(const BlitInfo& info)
+// Maps a source rect of size srcSize onto a dest rect of size destSize, one axis at a time.
+// Position(i) is the 16.16 source position of the center of dest pixel i, relative to the source rect.
+struct ScaleAxis
 {
-    unsigned        alpha   = info.mpSource->mPixelFormat.mSurfaceAlpha;
-    int             width   = info.mnDWidth;
-    int             height  = info.mnDHeight;
-    const uint32_t* pSrc    = (uint32_t*)info.mpSPixels;
-    int             srcskip = info.mnSSkip >> 2;
-    uint32_t*       pDst    = (uint32_t*)info.mpDPixels;
-    int             dstskip = info.mnDSkip >> 2;
-    uint32_t        s;
-    uint32_t        d;
-    uint32_t        s1;
-    uint32_t        d1;
-    
+    int64_t mStep;      // 16.16 source pixels per dest pixel.
+    int     mSrcSize;
+    int     mDestSize;
 
-    if(info.mDoAdditiveBlend)  
-    { 
-        const uint32_t sInvA = (255 - alpha);    
-        const uint32_t dAlpha = 0xff000000;
-        
-        while(height--)
-        {
-            // This can certainly be more optimized if needed...        
-            DUFFS_LOOP4({
-                s = *pSrc;
-                d = *pDst;
-                uint32_t sR = (s >> 16) & 0xff;
-                uint32_t sG = (s >> 8)  & 0xff;
-                uint32_t sB = s & 0xff;
+    ScaleAxis(int srcSize, int destSize) 
+        : mStep(((int64_t)srcSize << 16) / destSize), mSrcSize(srcSize), mDestSize(destSize) { }
 
-                uint32_t dR = (d >> 16) & 0xff;
-                uint32_t dG = (d >> 8)  & 0xff;
-                uint32_t dB = d & 0xff;
+    int64_t Position(int i) const { return (i * mStep) + (mStep >> 1); }
 
-                // Blend the fill color with the blend color 
-                uint32_t r = sR + ( (dR * sInvA) >> 8);
-                uint32_t g = sG + ( (dG * sInvA) >> 8);
-                uint32_t b = sB + ( (dB * sInvA) >> 8);
-                
-                // Overflow checking
-                if(r > 255)
-                    r = 255;
-                if(g > 255)
-                    g = 255;
-                if(b > 255)
-                    b = 255;
-              
-                // Store the blended color
-                *pDst = (dAlpha | (r << 16) | (g << 8) | b);
+    int Nearest(int i) const
+    {
+        const int x = (int)(Position(i) >> 16);
+        return (x < mSrcSize) ? x : (mSrcSize - 1);
+    }
 
-                ++pSrc;
-                ++pDst;
-            }, width);
+    // The pixel to the left of the sample point and the weight of the one to its right.
+    // The samples are kept within the source rect, so that nothing bleeds in from around it.
+    void Bilinear(int i, int& x, uint32_t& w) const
+    {
+        const int64_t p = Position(i) - 0x8000;
 
-            pSrc += srcskip;
-            pDst += dstskip;
+        if(p <= 0)
+        {
+            x = 0;
+            w = 0;
+        }
+        else if(p >= ((int64_t)(mSrcSize - 1) << 16))
+        {
+            x = mSrcSize - 2;
+            w = 256;
+        }
+        else
+        {
+            x = (int)(p >> 16);
+            w = (uint32_t)((p >> 8) & 0xff);
         }
     }
-    else
+
+    // The source pixels under dest pixel i, which are at least one.
+    void Box(int i, int& x0, int& x1) const
     {
-       while(height--)
-        {
-            DUFFS_LOOP_DOUBLE2({
-                // One pixel Blend
-                s = *pSrc;
-                d = *pDst;
-                s1 = s & 0x00ff00ff;
-                d1 = d & 0x00ff00ff;
-                d1 = (d1 + ((s1 - d1) * alpha >> 8)) & 0x00ff00ff;
-                s &= 0x0000ff00;
-                d &= 0x0000ff00;
-                d = (d + ((s - d) * alpha >> 8)) & 0x0000ff00;
-                *pDst = d1 | d | 0xff000000;
-                ++pSrc;
-                ++pDst;
-            },{
-                // Two Pixels Blend
-                s = *pSrc;
-                d = *pDst;
-                s1 = s & 0x00ff00ff;
-                d1 = d & 0x00ff00ff;
-                d1 += (s1 - d1) * alpha >> 8;
-                d1 &= 0x00ff00ff;
-                     
-                s = ((s & 0x0000ff00) >> 8) | ((pSrc[1] & 0x0000ff00) << 8);
-                d = ((d & 0x0000ff00) >> 8) | ((pDst[1] & 0x0000ff00) << 8);
-                d += (s - d) * alpha >> 8;
-                d &= 0x00ff00ff;
-                
-                *pDst++ = d1 | ((d << 8) & 0x0000ff00) | 0xff000000;
-                ++pSrc;
-                
-                s1 = *pSrc;
-                d1 = *pDst;
-                s1 &= 0x00ff00ff;
-                d1 &= 0x00ff00ff;
-                d1 += (s1 - d1) * alpha >> 8;
-                d1 &= 0x00ff00ff;
-                
-                *pDst = d1 | ((d >> 8) & 0x0000ff00) | 0xff000000;
+        x0 = (int)(((int64_t)i * mSrcSize) / mDestSize);
+        x1 = (int)(((int64_t)(i + 1) * mSrcSize) / mDestSize);
 
-                ++pSrc;
-                ++pDst;
-            }, width);
+        if(x1 <= x0)
+            x1 = x0 + 1;
+    }
+};
 
-            pSrc += srcskip;
-            pDst += dstskip;
-        }
+
+struct ScaledBlitInfo
+{
+    Surface*    mpSource;
+    Rect        mRectSource;    // Within the source surface.
+    Surface*    mpDest;
+    Rect        mRectDest;      // Where all of mRectSource goes, which can extend past the dest.
+    ScaleFilter mFilter;
+    bool        mbAdditive;
+    int         mOpacity;
+    bool        mbCopy;         // The dest is a new surface of the source's format, which gets the pixels as they are.
+};
+
+
+// A strong downscale skips most source pixels, so bilinear would alias. Averaging what is under each 
+// dest pixel doesn't. Bilinear also needs two pixels each way, so a single row or column gets sampled instead.
+static ScaleFilter GetScaleFilter(ScaleFilter filter, const Rect& rectSource, const Rect& rectDest)
+{
+    if(filter == kScaleFilterBilinear)
+    {
+        if(((rectDest.w * 2) < rectSource.w) || ((rectDest.h * 2) < rectSource.h))
+            return kScaleFilterBox;
+
+        if((rectSource.w < 2) || (rectSource.h < 2))
+            return kScaleFilterNearest;
     }
+
+    return filter;
 }
 
 
-// Fast ARGB -> ARGB blending with source pixel alpha.
-static void BlitRGBtoRGBPixelAlpha(const BlitInfo& info)
+// Draws the part of the scaled blit that lands in rect, which is within the dest surface.
+static void ScaledBlitRect(const ScaledBlitInfo& info, const Rect& rect, int opacity)
 {
-    int             width   = info.mnDWidth;
-    int             height  = info.mnDHeight;
-    const uint32_t* pSrc    = (uint32_t*)info.mpSPixels;
-    int             srcskip = info.mnSSkip >> 2;
-    uint32_t*       pDst    = (uint32_t*)info.mpDPixels;
-    int             dstskip = info.mnDSkip >> 2;
+    Surface* const pSource = info.mpSource;
+    Surface* const pDest   = info.mpDest;
 
-    if(info.mDoAdditiveBlend)  
-    { 
-        while(height--)
+    if(opacity <= 0)
+        return;
+
+    if(!info.mbCopy && !IsBlitFunctionSetUp(pSource, pDest))
+    {
+        if(!SetupBlitFunction(pSource, pDest))
+            return;
+    }
+
+    BlitFunctionType pBlitFunction = BlitCopy;
+
+    if(!info.mbCopy)
+        pBlitFunction = (opacity < 255) ? GetOpacityBlitFunction(pSource, pDest) : pSource->mpBlitFunction;
+
+    BilinearSpanFunctionType pBilinearFunction = BilinearSpan;
+    SumPixelsFunctionType    pSumFunction      = SumPixels;
+
+    #if SSE2_BLIT
+        if(HaveSSE2())
         {
-            // This is a bit slower then the            
-            DUFFS_LOOP4({
-                uint32_t d = *pDst;
-                uint32_t s = *pSrc;
-                uint32_t dalpha =  d & 0xff000000;
-                uint32_t alpha = (s >> 24);
-                // Note: Here we special-case opaque alpha since the
-                // compositioning used (>>8 instead of /255) doesn't handle
-                // it correctly. Also special-case alpha = 0 for speed?
+            pBilinearFunction = BilinearSpanSSE2;
+            pSumFunction      = SumPixelsSSE2;
+        }
+    #endif
 
-                if(!alpha)
-                {   
-                    // do nothing
-                }                
-                else if(!dalpha)
+    #if AVX2_BLIT
+        if(HaveAVX2())
+            pBilinearFunction = BilinearSpanAVX2;
+    #endif
+
+    const ScaleAxis axisX(info.mRectSource.w, info.mRectDest.w);
+    const ScaleAxis axisY(info.mRectSource.h, info.mRectDest.h);
+
+    const uint8_t* const pSourceOrigin = (const uint8_t*)pSource->mpData + (info.mRectSource.y * pSource->mStride) + (info.mRectSource.x * sizeof(uint32_t));
+    const int            destBpp       = pDest->mPixelFormat.mBytesPerPixel;
+
+    uint32_t span[kScaleSpanSize];
+    int      x0[kScaleSpanSize];
+    int      x1[kScaleSpanSize];
+    uint16_t fx[kScaleSpanSize];
+
+    BlitInfo blitInfo;
+    blitInfo.mpSource         = pSource;
+    blitInfo.mpSPixels        = (uint8_t*)span;
+    blitInfo.mnSHeight        = 1;
+    blitInfo.mnSSkip          = 0;
+    blitInfo.mpDest           = pDest;
+    blitInfo.mnDHeight        = 1;
+    blitInfo.mDoAdditiveBlend = info.mbAdditive;
+    blitInfo.mnOpacity        = opacity;
+
+    // Columns are done a span at a time, so the source positions are worked out once per span.
+    for(int spanX = rect.x; spanX < (rect.x + rect.w); spanX += kScaleSpanSize)
+    {
+        const int count = ((rect.x + rect.w) - spanX) < kScaleSpanSize ? ((rect.x + rect.w) - spanX) : kScaleSpanSize;
+        const int first = spanX - info.mRectDest.x;
+
+        for(int i = 0; i < count; ++i)
+        {
+            uint32_t w;
+
+            switch(info.mFilter)
+            {
+                case kScaleFilterNearest:
+                    x0[i] = axisX.Nearest(first + i);
+                    break;
+
+                case kScaleFilterBilinear:
+                    axisX.Bilinear(first + i, x0[i], w);
+                    fx[i] = (uint16_t)w;
+                    break;
+
+                case kScaleFilterBox:
+                    axisX.Box(first + i, x0[i], x1[i]);
+                    break;
+            }
+        }
+
+        blitInfo.mnSWidth = count;
+        blitInfo.mnDWidth = count;
+        blitInfo.mnDSkip  = pDest->mStride - (count * destBpp);
+
+        for(int y = rect.y; y < (rect.y + rect.h); ++y)
+        {
+            const int i = y - info.mRectDest.y;
+
+            switch(info.mFilter)
+            {
+                case kScaleFilterNearest:
                 {
-                    *pDst = s;
+                    const uint32_t* const pRow = (const uint32_t*)(pSourceOrigin + (axisY.Nearest(i) * pSource->mStride));
+
+                    for(int j = 0; j < count; ++j)
+                        span[j] = pRow[x0[j]];
+                    break;
                 }
-                else if(alpha == 255)
+
+                case kScaleFilterBilinear:
                 {
-                         *pDst = (s & 0x00ffffff) | dalpha;
+                    int      y0;
+                    uint32_t fy;
+
+                    axisY.Bilinear(i, y0, fy);
+
+                    const uint32_t* const pRow0 = (const uint32_t*)(pSourceOrigin + (y0 * pSource->mStride));
+                    pBilinearFunction(pRow0, (const uint32_t*)((const uint8_t*)pRow0 + pSource->mStride), fy, x0, fx, span, count);
+                    break;
                 }
-                else
+
+                case kScaleFilterBox:
                 {
-                    uint32_t sInvA = (255- alpha);    
+                    int y0, y1;
+                    axisY.Box(i, y0, y1);
 
-                    uint32_t sR = (s >> 16) & 0xff;
-                    uint32_t sG = (s >> 8)  & 0xff;
-                    uint32_t sB = s & 0xff;
+                    for(int j = 0; j < count; ++j)
+                    {
+                        const uint32_t area    = (uint32_t)((x1[j] - x0[j]) * (y1 - y0));
+                        uint32_t       sums[4] = { 0, 0, 0, 0 };
 
-                    uint32_t dR = (d >> 16) & 0xff;
-                    uint32_t dG = (d >> 8)  & 0xff;
-                    uint32_t dB = d & 0xff;
+                        for(int row = y0; row < y1; ++row)
+                            pSumFunction((const uint32_t*)(pSourceOrigin + (row * pSource->mStride)) + x0[j], x1[j] - x0[j], sums);
 
-                    // Blend the fill color with the blend color 
-                    uint32_t r = sR + ( (dR * sInvA) >> 8);
-                    uint32_t g = sG + ( (dG * sInvA) >> 8);
-                    uint32_t b = sB + ( (dB * sInvA) >> 8);
-                    
-                    // Overflow checking
-                    if(r > 255)
-                        r = 255;
-                    if(g > 255)
-                        g = 255;
-                    if(b > 255)
-                        b = 255;
-                  
-                    // Store the blended color
-                    *pDst = (dalpha | (r << 16) | (g << 8) | b);
+                        span[j] =  ((sums[0] + (area >> 1)) / area)        | 
+                                  (((sums[1] + (area >> 1)) / area) << 8)  | 
+                                  (((sums[2] + (area >> 1)) / area) << 16) | 
+                                  (((sums[3] + (area >> 1)) / area) << 24);
+                    }
+                    break;
                 }
-                ++pSrc;
-                ++pDst;
-            }, width);
+            }
 
-            pSrc += srcskip;
-            pDst += dstskip;
+            blitInfo.mpDPixels = (uint8_t*)pDest->mpData + (y * pDest->mStride) + (spanX * destBpp);
+            pBlitFunction(blitInfo);
         }
     }
-    else
-    {
-        while(height--)
-        {
-            DUFFS_LOOP4({
-                uint32_t s1;
-                uint32_t d1;
-                uint32_t d = *pDst;;
-                uint32_t s = *pSrc;
+}
 
-                uint32_t dalpha =  d & 0xff000000;;
-                uint32_t alpha = (s >> 24);
-                // Note: Here we special-case opaque alpha since the
-                // compositioning used (>>8 instead of /255) doesn't handle
-                // it correctly. Also special-case alpha = 0 for speed?
 
-                if(alpha)
-                {   
-                    // 7/24/09 CSidhall - added extra check for 0 alpha dest case
-                    if(!dalpha)
-                        *pDst = s;
-                    else if(alpha == 255)
-                         *pDst = (s & 0x00ffffff) | dalpha;
-                    else
-                    {
-                        // Take out the middle component (green), and process
+static void ClipScaledBlitRect(void* pContext, const Rect& rect, int coverage)
+{
+    const ScaledBlitInfo& info = *static_cast<const ScaledBlitInfo*>(pContext);
+
+    ScaledBlitRect(info, rect, (coverage == 255) ? info.mOpacity : (int)MODULATE_ALPHA((uint32_t)info.mOpacity, (uint32_t)coverage));
+}
+
+
+EARASTER_API int BlitScaled(Surface* pSource, const Rect* pRectSource, Surface* pDest, const Rect* pRectDest, const Rect* pDestClipRect, ScaleFilter filter, const bool additive, int opacity)
+{
+    EAW_ASSERT(pSource && pDest && (pSource != pDest));
+
+    const Rect sourceBounds(0, 0, pSource->mWidth, pSource->mHeight);
+    const Rect destBounds(0, 0, pDest->mWidth, pDest->mHeight);
+
+    ScaledBlitInfo info;
+    info.mpSource   = pSource;
+    info.mpDest     = pDest;
+    info.mRectDest  = pRectDest ? *pRectDest : destBounds;
+    info.mbAdditive = additive;
+    info.mOpacity   = (opacity < 255) ? opacity : 255;
+    info.mbCopy     = false;
+
+    // Unlike with Blit, a source rect that goes past the source isn't clipped, as that would change the scale.
+    if(pRectSource && !((pRectSource->x >= 0) && (pRectSource->y >= 0) && 
+                        ((pRectSource->x + pRectSource->w) <= pSource->mWidth) && ((pRectSource->y + pRectSource->h) <= pSource->mHeight)))
+        return -1;
+
+    info.mRectSource = pRectSource ? *pRectSource : sourceBounds;
+
+    if((info.mRectSource.w <= 0) || (info.mRectSource.h <= 0) || (info.mRectDest.w <= 0) || (info.mRectDest.h <= 0) || (info.mOpacity <= 0))
+        return 0;
+
+    if((info.mRectSource.w == info.mRectDest.w) && (info.mRectSource.h == info.mRectDest.h))
+        return Blit(pSource, &info.mRectSource, pDest, &info.mRectDest, pDestClipRect, additive, opacity);
+
+    if(pSource->mPixelFormat.mBytesPerPixel != 4)
+        return -1;
+
+    info.mFilter = GetScaleFilter(filter, info.mRectSource, info.mRectDest);
+
+    Rect rect;
+
+    if(!IntersectRect(info.mRectDest, pDest->mClipRect, rect) || !IntersectRect(rect, destBounds, rect))
+        return 0;
+
+    if(pDestClipRect && !IntersectRect(rect, *pDestClipRect, rect))
+        return 0;
+
+	NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeDrawRaster, EA::WebKit::kVProcessStatusStarted);
+
+    if(pDest->mpClipRegion)
+        pDest->mpClipRegion->ForEachRect(rect, ClipScaledBlitRect, &info);
+    else
+        ScaledBlitRect(info, rect, info.mOpacity);
+
+	NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeDrawRaster, EA::WebKit::kVProcessStatusEnded);
+
+    return 0;
+}
+
+
+EARASTER_API Surface* CreateScaledSurface(Surface* pSource, int width, int height, ScaleFilter filter)
+{
+    EAW_ASSERT(pSource);
+
+    if((pSource->mPixelFormat.mBytesPerPixel != 4) || (pSource->mWidth <= 0) || (pSource->mHeight <= 0) || (width <= 0) || (height <= 0))
+        return NULL;
+
+    Surface* const pScaledSurface = CreateSurface(width, height, pSource->mPixelFormat.mPixelFormatType);
+
+    if(pScaledSurface)
+    {
+        ScaledBlitInfo info;
+        info.mpSource    = pSource;
+        info.mRectSource = Rect(0, 0, pSource->mWidth, pSource->mHeight);
+        info.mpDest      = pScaledSurface;
+        info.mRectDest   = Rect(0, 0, width, height);
+        info.mFilter     = GetScaleFilter(filter, info.mRectSource, info.mRectDest);
+        info.mbAdditive  = false;
+        info.mOpacity    = 255;
+        info.mbCopy      = true;
+
+        ScaledBlitRect(info, info.mRectDest, 255);
+
+        // Filtering opaque pixels gives opaque pixels, so the copy blits without blending like the source does.
+        pScaledSurface->mSurfaceFlags |= (pSource->mSurfaceFlags & kFlagDisableAlpha);
+    }
+
+    return pScaledSurface;
+}
+
+
+struct ClipBlitContext
+{
+    Surface*    mpSource;
+    const Rect* mpRectSource;
+    Surface*    mpDest;
+    const Rect* mpRectDest;
+    bool        mbAdditive;
+    int         mOpacity;
+};
+
+
+// Blits the part of the source that lands in rect, a piece of the dest rect that is inside the clip region.
+static void ClipBlitRect(void* pContext, const Rect& rect, int coverage)
+{
+    const ClipBlitContext& context = *static_cast<const ClipBlitContext*>(pContext);
+    const Rect             rectSource(context.mpRectSource->x + (rect.x - context.mpRectDest->x), context.mpRectSource->y + (rect.y - context.mpRectDest->y), rect.w, rect.h);
+    const int              opacity = (coverage == 255) ? context.mOpacity : (int)MODULATE_ALPHA((uint32_t)context.mOpacity, (uint32_t)coverage);
+
+    BlitNoClip(context.mpSource, &rectSource, context.mpDest, &rect, context.mbAdditive, opacity);
+}
+
+
+EARASTER_API int Blit(Surface* pSource, const Rect* pRectSource, Surface* pDest, const Rect* pRectDest, const Rect* pDestClipRect, const bool additive, int opacity)
+{
+    EAW_ASSERT(pSource && pDest);
+
+    // If the source rectangle is NULL, use the entire source surface.
+    // If the destination rectangle is NULL, use the entire dest surface.
+
+    Rect rectSourceResult;
+    Rect rectDestResult;
+
+    if(ClipForBlit(pSource, pRectSource, pDest, pRectDest, rectSourceResult, rectDestResult))  // If there is anything to draw...
+    {
+        if(pDestClipRect)
+        {
+            // Test left side of clip rect to left side of dest rect.
+            int d = (pDestClipRect->x - rectDestResult.x);
+
+            if(d > 0)
+            {
+                rectDestResult.x   += d;
+                rectDestResult.w   -= d;
+                rectSourceResult.x += d;
+                rectSourceResult.w -= d;
+            }
+
+            // Test right side of clip rect to right side of dest rect.
+            d = (rectDestResult.x + rectDestResult.w) - (pDestClipRect->x + pDestClipRect->w);
+
+            if(d > 0)
+            {
+                rectDestResult.w   -= d;
+                rectSourceResult.w -= d;
+            }
+
+            // Test top side of clip rect to top side of dest rect.
+            d = (pDestClipRect->y - rectDestResult.y);
+
+            if(d > 0)
+            {
+                rectDestResult.y   += d;
+                rectDestResult.h   -= d;
+                rectSourceResult.y += d;
+                rectSourceResult.h -= d;
+            }
+
+            // Test bottom side of clip rect to bottom side of dest rect.
+            d = (rectDestResult.y + rectDestResult.h) - (pDestClipRect->y + pDestClipRect->h);
+
+            if(d > 0)
+            {
+                rectDestResult.h   -= d;
+                rectSourceResult.h -= d;
+            }
+
+            if((rectSourceResult.w <= 0) || (rectSourceResult.h <= 0))
+                return 0;
+        }
+
+        //Nicki Vankoughnett Stomp Fix:  
+        //it appears that it is possible at this piont for the pRectDest to cause us to attempt to draw out
+        //of bounds.  So lets constrain our pRectDest to the pDest surface mWidth and mHeight values.
+        EA::Raster::Rect destSurfaceConstraint(0,0,pDest->mWidth, pDest->mHeight);
+        destSurfaceConstraint.constrainRect(rectDestResult);
+        if(rectDestResult.w <= 0 || rectDestResult.h <= 0)
+            return 0;
+
+        if(pDest->mpClipRegion)
+        {
+            ClipBlitContext context = { pSource, &rectSourceResult, pDest, &rectDestResult, additive, opacity };
+            pDest->mpClipRegion->ForEachRect(rectDestResult, ClipBlitRect, &context);
+            return 0;
+        }
+
+        return BlitNoClip(pSource, &rectSourceResult, pDest, &rectDestResult, additive, opacity);
+    }
+
+    return 0;
+}
+
+
+EARASTER_API int BlitNoClip(Surface* pSource, const Rect* pRectSource, Surface* pDest, const Rect* pRectDest, const bool additive, int opacity)
+{
+    Rect rectSource; // Used if pRectSource is NULL.
+    Rect rectDest;   // Used if pRectDest is NULL.
+
+    // A fully transparent blit doesn't change anything.
+    if(opacity <= 0)
+        return 0;
+
+    // See if we need to set up the blit function.
+    // If we add the ability for the source or dest pixel format to change, 
+    // then we'll need to add a change detection mechanism.
+    if(!IsBlitFunctionSetUp(pSource, pDest))
+    {
+        if(!SetupBlitFunction(pSource, pDest))
+            return -1;
+    }
+
+    // 11/09/09 CSidhall Added notify start of process to user
+	NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeDrawRaster, EA::WebKit::kVProcessStatusStarted);
+	
+	if(!pRectSource)
+    {
+        rectSource.x = 0;
+        rectSource.y = 0;
+        rectSource.w = pSource->mWidth;
+        rectSource.h = pSource->mHeight;
+
+        pRectSource = &rectSource;
+    }
+
+    if(!pRectDest)
+    {
+        rectDest.x = 0;
+        rectDest.y = 0;
+        rectDest.w = pDest->mWidth;     // To do: Define the the behaviour for the case of (pRectSource->w != pRectDest->w).
+        rectDest.h = pDest->mHeight;
+
+        pRectDest = &rectDest;
+    }
+
+    //Nicki Vankoughnett:
+    //Avoid any chance of having a dest rect that cannot fit on the dest surface.
+    EAW_ASSERT(pRectDest->x >=  0 && pRectDest->x <= pDest->mWidth);
+    EAW_ASSERT((pRectDest->x + pRectDest->w) >=  0 && (pRectDest->x + pRectDest->w) <= pDest->mWidth);
+    EAW_ASSERT(pRectDest->y >=  0 && pRectDest->y <= pDest->mHeight);    // 3/10/09 CSidhall - Typo fix to mHeight instead of mWidth
+    EAW_ASSERT((pRectDest->y + pRectDest->h) >=  0 && (pRectDest->y + pRectDest->h) <= pDest->mHeight);
+
+    // Blits are done through a BlitFunction pointer. 
+    // The blit function takes a BlitInfo struct to encapsulate all parameters.
+    BlitInfo blitInfo;
+
+    blitInfo.mpSource  = pSource;
+    blitInfo.mpSPixels = (uint8_t*)pSource->mpData + (pRectSource->y * pSource->mStride) + (pRectSource->x * pSource->mPixelFormat.mBytesPerPixel);
+    blitInfo.mnSWidth  = pRectSource->w;
+    blitInfo.mnSHeight = pRectSource->h;
+    blitInfo.mnSSkip   = pSource->mStride - (blitInfo.mnSWidth * pSource->mPixelFormat.mBytesPerPixel);
+
+    blitInfo.mpDest    = pDest;
+    blitInfo.mpDPixels = (uint8_t*)pDest->mpData + (pRectDest->y * pDest->mStride) + (pRectDest->x * pDest->mPixelFormat.mBytesPerPixel);
+    blitInfo.mnDWidth  = pRectDest->w;
+    blitInfo.mnDHeight = pRectDest->h;
+    blitInfo.mnDSkip   = pDest->mStride - (blitInfo.mnDWidth * pDest->mPixelFormat.mBytesPerPixel);
+    blitInfo.mDoAdditiveBlend = additive;
+    blitInfo.mnOpacity = (opacity < 255) ? opacity : 255;
+
+    // The opacity blits aren't cached in the surface, as the same surface is usually
+    // drawn both with and without opacity.
+    if(blitInfo.mnOpacity < 255)
+        GetOpacityBlitFunction(pSource, pDest)(blitInfo);
+    else if(!pSource->mpAlphaRows || !BlitAlphaRows(blitInfo, *pRectSource))
+        pSource->mpBlitFunction(blitInfo);
+
+	NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeDrawRaster, EA::WebKit::kVProcessStatusEnded);
+
+	return 0;
+}
+
+
+EARASTER_API bool SetupBlitFunction(Surface* pSource, Surface* pDest)
+{
+    pSource->mpBlitDest     = pDest;
+    pSource->mDrawFlags     = 0;
+    pSource->mpBlitFunction = BlitNtoN;  // Initial default.
+
+    const bool bIdenticalFormats = (pSource->mPixelFormat.mPixelFormatType == pDest->mPixelFormat.mPixelFormatType);
+    const bool bSourceHasAlpha   = (pSource->mPixelFormat.mAMask != 0);
+    const bool bDestHasAlpha     = (pDest->mPixelFormat.mAMask != 0);
+    const bool bEnableAlphaBlend = (pSource->mSurfaceFlags & kFlagDisableAlpha) == 0;
+    const bool bSurfaceAlpha     = (pSource->mPixelFormat.mSurfaceAlpha != 0xff);
+    const bool bBlitAlpha        = (bEnableAlphaBlend && (bSourceHasAlpha || bSurfaceAlpha));
+
+    if(bIdenticalFormats)
+        pSource->mDrawFlags |= kDrawFlagIdenticalFormats;
+
+    // Blends into a dest that builds up its alpha have their own blitter, which takes any source format. 
+    // Copies are the same as for other dests.
+    if(AccumulatesAlpha(pDest))
+    {
+        pSource->mDrawFlags |= kDrawFlagAccumulateAlpha;
+
+        if(bBlitAlpha)
+        {
+            pSource->mpBlitFunction = BlitNtoAccumulatedAlpha;
+            return true;
+        }
+    }
+
+    // Blits to and from 16 bit surfaces, other than plain copies, convert through ARGB in their own blitters.
+    if((pSource->mPixelFormat.mBytesPerPixel == 2) || (pDest->mPixelFormat.mBytesPerPixel == 2))
+    {
+        if(!bBlitAlpha && bIdenticalFormats)
+            pSource->mpBlitFunction = (pSource == pDest) ? BlitCopyOverlap : BlitCopy;
+        else
+            pSource->mpBlitFunction = (pDest->mPixelFormat.mBytesPerPixel == 2) ? BlitNto16 : BlitUnpackedtoN;
+
+        return true;
+    }
+
+    // Premultiplied sources have their own blends, which take half the multiplies of the straight alpha ones.
+    if(bBlitAlpha && (pSource->mPixelFormat.mPixelFormatType == kPixelFormatTypePARGB))
+    {
+        pSource->mpBlitFunction = GetPremultipliedBlitFunction(pSource, pDest);
+        return true;
+    }
+
+    // If we are using a non-alpha copy between identical pixel formats, use a copy blit.
+    if(!bBlitAlpha && bIdenticalFormats)
+    {
+        pSource->mpBlitFunction = BlitCopy;
+
+        if (pSource == pDest)
+            pSource->mpBlitFunction = BlitCopyOverlap;
+    }
+    else
+    {
+        if(bBlitAlpha)
+        {
+            const PixelFormat& sf = pSource->mPixelFormat;
+            const PixelFormat& df = pDest->mPixelFormat;
+
+            if(sf.mAMask == 0)  // If source doesn't have alpha...
+            {
+                // Per-surface alpha blits
+                switch(df.mBytesPerPixel)
+                {
+                    case 4:
+                    {
+                        if((sf.mRMask == df.mRMask) &&
+                           (sf.mGMask == df.mGMask) &&
+                           (sf.mBMask == df.mBMask) &&
+                           (sf.mBytesPerPixel == 4))
+                        {
+                            #if AVX2_BLIT
+                                if(((sf.mRMask | sf.mGMask | sf.mBMask) == 0x00ffffff) && HaveAVX2())
+                                {
+                                    pSource->mpBlitFunction = BlitRGBtoRGBSurfaceAlphaAVX2;
+                                    break;
+                                }
+                            #endif
+
+                            #if SSE2_BLIT
+                                if(((sf.mRMask | sf.mGMask | sf.mBMask) == 0x00ffffff) && HaveSSE2())
+                                {
+                                    pSource->mpBlitFunction = BlitRGBtoRGBSurfaceAlphaSSE2;
+                                    break;
+                                }
+                            #endif
+
+                            #if MMX_ASMBLIT
+                                if(HaveMMX())
+                                {
+                                    pSource->mpBlitFunction = BlitRGBtoRGBSurfaceAlphaMMX;
+                                    break;
+                                }
+                            #endif
+
+                            if((sf.mRMask | sf.mGMask | sf.mBMask) == 0x00ffffff)
+                            {
+                                #if ALTIVEC_BLIT
+                                    if(HaveAltiVec())
+                                        pSource->mpBlitFunction = BlitRGBtoRGBSurfaceAlphaAltivec;
+                                    else
+                                #endif
+                                        pSource->mpBlitFunction = BlitRGBtoRGBSurfaceAlpha;
+                                break;
+                            }
+                        }
+
+                        #if ALTIVEC_BLIT
+                            if(HaveAltiVec())
+                                pSource->mpBlitFunction = Blit32to32SurfaceAlphaAltivec;
+                            else
+                        #endif
+                                pSource->mpBlitFunction = BlitNtoNSurfaceAlpha;
+                        break;
+                    }
+
+                    case 3:
+                    default:
+                        pSource->mpBlitFunction = BlitNtoNSurfaceAlpha;
+                        break;
+                }
+            }
+            else // Else source has alpha.
+            {
+                // Per-pixel alpha blits
+                switch(df.mBytesPerPixel)
+                {
+                    case 4:
+                        if((sf.mRMask == df.mRMask) && 
+                           (sf.mGMask == df.mGMask) && 
+                           (sf.mBMask == df.mBMask) && 
+                           (sf.mBytesPerPixel == 4))
+                        {
+                            #if AVX2_BLIT
+                                if((sf.mAMask == 0xff000000) && HaveAVX2())
+                                {
+                                    pSource->mpBlitFunction = BlitRGBtoRGBPixelAlphaAVX2;
+                                    break;
+                                }
+                            #endif
+
+                            #if SSE2_BLIT
+                                if((sf.mAMask == 0xff000000) && HaveSSE2())
+                                {
+                                    pSource->mpBlitFunction = BlitRGBtoRGBPixelAlphaSSE2;
+                                    break;
+                                }
+                            #endif
+
+                            #if MMX_ASMBLIT
+                                if(Have3DNow())
+                                {
+                                    pSource->mpBlitFunction = BlitRGBtoRGBPixelAlphaMMX3DNOW;
+                                    break;
+                                }
+
+                                if(HaveMMX())
+                                {
+                                    pSource->mpBlitFunction = BlitRGBtoRGBPixelAlphaMMX;
+                                    break;
+                                }
+                            #endif
+
+                            if(sf.mAMask == 0xff000000)
+                            {
+                                #if ALTIVEC_BLIT
+                                    if(HaveAltiVec())
+                                        pSource->mpBlitFunction = BlitRGBtoRGBPixelAlphaAltivec;
+                                    else
+                                #endif
+                                        pSource->mpBlitFunction = BlitRGBtoRGBPixelAlpha;
+
+                                break;
+                            }
+                        }
+
+                        #if ALTIVEC_BLIT
+                            if(HaveAltiVec())
+                                pSource->mpBlitFunction = Blit32to32PixelAlphaAltivec;
+                            else
+                        #endif
+                                pSource->mpBlitFunction = BlitNtoNPixelAlpha;
+                        break;
+
+                    case 3:
+                    default:
+                        pSource->mpBlitFunction = BlitNtoNPixelAlpha;
+                        break;
+                }
+            }
+        }
+        else
+        {
+            // To do: Come up with a better default value.
+            pSource->mpBlitFunction = BlitNtoN;
+
+            if(pSource->mpBlitFunction == BlitNtoN)
+            {
+                // Fastpath C fallback: 32bit RGB<->RGBA blit with matching RGB.
+                if ((pSource->mPixelFormat.mBytesPerPixel == 4) && 
+                    (pDest->mPixelFormat.mBytesPerPixel == 4) &&
+                    (pSource->mPixelFormat.mRMask == pDest->mPixelFormat.mRMask) &&
+                    (pSource->mPixelFormat.mGMask == pDest->mPixelFormat.mGMask) &&
+                    (pSource->mPixelFormat.mBMask == pDest->mPixelFormat.mBMask) )
+                {
+                    pSource->mpBlitFunction = Blit4to4MaskAlpha;
+                }
+                else if (bDestHasAlpha)
+                    pSource->mpBlitFunction = BlitNtoNCopyAlpha;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+// Whether the source alpha channel takes part in blending. If not, the source is treated as opaque.
+static inline bool SourceAlphaEnabled(const Surface* pSource)
+{
+    return (pSource->mPixelFormat.mAMask != 0) && ((pSource->mSurfaceFlags & kFlagDisableAlpha) == 0);
+}
+
+
+// Whether blends into pDest build up its alpha. See kFlagAccumulateAlpha.
+static bool AccumulatesAlpha(const Surface* pDest)
+{
+    return ((pDest->mSurfaceFlags & kFlagAccumulateAlpha) != 0) && (pDest->mPixelFormat.mPixelFormatType == kPixelFormatTypeARGB);
+}
+
+
+// Whether the blit function cached in pSource is the one for pDest. A dest that gets reused, 
+// such as a pooled surface, can have had kFlagAccumulateAlpha changed since it was set up.
+static bool IsBlitFunctionSetUp(const Surface* pSource, const Surface* pDest)
+{
+    return (pSource->mpBlitDest == pDest) && pSource->mpBlitFunction && 
+           (((pSource->mDrawFlags & kDrawFlagAccumulateAlpha) != 0) == AccumulatesAlpha(pDest));
+}
+
+
+// Returns the blit function to use for a blit with an opacity of less than 255.
+static BlitFunctionType GetOpacityBlitFunction(const Surface* pSource, const Surface* pDest)
+{
+    const PixelFormat& sf = pSource->mPixelFormat;
+    const PixelFormat& df = pDest->mPixelFormat;
+
+    if(AccumulatesAlpha(pDest))
+        return BlitNtoAccumulatedAlpha;
+
+    // The 16 bit blitters always apply the opacity.
+    if(df.mBytesPerPixel == 2)
+        return BlitNto16;
+
+    if(sf.mBytesPerPixel == 2)
+        return BlitUnpackedtoN;
+
+    if((sf.mPixelFormatType == kPixelFormatTypePARGB) && SourceAlphaEnabled(pSource))
+        return GetPremultipliedBlitFunction(pSource, pDest);
+
+    if((sf.mBytesPerPixel == 4) && (df.mBytesPerPixel == 4) &&
+       (sf.mRMask == df.mRMask) && 
+       (sf.mGMask == df.mGMask) && 
+       (sf.mBMask == df.mBMask) &&
+       ((sf.mRMask | sf.mGMask | sf.mBMask) == 0x00ffffff) &&
+       ((sf.mAMask == 0xff000000) || (sf.mAMask == 0)))
+    {
+        #if AVX2_BLIT
+            if(HaveAVX2())
+                return BlitRGBtoRGBOpacityAVX2;
+        #endif
+
+        #if SSE2_BLIT
+            if(HaveSSE2())
+                return BlitRGBtoRGBOpacitySSE2;
+        #endif
+
+        return BlitRGBtoRGBOpacity;
+    }
+
+    return BlitNtoNOpacity;
+}
+
+
+// Returns the blit function for a premultiplied ARGB source with alpha blending. 
+// These all apply info.mnOpacity, so they serve for the opacity blits as well.
+static BlitFunctionType GetPremultipliedBlitFunction(const Surface* pSource, const Surface* pDest)
+{
+    const PixelFormat& sf = pSource->mPixelFormat;
+    const PixelFormat& df = pDest->mPixelFormat;
+
+    if(df.mBytesPerPixel == 2)
+        return BlitNto16;
+
+    if((df.mBytesPerPixel == 4) &&
+       (sf.mRMask == df.mRMask) && 
+       (sf.mGMask == df.mGMask) && 
+       (sf.mBMask == df.mBMask))
+    {
+        #if AVX2_BLIT
+            if(HaveAVX2())
+                return BlitPARGBtoRGBAVX2;
+        #endif
+
+        #if SSE2_BLIT
+            if(HaveSSE2())
+                return BlitPARGBtoRGBSSE2;
+        #endif
+
+        return BlitPARGBtoRGB;
+    }
+
+    return BlitUnpackedtoN;
+}
+
+
+// Returns a blit function that writes opaque source pixels the way blending them would, 
+// or NULL if there isn't one that is cheaper than the blend.
+static BlitFunctionType GetOpaqueBlitFunction(const Surface* pSource, const Surface* pDest)
+{
+    const PixelFormat& sf = pSource->mPixelFormat;
+    const PixelFormat& df = pDest->mPixelFormat;
+
+    if((sf.mBytesPerPixel != 4) || (df.mBytesPerPixel != 4) ||
+       (sf.mRMask != df.mRMask) || 
+       (sf.mGMask != df.mGMask) || 
+       (sf.mBMask != df.mBMask))
+        return NULL;
+
+    // An opaque premultiplied pixel is the same as a straight one, so those copy as they are.
+    if(sf.mAMask == df.mAMask)
+        return BlitCopy;
+
+    return Blit4to4MaskAlpha;
+}
+
+
+// Gets the part of the opaque run of row that is within x1 to x2, relative to x1, 
+// or an empty run at 0 if there is none. Returns whether the row is transparent.
+static inline bool GetOpaqueRun(const AlphaRow& row, int x1, int x2, int& begin, int& end)
+{
+    begin = (row.mOpaqueBegin > x1) ? row.mOpaqueBegin : x1;
+    end   = (row.mOpaqueEnd   < x2) ? row.mOpaqueEnd   : x2;
+
+    if(begin < end)
+    {
+        begin -= x1;
+        end   -= x1;
+    }
+    else
+        begin = end = 0;
+
+    return row.mbTransparent;
+}
+
+
+// Blits the width x height part of info that starts at (x, y) within it.
+static inline void BlitPart(const BlitInfo& info, int x, int y, int width, int height, BlitFunctionType pBlitFunction)
+{
+    if(width <= 0)
+        return;
+
+    const int sBytesPerPixel = info.mpSource->mPixelFormat.mBytesPerPixel;
+    const int dBytesPerPixel = info.mpDest->mPixelFormat.mBytesPerPixel;
+    const int sStride        = (info.mnSWidth * sBytesPerPixel) + info.mnSSkip;
+    const int dStride        = (info.mnDWidth * dBytesPerPixel) + info.mnDSkip;
+
+    BlitInfo part(info);
+
+    part.mpSPixels = info.mpSPixels + (y * sStride) + (x * sBytesPerPixel);
+    part.mnSWidth  = width;
+    part.mnSHeight = height;
+    part.mnSSkip   = sStride - (width * sBytesPerPixel);
+
+    part.mpDPixels = info.mpDPixels + (y * dStride) + (x * dBytesPerPixel);
+    part.mnDWidth  = width;
+    part.mnDHeight = height;
+    part.mnDSkip   = dStride - (width * dBytesPerPixel);
+
+    pBlitFunction(part);
+}
+
+
+// Blits a source that has alpha rows (see Surface::mpAlphaRows) in bands of rows with the same opaque 
+// run within the blit. The opaque runs are copied, only the pixels on either side of them are blended 
+// and transparent rows are skipped. Returns false if the blit can't be done this way.
+static bool BlitAlphaRows(const BlitInfo& info, const Rect& rectSource)
+{
+    const Surface* const pSource = info.mpSource;
+
+    if(info.mDoAdditiveBlend || !SourceAlphaEnabled(pSource) || (pSource->mPixelFormat.mSurfaceAlpha != 0xff) || (pSource == info.mpDest) ||
+       (info.mnSWidth != info.mnDWidth) || (info.mnSHeight != info.mnDHeight))
+        return false;
+
+    const BlitFunctionType pOpaqueFunction = GetOpaqueBlitFunction(pSource, info.mpDest);
+
+    if(!pOpaqueFunction)
+        return false;
+
+    const BlitFunctionType pBlendFunction = pSource->mpBlitFunction;
+    const AlphaRow* const  pRows          = pSource->mpAlphaRows + rectSource.y;
+    const int              x1             = rectSource.x;
+    const int              x2             = rectSource.x + info.mnSWidth;
+    int                    y              = 0;
+
+    while(y < info.mnSHeight)
+    {
+        int begin, end, nextBegin, nextEnd;
+        const bool bTransparent = GetOpaqueRun(pRows[y], x1, x2, begin, end);
+        int        bandEnd      = y + 1;
+
+        while((bandEnd < info.mnSHeight) && 
+              (GetOpaqueRun(pRows[bandEnd], x1, x2, nextBegin, nextEnd) == bTransparent) && 
+              (nextBegin == begin) && (nextEnd == end))
+        {
+            bandEnd++;
+        }
+
+        if(!bTransparent)
+        {
+            BlitPart(info, 0,     y, begin,                bandEnd - y, pBlendFunction);
+            BlitPart(info, begin, y, end - begin,          bandEnd - y, pOpaqueFunction);
+            BlitPart(info, end,   y, info.mnSWidth - end,  bandEnd - y, pBlendFunction);
+        }
+
+        y = bandEnd;
+    }
+
+    return true;
+}
+
+
+// Blits 32 bit RGB <-> RGBA with both surfaces having the same R,G,B fields
+static void Blit4to4MaskAlpha(const BlitInfo& info)
+{
+    const int           width   = info.mnDWidth;
+    int                 height  = info.mnDHeight;
+    const uint32_t*     pSource = (uint32_t*)info.mpSPixels;
+    const int           srcskip = info.mnSSkip;
+    uint32_t*           pDest   = (uint32_t*)info.mpDPixels;
+    const int           dstskip = info.mnDSkip;
+    const PixelFormat&  srcfmt  = info.mpSource->mPixelFormat;
+    const PixelFormat&  dstfmt  = info.mpDest->mPixelFormat;
+
+    if (dstfmt.mAMask)
+    {
+        // RGB->RGBA, SET_ALPHA
+        const uint32_t aMask = (dstfmt.mSurfaceAlpha << dstfmt.mAShift);
+
+        while (height--)
+        {
+            DUFFS_LOOP(
+            {
+                *pDest = *pSource | aMask;
+
+                ++pSource;
+                ++pDest;
+            }, width);
+
+            pSource = (uint32_t*)((uint8_t*)pSource + srcskip);
+            pDest   = (uint32_t*)((uint8_t*)pDest + dstskip);
+        }
+    }
+    else
+    {
+        // RGBA->RGB, NO_ALPHA
+        const uint32_t rgbMask = (srcfmt.mRMask | srcfmt.mGMask | srcfmt.mBMask);
+
+        while (height--)
+        {
+            DUFFS_LOOP(
+            {
+                *pDest = *pSource & rgbMask;
+
+                ++pSource;
+                ++pDest;
+            }, width);
+
+            pSource = (uint32_t*)((uint8_t*)pSource + srcskip);
+            pDest   = (uint32_t*)((uint8_t*)pDest   + dstskip);
+        }
+    }
+}
+
+
+// Non-alpha-blending blit of source and dest of different formats. Generic but slow.
+static void BlitNtoN(const BlitInfo& info)
+{
+    const int           width   = info.mnDWidth;
+    int                 height  = info.mnDHeight;
+    const uint8_t*      pSource = info.mpSPixels;
+    const int           srcskip = info.mnSSkip;
+    uint8_t*            pDest   = info.mpDPixels;
+    const int           dstskip = info.mnDSkip;
+    const PixelFormat&  srcfmt  = info.mpSource->mPixelFormat;
+    const int           srcbpp  = srcfmt.mBytesPerPixel;
+    const PixelFormat&  dstfmt  = info.mpDest->mPixelFormat;
+    const int           dstbpp  = dstfmt.mBytesPerPixel;
+    const unsigned      alpha   = (dstfmt.mPixelFormatType == kPixelFormatTypeRGB) ? 0 : srcfmt.mSurfaceAlpha;
+
+    while (height--)
+    {
+        DUFFS_LOOP(
+        {
+            uint32_t pixel;
+            unsigned sR;
+            unsigned sG;
+            unsigned sB;
+
+            DISEMBLE_RGB(pSource, srcbpp, srcfmt, pixel, sR, sG, sB);
+            ASSEMBLE_RGBA(pDest, dstbpp, dstfmt, sR, sG, sB, alpha);
+
+            pSource += srcbpp;
+            pDest   += dstbpp;
+        }, width);
+
+        pSource += srcskip;
+        pDest   += dstskip;
+    }
+}
+
+
+static void BlitNtoNCopyAlpha(const BlitInfo& info)
+{
+    const int           width   = info.mnDWidth;
+    int                 height  = info.mnDHeight;
+    const uint8_t*      pSource = info.mpSPixels;
+    const int           srcskip = info.mnSSkip;
+    uint8_t*            pDest   = info.mpDPixels;
+    const int           dstskip = info.mnDSkip;
+    const PixelFormat&  srcfmt  = info.mpSource->mPixelFormat;
+    const int           srcbpp  = srcfmt.mBytesPerPixel;
+    const PixelFormat&  dstfmt  = info.mpDest->mPixelFormat;
+    const int           dstbpp  = dstfmt.mBytesPerPixel;
+
+    // To do: Should map alpha to [0..255] correctly.
+    while (height--)
+    {
+        for (int c = width; c; --c)
+        {
+            uint32_t pixel;
+            unsigned sR, sG, sB, sA;
+
+            DISEMBLE_RGBA(pSource, srcbpp, srcfmt, pixel, sR, sG, sB, sA);
+            ASSEMBLE_RGBA(pDest,   dstbpp, dstfmt,        sR, sG, sB, sA);
+
+            pSource += srcbpp;
+            pDest   += dstbpp;
+        }
+
+        pSource += srcskip;
+        pDest   += dstskip;
+    }
+}
+
+
+// Non-alpha-blending blit of equivalent source/dest format.
+static void BlitCopy(const BlitInfo& info)
+{
+    int            w       = info.mnDWidth * info.mpDest->mPixelFormat.mBytesPerPixel;
+    int            h       = info.mnDHeight;
+    const uint8_t* pSource = info.mpSPixels;
+    uint8_t*       pDest   = info.mpDPixels;
+    const int      srcskip = w + info.mnSSkip;
+    const int      dstskip = w + info.mnDSkip;
+
+    while(h--)
+    {
+        memcpy(pDest, pSource, w);
+
+        pSource += srcskip;
+        pDest   += dstskip;
+    }
+}
+
+
+// Non-alpha-blending blit of equivalent source/dest format of a surface to itself.
+static void BlitCopyOverlap(const BlitInfo& info)
+{
+    int            w       = info.mnDWidth * info.mpDest->mPixelFormat.mBytesPerPixel;
+    int            h       = info.mnDHeight;
+    const uint8_t* pSource = info.mpSPixels;
+    uint8_t*       pDest   = info.mpDPixels;
+    const int      srcskip = w + info.mnSSkip;
+    const int      dstskip = w + info.mnDSkip;
+
+    if (pDest < pSource)
+    {
+        while (h--)
+        {
+            memmove(pDest, pSource, w);
+
+            pSource += srcskip;
+            pDest   += dstskip;
+        }
+    }
+    else
+    {
+        // Walk the rows bottom up so we don't overwrite source rows before they are copied.
+        // memmove takes care of the overlap within a row (e.g. a horizontal scroll).
+        pSource += ((h - 1) * srcskip);
+        pDest   += ((h - 1) * dstskip);
+
+        while (h--)
+        {
+            memmove(pDest, pSource, w);
+
+            pSource -= srcskip;
+            pDest   -= dstskip;
+        }
+    }
+}
+
+
+// fast RGB888->(A)RGB888 blending with surface alpha
+static void BlitRGBtoRGBSurfaceAlpha(const BlitInfo& info)
+{
+    unsigned        alpha   = info.mpSource->mPixelFormat.mSurfaceAlpha;
+    int             width   = info.mnDWidth;
+    int             height  = info.mnDHeight;
+    const uint32_t* pSrc    = (uint32_t*)info.mpSPixels;
+    int             srcskip = info.mnSSkip >> 2;
+    uint32_t*       pDst    = (uint32_t*)info.mpDPixels;
+    int             dstskip = info.mnDSkip >> 2;
+    uint32_t        s;
+    uint32_t        d;
+    uint32_t        s1;
+    uint32_t        d1;
+    
+
+    if(info.mDoAdditiveBlend)  
+    { 
+        const uint32_t sInvA = (255 - alpha);    
+        const uint32_t dAlpha = 0xff000000;
+        
+        while(height--)
+        {
+            // This can certainly be more optimized if needed...        
+            DUFFS_LOOP4({
+                s = *pSrc;
+                d = *pDst;
+                uint32_t sR = (s >> 16) & 0xff;
+                uint32_t sG = (s >> 8)  & 0xff;
+                uint32_t sB = s & 0xff;
+
+                uint32_t dR = (d >> 16) & 0xff;
+                uint32_t dG = (d >> 8)  & 0xff;
+                uint32_t dB = d & 0xff;
+
+                // Blend the fill color with the blend color 
+                uint32_t r = sR + ( (dR * sInvA) >> 8);
+                uint32_t g = sG + ( (dG * sInvA) >> 8);
+                uint32_t b = sB + ( (dB * sInvA) >> 8);
+                
+                // Overflow checking
+                if(r > 255)
+                    r = 255;
+                if(g > 255)
+                    g = 255;
+                if(b > 255)
+                    b = 255;
+              
+                // Store the blended color
+                *pDst = (dAlpha | (r << 16) | (g << 8) | b);
+
+                ++pSrc;
+                ++pDst;
+            }, width);
+
+            pSrc += srcskip;
+            pDst += dstskip;
+        }
+    }
+    else
+    {
+       while(height--)
+        {
+            DUFFS_LOOP_DOUBLE2({
+                // One pixel Blend
+                s = *pSrc;
+                d = *pDst;
+                s1 = s & 0x00ff00ff;
+                d1 = d & 0x00ff00ff;
+                d1 = (d1 + ((s1 - d1) * alpha >> 8)) & 0x00ff00ff;
+                s &= 0x0000ff00;
+                d &= 0x0000ff00;
+                d = (d + ((s - d) * alpha >> 8)) & 0x0000ff00;
+                *pDst = d1 | d | 0xff000000;
+                ++pSrc;
+                ++pDst;
+            },{
+                // Two Pixels Blend
+                s = *pSrc;
+                d = *pDst;
+                s1 = s & 0x00ff00ff;
+                d1 = d & 0x00ff00ff;
+                d1 += (s1 - d1) * alpha >> 8;
+                d1 &= 0x00ff00ff;
+                     
+                s = ((s & 0x0000ff00) >> 8) | ((pSrc[1] & 0x0000ff00) << 8);
+                d = ((d & 0x0000ff00) >> 8) | ((pDst[1] & 0x0000ff00) << 8);
+                d += (s - d) * alpha >> 8;
+                d &= 0x00ff00ff;
+                
+                *pDst++ = d1 | ((d << 8) & 0x0000ff00) | 0xff000000;
+                ++pSrc;
+                
+                s1 = *pSrc;
+                d1 = *pDst;
+                s1 &= 0x00ff00ff;
+                d1 &= 0x00ff00ff;
+                d1 += (s1 - d1) * alpha >> 8;
+                d1 &= 0x00ff00ff;
+                
+                *pDst = d1 | ((d >> 8) & 0x0000ff00) | 0xff000000;
+
+                ++pSrc;
+                ++pDst;
+            }, width);
+
+            pSrc += srcskip;
+            pDst += dstskip;
+        }
+    }
+}
+
+
+// Fast ARGB -> ARGB blending with source pixel alpha.
+static void BlitRGBtoRGBPixelAlpha(const BlitInfo& info)
+{
+    int             width   = info.mnDWidth;
+    int             height  = info.mnDHeight;
+    const uint32_t* pSrc    = (uint32_t*)info.mpSPixels;
+    int             srcskip = info.mnSSkip >> 2;
+    uint32_t*       pDst    = (uint32_t*)info.mpDPixels;
+    int             dstskip = info.mnDSkip >> 2;
+
+    if(info.mDoAdditiveBlend)  
+    { 
+        while(height--)
+        {
+            // This is a bit slower then the            
+            DUFFS_LOOP4({
+                uint32_t d = *pDst;
+                uint32_t s = *pSrc;
+                uint32_t dalpha =  d & 0xff000000;
+                uint32_t alpha = (s >> 24);
+                // Note: Here we special-case opaque alpha since the
+                // compositioning used (>>8 instead of /255) doesn't handle
+                // it correctly. Also special-case alpha = 0 for speed?
+
+                if(!alpha)
+                {   
+                    // do nothing
+                }                
+                else if(!dalpha)
+                {
+                    *pDst = s;
+                }
+                else if(alpha == 255)
+                {
+                         *pDst = (s & 0x00ffffff) | dalpha;
+                }
+                else
+                {
+                    uint32_t sInvA = (255- alpha);    
+
+                    uint32_t sR = (s >> 16) & 0xff;
+                    uint32_t sG = (s >> 8)  & 0xff;
+                    uint32_t sB = s & 0xff;
+
+                    uint32_t dR = (d >> 16) & 0xff;
+                    uint32_t dG = (d >> 8)  & 0xff;
+                    uint32_t dB = d & 0xff;
+
+                    // Blend the fill color with the blend color 
+                    uint32_t r = sR + ( (dR * sInvA) >> 8);
+                    uint32_t g = sG + ( (dG * sInvA) >> 8);
+                    uint32_t b = sB + ( (dB * sInvA) >> 8);
+                    
+                    // Overflow checking
+                    if(r > 255)
+                        r = 255;
+                    if(g > 255)
+                        g = 255;
+                    if(b > 255)
+                        b = 255;
+                  
+                    // Store the blended color
+                    *pDst = (dalpha | (r << 16) | (g << 8) | b);
+                }
+                ++pSrc;
+                ++pDst;
+            }, width);
+
+            pSrc += srcskip;
+            pDst += dstskip;
+        }
+    }
+    else
+    {
+        while(height--)
+        {
+            DUFFS_LOOP4({
+                uint32_t s1;
+                uint32_t d1;
+                uint32_t d = *pDst;;
+                uint32_t s = *pSrc;
+
+                uint32_t dalpha =  d & 0xff000000;;
+                uint32_t alpha = (s >> 24);
+                // Note: Here we special-case opaque alpha since the
+                // compositioning used (>>8 instead of /255) doesn't handle
+                // it correctly. Also special-case alpha = 0 for speed?
+
+                if(alpha)
+                {   
+                    // 7/24/09 CSidhall - added extra check for 0 alpha dest case
+                    if(!dalpha)
+                        *pDst = s;
+                    else if(alpha == 255)
+                         *pDst = (s & 0x00ffffff) | dalpha;
+                    else
+                    {
+                        // Take out the middle component (green), and process
                         // the other two in parallel. One multiply less.
                     
-                        // dalpha = d & 0xff000000;
-                        s1     = s & 0x00ff00ff;
-                        d1     = d & 0x00ff00ff;
-                        d1     = (d1 + ((s1 - d1) * alpha >> 8)) & 0x00ff00ff;
-                        s     &= 0x0000ff00;
-                        d     &= 0x0000ff00;
-                        d      = (d + ((s - d) * alpha >> 8)) & 0x0000ff00;
+                        // dalpha = d & 0xff000000;
+                        s1     = s & 0x00ff00ff;
+                        d1     = d & 0x00ff00ff;
+                        d1     = (d1 + ((s1 - d1) * alpha >> 8)) & 0x00ff00ff;
+                        s     &= 0x0000ff00;
+                        d     &= 0x0000ff00;
+                        d      = (d + ((s - d) * alpha >> 8)) & 0x0000ff00;
+
+                        *pDst = d1 | d | dalpha;
+        
+                    }
+                }
+
+                ++pSrc;
+                ++pDst;
+            }, width);
+
+            pSrc += srcskip;
+            pDst += dstskip;
+        }
+    }
+}
+
+
+// General (slow) N->N blending with per-surface alpha.
+static void BlitNtoNSurfaceAlpha(const BlitInfo& info)
+{
+    const int            width   = info.mnDWidth;
+    int                  height  = info.mnDHeight;
+    const uint8_t*       pSource = info.mpSPixels;
+    const int            srcskip = info.mnSSkip;
+    uint8_t*             pDest   = info.mpDPixels;
+    const int            dstskip = info.mnDSkip;
+    const PixelFormat&   srcfmt  = info.mpSource->mPixelFormat;
+    const PixelFormat&   dstfmt  = info.mpDest->mPixelFormat;
+    const int            srcbpp  = srcfmt.mBytesPerPixel;
+    const int            dstbpp  = dstfmt.mBytesPerPixel;
+    const unsigned       sA      = srcfmt.mSurfaceAlpha;
+    const unsigned       dA      = dstfmt.mAMask ? 255 : 0;
+
+    if (sA)
+    {
+        if(info.mDoAdditiveBlend)  
+        { 
+            // Additive alpha blend        
+            while (height--)
+            {
+                DUFFS_LOOP4(
+                {
+                    uint32_t pixel;
+                    unsigned sR;
+                    unsigned sG;
+                    unsigned sB;
+                    unsigned dR;
+                    unsigned dG;
+                    unsigned dB;
+
+                    DISEMBLE_RGB(pSource, srcbpp, srcfmt, pixel, sR, sG, sB);
+                    DISEMBLE_RGB(pDest,   dstbpp, dstfmt, pixel, dR, dG, dB);
+                    ADDITIVE_ALPHA_BLEND(sR, sG, sB, sA, dR, dG, dB);
+                    ASSEMBLE_RGBA(pDest, dstbpp, dstfmt, dR, dG, dB, dA);
+
+                    pSource += srcbpp;
+                    pDest   += dstbpp;
+                }, width);
+
+                pSource += srcskip;
+                pDest   += dstskip;
+            }
+        }
+        else
+        {         
+            // Standard alpha blend
+            while (height--)
+            {
+                DUFFS_LOOP4(
+                {
+                    uint32_t pixel;
+                    unsigned sR;
+                    unsigned sG;
+                    unsigned sB;
+                    unsigned dR;
+                    unsigned dG;
+                    unsigned dB;
+
+                    DISEMBLE_RGB(pSource, srcbpp, srcfmt, pixel, sR, sG, sB);
+                    DISEMBLE_RGB(pDest,   dstbpp, dstfmt, pixel, dR, dG, dB);
+                    ALPHA_BLEND(sR, sG, sB, sA, dR, dG, dB);
+                    ASSEMBLE_RGBA(pDest, dstbpp, dstfmt, dR, dG, dB, dA);
+
+                    pSource += srcbpp;
+                    pDest   += dstbpp;
+                }, width);
+
+                pSource += srcskip;
+                pDest   += dstskip;
+            }
+       }
+    
+    }
+}
+
+
+// General (slow) N->N blending with pixel alpha.
+static void BlitNtoNPixelAlpha(const BlitInfo& info)
+{
+    const int            width   = info.mnDWidth;
+    int                  height  = info.mnDHeight;
+    const uint8_t*       pSource = info.mpSPixels;
+    const int            srcskip = info.mnSSkip;
+    uint8_t*             pDest   = info.mpDPixels;
+    const int            dstskip = info.mnDSkip;
+    const PixelFormat&   srcfmt  = info.mpSource->mPixelFormat;
+    const PixelFormat&   dstfmt  = info.mpDest->mPixelFormat;
+    const int            srcbpp  = srcfmt.mBytesPerPixel;
+    const int            dstbpp  = dstfmt.mBytesPerPixel;
+    
+    // Note: For 8bpp source alpha, this doesn't get opaque values
+    // quite right. For <8bpp source alpha, it gets them very wrong.
+    // It is unclear whether there is a good general solution that doesn't
+    // need a branch (or a divide).
+
+    if(info.mDoAdditiveBlend)  
+    { 
+        // Additive alpha blend version
+        while (height--)
+        {
+            DUFFS_LOOP4(
+            {
+                uint32_t pixel;
+                unsigned sR;
+                unsigned sG;
+                unsigned sB;
+                unsigned dR;
+                unsigned dG;
+                unsigned dB;
+                unsigned sA;
+                unsigned dA;
+
+                DISEMBLE_RGBA(pSource, srcbpp, srcfmt, pixel, sR, sG, sB, sA);
+
+                if(sA)
+                {
+                    DISEMBLE_RGBA(pDest, dstbpp, dstfmt, pixel, dR, dG, dB, dA);
+                    if(!dA)
+                    { 
+                        // 0 alpha background support               
+                        ASSEMBLE_RGBA(pDest, dstbpp, dstfmt, sR, sG, sB, sA);
+                    }
+                    else
+                    {
+                        ADDITIVE_ALPHA_BLEND(sR, sG, sB, sA, dR, dG, dB);
+                        ASSEMBLE_RGBA(pDest, dstbpp, dstfmt, dR, dG, dB, dA);
+                    }
+                }
+
+                pSource += srcbpp;
+                pDest   += dstbpp;
+            }, width);
+
+            pSource += srcskip;
+            pDest   += dstskip;
+        }
+    }
+    else
+    {
+        while (height--)
+        {
+            DUFFS_LOOP4(
+            {
+                uint32_t pixel;
+                unsigned sR;
+                unsigned sG;
+                unsigned sB;
+                unsigned dR;
+                unsigned dG;
+                unsigned dB;
+                unsigned sA;
+                unsigned dA;
+
+                DISEMBLE_RGBA(pSource, srcbpp, srcfmt, pixel, sR, sG, sB, sA);
+
+                if(sA)
+                {
+                    DISEMBLE_RGBA(pDest, dstbpp, dstfmt, pixel, dR, dG, dB, dA);
+                    if(!dA)
+                    { 
+                        // 0 alpha background support               
+                        ASSEMBLE_RGBA(pDest, dstbpp, dstfmt, sR, sG, sB, sA);
+                    }
+                    else
+                    {
+                        ALPHA_BLEND(sR, sG, sB, sA, dR, dG, dB);
+                        ASSEMBLE_RGBA(pDest, dstbpp, dstfmt, dR, dG, dB, dA);
+                    }
+                }
+
+                pSource += srcbpp;
+                pDest   += dstbpp;
+            }, width);
+
+            pSource += srcskip;
+            pDest   += dstskip;
+        }
+    }
+}
+
+
+// ARGB/XRGB -> ARGB blending with the source alpha multiplied by info.mnOpacity.
+// This gives the same result as the pixel alpha blit of a CreateTransparentSurface copy of the source.
+static void BlitRGBtoRGBOpacity(const BlitInfo& info)
+{
+    int             width        = info.mnDWidth;
+    int             height       = info.mnDHeight;
+    const uint32_t* pSrc         = (uint32_t*)info.mpSPixels;
+    int             srcskip      = info.mnSSkip >> 2;
+    uint32_t*       pDst         = (uint32_t*)info.mpDPixels;
+    int             dstskip      = info.mnDSkip >> 2;
+    const uint32_t  opacity      = (uint32_t)info.mnOpacity;
+    const bool      bSourceAlpha = SourceAlphaEnabled(info.mpSource);
+    const bool      bAdditive    = info.mDoAdditiveBlend;
+
+    while(height--)
+    {
+        DUFFS_LOOP4({
+            const uint32_t s      = *pSrc;
+            const uint32_t d      = *pDst;
+            const uint32_t dalpha = d & 0xff000000;
+            const uint32_t alpha  = bSourceAlpha ? MODULATE_ALPHA(s >> 24, opacity) : opacity;
+
+            if(alpha)
+            {
+                if(!dalpha)
+                    *pDst = (s & 0x00ffffff) | (alpha << 24);
+                else if(bAdditive)
+                {
+                    const uint32_t sInvA = 255 - alpha;
+
+                    uint32_t r = ((s >> 16) & 0xff) + ((((d >> 16) & 0xff) * sInvA) >> 8);
+                    uint32_t g = ((s >> 8)  & 0xff) + ((((d >> 8)  & 0xff) * sInvA) >> 8);
+                    uint32_t b = ( s        & 0xff) + ((( d        & 0xff) * sInvA) >> 8);
+
+                    if(r > 255)
+                        r = 255;
+                    if(g > 255)
+                        g = 255;
+                    if(b > 255)
+                        b = 255;
+
+                    *pDst = (dalpha | (r << 16) | (g << 8) | b);
+                }
+                else
+                {
+                    // Same as BlitRGBtoRGBPixelAlpha: red and blue are done in parallel.
+                    const uint32_t s1 = s & 0x00ff00ff;
+                    const uint32_t s2 = s & 0x0000ff00;
+                    uint32_t       d1 = d & 0x00ff00ff;
+                    uint32_t       d2 = d & 0x0000ff00;
+
+                    d1 = (d1 + ((s1 - d1) * alpha >> 8)) & 0x00ff00ff;
+                    d2 = (d2 + ((s2 - d2) * alpha >> 8)) & 0x0000ff00;
+
+                    *pDst = d1 | d2 | dalpha;
+                }
+            }
+
+            ++pSrc;
+            ++pDst;
+        }, width);
+
+        pSrc += srcskip;
+        pDst += dstskip;
+    }
+}
+
+
+// Divides the color of a premultiplied ARGB pixel by its alpha, giving straight ARGB.
+static inline uint32_t UnpremultiplyPixel(uint32_t p)
+{
+    const uint32_t a = p >> 24;
+
+    if((a == 0) || (a == 255))
+        return a ? p : 0;
+
+    uint32_t r = ((((p >> 16) & 0xff) * 255) + (a >> 1)) / a;
+    uint32_t g = ((((p >>  8) & 0xff) * 255) + (a >> 1)) / a;
+    uint32_t b = ((( p        & 0xff) * 255) + (a >> 1)) / a;
+
+    if(r > 255)
+        r = 255;
+    if(g > 255)
+        g = 255;
+    if(b > 255)
+        b = 255;
+
+    return (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+
+// Multiplies the channels held in the low bytes of the two 16 bit halves of v by scale / 255, rounded.
+static inline uint32_t ScaleChannelPair(uint32_t v, uint32_t scale)
+{
+    const uint32_t t = (v * scale) + 0x00800080;
+
+    return ((t + ((t >> 8) & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+}
+
+
+// Adds two channel pairs, clamping each channel to 255.
+static inline uint32_t AddChannelPair(uint32_t a, uint32_t b)
+{
+    const uint32_t sum   = a + b;
+    const uint32_t carry = sum & 0x01000100;
+
+    return (sum | (carry - (carry >> 8))) & 0x00ff00ff;
+}
+
+
+// PARGB -> ARGB/XRGB/PARGB blending with source pixel alpha. As the source color already has the 
+// alpha multiplied in, source-over is s + d * (255 - a) / 255, which is one multiply per channel 
+// instead of the two of the straight alpha blend. The additive blend is the same but with the
+// >> 8 of the straight alpha additive blend, which treats the source as premultiplied anyway.
+// A straight alpha dest keeps its alpha and gets the unpremultiplied source where its alpha is 0, 
+// as with BlitRGBtoRGBPixelAlpha. A PARGB dest gets a true source-over, alpha included.
+// This applies info.mnOpacity.
+static void BlitPARGBtoRGB(const BlitInfo& info)
+{
+    int             width              = info.mnDWidth;
+    int             height             = info.mnDHeight;
+    const uint32_t* pSrc               = (uint32_t*)info.mpSPixels;
+    int             srcskip            = info.mnSSkip >> 2;
+    uint32_t*       pDst               = (uint32_t*)info.mpDPixels;
+    int             dstskip            = info.mnDSkip >> 2;
+    const uint32_t  opacity            = MODULATE_ALPHA((uint32_t)info.mnOpacity, (uint32_t)info.mpSource->mPixelFormat.mSurfaceAlpha);
+    const bool      bAdditive          = info.mDoAdditiveBlend;
+    const bool      bPremultipliedDest = (info.mpDest->mPixelFormat.mPixelFormatType == kPixelFormatTypePARGB);
+
+    while(height--)
+    {
+        DUFFS_LOOP4({
+            uint32_t s = *pSrc;
+
+            // The opacity scales the color along with the alpha.
+            if(opacity < 255)
+                s = ScaleChannelPair(s & 0x00ff00ff, opacity) | (ScaleChannelPair((s >> 8) & 0x00ff00ff, opacity) << 8);
+
+            const uint32_t alpha = s >> 24;
+
+            if(alpha)
+            {
+                const uint32_t d      = *pDst;
+                const uint32_t dalpha = d & 0xff000000;
+
+                if(bPremultipliedDest)
+                {
+                    if(alpha == 255)
+                        *pDst = s;
+                    else
+                    {
+                        const uint32_t sInvA = 255 - alpha;
+                        uint32_t       d1    = d & 0x00ff00ff;
+                        uint32_t       d2    = (d >> 8) & 0x00ff00ff;
+
+                        if(bAdditive)
+                        {
+                            d1 = ((d1 * sInvA) >> 8) & 0x00ff00ff;
+                            d2 = ((d2 * sInvA) >> 8) & 0x00ff00ff;
+                        }
+                        else
+                        {
+                            d1 = ScaleChannelPair(d1, sInvA);
+                            d2 = ScaleChannelPair(d2, sInvA);
+                        }
+
+                        *pDst = AddChannelPair(s & 0x00ff00ff, d1) | (AddChannelPair((s >> 8) & 0x00ff00ff, d2) << 8);
+                    }
+                }
+                else if(!dalpha)
+                    *pDst = UnpremultiplyPixel(s);
+                else if(alpha == 255)
+                    *pDst = (s & 0x00ffffff) | dalpha;
+                else
+                {
+                    // Red and blue are done in parallel, then green.
+                    const uint32_t sInvA = 255 - alpha;
+                    uint32_t       d1    = d & 0x00ff00ff;
+                    uint32_t       d2    = (d >> 8) & 0x000000ff;
+
+                    if(bAdditive)
+                    {
+                        d1 = ((d1 * sInvA) >> 8) & 0x00ff00ff;
+                        d2 = (d2 * sInvA) >> 8;
+                    }
+                    else
+                    {
+                        d1 = ScaleChannelPair(d1, sInvA);
+                        d2 = ScaleChannelPair(d2, sInvA);
+                    }
+
+                    *pDst = AddChannelPair(s & 0x00ff00ff, d1) | (AddChannelPair((s >> 8) & 0x000000ff, d2) << 8) | dalpha;
+                }
+            }
+
+            ++pSrc;
+            ++pDst;
+        }, width);
+
+        pSrc += srcskip;
+        pDst += dstskip;
+    }
+}
+
+
+// General (slow) N->N blending with the source alpha multiplied by info.mnOpacity.
+static void BlitNtoNOpacity(const BlitInfo& info)
+{
+    const int            width        = info.mnDWidth;
+    int                  height       = info.mnDHeight;
+    const uint8_t*       pSource      = info.mpSPixels;
+    const int            srcskip      = info.mnSSkip;
+    uint8_t*             pDest        = info.mpDPixels;
+    const int            dstskip      = info.mnDSkip;
+    const PixelFormat&   srcfmt       = info.mpSource->mPixelFormat;
+    const PixelFormat&   dstfmt       = info.mpDest->mPixelFormat;
+    const int            srcbpp       = srcfmt.mBytesPerPixel;
+    const int            dstbpp       = dstfmt.mBytesPerPixel;
+    const unsigned       opacity      = (unsigned)info.mnOpacity;
+    const bool           bSourceAlpha = SourceAlphaEnabled(info.mpSource);
+    const bool           bAdditive    = info.mDoAdditiveBlend;
+
+    while (height--)
+    {
+        DUFFS_LOOP4(
+        {
+            uint32_t pixel;
+            unsigned sR;
+            unsigned sG;
+            unsigned sB;
+            unsigned dR;
+            unsigned dG;
+            unsigned dB;
+            unsigned sA;
+            unsigned dA;
+
+            DISEMBLE_RGBA(pSource, srcbpp, srcfmt, pixel, sR, sG, sB, sA);
+            sA = bSourceAlpha ? MODULATE_ALPHA(sA, opacity) : opacity;
+
+            if(sA)
+            {
+                DISEMBLE_RGBA(pDest, dstbpp, dstfmt, pixel, dR, dG, dB, dA);
+                if(!dA)
+                { 
+                    // 0 alpha background support               
+                    ASSEMBLE_RGBA(pDest, dstbpp, dstfmt, sR, sG, sB, sA);
+                }
+                else
+                {
+                    if(bAdditive)
+                        ADDITIVE_ALPHA_BLEND(sR, sG, sB, sA, dR, dG, dB);
+                    else
+                        ALPHA_BLEND(sR, sG, sB, sA, dR, dG, dB);
+                    ASSEMBLE_RGBA(pDest, dstbpp, dstfmt, dR, dG, dB, dA);
+                }
+            }
+
+            pSource += srcbpp;
+            pDest   += dstbpp;
+        }, width);
+
+        pSource += srcskip;
+        pDest   += dstskip;
+    }
+}
+
+
+// (A)RGB pen blending through an 8 bit coverage mask. This matches BlitRGBtoRGBPixelAlpha 
+// with a source pixel of pen and an alpha of the coverage times penAlpha.
+static void BlitMaskA8Row(const uint8_t* pMask, uint32_t* pDst, int width, uint32_t pen, uint32_t penAlpha)
+{
+    while(width--)
+    {
+        const uint32_t alpha = MODULATE_ALPHA((uint32_t)*pMask, penAlpha);
+
+        if(alpha)
+        {
+            const uint32_t d      = *pDst;
+            const uint32_t dalpha = d & 0xff000000;
+
+            if(!dalpha)
+                *pDst = pen | (alpha << 24);
+            else if(alpha == 255)
+                *pDst = pen | dalpha;
+            else
+            {
+                const uint32_t s1 = pen & 0x00ff00ff;
+                const uint32_t s2 = pen & 0x0000ff00;
+                uint32_t       d1 = d & 0x00ff00ff;
+                uint32_t       d2 = d & 0x0000ff00;
+
+                d1 = (d1 + ((s1 - d1) * alpha >> 8)) & 0x00ff00ff;
+                d2 = (d2 + ((s2 - d2) * alpha >> 8)) & 0x0000ff00;
+
+                *pDst = d1 | d2 | dalpha;
+            }
+        }
+
+        ++pMask;
+        ++pDst;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////
+// 16 bit surfaces
+///////////////////////////////////////////////////////////////////////
+
+// 4x4 ordered (Bayer) dither thresholds, 0-15.
+static const uint8_t kDither4x4[4][4] =
+{
+    {  0,  8,  2, 10 },
+    { 12,  4, 14,  6 },
+    {  3, 11,  1,  9 },
+    { 15,  7, 13,  5 }
+};
+
+// The threshold used when not dithering, which rounds to the nearest 16 bit value.
+static const uint32_t kNoDither = 8;
+
+// Chunk size for converting non-ARGB rows to ARGB on the stack.
+static const int kBlit16ChunkSize = 256;
+
+
+// Reduces 8 bit channels to a 16 bit pixel, with a dither threshold of 0-15 scaled to each field's step.
+// Values that were expanded from the 16 bit format come back unchanged at any threshold, so 
+// blending a pixel with itself doesn't drift.
+static inline uint32_t PackRGB565(uint32_t r, uint32_t g, uint32_t b, uint32_t d)
+{
+    return (((r + (d >> 1) - (r >> 5)) >> 3) << 11) | 
+           (((g + (d >> 2) - (g >> 6)) >> 2) <<  5) | 
+            ((b + (d >> 1) - (b >> 5)) >> 3);
+}
+
+
+static inline uint32_t PackARGB4444(uint32_t a, uint32_t r, uint32_t g, uint32_t b, uint32_t d)
+{
+    return (((a + d - (a >> 4)) >> 4) << 12) | 
+           (((r + d - (r >> 4)) >> 4) <<  8) | 
+           (((g + d - (g >> 4)) >> 4) <<  4) | 
+            ((b + d - (b >> 4)) >> 4);
+}
+
+
+// Expands a 16 bit pixel to 0xAARRGGBB.
+static inline uint32_t Unpack16(uint32_t p, PixelFormatType pft)
+{
+    if(pft == kPixelFormatTypeRGB565)
+    {
+        const uint32_t r = (p >> 11) & 0x1f;
+        const uint32_t g = (p >>  5) & 0x3f;
+        const uint32_t b =  p        & 0x1f;
+
+        return 0xff000000 | (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+    }
+
+    return ((p & 0xf000) * 0x11000) | ((p & 0x0f00) * 0x1100) | ((p & 0x00f0) * 0x110) | ((p & 0x000f) * 0x11);
+}
+
+
+// Expands count pixels of any format to straight alpha 0xAARRGGBB. Formats without alpha come out opaque.
+static void UnpackRow(const uint8_t* pSource, const PixelFormat& sf, uint32_t* pColors, int count)
+{
+    const int bpp = sf.mBytesPerPixel;
+
+    if(bpp == 2)
+    {
+        const uint16_t* const pSource16 = (const uint16_t*)pSource;
+
+        for(int i = 0; i < count; i++)
+            pColors[i] = Unpack16(pSource16[i], sf.mPixelFormatType);
+    }
+    else if(sf.mPixelFormatType == kPixelFormatTypePARGB)
+    {
+        const uint32_t* const pSource32 = (const uint32_t*)pSource;
+
+        for(int i = 0; i < count; i++)
+            pColors[i] = UnpremultiplyPixel(pSource32[i]);
+    }
+    else
+    {
+        for(int i = 0; i < count; i++, pSource += bpp)
+        {
+            uint32_t pixel;
+            unsigned r, g, b, a;
+
+            DISEMBLE_RGBA(pSource, bpp, sf, pixel, r, g, b, a);
+
+            if(!sf.mAMask)
+                a = 255;
+
+            pColors[i] = (a << 24) | (r << 16) | (g << 8) | b;
+        }
+    }
+}
+
+
+// Blends count 0xAARRGGBB colors into the 16 bit pixels at pDest, which are at x, y in their surface. 
+// pColors advances by colorStep per pixel. alphaOr is OR'd into each color, which is how sources without 
+// alpha are made opaque. Each alpha is multiplied by opacity and by pCoverage if that isn't NULL.
+static void BlendPixels16(uint16_t* pDest, PixelFormatType pft, int x, int y, int count, const uint32_t* pColors, int colorStep, 
+                          uint32_t alphaOr, const uint8_t* pCoverage, uint32_t opacity, bool bAdditive, bool bDither)
+{
+    const uint8_t* const pDither = kDither4x4[y & 3];
+    const bool           bRGB565 = (pft == kPixelFormatTypeRGB565);
+
+    for(int i = 0; i < count; i++, pColors += colorStep)
+    {
+        const uint32_t s = *pColors | alphaOr;
+        uint32_t       a = s >> 24;
+
+        if(pCoverage)
+            a = MODULATE_ALPHA(a, (uint32_t)pCoverage[i]);
+
+        if(opacity < 255)
+            a = MODULATE_ALPHA(a, opacity);
+
+        if(!a)
+            continue;
+
+        const uint32_t d  = bDither ? pDither[(x + i) & 3] : kNoDither;
+        const int      sR = (int)((s >> 16) & 0xff);
+        const int      sG = (int)((s >>  8) & 0xff);
+        const int      sB = (int)( s        & 0xff);
+        int            dR = sR;
+        int            dG = sG;
+        int            dB = sB;
+        int            dA = 255;
+
+        if((a < 255) || bAdditive)
+        {
+            const uint32_t p = Unpack16(pDest[i], pft);
+
+            dA = (int)(p >> 24);
+
+            if(!dA)
+                dA = (int)a;  // 0 alpha background support; the source is copied as is.
+            else
+            {
+                dR = (int)((p >> 16) & 0xff);
+                dG = (int)((p >>  8) & 0xff);
+                dB = (int)( p        & 0xff);
+
+                if(bAdditive)
+                    ADDITIVE_ALPHA_BLEND(sR, sG, sB, (int)a, dR, dG, dB);
+                else
+                    ALPHA_BLEND(sR, sG, sB, (int)a, dR, dG, dB);
+
+                dA = (int)(a + MODULATE_ALPHA((uint32_t)dA, 255 - a));
+            }
+        }
+
+        if(bRGB565)
+            pDest[i] = (uint16_t)PackRGB565((uint32_t)dR, (uint32_t)dG, (uint32_t)dB, d);
+        else
+            pDest[i] = (uint16_t)PackARGB4444((uint32_t)dA, (uint32_t)dR, (uint32_t)dG, (uint32_t)dB, d);
+    }
+}
+
+
+EARASTER_API void BlendRow16(Surface* pSurface, int x, int y, int count, const uint32_t* pColors, int colorStep, const uint8_t* pCoverage, int opacity, bool bDither)
+{
+    EAW_ASSERT(pSurface && (pSurface->mPixelFormat.mBytesPerPixel == 2));
+
+    if(opacity > 0)
+    {
+        uint16_t* const pDest = (uint16_t*)((uint8_t*)pSurface->mpData + (y * pSurface->mStride)) + x;
+
+        BlendPixels16(pDest, pSurface->mPixelFormat.mPixelFormatType, x, y, count, pColors, colorStep, 0, pCoverage, (opacity < 255) ? (uint32_t)opacity : 255, false, bDither);
+    }
+}
+
+
+// Any format -> RGB565/ARGB4444, blended and dithered. ARGB/XRGB sources are read in place and 
+// anything else, PARGB included, is expanded to straight ARGB a chunk at a time. This applies info.mnOpacity, so it is 
+// also the opacity blit function for 16 bit dests.
+static void BlitNto16(const BlitInfo& info)
+{
+    const int           width    = info.mnDWidth;
+    const uint8_t*      pSource  = info.mpSPixels;
+    uint8_t*            pDest    = info.mpDPixels;
+    const PixelFormat&  srcfmt   = info.mpSource->mPixelFormat;
+    const int           srcbpp   = srcfmt.mBytesPerPixel;
+    const PixelFormat&  dstfmt   = info.mpDest->mPixelFormat;
+    const bool          bARGB    = (srcbpp == 4) && ((srcfmt.mRMask | srcfmt.mGMask | srcfmt.mBMask) == 0x00ffffff) && (srcfmt.mPixelFormatType != kPixelFormatTypePARGB);
+    const uint32_t      alphaOr  = SourceAlphaEnabled(info.mpSource) ? 0 : 0xff000000;
+    const uint32_t      opacity  = MODULATE_ALPHA((uint32_t)info.mnOpacity, (uint32_t)srcfmt.mSurfaceAlpha);
+    uint32_t            colors[kBlit16ChunkSize];
+
+    // Where the blit is in the dest, which the dither pattern is aligned to.
+    const int offset = (int)(pDest - (uint8_t*)info.mpDest->mpData);
+    const int x      = (offset % info.mpDest->mStride) / 2;
+    int       y      = offset / info.mpDest->mStride;
+
+    for(int h = info.mnDHeight; h > 0; --h, ++y)
+    {
+        if(bARGB)
+            BlendPixels16((uint16_t*)pDest, dstfmt.mPixelFormatType, x, y, width, (const uint32_t*)pSource, 1, alphaOr, NULL, opacity, info.mDoAdditiveBlend, true);
+        else
+        {
+            for(int i = 0; i < width; i += kBlit16ChunkSize)
+            {
+                const int count = ((width - i) < kBlit16ChunkSize) ? (width - i) : kBlit16ChunkSize;
+
+                UnpackRow(pSource + (i * srcbpp), srcfmt, colors, count);
+                BlendPixels16((uint16_t*)pDest + i, dstfmt.mPixelFormatType, x + i, y, count, colors, 1, alphaOr, NULL, opacity, info.mDoAdditiveBlend, true);
+            }
+        }
+
+        pSource += (width * srcbpp) + info.mnSSkip;
+        pDest   += (width * 2)      + info.mnDSkip;
+    }
+}
+
+
+// RGB565/ARGB4444, or PARGB to a layout other than ARGB's -> 24 and 32 bit formats. The source is 
+// expanded to straight ARGB a chunk at a time and blended as BlitNtoNPixelAlpha does. 
+// This applies info.mnOpacity as well.
+static void BlitUnpackedtoN(const BlitInfo& info)
+{
+    const int           width    = info.mnDWidth;
+    const uint8_t*      pSource  = info.mpSPixels;
+    uint8_t*            pDest    = info.mpDPixels;
+    const PixelFormat&  srcfmt   = info.mpSource->mPixelFormat;
+    const int           srcbpp   = srcfmt.mBytesPerPixel;
+    const PixelFormat&  dstfmt   = info.mpDest->mPixelFormat;
+    const int           dstbpp   = dstfmt.mBytesPerPixel;
+    const uint32_t      alphaOr  = SourceAlphaEnabled(info.mpSource) ? 0 : 0xff000000;
+    const uint32_t      opacity  = MODULATE_ALPHA((uint32_t)info.mnOpacity, (uint32_t)srcfmt.mSurfaceAlpha);
+    uint32_t            colors[kBlit16ChunkSize];
+
+    for(int h = info.mnDHeight; h > 0; --h)
+    {
+        uint8_t* pD = pDest;
+
+        for(int i = 0; i < width; i += kBlit16ChunkSize)
+        {
+            const int count = ((width - i) < kBlit16ChunkSize) ? (width - i) : kBlit16ChunkSize;
+
+            UnpackRow(pSource + (i * srcbpp), srcfmt, colors, count);
+
+            for(int c = 0; c < count; c++, pD += dstbpp)
+            {
+                const uint32_t s = colors[c] | alphaOr;
+                const int      a = (int)MODULATE_ALPHA(s >> 24, opacity);
+
+                if(!a)
+                    continue;
+
+                const int sR = (int)((s >> 16) & 0xff);
+                const int sG = (int)((s >>  8) & 0xff);
+                const int sB = (int)( s        & 0xff);
+
+                if((a == 255) && !info.mDoAdditiveBlend)
+                {
+                    ASSEMBLE_RGBA(pD, dstbpp, dstfmt, sR, sG, sB, 255);
+                }
+                else
+                {
+                    uint32_t pixel;
+                    int      dR, dG, dB, dA;
+
+                    DISEMBLE_RGBA(pD, dstbpp, dstfmt, pixel, dR, dG, dB, dA);
+
+                    if(!dA && dstfmt.mAMask)
+                    {
+                        // 0 alpha background support
+                        ASSEMBLE_RGBA(pD, dstbpp, dstfmt, sR, sG, sB, a);
+                    }
+                    else
+                    {
+                        if(info.mDoAdditiveBlend)
+                            ADDITIVE_ALPHA_BLEND(sR, sG, sB, a, dR, dG, dB);
+                        else
+                            ALPHA_BLEND(sR, sG, sB, a, dR, dG, dB);
+
+                        dA = dstfmt.mAMask ? (int)(a + MODULATE_ALPHA((uint32_t)dA, (uint32_t)(255 - a))) : 255;
+                        ASSEMBLE_RGBA(pD, dstbpp, dstfmt, dR, dG, dB, dA);
+                    }
+                }
+            }
+        }
+
+        pSource += (width * srcbpp) + info.mnSSkip;
+        pDest   += (width * dstbpp) + info.mnDSkip;
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////
+// Alpha accumulating surfaces
+///////////////////////////////////////////////////////////////////////
+
+// Blends count 0xAARRGGBB colors into the ARGB pixels at pDest as source-over does, the dest alpha included: 
+// it becomes a + dA * (255 - a) / 255, and the colors are weighted by their share of that. Blending the pixels 
+// onto something later then gives what blending each color onto it in turn would have. pColors advances by 
+// colorStep per pixel. alphaOr is OR'd into each color, and each alpha is multiplied by opacity and by 
+// pCoverage if that isn't NULL, as with BlendPixels16.
+static void BlendPixelsAccumulateAlpha(uint32_t* pDest, int count, const uint32_t* pColors, int colorStep, 
+                                       uint32_t alphaOr, const uint8_t* pCoverage, uint32_t opacity)
+{
+    for(int i = 0; i < count; i++, pColors += colorStep)
+    {
+        const uint32_t s = *pColors | alphaOr;
+        uint32_t       a = s >> 24;
+
+        if(pCoverage)
+            a = MODULATE_ALPHA(a, (uint32_t)pCoverage[i]);
+
+        if(opacity < 255)
+            a = MODULATE_ALPHA(a, opacity);
+
+        if(!a)
+            continue;
+
+        const uint32_t d  = pDest[i];
+        const uint32_t dA = d >> 24;
+
+        if((a == 255) || !dA)
+        {
+            pDest[i] = (s & 0x00ffffff) | (a << 24);
+            continue;
+        }
+
+        // dW is what shows of the dest under the source, rounded. The result alpha is at least a, so never 0.
+        const uint32_t t     = (dA * (255 - a)) + 128;
+        const uint32_t dW    = (t + (t >> 8)) >> 8;
+        const uint32_t rA    = a + dW;
+        const uint32_t round = rA >> 1;
+
+        const uint32_t r = ((((s >> 16) & 0xff) * a) + (((d >> 16) & 0xff) * dW) + round) / rA;
+        const uint32_t g = ((((s >>  8) & 0xff) * a) + (((d >>  8) & 0xff) * dW) + round) / rA;
+        const uint32_t b = ((( s        & 0xff) * a) + (( d        & 0xff) * dW) + round) / rA;
+
+        pDest[i] = (rA << 24) | (r << 16) | (g << 8) | b;
+    }
+}
+
+
+EARASTER_API void BlendRowAccumulateAlpha(Surface* pSurface, int x, int y, int count, const uint32_t* pColors, int colorStep, const uint8_t* pCoverage, int opacity)
+{
+    EAW_ASSERT(pSurface && (pSurface->mPixelFormat.mPixelFormatType == kPixelFormatTypeARGB));
+
+    if(opacity > 0)
+    {
+        uint32_t* const pDest = (uint32_t*)((uint8_t*)pSurface->mpData + (y * pSurface->mStride)) + x;
+
+        BlendPixelsAccumulateAlpha(pDest, count, pColors, colorStep, 0, pCoverage, (opacity < 255) ? (uint32_t)opacity : 255);
+    }
+}
+
+
+// Any format -> ARGB with kFlagAccumulateAlpha. ARGB/XRGB sources are read in place and anything else, 
+// PARGB included, is expanded to straight ARGB a chunk at a time, as with BlitNto16. There is no additive 
+// blend into these; additive blits blend normally. This applies info.mnOpacity, so it is also the opacity 
+// blit function for these dests.
+static void BlitNtoAccumulatedAlpha(const BlitInfo& info)
+{
+    const int           width    = info.mnDWidth;
+    const uint8_t*      pSource  = info.mpSPixels;
+    uint8_t*            pDest    = info.mpDPixels;
+    const PixelFormat&  srcfmt   = info.mpSource->mPixelFormat;
+    const int           srcbpp   = srcfmt.mBytesPerPixel;
+    const bool          bARGB    = (srcbpp == 4) && ((srcfmt.mRMask | srcfmt.mGMask | srcfmt.mBMask) == 0x00ffffff) && (srcfmt.mPixelFormatType != kPixelFormatTypePARGB);
+    const uint32_t      alphaOr  = SourceAlphaEnabled(info.mpSource) ? 0 : 0xff000000;
+    const uint32_t      opacity  = MODULATE_ALPHA((uint32_t)info.mnOpacity, (uint32_t)srcfmt.mSurfaceAlpha);
+    uint32_t            colors[kBlit16ChunkSize];
+
+    for(int h = info.mnDHeight; h > 0; --h)
+    {
+        if(bARGB)
+            BlendPixelsAccumulateAlpha((uint32_t*)pDest, width, (const uint32_t*)pSource, 1, alphaOr, NULL, opacity);
+        else
+        {
+            for(int i = 0; i < width; i += kBlit16ChunkSize)
+            {
+                const int count = ((width - i) < kBlit16ChunkSize) ? (width - i) : kBlit16ChunkSize;
+
+                UnpackRow(pSource + (i * srcbpp), srcfmt, colors, count);
+                BlendPixelsAccumulateAlpha((uint32_t*)pDest + i, count, colors, 1, alphaOr, NULL, opacity);
+            }
+        }
+
+        pSource += (width * srcbpp) + info.mnSSkip;
+        pDest   += (width * 4)      + info.mnDSkip;
+    }
+}
+
+
+#if MSVC_ASMBLIT
+
+
+// Fast XRGB -> XRGB/ARGB with source surface alpha.
+static void BlitRGBtoRGBSurfaceAlphaMMX(const BlitInfo& info)
+{
+    const PixelFormat&  df       = info.mpDest->mPixelFormat;
+    const uint32_t      chanmask = df.mRMask | df.mGMask | df.mBMask;
+    const uint32_t      dalpha   = df.mAMask;
+    const unsigned      alpha    = info.mpSource->mPixelFormat.mSurfaceAlpha;
+    const int           width    = info.mnDWidth;
+    int                 height   = info.mnDHeight;
+    const uint32_t*     pSrc     = (const uint32_t*)info.mpSPixels;
+    const int           srcskip  = info.mnSSkip >> 2;
+    uint32_t*           pDst     = (uint32_t*)info.mpDPixels;
+    const int           dstskip  = info.mnDSkip >> 2;
+    uint32_t            amult;
+   
+    if(info.mDoAdditiveBlend)    
+    {
+        __m64  src1, dst1, mm_alpha, mm_zero, dsta, mm_overflow;
+        
+        mm_zero  = _mm_setzero_si64();          // 0 -> mm_zero
+          
+        // So the alpha stay fixed in this version...
+        unsigned invAlpha = 255 - alpha;    // Inverse alpha
+        amult    = invAlpha | (invAlpha << 8);
+        amult    = amult | (amult << 16);
+        mm_alpha = _mm_set_pi32(0, amult & chanmask);   // 0000AAAA -> mm_alpha, minus 1 chan
+        mm_alpha = _mm_unpacklo_pi8(mm_alpha, mm_zero); // 0A0A0A0A -> mm_alpha, minus 1 chan
+
+        // At this point mm_alpha can be 000A0A0A or 0A0A0A00 or another combo
+        dsta = _mm_set_pi32(0x00, dalpha); // pDest alpha mask -> dsta
+        
+        
+        int filter = ~(dalpha);
+        mm_overflow = _mm_set_pi32(0, filter);                  // 0000AAAA 
+        mm_overflow = _mm_unpacklo_pi8(mm_overflow, mm_zero);   // 0A0A0A0A 
+      
+        while (height--)
+        {
+            int n = width;
+            while(n--)
+            {
+                // Extract the colors
+                dst1 = _mm_cvtsi32_si64(*pDst);                     // pDest(ARGB) -> dst1 (0000ARGB)
+                src1 = _mm_cvtsi32_si64(*pSrc);                     // pSource(ARGB) -> src1 (0000ARGB)
+                src1 = _mm_unpacklo_pi8(src1, mm_zero);             // 000R0G0B -> src1  
+                dst1 = _mm_unpacklo_pi8(dst1, mm_zero);             // 0A0R0G0B -> dst1
+
+                // Blend the destination color with the inverse alpha         
+                dst1 = _mm_mullo_pi16(dst1, mm_alpha);              // dst1 * invAlpha 
+                dst1 = _mm_srli_pi16(dst1, 8);                      // src1 >> 8 -> src1(000R0G0B) = /256 (technically should be 255 but this is faster)
+                
+                // Additive color
+                dst1 = _mm_add_pi16(src1, dst1);                    // src1 + dst1 (additive)
+
+                // Check for color saturation beyond 0xff
+                src1 =_mm_cmpgt_pi16 (dst1, mm_overflow);           // Compare against 0x00ff00ff00ff00ff
+                dst1 =_mm_andnot_si64(src1, dst1);                  // Filter our dst1 resutls that overflow
+                dst1 = _mm_or_si64 (dst1, src1);                    // Add in 0xffff to the colors that overflowed
+                          
+                // Pack down to byte format
+                dst1 = _mm_and_si64(dst1, mm_overflow);             // Clean out the high bytes for the packing and the alpha channel
+                dst1 = _mm_packs_pu16(dst1, mm_zero);               // 0000ARGB -> dst1
+            
+                // Add in the source alpha
+                dst1 = _mm_or_si64 (dst1, dsta);               
+                *pDst = _mm_cvtsi64_si32(dst1);                     // dst1 -> pixel
+            
+                ++pSrc;
+                ++pDst;            
+            }
+
+            pSrc += srcskip;
+            pDst += dstskip;
+        }
+    }
+    else
+    {
+         __m64               src1, src2, dst1, dst2, mm_alpha, mm_zero, dsta;
+
+        mm_zero = _mm_setzero_si64(); // 0 -> mm_zero
+
+        // Form the alpha mult.
+        amult    = alpha | (alpha << 8);
+        amult    = amult | (amult << 16);
+        mm_alpha = _mm_set_pi32(0, amult & chanmask);   // 0000AAAA -> mm_alpha, minus 1 chan
+        mm_alpha = _mm_unpacklo_pi8(mm_alpha, mm_zero); // 0A0A0A0A -> mm_alpha, minus 1 chan
+
+        // At this point mm_alpha can be 000A0A0A or 0A0A0A00 or another combo
+        dsta = _mm_set_pi32(dalpha, dalpha); // pDest alpha mask -> dsta
+        
+        while (height--)
+        {
+            int n = width;
+
+            if (n & 1)
+            {
+                // One pixel Blend
+                src2 = _mm_cvtsi32_si64(*pSrc);         // pSource(ARGB) -> src2 (0000ARGB)
+                src2 = _mm_unpacklo_pi8(src2, mm_zero); // 0A0R0G0B -> src2
+
+                dst1 = _mm_cvtsi32_si64(*pDst);         // pDest(ARGB) -> dst1 (0000ARGB)
+                dst1 = _mm_unpacklo_pi8(dst1, mm_zero); // 0A0R0G0B -> dst1
+
+                src2 = _mm_sub_pi16(src2, dst1);        // src2 - dst2 -> src2
+                src2 = _mm_mullo_pi16(src2, mm_alpha);  // src2 * alpha -> src2
+                src2 = _mm_srli_pi16(src2, 8);          // src2 >> 8 -> src2
+                dst1 = _mm_add_pi8(src2, dst1);         // src2 + dst1 -> dst1
+                
+                dst1 = _mm_packs_pu16(dst1, mm_zero);   // 0000ARGB -> dst1
+                dst1 = _mm_or_si64(dst1, dsta);         // dsta | dst1 -> dst1
+                *pDst = _mm_cvtsi64_si32(dst1);         // dst1 -> pixel
+
+                ++pSrc;
+                ++pDst;
+                
+                n--;
+            }
+
+            for (n >>= 1; n > 0; --n)
+            {
+                // Two Pixels Blend
+                src1 = *(__m64*)pSrc;                   // 2 x pSource -> src1(ARGBARGB)
+                src2 = src1;                            // 2 x pSource -> src2(ARGBARGB)
+                src1 = _mm_unpacklo_pi8(src1, mm_zero); // low - 0A0R0G0B -> src1
+                src2 = _mm_unpackhi_pi8(src2, mm_zero); // high - 0A0R0G0B -> src2
+
+                dst1 = *(__m64*)pDst;                   // 2 x pDest -> dst1(ARGBARGB)
+                dst2 = dst1;                            // 2 x pDest -> dst2(ARGBARGB)
+                dst1 = _mm_unpacklo_pi8(dst1, mm_zero); // low - 0A0R0G0B -> dst1
+                dst2 = _mm_unpackhi_pi8(dst2, mm_zero); // high - 0A0R0G0B -> dst2
+
+                src1 = _mm_sub_pi16(src1, dst1);        // src1 - dst1 -> src1
+                src1 = _mm_mullo_pi16(src1, mm_alpha);  // src1 * alpha -> src1
+                src1 = _mm_srli_pi16(src1, 8);          // src1 >> 8 -> src1
+                dst1 = _mm_add_pi8(src1, dst1);         // src1 + dst1(dst1) -> dst1
+
+                src2 = _mm_sub_pi16(src2, dst2);        // src2 - dst2 -> src2
+                src2 = _mm_mullo_pi16(src2, mm_alpha);  // src2 * alpha -> src2
+                src2 = _mm_srli_pi16(src2, 8);          // src2 >> 8 -> src2
+                dst2 = _mm_add_pi8(src2, dst2);         // src2 + dst2(dst2) -> dst2
+                
+                dst1 = _mm_packs_pu16(dst1, dst2);      // 0A0R0G0B(res1), 0A0R0G0B(res2) -> dst1(ARGBARGB)
+                dst1 = _mm_or_si64(dst1, dsta);         // dsta | dst1 -> dst1
+
+                *(__m64*)pDst = dst1;                   // dst1 -> 2 x pixel
+
+                pSrc += 2;
+                pDst += 2;
+            }
+
+            pSrc += srcskip;
+            pDst += dstskip;
+        }
+    }
+    _mm_empty();
+}
+
+
+// Fast ARGB -> XRGB/ARGB with pixel alpha.
+static void BlitRGBtoRGBPixelAlphaMMX(const BlitInfo& info)
+{
+    const int           width    = info.mnDWidth;
+    int                 height   = info.mnDHeight;
+    const uint32_t*     pSrc     = (uint32_t*)info.mpSPixels;
+    const int           srcskip  = info.mnSSkip >> 2;
+    uint32_t*           pDst     = (uint32_t*)info.mpDPixels;
+    const int           dstskip  = info.mnDSkip >> 2;
+    const PixelFormat&  sf       = info.mpSource->mPixelFormat;
+    const uint32_t      chanmask = sf.mRMask | sf.mGMask | sf.mBMask;
+    const uint32_t      amask    = sf.mAMask;
+    const uint32_t      ashift   = sf.mAShift;
+    uint64_t            multmask;
+    __m64               src1, dst1, mm_alpha, mm_zero, dmask;
+
+    mm_zero  = _mm_setzero_si64();          // 0 -> mm_zero
+    multmask = ~(0x000000000000FFFFi64 << (ashift * 2));
+    dmask    = *(__m64*)&multmask;          // pDest alpha mask -> dmask
+
+    if(info.mDoAdditiveBlend)    
+    {
+        // This is doing an additive alpha blend: source + dest * inv alpha 
+        __m64 mm_overflow,mm_dst_alpha;
+        mm_overflow = _mm_set_pi16(0xff,0xff,0xff,0xff);
+        mm_overflow =  _mm_and_si64(mm_overflow, dmask);    // Keep alpha channel 0x0 so can be used to clean it too    
+
+        while(height--)
+        {
+            DUFFS_LOOP4({
+                uint32_t alpha = *pSrc & amask;
+                uint32_t destApha = *pDst & amask;
+                
+                if (alpha == 0)
+                {
+                    // do nothing
+                }
+                else if(!destApha)
+                {
+                    // 7/23/09 CSidhall - Added 0 alpha case for destination for the MMX blend bellow will fail with a 0 dest alpha
+                    *pDst = *pSrc;         
+                }
+                else if (alpha == amask)
+                {
+                    // opaque alpha -- copy RGB, keep pDest alpha
+                    *pDst = (*pSrc & chanmask) | (*pDst & ~chanmask);
+                }
+                else
+                {
+                    // Extract the colors
+                    src1 = _mm_cvtsi32_si64(*pSrc);                     // pSource(ARGB) -> src1 (0000ARGB)
+                    dst1 = _mm_cvtsi32_si64(*pDst);                     // pDest(ARGB) -> dst1 (0000ARGB)
+                    mm_alpha = _mm_srli_si64(src1, ashift);             // Grab the alpha: mm_alpha >> ashift -> mm_alpha(0000000A) 
+                    src1 = _mm_unpacklo_pi8(src1, mm_zero);             // 000R0G0B -> src1  
+                    dst1 = _mm_unpacklo_pi8(dst1, mm_zero);             // 0A0R0G0B -> dst1
+                    mm_dst_alpha =_mm_andnot_si64( dmask, dst1);        // Grab the destination alpha
+
+                    // Build the inverse alpha and broadcast it to all the color channels 
+                    // We don't care if it goes into the alpha channel as this will be cleaned later
+                    mm_alpha =_mm_sub_pi8(mm_overflow, mm_alpha);       // inverse alpha: 255 - alpha - we ignore the upper words
+                    mm_alpha = _mm_unpacklo_pi16(mm_alpha, mm_alpha);   // 00000A0A -> mm_alpha
+                    mm_alpha = _mm_unpacklo_pi32(mm_alpha, mm_alpha);   // 0A0A0A0A -> mm_alpha
+
+                    // Blend the destination color with the inverse alpha         
+                    dst1 = _mm_mullo_pi16(dst1, mm_alpha);              // dst1 * invAlpha 
+                    dst1 = _mm_srli_pi16(dst1, 8);                      // src1 >> 8 -> src1(000R0G0B) = /256 (technically should be 255 but this is faster)
+                    
+                    // Additive color
+                    dst1 = _mm_add_pi16(src1, dst1);                    // src1 + dst1 (additive)
+
+                    // Check for color saturation
+                    src1 =_mm_cmpgt_pi16 (dst1, mm_overflow);           // Compare against 0x00ff00ff00ff00ff
+                    dst1 =_mm_andnot_si64(src1, dst1);                  // Filter our dst1 resutls that overflow
+                    dst1 = _mm_or_si64 (dst1, src1);                    // Add in 0xffff to the colors that overflowed
+                
+                    // Add in the source alpha
+                    dst1 = _mm_and_si64(dst1, mm_overflow);             // Clean out the high bytes for the packing and alpha channel
+                    dst1 = _mm_or_si64 (dst1, mm_dst_alpha);
+
+                    // Pack down to byte format
+                    dst1 = _mm_packs_pu16(dst1, mm_zero);               // 0000ARGB -> dst1
+                    *pDst = _mm_cvtsi64_si32(dst1);                     // dst1 -> pixel
+                }
+
+                ++pSrc;
+                ++pDst;
+            }, width);
+
+            pSrc += srcskip;
+            pDst += dstskip;
+        }
+    }   
+    else
+    {
+        // This is a normal alpha blend: source * alpha + dest * inv alpha
+        while(height--)
+        {
+            DUFFS_LOOP4({
+                uint32_t alpha = *pSrc & amask;
+                uint32_t destApha = *pDst & amask;
+                
+                if (alpha == 0)
+                {
+                    // do nothing
+                }
+                else if(!destApha)
+                {
+                    // 7/23/09 CSidhall - Added 0 alpha case for destination for the MMX blend bellow will fail with a 0 dest alpha
+                    *pDst = *pSrc;         
+                }
+                else if (alpha == amask)
+                {
+                    // opaque alpha -- copy RGB, keep pDest alpha
+                    *pDst = (*pSrc & chanmask) | (*pDst & ~chanmask);
+                }
+                else
+                {
+                    src1 = _mm_cvtsi32_si64(*pSrc);             // pSource(ARGB) -> src1 (0000ARGB)
+                    src1 = _mm_unpacklo_pi8(src1, mm_zero);     // 0A0R0G0B -> src1
+
+                    dst1 = _mm_cvtsi32_si64(*pDst);             // pDest(ARGB) -> dst1 (0000ARGB)
+                    dst1 = _mm_unpacklo_pi8(dst1, mm_zero);     // 0A0R0G0B -> dst1
+
+                    mm_alpha = _mm_cvtsi32_si64(alpha);                 // alpha -> mm_alpha (0000000A)
+                    mm_alpha = _mm_srli_si64(mm_alpha, ashift);         // mm_alpha >> ashift -> mm_alpha(0000000A)
+                    mm_alpha = _mm_unpacklo_pi16(mm_alpha, mm_alpha);   // 00000A0A -> mm_alpha
+                    mm_alpha = _mm_unpacklo_pi32(mm_alpha, mm_alpha);   // 0A0A0A0A -> mm_alpha
+                    mm_alpha = _mm_and_si64(mm_alpha, dmask);           // 000A0A0A -> mm_alpha, preserve pDest alpha on add
+
+                    // blend          
+                    src1 = _mm_sub_pi16(src1, dst1);            // src1 - dst1 -> src1
+                    src1 = _mm_mullo_pi16(src1, mm_alpha);      // (src1 - dst1) * alpha -> src1
+                    src1 = _mm_srli_pi16(src1, 8);              // src1 >> 8 -> src1(000R0G0B)
+                    dst1 = _mm_add_pi8(src1, dst1);             // src1 + dst1 -> dst1(0A0R0G0B)
+                    dst1 = _mm_packs_pu16(dst1, mm_zero);       // 0000ARGB -> dst1
+                    
+                    *pDst = _mm_cvtsi64_si32(dst1);             // dst1 -> pixel
+                }
+
+                ++pSrc;
+                ++pDst;
+            }, width);
+
+            pSrc += srcskip;
+            pDst += dstskip;
+        }
+    }   
+   _mm_empty();
+}
+
+
+// Fast (as in MMX with prefetch) ARGB888->(A)RGB888 blending with pixel alpha.
+static void BlitRGBtoRGBPixelAlphaMMX3DNOW(const BlitInfo& info)
+{
+    const int           width    = info.mnDWidth;
+    int                 height   = info.mnDHeight;
+    const uint32_t*     pSrc     = (uint32_t*)info.mpSPixels;
+    const int           srcskip  = info.mnSSkip >> 2;
+    uint32_t*           pDst     = (uint32_t*)info.mpDPixels;
+    const int           dstskip  = info.mnDSkip >> 2;
+    const PixelFormat&  sf       = info.mpSource->mPixelFormat;
+    const uint32_t      chanmask = sf.mRMask | sf.mGMask | sf.mBMask;
+    const uint32_t      amask    = sf.mAMask;
+    const uint32_t      ashift   = sf.mAShift;
+    uint64_t            multmask;
+    __m64               src1, dst1, mm_alpha, mm_zero, dmask;
+
+    mm_zero  = _mm_setzero_si64();          // 0 -> mm_zero
+    multmask = ~(0x000000000000FFFFi64 << (ashift * 2));
+    dmask    = *(__m64*)&multmask;          // pDest alpha mask -> dmask
+
+    if(info.mDoAdditiveBlend)    
+    {
+        // This is doing an additive alpha blend: source + dest * inv alpha 
+        __m64 mm_overflow,mm_dst_alpha;
+        mm_overflow = _mm_set_pi16(0xff,0xff,0xff,0xff);
+        mm_overflow =  _mm_and_si64(mm_overflow, dmask);    // Keep alpha channel 0x0 so can be used to clean it too    
+
+        while(height--)
+        {
+            DUFFS_LOOP4({
+                uint32_t alpha;
+                uint32_t destApha;
+
+                // 3D Now 
+                _m_prefetch((uint32_t*)pSrc + 16);
+                _m_prefetch((uint32_t*)pDst + 16);
+
+                alpha = *pSrc & amask;
+                destApha = *pDst & amask;
+                
+                if (alpha == 0)
+                {
+                    // do nothing
+                }
+                else if(!destApha)
+                {
+                    // 7/23/09 CSidhall - Added 0 alpha case for destination for the MMX blend bellow will fail with a 0 dest alpha
+                    *pDst = *pSrc;         
+                }
+                else if (alpha == amask)
+                {
+                    // opaque alpha -- copy RGB, keep pDest alpha
+                    *pDst = (*pSrc & chanmask) | (*pDst & ~chanmask);
+                }
+                else
+                {
+                    // Extract the colors
+                    src1 = _mm_cvtsi32_si64(*pSrc);                     // pSource(ARGB) -> src1 (0000ARGB)
+                    dst1 = _mm_cvtsi32_si64(*pDst);                     // pDest(ARGB) -> dst1 (0000ARGB)
+                    mm_alpha = _mm_srli_si64(src1, ashift);             // Grab the alpha: mm_alpha >> ashift -> mm_alpha(0000000A) 
+                    src1 = _mm_unpacklo_pi8(src1, mm_zero);             // 000R0G0B -> src1  
+                    dst1 = _mm_unpacklo_pi8(dst1, mm_zero);             // 0A0R0G0B -> dst1
+                    mm_dst_alpha =_mm_andnot_si64( dmask, dst1);        // Grab the destination alpha
+
+                    // Build the inverse alpha and broadcast it to all the color channels 
+                    // We don't care if it goes into the alpha channel as this will be cleaned later
+                    mm_alpha =_mm_sub_pi8(mm_overflow, mm_alpha);       // inverse alpha: 255 - alpha - we ignore the upper words
+                    mm_alpha = _mm_unpacklo_pi16(mm_alpha, mm_alpha);   // 00000A0A -> mm_alpha
+                    mm_alpha = _mm_unpacklo_pi32(mm_alpha, mm_alpha);   // 0A0A0A0A -> mm_alpha
+
+                    // Blend the destination color with the inverse alpha         
+                    dst1 = _mm_mullo_pi16(dst1, mm_alpha);              // dst1 * invAlpha 
+                    dst1 = _mm_srli_pi16(dst1, 8);                      // src1 >> 8 -> src1(000R0G0B) = /256 (technically should be 255 but this is faster)
+                    
+                    // Additive color
+                    dst1 = _mm_add_pi16(src1, dst1);                    // src1 + dst1 (additive)
+
+                    // Check for color saturation
+                    src1 =_mm_cmpgt_pi16 (dst1, mm_overflow);           // Compare against 0x00ff00ff00ff00ff
+                    dst1 =_mm_andnot_si64(src1, dst1);                  // Filter our dst1 resutls that overflow
+                    dst1 = _mm_or_si64 (dst1, src1);                    // Add in 0xffff to the colors that overflowed
+                
+                    // Add in the source alpha
+                    dst1 = _mm_and_si64(dst1, mm_overflow);             // Clean out the high bytes for the packing
+                    dst1 = _mm_or_si64 (dst1, mm_dst_alpha);
+
+                    // Pack down to byte format
+                    dst1 = _mm_packs_pu16(dst1, mm_zero);               // 0000ARGB -> dst1
+                    *pDst = _mm_cvtsi64_si32(dst1);                     // dst1 -> pixel
+                }
+
+                ++pSrc;
+                ++pDst;
+            }, width);
+            
+            pSrc += srcskip;
+            pDst += dstskip;
+        }
+        _mm_empty();
+    
+    }   
+    else
+    {
+        // This is a normal alpha blend: source * alpha + dest * inv alpha
+        while(height--)
+        {
+            DUFFS_LOOP4({
+                uint32_t alpha;
+                uint32_t destApha;
+
+                // 3D Now 
+                _m_prefetch((uint32_t*)pSrc + 16);
+                _m_prefetch((uint32_t*)pDst + 16);
+
+                alpha = *pSrc & amask;
+                destApha = *pDst & amask;
+                
+                if (alpha == 0)
+                {
+                    // do nothing
+                }
+                else if(!destApha)
+                {
+                    // 7/23/09 CSidhall - Added 0 alpha case for destination for the MMX blend bellow will fail with a 0 dest alpha
+                    *pDst = *pSrc;         
+                }
+                else if (alpha == amask)
+                {
+                    // opaque alpha -- copy RGB, keep pDest alpha
+                    *pDst = (*pSrc & chanmask) | (*pDst & ~chanmask);
+                }
+                else
+                {
+                    src1 = _mm_cvtsi32_si64(*pSrc);             // pSource(ARGB) -> src1 (0000ARGB)
+                    src1 = _mm_unpacklo_pi8(src1, mm_zero);     // 0A0R0G0B -> src1
+
+                    dst1 = _mm_cvtsi32_si64(*pDst);             // pDest(ARGB) -> dst1 (0000ARGB)
+                    dst1 = _mm_unpacklo_pi8(dst1, mm_zero);     // 0A0R0G0B -> dst1
+
+                    mm_alpha = _mm_cvtsi32_si64(alpha);                 // alpha -> mm_alpha (0000000A)
+                    mm_alpha = _mm_srli_si64(mm_alpha, ashift);         // mm_alpha >> ashift -> mm_alpha(0000000A)
+                    mm_alpha = _mm_unpacklo_pi16(mm_alpha, mm_alpha);   // 00000A0A -> mm_alpha
+                    mm_alpha = _mm_unpacklo_pi32(mm_alpha, mm_alpha);   // 0A0A0A0A -> mm_alpha
+                    mm_alpha = _mm_and_si64(mm_alpha, dmask);           // 000A0A0A -> mm_alpha, preserve pDest alpha on add
+
+                    // blend          
+                    src1 = _mm_sub_pi16(src1, dst1);            // src1 - dst1 -> src1
+                    src1 = _mm_mullo_pi16(src1, mm_alpha);      // (src1 - dst1) * alpha -> src1
+                    src1 = _mm_srli_pi16(src1, 8);              // src1 >> 8 -> src1(000R0G0B)
+                    dst1 = _mm_add_pi8(src1, dst1);             // src1 + dst1 -> dst1(0A0R0G0B)
+                    dst1 = _mm_packs_pu16(dst1, mm_zero);       // 0000ARGB -> dst1
+                    
+                    *pDst = _mm_cvtsi64_si32(dst1);             // dst1 -> pixel
+                }
+
+                ++pSrc;
+                ++pDst;
+            }, width);
+
+            pSrc += srcskip;
+            pDst += dstskip;
+        }
+        _mm_empty();
+    }   
+}
+
+
+
+#endif // MSVC_ASMBLIT
+
+
+
+#if SSE2_BLIT
+
+// The SSE2 and AVX2 blits work on 4 and 8 pixels at a time. They use an accurate divide by 255 
+// for the normal blend, which also gets the fully opaque and fully transparent source cases right 
+// without special-casing them. Additive blending matches the C version: src + (dst * (255 - alpha) >> 8), 
+// clamped to 255.
+
+
+// Blends the color channels of 4 source pixels onto 4 dest pixels. aLo and aHi hold the alpha for 
+// each 16 bit channel of the low and high two pixels. The alpha channel of the result is undefined.
+static inline __m128i BlendChannelsSSE2(__m128i s, __m128i d, __m128i aLo, __m128i aHi, bool bAdditive)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c255 = _mm_set1_epi16(0xff);
+    const __m128i dLo  = _mm_unpacklo_epi8(d, zero);
+    const __m128i dHi  = _mm_unpackhi_epi8(d, zero);
+
+    if(bAdditive)
+    {
+        const __m128i tLo = _mm_srli_epi16(_mm_mullo_epi16(dLo, _mm_sub_epi16(c255, aLo)), 8);
+        const __m128i tHi = _mm_srli_epi16(_mm_mullo_epi16(dHi, _mm_sub_epi16(c255, aHi)), 8);
+
+        return _mm_adds_epu8(s, _mm_packus_epi16(tLo, tHi));
+    }
+
+    // (s * a + d * (255 - a) + 128) / 255. Everything fits in 16 bits unsigned.
+    const __m128i c128 = _mm_set1_epi16(0x80);
+    const __m128i sLo  = _mm_unpacklo_epi8(s, zero);
+    const __m128i sHi  = _mm_unpackhi_epi8(s, zero);
+    __m128i       tLo  = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(sLo, aLo), _mm_mullo_epi16(dLo, _mm_sub_epi16(c255, aLo))), c128);
+    __m128i       tHi  = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(sHi, aHi), _mm_mullo_epi16(dHi, _mm_sub_epi16(c255, aHi))), c128);
+
+    tLo = _mm_srli_epi16(_mm_add_epi16(tLo, _mm_srli_epi16(tLo, 8)), 8);
+    tHi = _mm_srli_epi16(_mm_add_epi16(tHi, _mm_srli_epi16(tHi, 8)), 8);
+
+    return _mm_packus_epi16(tLo, tHi);
+}
+
+
+// Selects a where mask is set, else b.
+static inline __m128i SelectSSE2(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+
+// ARGB -> ARGB blending of 4 pixels with source pixel alpha. 
+static inline __m128i PixelAlphaBlend4SSE2(__m128i s, __m128i d, bool bAdditive)
+{
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i amask = _mm_set1_epi32((int)0xff000000);
+
+    // Spread the alpha of each pixel over its channels.
+    const __m128i sLo = _mm_unpacklo_epi8(s, zero);
+    const __m128i sHi = _mm_unpackhi_epi8(s, zero);
+    const __m128i aLo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sLo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128i aHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sHi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+    __m128i result = BlendChannelsSSE2(s, d, aLo, aHi, bAdditive);
 
-                        *pDst = d1 | d | dalpha;
-        
-                    }
-                }
+    // Like the C version: the dest alpha is kept, a dest with zero alpha takes the source as-is 
+    // and a source with zero alpha leaves the dest alone.
+    result = SelectSSE2(amask, d, result);
+    result = SelectSSE2(_mm_cmpeq_epi32(_mm_and_si128(d, amask), zero), s, result);
+    result = SelectSSE2(_mm_cmpeq_epi32(_mm_and_si128(s, amask), zero), d, result);
 
-                ++pSrc;
-                ++pDst;
-            }, width);
+    return result;
+}
 
-            pSrc += srcskip;
-            pDst += dstskip;
+
+// XRGB -> XRGB/ARGB blending of 4 pixels with source surface alpha. 
+static inline __m128i SurfaceAlphaBlend4SSE2(__m128i s, __m128i d, __m128i alpha, bool bAdditive)
+{
+    const __m128i amask = _mm_set1_epi32((int)0xff000000);
+
+    return _mm_or_si128(BlendChannelsSSE2(s, d, alpha, alpha, bAdditive), amask);
+}
+
+
+// Fast ARGB -> ARGB blending with source pixel alpha.
+static void BlitRGBtoRGBPixelAlphaSSE2(const BlitInfo& info)
+{
+    const int       width     = info.mnDWidth;
+    int             height    = info.mnDHeight;
+    const uint32_t* pSrc      = (uint32_t*)info.mpSPixels;
+    const int       srcskip   = info.mnSSkip >> 2;
+    uint32_t*       pDst      = (uint32_t*)info.mpDPixels;
+    const int       dstskip   = info.mnDSkip >> 2;
+    const bool      bAdditive = info.mDoAdditiveBlend;
+    const __m128i   zero      = _mm_setzero_si128();
+    const __m128i   amask     = _mm_set1_epi32((int)0xff000000);
+
+    while(height--)
+    {
+        int n = width;
+
+        for(; n >= 4; n -= 4, pSrc += 4, pDst += 4)
+        {
+            const __m128i s = _mm_loadu_si128((const __m128i*)pSrc);
+
+            // Fully transparent runs are common (glyph and image borders), so we skip them.
+            if(_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(s, amask), zero)) == 0xffff)
+                continue;
+
+            const __m128i d = _mm_loadu_si128((const __m128i*)pDst);
+            _mm_storeu_si128((__m128i*)pDst, PixelAlphaBlend4SSE2(s, d, bAdditive));
+        }
+
+        if(n)
+        {
+            // The last few pixels go through the same math so they match the rest of the row.
+            uint32_t sTail[4] = { 0, 0, 0, 0 };
+            uint32_t dTail[4] = { 0, 0, 0, 0 };
+
+            memcpy(sTail, pSrc, n * sizeof(uint32_t));
+            memcpy(dTail, pDst, n * sizeof(uint32_t));
+            _mm_storeu_si128((__m128i*)dTail, PixelAlphaBlend4SSE2(_mm_loadu_si128((const __m128i*)sTail), _mm_loadu_si128((const __m128i*)dTail), bAdditive));
+            memcpy(pDst, dTail, n * sizeof(uint32_t));
+
+            pSrc += n;
+            pDst += n;
         }
+
+        pSrc += srcskip;
+        pDst += dstskip;
     }
 }
 
 
-// General (slow) N->N blending with per-surface alpha.
-static void BlitNtoNSurfaceAlpha(const BlitInfo& info)
+// Fast RGB888 -> (A)RGB888 blending with source surface alpha.
+static void BlitRGBtoRGBSurfaceAlphaSSE2(const BlitInfo& info)
 {
-    const int            width   = info.mnDWidth;
-    int                  height  = info.mnDHeight;
-    const uint8_t*       pSource = info.mpSPixels;
-    const int            srcskip = info.mnSSkip;
-    uint8_t*             pDest   = info.mpDPixels;
-    const int            dstskip = info.mnDSkip;
-    const PixelFormat&   srcfmt  = info.mpSource->mPixelFormat;
-    const PixelFormat&   dstfmt  = info.mpDest->mPixelFormat;
-    const int            srcbpp  = srcfmt.mBytesPerPixel;
-    const int            dstbpp  = dstfmt.mBytesPerPixel;
-    const unsigned       sA      = srcfmt.mSurfaceAlpha;
-    const unsigned       dA      = dstfmt.mAMask ? 255 : 0;
-
-    if (sA)
+    const int       width     = info.mnDWidth;
+    int             height    = info.mnDHeight;
+    const uint32_t* pSrc      = (uint32_t*)info.mpSPixels;
+    const int       srcskip   = info.mnSSkip >> 2;
+    uint32_t*       pDst      = (uint32_t*)info.mpDPixels;
+    const int       dstskip   = info.mnDSkip >> 2;
+    const bool      bAdditive = info.mDoAdditiveBlend;
+    const __m128i   alpha     = _mm_set1_epi16((short)info.mpSource->mPixelFormat.mSurfaceAlpha);
+
+    while(height--)
     {
-        if(info.mDoAdditiveBlend)  
-        { 
-            // Additive alpha blend        
-            while (height--)
-            {
-                DUFFS_LOOP4(
-                {
-                    uint32_t pixel;
-                    unsigned sR;
-                    unsigned sG;
-                    unsigned sB;
-                    unsigned dR;
-                    unsigned dG;
-                    unsigned dB;
+        int n = width;
 
-                    DISEMBLE_RGB(pSource, srcbpp, srcfmt, pixel, sR, sG, sB);
-                    DISEMBLE_RGB(pDest,   dstbpp, dstfmt, pixel, dR, dG, dB);
-                    ADDITIVE_ALPHA_BLEND(sR, sG, sB, sA, dR, dG, dB);
-                    ASSEMBLE_RGBA(pDest, dstbpp, dstfmt, dR, dG, dB, dA);
+        for(; n >= 4; n -= 4, pSrc += 4, pDst += 4)
+        {
+            const __m128i s = _mm_loadu_si128((const __m128i*)pSrc);
+            const __m128i d = _mm_loadu_si128((const __m128i*)pDst);
+            _mm_storeu_si128((__m128i*)pDst, SurfaceAlphaBlend4SSE2(s, d, alpha, bAdditive));
+        }
 
-                    pSource += srcbpp;
-                    pDest   += dstbpp;
-                }, width);
+        if(n)
+        {
+            uint32_t sTail[4] = { 0, 0, 0, 0 };
+            uint32_t dTail[4] = { 0, 0, 0, 0 };
 
-                pSource += srcskip;
-                pDest   += dstskip;
-            }
+            memcpy(sTail, pSrc, n * sizeof(uint32_t));
+            memcpy(dTail, pDst, n * sizeof(uint32_t));
+            _mm_storeu_si128((__m128i*)dTail, SurfaceAlphaBlend4SSE2(_mm_loadu_si128((const __m128i*)sTail), _mm_loadu_si128((const __m128i*)dTail), alpha, bAdditive));
+            memcpy(pDst, dTail, n * sizeof(uint32_t));
+
+            pSrc += n;
+            pDst += n;
         }
-        else
-        {         
-            // Standard alpha blend
-            while (height--)
-            {
-                DUFFS_LOOP4(
-                {
-                    uint32_t pixel;
-                    unsigned sR;
-                    unsigned sG;
-                    unsigned sB;
-                    unsigned dR;
-                    unsigned dG;
-                    unsigned dB;
 
-                    DISEMBLE_RGB(pSource, srcbpp, srcfmt, pixel, sR, sG, sB);
-                    DISEMBLE_RGB(pDest,   dstbpp, dstfmt, pixel, dR, dG, dB);
-                    ALPHA_BLEND(sR, sG, sB, sA, dR, dG, dB);
-                    ASSEMBLE_RGBA(pDest, dstbpp, dstfmt, dR, dG, dB, dA);
+        pSrc += srcskip;
+        pDst += dstskip;
+    }
+}
 
-                    pSource += srcbpp;
-                    pDest   += dstbpp;
-                }, width);
+// Multiplies the alpha of 4 ARGB pixels by opacity, which holds the opacity in each 32 bit lane.
+// Sources without alpha are treated as opaque.
+static inline __m128i ModulateAlpha4SSE2(__m128i s, __m128i opacity, bool bSourceAlpha)
+{
+    const __m128i c255 = _mm_set1_epi32(0xff);
+    const __m128i a    = bSourceAlpha ? _mm_srli_epi32(s, 24) : c255;
 
-                pSource += srcskip;
-                pDest   += dstskip;
-            }
-       }
-    
-    }
+    // a * opacity fits in the low 16 bits of each lane.
+    const __m128i aMod = _mm_srli_epi32(_mm_add_epi32(_mm_mullo_epi16(a, opacity), c255), 8);
+
+    return _mm_or_si128(_mm_and_si128(s, _mm_set1_epi32(0x00ffffff)), _mm_slli_epi32(aMod, 24));
 }
 
 
-// General (slow) N->N blending with pixel alpha.
-static void BlitNtoNPixelAlpha(const BlitInfo& info)
+// ARGB/XRGB -> ARGB blending with the source alpha multiplied by info.mnOpacity.
+static void BlitRGBtoRGBOpacitySSE2(const BlitInfo& info)
 {
-    const int            width   = info.mnDWidth;
-    int                  height  = info.mnDHeight;
-    const uint8_t*       pSource = info.mpSPixels;
-    const int            srcskip = info.mnSSkip;
-    uint8_t*             pDest   = info.mpDPixels;
-    const int            dstskip = info.mnDSkip;
-    const PixelFormat&   srcfmt  = info.mpSource->mPixelFormat;
-    const PixelFormat&   dstfmt  = info.mpDest->mPixelFormat;
-    const int            srcbpp  = srcfmt.mBytesPerPixel;
-    const int            dstbpp  = dstfmt.mBytesPerPixel;
-    
-    // Note: For 8bpp source alpha, this doesn't get opaque values
-    // quite right. For <8bpp source alpha, it gets them very wrong.
-    // It is unclear whether there is a good general solution that doesn't
-    // need a branch (or a divide).
+    const int       width        = info.mnDWidth;
+    int             height       = info.mnDHeight;
+    const uint32_t* pSrc         = (uint32_t*)info.mpSPixels;
+    const int       srcskip      = info.mnSSkip >> 2;
+    uint32_t*       pDst         = (uint32_t*)info.mpDPixels;
+    const int       dstskip      = info.mnDSkip >> 2;
+    const bool      bAdditive    = info.mDoAdditiveBlend;
+    const bool      bSourceAlpha = SourceAlphaEnabled(info.mpSource);
+    const __m128i   opacity      = _mm_set1_epi32(info.mnOpacity);
+    const __m128i   zero         = _mm_setzero_si128();
+    const __m128i   amask        = _mm_set1_epi32((int)0xff000000);
+
+    while(height--)
+    {
+        int n = width;
 
-    if(info.mDoAdditiveBlend)  
-    { 
-        // Additive alpha blend version
-        while (height--)
+        for(; n >= 4; n -= 4, pSrc += 4, pDst += 4)
         {
-            DUFFS_LOOP4(
-            {
-                uint32_t pixel;
-                unsigned sR;
-                unsigned sG;
-                unsigned sB;
-                unsigned dR;
-                unsigned dG;
-                unsigned dB;
-                unsigned sA;
-                unsigned dA;
+            const __m128i s = ModulateAlpha4SSE2(_mm_loadu_si128((const __m128i*)pSrc), opacity, bSourceAlpha);
 
-                DISEMBLE_RGBA(pSource, srcbpp, srcfmt, pixel, sR, sG, sB, sA);
+            if(_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(s, amask), zero)) == 0xffff)
+                continue;
 
-                if(sA)
-                {
-                    DISEMBLE_RGBA(pDest, dstbpp, dstfmt, pixel, dR, dG, dB, dA);
-                    if(!dA)
-                    { 
-                        // 0 alpha background support               
-                        ASSEMBLE_RGBA(pDest, dstbpp, dstfmt, sR, sG, sB, sA);
-                    }
-                    else
-                    {
-                        ADDITIVE_ALPHA_BLEND(sR, sG, sB, sA, dR, dG, dB);
-                        ASSEMBLE_RGBA(pDest, dstbpp, dstfmt, dR, dG, dB, dA);
-                    }
-                }
+            const __m128i d = _mm_loadu_si128((const __m128i*)pDst);
+            _mm_storeu_si128((__m128i*)pDst, PixelAlphaBlend4SSE2(s, d, bAdditive));
+        }
 
-                pSource += srcbpp;
-                pDest   += dstbpp;
-            }, width);
+        if(n)
+        {
+            uint32_t sTail[4] = { 0, 0, 0, 0 };
+            uint32_t dTail[4] = { 0, 0, 0, 0 };
 
-            pSource += srcskip;
-            pDest   += dstskip;
+            memcpy(sTail, pSrc, n * sizeof(uint32_t));
+            memcpy(dTail, pDst, n * sizeof(uint32_t));
+            _mm_storeu_si128((__m128i*)dTail, PixelAlphaBlend4SSE2(ModulateAlpha4SSE2(_mm_loadu_si128((const __m128i*)sTail), opacity, bSourceAlpha), _mm_loadu_si128((const __m128i*)dTail), bAdditive));
+            memcpy(pDst, dTail, n * sizeof(uint32_t));
+
+            pSrc += n;
+            pDst += n;
         }
+
+        pSrc += srcskip;
+        pDst += dstskip;
+    }
+}
+
+// Multiplies all four channels of 4 pixels by scale / 255, rounded. scale is in each 16 bit lane.
+static inline __m128i ScalePixels4SSE2(__m128i s, __m128i scale)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c128 = _mm_set1_epi16(0x80);
+    __m128i       tLo  = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), scale), c128);
+    __m128i       tHi  = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), scale), c128);
+
+    tLo = _mm_srli_epi16(_mm_add_epi16(tLo, _mm_srli_epi16(tLo, 8)), 8);
+    tHi = _mm_srli_epi16(_mm_add_epi16(tHi, _mm_srli_epi16(tHi, 8)), 8);
+
+    return _mm_packus_epi16(tLo, tHi);
+}
+
+
+// Premultiplied source-over of 4 pixels on all four channels: s + d * (255 - a) / 255, or 
+// s + (d * (255 - a) >> 8) for the additive blend.
+static inline __m128i PremultipliedBlend4SSE2(__m128i s, __m128i d, bool bAdditive)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c255 = _mm_set1_epi16(0xff);
+    const __m128i sLo  = _mm_unpacklo_epi8(s, zero);
+    const __m128i sHi  = _mm_unpackhi_epi8(s, zero);
+    const __m128i aLo  = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sLo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128i aHi  = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sHi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m128i       tLo  = _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_sub_epi16(c255, aLo));
+    __m128i       tHi  = _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_sub_epi16(c255, aHi));
+
+    if(!bAdditive)
+    {
+        const __m128i c128 = _mm_set1_epi16(0x80);
+
+        tLo = _mm_add_epi16(tLo, c128);
+        tHi = _mm_add_epi16(tHi, c128);
+        tLo = _mm_add_epi16(tLo, _mm_srli_epi16(tLo, 8));
+        tHi = _mm_add_epi16(tHi, _mm_srli_epi16(tHi, 8));
     }
+
+    return _mm_adds_epu8(s, _mm_packus_epi16(_mm_srli_epi16(tLo, 8), _mm_srli_epi16(tHi, 8)));
+}
+
+
+// Blends 4 PARGB pixels onto pDst the way BlitPARGBtoRGB does.
+static inline void BlitPARGB4SSE2(const uint32_t* pSrc, uint32_t* pDst, __m128i opacity, bool bOpacity, bool bAdditive, bool bPremultipliedDest)
+{
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i amask = _mm_set1_epi32((int)0xff000000);
+    __m128i       s     = _mm_loadu_si128((const __m128i*)pSrc);
+
+    if(bOpacity)
+        s = ScalePixels4SSE2(s, opacity);
+
+    const __m128i sAlphaZero = _mm_cmpeq_epi32(_mm_and_si128(s, amask), zero);
+
+    // Fully transparent runs are common (glyph and image borders), so we skip them.
+    if(_mm_movemask_epi8(sAlphaZero) == 0xffff)
+        return;
+
+    const __m128i d      = _mm_loadu_si128((const __m128i*)pDst);
+    __m128i       result = SelectSSE2(sAlphaZero, d, PremultipliedBlend4SSE2(s, d, bAdditive));
+
+    if(bPremultipliedDest)
+        _mm_storeu_si128((__m128i*)pDst, result);
     else
     {
-        while (height--)
+        _mm_storeu_si128((__m128i*)pDst, SelectSSE2(amask, d, result));
+
+        // A dest with zero alpha takes the source as is, which has to be unpremultiplied. 
+        // That's a division, but it's only the first draw into a cleared layer.
+        const int transparentDest = _mm_movemask_ps(_mm_castsi128_ps(_mm_andnot_si128(sAlphaZero, _mm_cmpeq_epi32(_mm_and_si128(d, amask), zero))));
+
+        if(transparentDest)
         {
-            DUFFS_LOOP4(
+            uint32_t sPixels[4];
+            _mm_storeu_si128((__m128i*)sPixels, s);
+
+            for(int i = 0; i < 4; i++)
             {
-                uint32_t pixel;
-                unsigned sR;
-                unsigned sG;
-                unsigned sB;
-                unsigned dR;
-                unsigned dG;
-                unsigned dB;
-                unsigned sA;
-                unsigned dA;
+                if(transparentDest & (1 << i))
+                    pDst[i] = UnpremultiplyPixel(sPixels[i]);
+            }
+        }
+    }
+}
 
-                DISEMBLE_RGBA(pSource, srcbpp, srcfmt, pixel, sR, sG, sB, sA);
 
-                if(sA)
-                {
-                    DISEMBLE_RGBA(pDest, dstbpp, dstfmt, pixel, dR, dG, dB, dA);
-                    if(!dA)
-                    { 
-                        // 0 alpha background support               
-                        ASSEMBLE_RGBA(pDest, dstbpp, dstfmt, sR, sG, sB, sA);
-                    }
-                    else
-                    {
-                        ALPHA_BLEND(sR, sG, sB, sA, dR, dG, dB);
-                        ASSEMBLE_RGBA(pDest, dstbpp, dstfmt, dR, dG, dB, dA);
-                    }
-                }
+// PARGB -> ARGB/XRGB/PARGB blending with source pixel alpha. See BlitPARGBtoRGB.
+static void BlitPARGBtoRGBSSE2(const BlitInfo& info)
+{
+    const int       width              = info.mnDWidth;
+    int             height             = info.mnDHeight;
+    const uint32_t* pSrc               = (uint32_t*)info.mpSPixels;
+    const int       srcskip            = info.mnSSkip >> 2;
+    uint32_t*       pDst               = (uint32_t*)info.mpDPixels;
+    const int       dstskip            = info.mnDSkip >> 2;
+    const uint32_t  opacity            = MODULATE_ALPHA((uint32_t)info.mnOpacity, (uint32_t)info.mpSource->mPixelFormat.mSurfaceAlpha);
+    const __m128i   opacity16          = _mm_set1_epi16((short)opacity);
+    const bool      bOpacity           = (opacity < 255);
+    const bool      bAdditive          = info.mDoAdditiveBlend;
+    const bool      bPremultipliedDest = (info.mpDest->mPixelFormat.mPixelFormatType == kPixelFormatTypePARGB);
+
+    while(height--)
+    {
+        int n = width;
+
+        for(; n >= 4; n -= 4, pSrc += 4, pDst += 4)
+            BlitPARGB4SSE2(pSrc, pDst, opacity16, bOpacity, bAdditive, bPremultipliedDest);
+
+        if(n)
+        {
+            uint32_t sTail[4] = { 0, 0, 0, 0 };
+            uint32_t dTail[4] = { 0, 0, 0, 0 };
+
+            memcpy(sTail, pSrc, n * sizeof(uint32_t));
+            memcpy(dTail, pDst, n * sizeof(uint32_t));
+            BlitPARGB4SSE2(sTail, dTail, opacity16, bOpacity, bAdditive, bPremultipliedDest);
+            memcpy(pDst, dTail, n * sizeof(uint32_t));
+
+            pSrc += n;
+            pDst += n;
+        }
+
+        pSrc += srcskip;
+        pDst += dstskip;
+    }
+}
+
+// Turns 4 coverage values into 4 ARGB pen pixels with alpha = coverage * penAlpha.
+static inline __m128i MaskToPen4SSE2(uint32_t mask4, __m128i pen, __m128i penAlpha)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c255 = _mm_set1_epi32(0xff);
+    const __m128i cov  = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((int)mask4), zero), zero);
+    const __m128i a    = _mm_srli_epi32(_mm_add_epi32(_mm_mullo_epi16(cov, penAlpha), c255), 8);
+
+    return _mm_or_si128(pen, _mm_slli_epi32(a, 24));
+}
+
+
+static void BlitMaskA8RowSSE2(const uint8_t* pMask, uint32_t* pDst, int width, uint32_t pen, uint32_t penAlpha)
+{
+    const __m128i penV      = _mm_set1_epi32((int)pen);
+    const __m128i penAlphaV = _mm_set1_epi32((int)penAlpha);
+
+    for(; width >= 4; width -= 4, pMask += 4, pDst += 4)
+    {
+        uint32_t mask4;
+        memcpy(&mask4, pMask, sizeof(mask4));
+
+        // Glyphs have a lot of empty space around them.
+        if(!mask4)
+            continue;
+
+        const __m128i d = _mm_loadu_si128((const __m128i*)pDst);
+        _mm_storeu_si128((__m128i*)pDst, PixelAlphaBlend4SSE2(MaskToPen4SSE2(mask4, penV, penAlphaV), d, false));
+    }
+
+    if(width)
+    {
+        uint32_t mask4    = 0;
+        uint32_t dTail[4] = { 0, 0, 0, 0 };
+
+        memcpy(&mask4, pMask, width);
+        memcpy(dTail, pDst, width * sizeof(uint32_t));
+        _mm_storeu_si128((__m128i*)dTail, PixelAlphaBlend4SSE2(MaskToPen4SSE2(mask4, penV, penAlphaV), _mm_loadu_si128((const __m128i*)dTail), false));
+        memcpy(pDst, dTail, width * sizeof(uint32_t));
+    }
+}
+
+// The vertical box blur of 8 columns at a time. The sums are 16 bits, and the average is the high 
+// 16 bits of the sum times the reciprocal, rounded by the top bit of the low 16 bits as in BoxAverage.
+static void BoxBlurRowSSE2(const uint8_t* pAdd, const uint8_t* pSub, uint16_t* pSums, uint8_t* pDest, int width, uint32_t reciprocal)
+{
+    const __m128i zero        = _mm_setzero_si128();
+    const __m128i reciprocalV = _mm_set1_epi16((short)reciprocal);
+
+    for(; width >= 8; width -= 8, pAdd += 8, pSub += 8, pSums += 8, pDest += 8)
+    {
+        const __m128i add     = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)pAdd), zero);
+        const __m128i sub     = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)pSub), zero);
+        const __m128i sums    = _mm_add_epi16(_mm_loadu_si128((const __m128i*)pSums), add);
+        const __m128i average = _mm_add_epi16(_mm_mulhi_epu16(sums, reciprocalV), _mm_srli_epi16(_mm_mullo_epi16(sums, reciprocalV), 15));
+
+        _mm_storel_epi64((__m128i*)pDest, _mm_packus_epi16(average, zero));
+        _mm_storeu_si128((__m128i*)pSums, _mm_sub_epi16(sums, sub));
+    }
+
+    if(width)
+        BoxBlurRow(pAdd, pSub, pSums, pDest, width, reciprocal);
+}
+
+
+// Two dest pixels at a time. Each source row gives the two pixels around each dest pixel as 8 bytes, 
+// which get blended vertically as 16 bit channels and then the left half with the right half.
+static void BilinearSpanSSE2(const uint32_t* pRow0, const uint32_t* pRow1, uint32_t fy, const int* pX, const uint16_t* pFx, uint32_t* pDest, int count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c128 = _mm_set1_epi16(0x80);
+    const __m128i wy0  = _mm_set1_epi16((short)(256 - fy));
+    const __m128i wy1  = _mm_set1_epi16((short)fy);
+
+    for(; count >= 2; count -= 2, pX += 2, pFx += 2, pDest += 2)
+    {
+        const __m128i t0  = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)(pRow0 + pX[0])), _mm_loadl_epi64((const __m128i*)(pRow0 + pX[1])));
+        const __m128i t1  = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)(pRow1 + pX[0])), _mm_loadl_epi64((const __m128i*)(pRow1 + pX[1])));
 
-                pSource += srcbpp;
-                pDest   += dstbpp;
-            }, width);
+        const __m128i vLo = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(t0, zero), wy0), _mm_mullo_epi16(_mm_unpacklo_epi8(t1, zero), wy1)), c128), 8);
+        const __m128i vHi = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(t0, zero), wy0), _mm_mullo_epi16(_mm_unpackhi_epi8(t1, zero), wy1)), c128), 8);
 
-            pSource += srcskip;
-            pDest   += dstskip;
-        }
+        const short   fx0 = (short)pFx[0];
+        const short   fx1 = (short)pFx[1];
+        __m128i       hLo = _mm_mullo_epi16(vLo, _mm_set_epi16(fx0, fx0, fx0, fx0, (short)(256 - fx0), (short)(256 - fx0), (short)(256 - fx0), (short)(256 - fx0)));
+        __m128i       hHi = _mm_mullo_epi16(vHi, _mm_set_epi16(fx1, fx1, fx1, fx1, (short)(256 - fx1), (short)(256 - fx1), (short)(256 - fx1), (short)(256 - fx1)));
+
+        hLo = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(hLo, _mm_shuffle_epi32(hLo, _MM_SHUFFLE(1, 0, 3, 2))), c128), 8);
+        hHi = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(hHi, _mm_shuffle_epi32(hHi, _MM_SHUFFLE(1, 0, 3, 2))), c128), 8);
+
+        // The pixels are in the even 32 bit lanes.
+        _mm_storel_epi64((__m128i*)pDest, _mm_shuffle_epi32(_mm_packus_epi16(hLo, hHi), _MM_SHUFFLE(3, 1, 2, 0)));
     }
+
+    if(count)
+        BilinearSpan(pRow0, pRow1, fy, pX, pFx, pDest, count);
 }
 
 
-#if MSVC_ASMBLIT
+// Four pixels at a time, added up as 16 bit channels in pairs before going into the 32 bit sums.
+static void SumPixelsSSE2(const uint32_t* pPixels, int count, uint32_t* pSums)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i       sums = _mm_setzero_si128();
 
+    for(; count >= 4; count -= 4, pPixels += 4)
+    {
+        const __m128i p    = _mm_loadu_si128((const __m128i*)pPixels);
+        const __m128i pair = _mm_add_epi16(_mm_unpacklo_epi8(p, zero), _mm_unpackhi_epi8(p, zero));
 
-// Fast XRGB -> XRGB/ARGB with source surface alpha.
-static void BlitRGBtoRGBSurfaceAlphaMMX(const BlitInfo& info)
+        sums = _mm_add_epi32(sums, _mm_add_epi32(_mm_unpacklo_epi16(pair, zero), _mm_unpackhi_epi16(pair, zero)));
+    }
+
+    for(; count > 0; --count, ++pPixels)
+        sums = _mm_add_epi32(sums, _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((int)*pPixels), zero), zero));
+
+    uint32_t s[4];
+    _mm_storeu_si128((__m128i*)s, sums);
+
+    pSums[0] += s[0];
+    pSums[1] += s[1];
+    pSums[2] += s[2];
+    pSums[3] += s[3];
+}
+
+#endif // SSE2_BLIT
+
+
+
+#if AVX2_BLIT
+
+// The AVX2 versions are the SSE2 ones at twice the width. Note that the unpack and pack 
+// instructions work within each 128 bit lane, which is fine as they are always used in pairs.
+
+AVX2_TARGET static inline __m256i BlendChannelsAVX2(__m256i s, __m256i d, __m256i aLo, __m256i aHi, bool bAdditive)
 {
-    const PixelFormat&  df       = info.mpDest->mPixelFormat;
-    const uint32_t      chanmask = df.mRMask | df.mGMask | df.mBMask;
-    const uint32_t      dalpha   = df.mAMask;
-    const unsigned      alpha    = info.mpSource->mPixelFormat.mSurfaceAlpha;
-    const int           width    = info.mnDWidth;
-    int                 height   = info.mnDHeight;
-    const uint32_t*     pSrc     = (const uint32_t*)info.mpSPixels;
-    const int           srcskip  = info.mnSSkip >> 2;
-    uint32_t*           pDst     = (uint32_t*)info.mpDPixels;
-    const int           dstskip  = info.mnDSkip >> 2;
-    uint32_t            amult;
-   
-    if(info.mDoAdditiveBlend)    
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i c255 = _mm256_set1_epi16(0xff);
+    const __m256i dLo  = _mm256_unpacklo_epi8(d, zero);
+    const __m256i dHi  = _mm256_unpackhi_epi8(d, zero);
+
+    if(bAdditive)
     {
-        __m64  src1, dst1, mm_alpha, mm_zero, dsta, mm_overflow;
-        
-        mm_zero  = _mm_setzero_si64();          // 0 -> mm_zero
-          
-        // So the alpha stay fixed in this version...
-        unsigned invAlpha = 255 - alpha;    // Inverse alpha
-        amult    = invAlpha | (invAlpha << 8);
-        amult    = amult | (amult << 16);
-        mm_alpha = _mm_set_pi32(0, amult & chanmask);   // 0000AAAA -> mm_alpha, minus 1 chan
-        mm_alpha = _mm_unpacklo_pi8(mm_alpha, mm_zero); // 0A0A0A0A -> mm_alpha, minus 1 chan
+        const __m256i tLo = _mm256_srli_epi16(_mm256_mullo_epi16(dLo, _mm256_sub_epi16(c255, aLo)), 8);
+        const __m256i tHi = _mm256_srli_epi16(_mm256_mullo_epi16(dHi, _mm256_sub_epi16(c255, aHi)), 8);
 
-        // At this point mm_alpha can be 000A0A0A or 0A0A0A00 or another combo
-        dsta = _mm_set_pi32(0x00, dalpha); // pDest alpha mask -> dsta
-        
-        
-        int filter = ~(dalpha);
-        mm_overflow = _mm_set_pi32(0, filter);                  // 0000AAAA 
-        mm_overflow = _mm_unpacklo_pi8(mm_overflow, mm_zero);   // 0A0A0A0A 
-      
-        while (height--)
-        {
-            int n = width;
-            while(n--)
-            {
-                // Extract the colors
-                dst1 = _mm_cvtsi32_si64(*pDst);                     // pDest(ARGB) -> dst1 (0000ARGB)
-                src1 = _mm_cvtsi32_si64(*pSrc);                     // pSource(ARGB) -> src1 (0000ARGB)
-                src1 = _mm_unpacklo_pi8(src1, mm_zero);             // 000R0G0B -> src1  
-                dst1 = _mm_unpacklo_pi8(dst1, mm_zero);             // 0A0R0G0B -> dst1
+        return _mm256_adds_epu8(s, _mm256_packus_epi16(tLo, tHi));
+    }
 
-                // Blend the destination color with the inverse alpha         
-                dst1 = _mm_mullo_pi16(dst1, mm_alpha);              // dst1 * invAlpha 
-                dst1 = _mm_srli_pi16(dst1, 8);                      // src1 >> 8 -> src1(000R0G0B) = /256 (technically should be 255 but this is faster)
-                
-                // Additive color
-                dst1 = _mm_add_pi16(src1, dst1);                    // src1 + dst1 (additive)
+    const __m256i c128 = _mm256_set1_epi16(0x80);
+    const __m256i sLo  = _mm256_unpacklo_epi8(s, zero);
+    const __m256i sHi  = _mm256_unpackhi_epi8(s, zero);
+    __m256i       tLo  = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(sLo, aLo), _mm256_mullo_epi16(dLo, _mm256_sub_epi16(c255, aLo))), c128);
+    __m256i       tHi  = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(sHi, aHi), _mm256_mullo_epi16(dHi, _mm256_sub_epi16(c255, aHi))), c128);
 
-                // Check for color saturation beyond 0xff
-                src1 =_mm_cmpgt_pi16 (dst1, mm_overflow);           // Compare against 0x00ff00ff00ff00ff
-                dst1 =_mm_andnot_si64(src1, dst1);                  // Filter our dst1 resutls that overflow
-                dst1 = _mm_or_si64 (dst1, src1);                    // Add in 0xffff to the colors that overflowed
-                          
-                // Pack down to byte format
-                dst1 = _mm_and_si64(dst1, mm_overflow);             // Clean out the high bytes for the packing and the alpha channel
-                dst1 = _mm_packs_pu16(dst1, mm_zero);               // 0000ARGB -> dst1
-            
-                // Add in the source alpha
-                dst1 = _mm_or_si64 (dst1, dsta);               
-                *pDst = _mm_cvtsi64_si32(dst1);                     // dst1 -> pixel
-            
-                ++pSrc;
-                ++pDst;            
-            }
+    tLo = _mm256_srli_epi16(_mm256_add_epi16(tLo, _mm256_srli_epi16(tLo, 8)), 8);
+    tHi = _mm256_srli_epi16(_mm256_add_epi16(tHi, _mm256_srli_epi16(tHi, 8)), 8);
 
-            pSrc += srcskip;
-            pDst += dstskip;
-        }
-    }
-    else
-    {
-         __m64               src1, src2, dst1, dst2, mm_alpha, mm_zero, dsta;
+    return _mm256_packus_epi16(tLo, tHi);
+}
 
-        mm_zero = _mm_setzero_si64(); // 0 -> mm_zero
 
-        // Form the alpha mult.
-        amult    = alpha | (alpha << 8);
-        amult    = amult | (amult << 16);
-        mm_alpha = _mm_set_pi32(0, amult & chanmask);   // 0000AAAA -> mm_alpha, minus 1 chan
-        mm_alpha = _mm_unpacklo_pi8(mm_alpha, mm_zero); // 0A0A0A0A -> mm_alpha, minus 1 chan
+AVX2_TARGET static inline __m256i PixelAlphaBlend8AVX2(__m256i s, __m256i d, bool bAdditive)
+{
+    const __m256i zero  = _mm256_setzero_si256();
+    const __m256i amask = _mm256_set1_epi32((int)0xff000000);
 
-        // At this point mm_alpha can be 000A0A0A or 0A0A0A00 or another combo
-        dsta = _mm_set_pi32(dalpha, dalpha); // pDest alpha mask -> dsta
-        
-        while (height--)
-        {
-            int n = width;
+    const __m256i sLo = _mm256_unpacklo_epi8(s, zero);
+    const __m256i sHi = _mm256_unpackhi_epi8(s, zero);
+    const __m256i aLo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(sLo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    const __m256i aHi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(sHi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
 
-            if (n & 1)
-            {
-                // One pixel Blend
-                src2 = _mm_cvtsi32_si64(*pSrc);         // pSource(ARGB) -> src2 (0000ARGB)
-                src2 = _mm_unpacklo_pi8(src2, mm_zero); // 0A0R0G0B -> src2
+    __m256i result = BlendChannelsAVX2(s, d, aLo, aHi, bAdditive);
 
-                dst1 = _mm_cvtsi32_si64(*pDst);         // pDest(ARGB) -> dst1 (0000ARGB)
-                dst1 = _mm_unpacklo_pi8(dst1, mm_zero); // 0A0R0G0B -> dst1
+    result = _mm256_blendv_epi8(result, d, amask);
+    result = _mm256_blendv_epi8(result, s, _mm256_cmpeq_epi32(_mm256_and_si256(d, amask), zero));
+    result = _mm256_blendv_epi8(result, d, _mm256_cmpeq_epi32(_mm256_and_si256(s, amask), zero));
 
-                src2 = _mm_sub_pi16(src2, dst1);        // src2 - dst2 -> src2
-                src2 = _mm_mullo_pi16(src2, mm_alpha);  // src2 * alpha -> src2
-                src2 = _mm_srli_pi16(src2, 8);          // src2 >> 8 -> src2
-                dst1 = _mm_add_pi8(src2, dst1);         // src2 + dst1 -> dst1
-                
-                dst1 = _mm_packs_pu16(dst1, mm_zero);   // 0000ARGB -> dst1
-                dst1 = _mm_or_si64(dst1, dsta);         // dsta | dst1 -> dst1
-                *pDst = _mm_cvtsi64_si32(dst1);         // dst1 -> pixel
+    return result;
+}
 
-                ++pSrc;
-                ++pDst;
-                
-                n--;
-            }
 
-            for (n >>= 1; n > 0; --n)
-            {
-                // Two Pixels Blend
-                src1 = *(__m64*)pSrc;                   // 2 x pSource -> src1(ARGBARGB)
-                src2 = src1;                            // 2 x pSource -> src2(ARGBARGB)
-                src1 = _mm_unpacklo_pi8(src1, mm_zero); // low - 0A0R0G0B -> src1
-                src2 = _mm_unpackhi_pi8(src2, mm_zero); // high - 0A0R0G0B -> src2
+AVX2_TARGET static inline __m256i SurfaceAlphaBlend8AVX2(__m256i s, __m256i d, __m256i alpha, bool bAdditive)
+{
+    const __m256i amask = _mm256_set1_epi32((int)0xff000000);
 
-                dst1 = *(__m64*)pDst;                   // 2 x pDest -> dst1(ARGBARGB)
-                dst2 = dst1;                            // 2 x pDest -> dst2(ARGBARGB)
-                dst1 = _mm_unpacklo_pi8(dst1, mm_zero); // low - 0A0R0G0B -> dst1
-                dst2 = _mm_unpackhi_pi8(dst2, mm_zero); // high - 0A0R0G0B -> dst2
+    return _mm256_or_si256(BlendChannelsAVX2(s, d, alpha, alpha, bAdditive), amask);
+}
 
-                src1 = _mm_sub_pi16(src1, dst1);        // src1 - dst1 -> src1
-                src1 = _mm_mullo_pi16(src1, mm_alpha);  // src1 * alpha -> src1
-                src1 = _mm_srli_pi16(src1, 8);          // src1 >> 8 -> src1
-                dst1 = _mm_add_pi8(src1, dst1);         // src1 + dst1(dst1) -> dst1
 
-                src2 = _mm_sub_pi16(src2, dst2);        // src2 - dst2 -> src2
-                src2 = _mm_mullo_pi16(src2, mm_alpha);  // src2 * alpha -> src2
-                src2 = _mm_srli_pi16(src2, 8);          // src2 >> 8 -> src2
-                dst2 = _mm_add_pi8(src2, dst2);         // src2 + dst2(dst2) -> dst2
-                
-                dst1 = _mm_packs_pu16(dst1, dst2);      // 0A0R0G0B(res1), 0A0R0G0B(res2) -> dst1(ARGBARGB)
-                dst1 = _mm_or_si64(dst1, dsta);         // dsta | dst1 -> dst1
+// Fast ARGB -> ARGB blending with source pixel alpha.
+AVX2_TARGET static void BlitRGBtoRGBPixelAlphaAVX2(const BlitInfo& info)
+{
+    const int       width     = info.mnDWidth;
+    int             height    = info.mnDHeight;
+    const uint32_t* pSrc      = (uint32_t*)info.mpSPixels;
+    const int       srcskip   = info.mnSSkip >> 2;
+    uint32_t*       pDst      = (uint32_t*)info.mpDPixels;
+    const int       dstskip   = info.mnDSkip >> 2;
+    const bool      bAdditive = info.mDoAdditiveBlend;
+    const __m256i   amask     = _mm256_set1_epi32((int)0xff000000);
+
+    while(height--)
+    {
+        int n = width;
 
-                *(__m64*)pDst = dst1;                   // dst1 -> 2 x pixel
+        for(; n >= 8; n -= 8, pSrc += 8, pDst += 8)
+        {
+            const __m256i s = _mm256_loadu_si256((const __m256i*)pSrc);
 
-                pSrc += 2;
-                pDst += 2;
-            }
+            // Skip fully transparent runs.
+            if(_mm256_testz_si256(s, amask))
+                continue;
 
-            pSrc += srcskip;
-            pDst += dstskip;
+            const __m256i d = _mm256_loadu_si256((const __m256i*)pDst);
+            _mm256_storeu_si256((__m256i*)pDst, PixelAlphaBlend8AVX2(s, d, bAdditive));
+        }
+
+        if(n)
+        {
+            uint32_t sTail[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+            uint32_t dTail[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+            memcpy(sTail, pSrc, n * sizeof(uint32_t));
+            memcpy(dTail, pDst, n * sizeof(uint32_t));
+            _mm256_storeu_si256((__m256i*)dTail, PixelAlphaBlend8AVX2(_mm256_loadu_si256((const __m256i*)sTail), _mm256_loadu_si256((const __m256i*)dTail), bAdditive));
+            memcpy(pDst, dTail, n * sizeof(uint32_t));
+
+            pSrc += n;
+            pDst += n;
         }
+
+        pSrc += srcskip;
+        pDst += dstskip;
     }
-    _mm_empty();
 }
 
 
-// Fast ARGB -> XRGB/ARGB with pixel alpha.
-static void BlitRGBtoRGBPixelAlphaMMX(const BlitInfo& info)
+// Fast RGB888 -> (A)RGB888 blending with source surface alpha.
+AVX2_TARGET static void BlitRGBtoRGBSurfaceAlphaAVX2(const BlitInfo& info)
 {
-    const int           width    = info.mnDWidth;
-    int                 height   = info.mnDHeight;
-    const uint32_t*     pSrc     = (uint32_t*)info.mpSPixels;
-    const int           srcskip  = info.mnSSkip >> 2;
-    uint32_t*           pDst     = (uint32_t*)info.mpDPixels;
-    const int           dstskip  = info.mnDSkip >> 2;
-    const PixelFormat&  sf       = info.mpSource->mPixelFormat;
-    const uint32_t      chanmask = sf.mRMask | sf.mGMask | sf.mBMask;
-    const uint32_t      amask    = sf.mAMask;
-    const uint32_t      ashift   = sf.mAShift;
-    uint64_t            multmask;
-    __m64               src1, dst1, mm_alpha, mm_zero, dmask;
-
-    mm_zero  = _mm_setzero_si64();          // 0 -> mm_zero
-    multmask = ~(0x000000000000FFFFi64 << (ashift * 2));
-    dmask    = *(__m64*)&multmask;          // pDest alpha mask -> dmask
-
-    if(info.mDoAdditiveBlend)    
+    const int       width     = info.mnDWidth;
+    int             height    = info.mnDHeight;
+    const uint32_t* pSrc      = (uint32_t*)info.mpSPixels;
+    const int       srcskip   = info.mnSSkip >> 2;
+    uint32_t*       pDst      = (uint32_t*)info.mpDPixels;
+    const int       dstskip   = info.mnDSkip >> 2;
+    const bool      bAdditive = info.mDoAdditiveBlend;
+    const __m256i   alpha     = _mm256_set1_epi16((short)info.mpSource->mPixelFormat.mSurfaceAlpha);
+
+    while(height--)
     {
-        // This is doing an additive alpha blend: source + dest * inv alpha 
-        __m64 mm_overflow,mm_dst_alpha;
-        mm_overflow = _mm_set_pi16(0xff,0xff,0xff,0xff);
-        mm_overflow =  _mm_and_si64(mm_overflow, dmask);    // Keep alpha channel 0x0 so can be used to clean it too    
+        int n = width;
 
-        while(height--)
+        for(; n >= 8; n -= 8, pSrc += 8, pDst += 8)
         {
-            DUFFS_LOOP4({
-                uint32_t alpha = *pSrc & amask;
-                uint32_t destApha = *pDst & amask;
-                
-                if (alpha == 0)
-                {
-                    // do nothing
-                }
-                else if(!destApha)
-                {
-                    // 7/23/09 CSidhall - Added 0 alpha case for destination for the MMX blend bellow will fail with a 0 dest alpha
-                    *pDst = *pSrc;         
-                }
-                else if (alpha == amask)
-                {
-                    // opaque alpha -- copy RGB, keep pDest alpha
-                    *pDst = (*pSrc & chanmask) | (*pDst & ~chanmask);
-                }
-                else
-                {
-                    // Extract the colors
-                    src1 = _mm_cvtsi32_si64(*pSrc);                     // pSource(ARGB) -> src1 (0000ARGB)
-                    dst1 = _mm_cvtsi32_si64(*pDst);                     // pDest(ARGB) -> dst1 (0000ARGB)
-                    mm_alpha = _mm_srli_si64(src1, ashift);             // Grab the alpha: mm_alpha >> ashift -> mm_alpha(0000000A) 
-                    src1 = _mm_unpacklo_pi8(src1, mm_zero);             // 000R0G0B -> src1  
-                    dst1 = _mm_unpacklo_pi8(dst1, mm_zero);             // 0A0R0G0B -> dst1
-                    mm_dst_alpha =_mm_andnot_si64( dmask, dst1);        // Grab the destination alpha
+            const __m256i s = _mm256_loadu_si256((const __m256i*)pSrc);
+            const __m256i d = _mm256_loadu_si256((const __m256i*)pDst);
+            _mm256_storeu_si256((__m256i*)pDst, SurfaceAlphaBlend8AVX2(s, d, alpha, bAdditive));
+        }
 
-                    // Build the inverse alpha and broadcast it to all the color channels 
-                    // We don't care if it goes into the alpha channel as this will be cleaned later
-                    mm_alpha =_mm_sub_pi8(mm_overflow, mm_alpha);       // inverse alpha: 255 - alpha - we ignore the upper words
-                    mm_alpha = _mm_unpacklo_pi16(mm_alpha, mm_alpha);   // 00000A0A -> mm_alpha
-                    mm_alpha = _mm_unpacklo_pi32(mm_alpha, mm_alpha);   // 0A0A0A0A -> mm_alpha
+        if(n)
+        {
+            uint32_t sTail[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+            uint32_t dTail[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
 
-                    // Blend the destination color with the inverse alpha         
-                    dst1 = _mm_mullo_pi16(dst1, mm_alpha);              // dst1 * invAlpha 
-                    dst1 = _mm_srli_pi16(dst1, 8);                      // src1 >> 8 -> src1(000R0G0B) = /256 (technically should be 255 but this is faster)
-                    
-                    // Additive color
-                    dst1 = _mm_add_pi16(src1, dst1);                    // src1 + dst1 (additive)
+            memcpy(sTail, pSrc, n * sizeof(uint32_t));
+            memcpy(dTail, pDst, n * sizeof(uint32_t));
+            _mm256_storeu_si256((__m256i*)dTail, SurfaceAlphaBlend8AVX2(_mm256_loadu_si256((const __m256i*)sTail), _mm256_loadu_si256((const __m256i*)dTail), alpha, bAdditive));
+            memcpy(pDst, dTail, n * sizeof(uint32_t));
 
-                    // Check for color saturation
-                    src1 =_mm_cmpgt_pi16 (dst1, mm_overflow);           // Compare against 0x00ff00ff00ff00ff
-                    dst1 =_mm_andnot_si64(src1, dst1);                  // Filter our dst1 resutls that overflow
-                    dst1 = _mm_or_si64 (dst1, src1);                    // Add in 0xffff to the colors that overflowed
-                
-                    // Add in the source alpha
-                    dst1 = _mm_and_si64(dst1, mm_overflow);             // Clean out the high bytes for the packing and alpha channel
-                    dst1 = _mm_or_si64 (dst1, mm_dst_alpha);
+            pSrc += n;
+            pDst += n;
+        }
 
-                    // Pack down to byte format
-                    dst1 = _mm_packs_pu16(dst1, mm_zero);               // 0000ARGB -> dst1
-                    *pDst = _mm_cvtsi64_si32(dst1);                     // dst1 -> pixel
-                }
+        pSrc += srcskip;
+        pDst += dstskip;
+    }
+}
+
+AVX2_TARGET static inline __m256i ModulateAlpha8AVX2(__m256i s, __m256i opacity, bool bSourceAlpha)
+{
+    const __m256i c255 = _mm256_set1_epi32(0xff);
+    const __m256i a    = bSourceAlpha ? _mm256_srli_epi32(s, 24) : c255;
+    const __m256i aMod = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi16(a, opacity), c255), 8);
 
-                ++pSrc;
-                ++pDst;
-            }, width);
+    return _mm256_or_si256(_mm256_and_si256(s, _mm256_set1_epi32(0x00ffffff)), _mm256_slli_epi32(aMod, 24));
+}
 
-            pSrc += srcskip;
-            pDst += dstskip;
-        }
-    }   
-    else
+
+// ARGB/XRGB -> ARGB blending with the source alpha multiplied by info.mnOpacity.
+AVX2_TARGET static void BlitRGBtoRGBOpacityAVX2(const BlitInfo& info)
+{
+    const int       width        = info.mnDWidth;
+    int             height       = info.mnDHeight;
+    const uint32_t* pSrc         = (uint32_t*)info.mpSPixels;
+    const int       srcskip      = info.mnSSkip >> 2;
+    uint32_t*       pDst         = (uint32_t*)info.mpDPixels;
+    const int       dstskip      = info.mnDSkip >> 2;
+    const bool      bAdditive    = info.mDoAdditiveBlend;
+    const bool      bSourceAlpha = SourceAlphaEnabled(info.mpSource);
+    const __m256i   opacity      = _mm256_set1_epi32(info.mnOpacity);
+    const __m256i   amask        = _mm256_set1_epi32((int)0xff000000);
+
+    while(height--)
     {
-        // This is a normal alpha blend: source * alpha + dest * inv alpha
-        while(height--)
+        int n = width;
+
+        for(; n >= 8; n -= 8, pSrc += 8, pDst += 8)
         {
-            DUFFS_LOOP4({
-                uint32_t alpha = *pSrc & amask;
-                uint32_t destApha = *pDst & amask;
-                
-                if (alpha == 0)
-                {
-                    // do nothing
-                }
-                else if(!destApha)
-                {
-                    // 7/23/09 CSidhall - Added 0 alpha case for destination for the MMX blend bellow will fail with a 0 dest alpha
-                    *pDst = *pSrc;         
-                }
-                else if (alpha == amask)
-                {
-                    // opaque alpha -- copy RGB, keep pDest alpha
-                    *pDst = (*pSrc & chanmask) | (*pDst & ~chanmask);
-                }
-                else
-                {
-                    src1 = _mm_cvtsi32_si64(*pSrc);             // pSource(ARGB) -> src1 (0000ARGB)
-                    src1 = _mm_unpacklo_pi8(src1, mm_zero);     // 0A0R0G0B -> src1
+            const __m256i s = ModulateAlpha8AVX2(_mm256_loadu_si256((const __m256i*)pSrc), opacity, bSourceAlpha);
 
-                    dst1 = _mm_cvtsi32_si64(*pDst);             // pDest(ARGB) -> dst1 (0000ARGB)
-                    dst1 = _mm_unpacklo_pi8(dst1, mm_zero);     // 0A0R0G0B -> dst1
+            if(_mm256_testz_si256(s, amask))
+                continue;
 
-                    mm_alpha = _mm_cvtsi32_si64(alpha);                 // alpha -> mm_alpha (0000000A)
-                    mm_alpha = _mm_srli_si64(mm_alpha, ashift);         // mm_alpha >> ashift -> mm_alpha(0000000A)
-                    mm_alpha = _mm_unpacklo_pi16(mm_alpha, mm_alpha);   // 00000A0A -> mm_alpha
-                    mm_alpha = _mm_unpacklo_pi32(mm_alpha, mm_alpha);   // 0A0A0A0A -> mm_alpha
-                    mm_alpha = _mm_and_si64(mm_alpha, dmask);           // 000A0A0A -> mm_alpha, preserve pDest alpha on add
+            const __m256i d = _mm256_loadu_si256((const __m256i*)pDst);
+            _mm256_storeu_si256((__m256i*)pDst, PixelAlphaBlend8AVX2(s, d, bAdditive));
+        }
 
-                    // blend          
-                    src1 = _mm_sub_pi16(src1, dst1);            // src1 - dst1 -> src1
-                    src1 = _mm_mullo_pi16(src1, mm_alpha);      // (src1 - dst1) * alpha -> src1
-                    src1 = _mm_srli_pi16(src1, 8);              // src1 >> 8 -> src1(000R0G0B)
-                    dst1 = _mm_add_pi8(src1, dst1);             // src1 + dst1 -> dst1(0A0R0G0B)
-                    dst1 = _mm_packs_pu16(dst1, mm_zero);       // 0000ARGB -> dst1
-                    
-                    *pDst = _mm_cvtsi64_si32(dst1);             // dst1 -> pixel
-                }
+        if(n)
+        {
+            uint32_t sTail[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+            uint32_t dTail[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
 
-                ++pSrc;
-                ++pDst;
-            }, width);
+            memcpy(sTail, pSrc, n * sizeof(uint32_t));
+            memcpy(dTail, pDst, n * sizeof(uint32_t));
+            _mm256_storeu_si256((__m256i*)dTail, PixelAlphaBlend8AVX2(ModulateAlpha8AVX2(_mm256_loadu_si256((const __m256i*)sTail), opacity, bSourceAlpha), _mm256_loadu_si256((const __m256i*)dTail), bAdditive));
+            memcpy(pDst, dTail, n * sizeof(uint32_t));
 
-            pSrc += srcskip;
-            pDst += dstskip;
+            pSrc += n;
+            pDst += n;
         }
-    }   
-   _mm_empty();
-}
 
+        pSrc += srcskip;
+        pDst += dstskip;
+    }
+}
 
-// Fast (as in MMX with prefetch) ARGB888->(A)RGB888 blending with pixel alpha.
-static void BlitRGBtoRGBPixelAlphaMMX3DNOW(const BlitInfo& info)
+AVX2_TARGET static inline __m256i ScalePixels8AVX2(__m256i s, __m256i scale)
 {
-    const int           width    = info.mnDWidth;
-    int                 height   = info.mnDHeight;
-    const uint32_t*     pSrc     = (uint32_t*)info.mpSPixels;
-    const int           srcskip  = info.mnSSkip >> 2;
-    uint32_t*           pDst     = (uint32_t*)info.mpDPixels;
-    const int           dstskip  = info.mnDSkip >> 2;
-    const PixelFormat&  sf       = info.mpSource->mPixelFormat;
-    const uint32_t      chanmask = sf.mRMask | sf.mGMask | sf.mBMask;
-    const uint32_t      amask    = sf.mAMask;
-    const uint32_t      ashift   = sf.mAShift;
-    uint64_t            multmask;
-    __m64               src1, dst1, mm_alpha, mm_zero, dmask;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i c128 = _mm256_set1_epi16(0x80);
+    __m256i       tLo  = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(s, zero), scale), c128);
+    __m256i       tHi  = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(s, zero), scale), c128);
 
-    mm_zero  = _mm_setzero_si64();          // 0 -> mm_zero
-    multmask = ~(0x000000000000FFFFi64 << (ashift * 2));
-    dmask    = *(__m64*)&multmask;          // pDest alpha mask -> dmask
+    tLo = _mm256_srli_epi16(_mm256_add_epi16(tLo, _mm256_srli_epi16(tLo, 8)), 8);
+    tHi = _mm256_srli_epi16(_mm256_add_epi16(tHi, _mm256_srli_epi16(tHi, 8)), 8);
 
-    if(info.mDoAdditiveBlend)    
+    return _mm256_packus_epi16(tLo, tHi);
+}
+
+
+AVX2_TARGET static inline __m256i PremultipliedBlend8AVX2(__m256i s, __m256i d, bool bAdditive)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i c255 = _mm256_set1_epi16(0xff);
+    const __m256i sLo  = _mm256_unpacklo_epi8(s, zero);
+    const __m256i sHi  = _mm256_unpackhi_epi8(s, zero);
+    const __m256i aLo  = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(sLo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    const __m256i aHi  = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(sHi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m256i       tLo  = _mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), _mm256_sub_epi16(c255, aLo));
+    __m256i       tHi  = _mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), _mm256_sub_epi16(c255, aHi));
+
+    if(!bAdditive)
     {
-        // This is doing an additive alpha blend: source + dest * inv alpha 
-        __m64 mm_overflow,mm_dst_alpha;
-        mm_overflow = _mm_set_pi16(0xff,0xff,0xff,0xff);
-        mm_overflow =  _mm_and_si64(mm_overflow, dmask);    // Keep alpha channel 0x0 so can be used to clean it too    
+        const __m256i c128 = _mm256_set1_epi16(0x80);
 
-        while(height--)
-        {
-            DUFFS_LOOP4({
-                uint32_t alpha;
-                uint32_t destApha;
+        tLo = _mm256_add_epi16(tLo, c128);
+        tHi = _mm256_add_epi16(tHi, c128);
+        tLo = _mm256_add_epi16(tLo, _mm256_srli_epi16(tLo, 8));
+        tHi = _mm256_add_epi16(tHi, _mm256_srli_epi16(tHi, 8));
+    }
 
-                // 3D Now 
-                _m_prefetch((uint32_t*)pSrc + 16);
-                _m_prefetch((uint32_t*)pDst + 16);
+    return _mm256_adds_epu8(s, _mm256_packus_epi16(_mm256_srli_epi16(tLo, 8), _mm256_srli_epi16(tHi, 8)));
+}
 
-                alpha = *pSrc & amask;
-                destApha = *pDst & amask;
-                
-                if (alpha == 0)
-                {
-                    // do nothing
-                }
-                else if(!destApha)
-                {
-                    // 7/23/09 CSidhall - Added 0 alpha case for destination for the MMX blend bellow will fail with a 0 dest alpha
-                    *pDst = *pSrc;         
-                }
-                else if (alpha == amask)
-                {
-                    // opaque alpha -- copy RGB, keep pDest alpha
-                    *pDst = (*pSrc & chanmask) | (*pDst & ~chanmask);
-                }
-                else
-                {
-                    // Extract the colors
-                    src1 = _mm_cvtsi32_si64(*pSrc);                     // pSource(ARGB) -> src1 (0000ARGB)
-                    dst1 = _mm_cvtsi32_si64(*pDst);                     // pDest(ARGB) -> dst1 (0000ARGB)
-                    mm_alpha = _mm_srli_si64(src1, ashift);             // Grab the alpha: mm_alpha >> ashift -> mm_alpha(0000000A) 
-                    src1 = _mm_unpacklo_pi8(src1, mm_zero);             // 000R0G0B -> src1  
-                    dst1 = _mm_unpacklo_pi8(dst1, mm_zero);             // 0A0R0G0B -> dst1
-                    mm_dst_alpha =_mm_andnot_si64( dmask, dst1);        // Grab the destination alpha
 
-                    // Build the inverse alpha and broadcast it to all the color channels 
-                    // We don't care if it goes into the alpha channel as this will be cleaned later
-                    mm_alpha =_mm_sub_pi8(mm_overflow, mm_alpha);       // inverse alpha: 255 - alpha - we ignore the upper words
-                    mm_alpha = _mm_unpacklo_pi16(mm_alpha, mm_alpha);   // 00000A0A -> mm_alpha
-                    mm_alpha = _mm_unpacklo_pi32(mm_alpha, mm_alpha);   // 0A0A0A0A -> mm_alpha
+AVX2_TARGET static inline void BlitPARGB8AVX2(const uint32_t* pSrc, uint32_t* pDst, __m256i opacity, bool bOpacity, bool bAdditive, bool bPremultipliedDest)
+{
+    const __m256i zero  = _mm256_setzero_si256();
+    const __m256i amask = _mm256_set1_epi32((int)0xff000000);
+    __m256i       s     = _mm256_loadu_si256((const __m256i*)pSrc);
 
-                    // Blend the destination color with the inverse alpha         
-                    dst1 = _mm_mullo_pi16(dst1, mm_alpha);              // dst1 * invAlpha 
-                    dst1 = _mm_srli_pi16(dst1, 8);                      // src1 >> 8 -> src1(000R0G0B) = /256 (technically should be 255 but this is faster)
-                    
-                    // Additive color
-                    dst1 = _mm_add_pi16(src1, dst1);                    // src1 + dst1 (additive)
+    if(bOpacity)
+        s = ScalePixels8AVX2(s, opacity);
 
-                    // Check for color saturation
-                    src1 =_mm_cmpgt_pi16 (dst1, mm_overflow);           // Compare against 0x00ff00ff00ff00ff
-                    dst1 =_mm_andnot_si64(src1, dst1);                  // Filter our dst1 resutls that overflow
-                    dst1 = _mm_or_si64 (dst1, src1);                    // Add in 0xffff to the colors that overflowed
-                
-                    // Add in the source alpha
-                    dst1 = _mm_and_si64(dst1, mm_overflow);             // Clean out the high bytes for the packing
-                    dst1 = _mm_or_si64 (dst1, mm_dst_alpha);
+    // Skip fully transparent runs.
+    if(_mm256_testz_si256(s, amask))
+        return;
 
-                    // Pack down to byte format
-                    dst1 = _mm_packs_pu16(dst1, mm_zero);               // 0000ARGB -> dst1
-                    *pDst = _mm_cvtsi64_si32(dst1);                     // dst1 -> pixel
-                }
+    const __m256i sAlphaZero = _mm256_cmpeq_epi32(_mm256_and_si256(s, amask), zero);
+    const __m256i d          = _mm256_loadu_si256((const __m256i*)pDst);
+    const __m256i result     = _mm256_blendv_epi8(PremultipliedBlend8AVX2(s, d, bAdditive), d, sAlphaZero);
 
-                ++pSrc;
-                ++pDst;
-            }, width);
-            
-            pSrc += srcskip;
-            pDst += dstskip;
-        }
-        _mm_empty();
-    
-    }   
+    if(bPremultipliedDest)
+        _mm256_storeu_si256((__m256i*)pDst, result);
     else
     {
-        // This is a normal alpha blend: source * alpha + dest * inv alpha
-        while(height--)
+        _mm256_storeu_si256((__m256i*)pDst, _mm256_blendv_epi8(result, d, amask));
+
+        const int transparentDest = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_andnot_si256(sAlphaZero, _mm256_cmpeq_epi32(_mm256_and_si256(d, amask), zero))));
+
+        if(transparentDest)
         {
-            DUFFS_LOOP4({
-                uint32_t alpha;
-                uint32_t destApha;
+            uint32_t sPixels[8];
+            _mm256_storeu_si256((__m256i*)sPixels, s);
 
-                // 3D Now 
-                _m_prefetch((uint32_t*)pSrc + 16);
-                _m_prefetch((uint32_t*)pDst + 16);
+            for(int i = 0; i < 8; i++)
+            {
+                if(transparentDest & (1 << i))
+                    pDst[i] = UnpremultiplyPixel(sPixels[i]);
+            }
+        }
+    }
+}
 
-                alpha = *pSrc & amask;
-                destApha = *pDst & amask;
-                
-                if (alpha == 0)
-                {
-                    // do nothing
-                }
-                else if(!destApha)
-                {
-                    // 7/23/09 CSidhall - Added 0 alpha case for destination for the MMX blend bellow will fail with a 0 dest alpha
-                    *pDst = *pSrc;         
-                }
-                else if (alpha == amask)
-                {
-                    // opaque alpha -- copy RGB, keep pDest alpha
-                    *pDst = (*pSrc & chanmask) | (*pDst & ~chanmask);
-                }
-                else
-                {
-                    src1 = _mm_cvtsi32_si64(*pSrc);             // pSource(ARGB) -> src1 (0000ARGB)
-                    src1 = _mm_unpacklo_pi8(src1, mm_zero);     // 0A0R0G0B -> src1
 
-                    dst1 = _mm_cvtsi32_si64(*pDst);             // pDest(ARGB) -> dst1 (0000ARGB)
-                    dst1 = _mm_unpacklo_pi8(dst1, mm_zero);     // 0A0R0G0B -> dst1
+// PARGB -> ARGB/XRGB/PARGB blending with source pixel alpha. See BlitPARGBtoRGB.
+AVX2_TARGET static void BlitPARGBtoRGBAVX2(const BlitInfo& info)
+{
+    const int       width              = info.mnDWidth;
+    int             height             = info.mnDHeight;
+    const uint32_t* pSrc               = (uint32_t*)info.mpSPixels;
+    const int       srcskip            = info.mnSSkip >> 2;
+    uint32_t*       pDst               = (uint32_t*)info.mpDPixels;
+    const int       dstskip            = info.mnDSkip >> 2;
+    const uint32_t  opacity            = MODULATE_ALPHA((uint32_t)info.mnOpacity, (uint32_t)info.mpSource->mPixelFormat.mSurfaceAlpha);
+    const __m256i   opacity16          = _mm256_set1_epi16((short)opacity);
+    const bool      bOpacity           = (opacity < 255);
+    const bool      bAdditive          = info.mDoAdditiveBlend;
+    const bool      bPremultipliedDest = (info.mpDest->mPixelFormat.mPixelFormatType == kPixelFormatTypePARGB);
+
+    while(height--)
+    {
+        int n = width;
 
-                    mm_alpha = _mm_cvtsi32_si64(alpha);                 // alpha -> mm_alpha (0000000A)
-                    mm_alpha = _mm_srli_si64(mm_alpha, ashift);         // mm_alpha >> ashift -> mm_alpha(0000000A)
-                    mm_alpha = _mm_unpacklo_pi16(mm_alpha, mm_alpha);   // 00000A0A -> mm_alpha
-                    mm_alpha = _mm_unpacklo_pi32(mm_alpha, mm_alpha);   // 0A0A0A0A -> mm_alpha
-                    mm_alpha = _mm_and_si64(mm_alpha, dmask);           // 000A0A0A -> mm_alpha, preserve pDest alpha on add
+        for(; n >= 8; n -= 8, pSrc += 8, pDst += 8)
+            BlitPARGB8AVX2(pSrc, pDst, opacity16, bOpacity, bAdditive, bPremultipliedDest);
 
-                    // blend          
-                    src1 = _mm_sub_pi16(src1, dst1);            // src1 - dst1 -> src1
-                    src1 = _mm_mullo_pi16(src1, mm_alpha);      // (src1 - dst1) * alpha -> src1
-                    src1 = _mm_srli_pi16(src1, 8);              // src1 >> 8 -> src1(000R0G0B)
-                    dst1 = _mm_add_pi8(src1, dst1);             // src1 + dst1 -> dst1(0A0R0G0B)
-                    dst1 = _mm_packs_pu16(dst1, mm_zero);       // 0000ARGB -> dst1
-                    
-                    *pDst = _mm_cvtsi64_si32(dst1);             // dst1 -> pixel
-                }
+        if(n)
+        {
+            uint32_t sTail[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+            uint32_t dTail[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
 
-                ++pSrc;
-                ++pDst;
-            }, width);
+            memcpy(sTail, pSrc, n * sizeof(uint32_t));
+            memcpy(dTail, pDst, n * sizeof(uint32_t));
+            BlitPARGB8AVX2(sTail, dTail, opacity16, bOpacity, bAdditive, bPremultipliedDest);
+            memcpy(pDst, dTail, n * sizeof(uint32_t));
 
-            pSrc += srcskip;
-            pDst += dstskip;
+            pSrc += n;
+            pDst += n;
         }
-        _mm_empty();
-    }   
+
+        pSrc += srcskip;
+        pDst += dstskip;
+    }
 }
 
+AVX2_TARGET static inline __m256i MaskToPen8AVX2(uint64_t mask8, __m256i pen, __m256i penAlpha)
+{
+    const __m256i c255 = _mm256_set1_epi32(0xff);
+    const __m256i cov  = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)&mask8));
+    const __m256i a    = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi16(cov, penAlpha), c255), 8);
+
+    return _mm256_or_si256(pen, _mm256_slli_epi32(a, 24));
+}
 
 
-#endif // MSVC_ASMBLIT
+AVX2_TARGET static void BlitMaskA8RowAVX2(const uint8_t* pMask, uint32_t* pDst, int width, uint32_t pen, uint32_t penAlpha)
+{
+    const __m256i penV      = _mm256_set1_epi32((int)pen);
+    const __m256i penAlphaV = _mm256_set1_epi32((int)penAlpha);
+
+    for(; width >= 8; width -= 8, pMask += 8, pDst += 8)
+    {
+        uint64_t mask8;
+        memcpy(&mask8, pMask, sizeof(mask8));
+
+        if(!mask8)
+            continue;
+
+        const __m256i d = _mm256_loadu_si256((const __m256i*)pDst);
+        _mm256_storeu_si256((__m256i*)pDst, PixelAlphaBlend8AVX2(MaskToPen8AVX2(mask8, penV, penAlphaV), d, false));
+    }
+
+    if(width)
+    {
+        uint64_t mask8    = 0;
+        uint32_t dTail[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+        memcpy(&mask8, pMask, width);
+        memcpy(dTail, pDst, width * sizeof(uint32_t));
+        _mm256_storeu_si256((__m256i*)dTail, PixelAlphaBlend8AVX2(MaskToPen8AVX2(mask8, penV, penAlphaV), _mm256_loadu_si256((const __m256i*)dTail), false));
+        memcpy(pDst, dTail, width * sizeof(uint32_t));
+    }
+}
+
+
+// Four dest pixels at a time, as BilinearSpanSSE2 does two. The lanes hold pixels 0 and 2 in 
+// the low halves of the unpacks and 1 and 3 in the high halves.
+AVX2_TARGET static void BilinearSpanAVX2(const uint32_t* pRow0, const uint32_t* pRow1, uint32_t fy, const int* pX, const uint16_t* pFx, uint32_t* pDest, int count)
+{
+    const __m256i zero  = _mm256_setzero_si256();
+    const __m256i c128  = _mm256_set1_epi16(0x80);
+    const __m256i wy0   = _mm256_set1_epi16((short)(256 - fy));
+    const __m256i wy1   = _mm256_set1_epi16((short)fy);
+    const __m256i order = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+
+    for(; count >= 4; count -= 4, pX += 4, pFx += 4, pDest += 4)
+    {
+        int64_t taps0[4], taps1[4];
+
+        for(int i = 0; i < 4; ++i)
+        {
+            memcpy(&taps0[i], pRow0 + pX[i], sizeof(int64_t));
+            memcpy(&taps1[i], pRow1 + pX[i], sizeof(int64_t));
+        }
+
+        const __m256i t0  = _mm256_loadu_si256((const __m256i*)taps0);
+        const __m256i t1  = _mm256_loadu_si256((const __m256i*)taps1);
+
+        const __m256i vLo = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(t0, zero), wy0), _mm256_mullo_epi16(_mm256_unpacklo_epi8(t1, zero), wy1)), c128), 8);
+        const __m256i vHi = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(t0, zero), wy0), _mm256_mullo_epi16(_mm256_unpackhi_epi8(t1, zero), wy1)), c128), 8);
+
+        const short   fx0 = (short)pFx[0], fx1 = (short)pFx[1], fx2 = (short)pFx[2], fx3 = (short)pFx[3];
+        __m256i       hLo = _mm256_mullo_epi16(vLo, _mm256_set_epi16(fx2, fx2, fx2, fx2, (short)(256 - fx2), (short)(256 - fx2), (short)(256 - fx2), (short)(256 - fx2),
+                                                                      fx0, fx0, fx0, fx0, (short)(256 - fx0), (short)(256 - fx0), (short)(256 - fx0), (short)(256 - fx0)));
+        __m256i       hHi = _mm256_mullo_epi16(vHi, _mm256_set_epi16(fx3, fx3, fx3, fx3, (short)(256 - fx3), (short)(256 - fx3), (short)(256 - fx3), (short)(256 - fx3),
+                                                                      fx1, fx1, fx1, fx1, (short)(256 - fx1), (short)(256 - fx1), (short)(256 - fx1), (short)(256 - fx1)));
+
+        hLo = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(hLo, _mm256_shuffle_epi32(hLo, _MM_SHUFFLE(1, 0, 3, 2))), c128), 8);
+        hHi = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(hHi, _mm256_shuffle_epi32(hHi, _MM_SHUFFLE(1, 0, 3, 2))), c128), 8);
+
+        // The pixels are in the even 32 bit lanes, in order.
+        const __m256i packed = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(hLo, hHi), order);
+        _mm_storeu_si128((__m128i*)pDest, _mm256_castsi256_si128(packed));
+    }
+
+    if(count)
+        BilinearSpanSSE2(pRow0, pRow1, fy, pX, pFx, pDest, count);
+}
+
+#endif // AVX2_BLIT
 
 
 
@@ -0,0 +1,691 @@
+/*
+Copyright (C) 2010 Electronic Arts, Inc.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of Electronic Arts, Inc. ("EA") nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS AND ITS CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ELECTRONIC ARTS OR ITS CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+// EARasterClip.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+// Clip regions. 
+// Overflow and layer clips have pixel aligned edges, so a region is kept as spans for each 
+// row for as long as it can be, and the fills and blits draw each band of identical rows as a 
+// rect. Anti-aliased clip paths and masks make the region a coverage mask over its bounds, 
+// which the path fills combine with their own coverage one span at a time.
+
+
+#include "EARaster.h"
+#include <EAWebKit/internal/EAWebKitAssert.h>
+#include <math.h>
+#include <string.h>
+#include <wtf/FastAllocBase.h>
+#include <wtf/Vector.h>
+
+
+namespace EA {
+
+namespace Raster {
+
+
+// ClipSpan combines coverage a chunk of this many pixels at a time.
+static const int kClipChunkSize = 256;
+
+
+static inline int MultiplyCoverage(int a, int b)
+{
+    const int t = (a * b) + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+
+// Collects the spans of a region, a row at a time and left to right within each row.
+// A row with the same spans as the one above it shares them.
+class SpanBuilder
+{
+public:
+    SpanBuilder() : mRowStart(0) { }
+
+    void BeginRow()
+    {
+        mRowStart = (int)mSpans.size();
+    }
+
+    void AddSpan(int x1, int x2)
+    {
+        if(x2 <= x1)
+            return;
+
+        if(((int)mSpans.size() > mRowStart) && (mSpans.last().mX2 >= x1))
+        {
+            if(x2 > mSpans.last().mX2)
+                mSpans.last().mX2 = x2;
+        }
+        else
+        {
+            const ClipRegion::Span span = { x1, x2 };
+            mSpans.append(span);
+        }
+    }
+
+    void EndRow()
+    {
+        ClipRegion::Row row = { mRowStart, (int)mSpans.size() - mRowStart };
+
+        if(!mRows.isEmpty())
+        {
+            const ClipRegion::Row& above = mRows.last();
+
+            if((above.mSpanCount == row.mSpanCount) && 
+               (!row.mSpanCount || !memcmp(&mSpans[above.mFirstSpan], &mSpans[row.mFirstSpan], row.mSpanCount * sizeof(ClipRegion::Span))))
+            {
+                mSpans.shrink(mRowStart);
+                row.mFirstSpan = above.mFirstSpan;
+            }
+        }
+
+        mRows.append(row);
+    }
+
+    WTF::Vector<ClipRegion::Row>  mRows;
+    WTF::Vector<ClipRegion::Span> mSpans;
+    int                           mRowStart;
+};
+
+
+struct MaskSpanContext
+{
+    uint8_t* mpCoverage;
+    Rect     mBounds;
+};
+
+
+static void MaskSpan(void* pContext, int x, int y, int length, const uint8_t* pCoverage)
+{
+    const MaskSpanContext& context = *static_cast<const MaskSpanContext*>(pContext);
+    uint8_t* const         pDest   = context.mpCoverage + ((y - context.mBounds.y) * context.mBounds.w) + (x - context.mBounds.x);
+
+    if(pCoverage)
+        memcpy(pDest, pCoverage, length);
+    else
+        memset(pDest, 255, length);
+}
+
+
+ClipRegion::ClipRegion(const Rect& rect)
+  : mBounds(0, 0, 0, 0),
+    mRefCount(1),
+    mpRows(NULL),
+    mpSpans(NULL),
+    mSpanCount(0),
+    mpCoverage(NULL)
+{
+    if((rect.w > 0) && (rect.h > 0))
+    {
+        mBounds    = rect;
+        mpRows     = WTF::fastNewArray<Row>(rect.h);
+        mpSpans    = WTF::fastNewArray<Span>(1);
+        mSpanCount = 1;
+
+        mpSpans[0].mX1 = rect.x;
+        mpSpans[0].mX2 = rect.x + rect.w;
+
+        for(int i = 0; i < rect.h; i++)
+        {
+            mpRows[i].mFirstSpan = 0;
+            mpRows[i].mSpanCount = 1;
+        }
+    }
+}
+
+
+ClipRegion::ClipRegion(const ClipRegion& region)
+  : mBounds(region.mBounds),
+    mRefCount(1),
+    mpRows(NULL),
+    mpSpans(NULL),
+    mSpanCount(region.mSpanCount),
+    mpCoverage(NULL)
+{
+    if(region.mpCoverage)
+    {
+        mpCoverage = WTF::fastNewArray<uint8_t>(mBounds.w * mBounds.h);
+        memcpy(mpCoverage, region.mpCoverage, mBounds.w * mBounds.h);
+    }
+    else if(region.mpRows)
+    {
+        mpRows  = WTF::fastNewArray<Row>(mBounds.h);
+        mpSpans = WTF::fastNewArray<Span>(mSpanCount);
+        memcpy(mpRows, region.mpRows, mBounds.h * sizeof(Row));
+        memcpy(mpSpans, region.mpSpans, mSpanCount * sizeof(Span));
+    }
+}
+
+
+ClipRegion::~ClipRegion()
+{
+    FreeData();
+}
+
+
+int ClipRegion::AddRef()
+{
+    // This is not thread-safe.
+    return ++mRefCount;
+}
+
+
+int ClipRegion::Release()
+{
+    // This is not thread-safe.
+    if(mRefCount > 1)
+        return --mRefCount;
+
+    WTF::fastDelete<ClipRegion>(this);
+    return 0;
+}
+
+
+void ClipRegion::FreeData()
+{
+    WTF::fastDeleteArray<Row>(mpRows);
+    WTF::fastDeleteArray<Span>(mpSpans);
+    WTF::fastDeleteArray<uint8_t>(mpCoverage);
+
+    mpRows     = NULL;
+    mpSpans    = NULL;
+    mSpanCount = 0;
+    mpCoverage = NULL;
+}
+
+
+// Makes the region the given rows of spans, starting at row y. 
+// Empty rows at the top and bottom are dropped and the bounds are fitted to what is left.
+void ClipRegion::SetSpans(const Row* pRows, int rowCount, const Span* pSpans, int spanCount, int y)
+{
+    int first = 0;
+    int last  = rowCount;
+
+    while((first < last) && !pRows[first].mSpanCount)
+        first++;
+    while((last > first) && !pRows[last - 1].mSpanCount)
+        last--;
+
+    FreeData();
+    mBounds = Rect(0, 0, 0, 0);
+
+    if(first == last)
+        return;
+
+    int x1 = pSpans[pRows[first].mFirstSpan].mX1;
+    int x2 = x1;
+
+    for(int i = first; i < last; i++)
+    {
+        if(pRows[i].mSpanCount)
+        {
+            const Span* const pRowSpans = pSpans + pRows[i].mFirstSpan;
+
+            if(pRowSpans[0].mX1 < x1)
+                x1 = pRowSpans[0].mX1;
+            if(pRowSpans[pRows[i].mSpanCount - 1].mX2 > x2)
+                x2 = pRowSpans[pRows[i].mSpanCount - 1].mX2;
+        }
+    }
+
+    mBounds    = Rect(x1, y + first, x2 - x1, last - first);
+    mpRows     = WTF::fastNewArray<Row>(mBounds.h);
+    mpSpans    = WTF::fastNewArray<Span>(spanCount);
+    mSpanCount = spanCount;
+
+    memcpy(mpRows, pRows + first, mBounds.h * sizeof(Row));
+    memcpy(mpSpans, pSpans, spanCount * sizeof(Span));
+}
+
+
+// Makes the region the given coverage, which covers bounds and was allocated with fastNewArray.
+// The region takes it over, or turns it back into spans if there is no partial coverage in it.
+void ClipRegion::SetCoverage(uint8_t* pCoverage, const Rect& bounds)
+{
+    const int size = bounds.w * bounds.h;
+    int       i    = 0;
+
+    while((i < size) && ((pCoverage[i] == 0) || (pCoverage[i] == 255)))
+        i++;
+
+    if(pCoverage == mpCoverage)
+        mpCoverage = NULL;  // So that FreeData leaves it alone.
+
+    if(i < size)
+    {
+        FreeData();
+        mpCoverage = pCoverage;
+        mBounds    = bounds;
+        return;
+    }
+
+    SpanBuilder builder;
+
+    for(int y = 0; y < bounds.h; y++)
+    {
+        const uint8_t* const pRow = pCoverage + (y * bounds.w);
+
+        builder.BeginRow();
+
+        for(int x = 0; x < bounds.w; )
+        {
+            if(pRow[x])
+            {
+                int end = x + 1;
+
+                while((end < bounds.w) && pRow[end])
+                    end++;
+
+                builder.AddSpan(bounds.x + x, bounds.x + end);
+                x = end;
+            }
+            else
+                x++;
+        }
+
+        builder.EndRow();
+    }
+
+    WTF::fastDeleteArray<uint8_t>(pCoverage);
+    SetSpans(builder.mRows.data(), (int)builder.mRows.size(), builder.mSpans.data(), (int)builder.mSpans.size(), bounds.y);
+}
+
+
+// Writes the region's coverage of length pixels of row y, starting at x.
+void ClipRegion::GetRowCoverage(int y, int x, int length, uint8_t* pCoverage) const
+{
+    memset(pCoverage, 0, length);
+
+    if((y < mBounds.y) || (y >= (mBounds.y + mBounds.h)))
+        return;
+
+    const int x1 = (x > mBounds.x) ? x : mBounds.x;
+    const int x2 = ((x + length) < (mBounds.x + mBounds.w)) ? (x + length) : (mBounds.x + mBounds.w);
+
+    if(mpCoverage)
+    {
+        if(x2 > x1)
+            memcpy(pCoverage + (x1 - x), mpCoverage + ((y - mBounds.y) * mBounds.w) + (x1 - mBounds.x), x2 - x1);
+    }
+    else if(mpRows)
+    {
+        const Row&        row       = mpRows[y - mBounds.y];
+        const Span* const pRowSpans = mpSpans + row.mFirstSpan;
+
+        for(int i = 0; i < row.mSpanCount; i++)
+        {
+            const int s1 = (pRowSpans[i].mX1 > x1) ? pRowSpans[i].mX1 : x1;
+            const int s2 = (pRowSpans[i].mX2 < x2) ? pRowSpans[i].mX2 : x2;
+
+            if(s2 > s1)
+                memset(pCoverage + (s1 - x), 255, s2 - s1);
+        }
+    }
+}
+
+
+void ClipRegion::ClipToRect(const Rect& rect)
+{
+    Rect r;
+
+    if(IsEmpty())
+        return;
+
+    if(!EA::Raster::IntersectRect(mBounds, rect, r))
+    {
+        FreeData();
+        mBounds = Rect(0, 0, 0, 0);
+        return;
+    }
+
+    if(mpCoverage)
+    {
+        uint8_t* const pCoverage = WTF::fastNewArray<uint8_t>(r.w * r.h);
+
+        for(int y = 0; y < r.h; y++)
+            memcpy(pCoverage + (y * r.w), mpCoverage + ((r.y - mBounds.y + y) * mBounds.w) + (r.x - mBounds.x), r.w);
+
+        SetCoverage(pCoverage, r);
+    }
+    else
+    {
+        SpanBuilder builder;
+
+        for(int y = r.y; y < (r.y + r.h); y++)
+        {
+            const Row&        row       = mpRows[y - mBounds.y];
+            const Span* const pRowSpans = mpSpans + row.mFirstSpan;
+
+            builder.BeginRow();
+            for(int i = 0; i < row.mSpanCount; i++)
+                builder.AddSpan((pRowSpans[i].mX1 > r.x) ? pRowSpans[i].mX1 : r.x, (pRowSpans[i].mX2 < (r.x + r.w)) ? pRowSpans[i].mX2 : (r.x + r.w));
+            builder.EndRow();
+        }
+
+        SetSpans(builder.mRows.data(), (int)builder.mRows.size(), builder.mSpans.data(), (int)builder.mSpans.size(), r.y);
+    }
+}
+
+
+void ClipRegion::ClipOutRect(const Rect& rect)
+{
+    Rect r;
+
+    if(IsEmpty() || !EA::Raster::IntersectRect(mBounds, rect, r))
+        return;
+
+    if(mpCoverage)
+    {
+        for(int y = 0; y < r.h; y++)
+            memset(mpCoverage + ((r.y - mBounds.y + y) * mBounds.w) + (r.x - mBounds.x), 0, r.w);
+
+        SetCoverage(mpCoverage, mBounds);
+    }
+    else
+    {
+        SpanBuilder builder;
+
+        for(int y = mBounds.y; y < (mBounds.y + mBounds.h); y++)
+        {
+            const Row&        row       = mpRows[y - mBounds.y];
+            const Span* const pRowSpans = mpSpans + row.mFirstSpan;
+            const bool        bInside   = (y >= r.y) && (y < (r.y + r.h));
+
+            builder.BeginRow();
+
+            for(int i = 0; i < row.mSpanCount; i++)
+            {
+                if(bInside)
+                {
+                    builder.AddSpan(pRowSpans[i].mX1, (pRowSpans[i].mX2 < r.x) ? pRowSpans[i].mX2 : r.x);
+                    builder.AddSpan((pRowSpans[i].mX1 > (r.x + r.w)) ? pRowSpans[i].mX1 : (r.x + r.w), pRowSpans[i].mX2);
+                }
+                else
+                    builder.AddSpan(pRowSpans[i].mX1, pRowSpans[i].mX2);
+            }
+
+            builder.EndRow();
+        }
+
+        SetSpans(builder.mRows.data(), (int)builder.mRows.size(), builder.mSpans.data(), (int)builder.mSpans.size(), mBounds.y);
+    }
+}
+
+
+int ClipRegion::ClipToPath(const PointF* pPoints, const int* pContourSizes, int contourCount, FillRule fillRule, bool bAntialias, RasterScratch* pScratch)
+{
+    return ClipToPathInternal(pPoints, pContourSizes, contourCount, fillRule, bAntialias, false, pScratch);
+}
+
+
+int ClipRegion::ClipOutPath(const PointF* pPoints, const int* pContourSizes, int contourCount, FillRule fillRule, bool bAntialias, RasterScratch* pScratch)
+{
+    return ClipToPathInternal(pPoints, pContourSizes, contourCount, fillRule, bAntialias, true, pScratch);
+}
+
+
+// The path is rasterized into a mask over the region's bounds, or just the part of them 
+// the path covers when clipping to it, and then combined with the region.
+int ClipRegion::ClipToPathInternal(const PointF* pPoints, const int* pContourSizes, int contourCount, FillRule fillRule, bool bAntialias, bool bOutside, RasterScratch* pScratch)
+{
+    if(IsEmpty())
+        return 0;
+
+    Rect r(mBounds);
+
+    if(!bOutside)
+    {
+        int pointCount = 0;
+
+        for(int i = 0; i < contourCount; i++)
+            pointCount += pContourSizes[i];
+
+        float x1 = pointCount ? pPoints[0].x : 0.f, y1 = pointCount ? pPoints[0].y : 0.f, x2 = x1, y2 = y1;
+
+        for(int i = 1; i < pointCount; i++)
+        {
+            if(pPoints[i].x < x1) x1 = pPoints[i].x;
+            if(pPoints[i].y < y1) y1 = pPoints[i].y;
+            if(pPoints[i].x > x2) x2 = pPoints[i].x;
+            if(pPoints[i].y > y2) y2 = pPoints[i].y;
+        }
+
+        const Rect pathRect((int)floorf(x1), (int)floorf(y1), (int)ceilf(x2) - (int)floorf(x1), (int)ceilf(y2) - (int)floorf(y1));
+
+        if((pointCount < 3) || !EA::Raster::IntersectRect(mBounds, pathRect, r))
+        {
+            FreeData();
+            mBounds = Rect(0, 0, 0, 0);
+            return 0;
+        }
+    }
+
+    uint8_t* const pCoverage = WTF::fastNewArray<uint8_t>(r.w * r.h);
+    memset(pCoverage, 0, r.w * r.h);
+
+    MaskSpanContext context = { pCoverage, r };
+    const int result = RasterizePath(pPoints, pContourSizes, contourCount, fillRule, bAntialias, r, MaskSpan, &context, pScratch);
+
+    if(result != 0)
+    {
+        WTF::fastDeleteArray<uint8_t>(pCoverage);
+        return result;
+    }
+
+    uint8_t* const pRegionRow = WTF::fastNewArray<uint8_t>(r.w);
+
+    for(int y = 0; y < r.h; y++)
+    {
+        uint8_t* const pRow = pCoverage + (y * r.w);
+
+        GetRowCoverage(r.y + y, r.x, r.w, pRegionRow);
+
+        for(int x = 0; x < r.w; x++)
+            pRow[x] = (uint8_t)MultiplyCoverage(bOutside ? (255 - pRow[x]) : pRow[x], pRegionRow[x]);
+    }
+
+    WTF::fastDeleteArray<uint8_t>(pRegionRow);
+    SetCoverage(pCoverage, r);
+
+    return 0;
+}
+
+
+void ClipRegion::ClipToMask(const uint8_t* pMask, int maskWidth, int maskHeight, int maskStride, int x, int y)
+{
+    Rect r;
+
+    if(IsEmpty())
+        return;
+
+    if(!EA::Raster::IntersectRect(mBounds, Rect(x, y, maskWidth, maskHeight), r))
+    {
+        FreeData();
+        mBounds = Rect(0, 0, 0, 0);
+        return;
+    }
+
+    uint8_t* const pCoverage = WTF::fastNewArray<uint8_t>(r.w * r.h);
+
+    for(int row = 0; row < r.h; row++)
+    {
+        uint8_t* const       pRow     = pCoverage + (row * r.w);
+        const uint8_t* const pMaskRow = pMask + ((r.y - y + row) * maskStride) + (r.x - x);
+
+        GetRowCoverage(r.y + row, r.x, r.w, pRow);
+
+        for(int i = 0; i < r.w; i++)
+            pRow[i] = (uint8_t)MultiplyCoverage(pRow[i], pMaskRow[i]);
+    }
+
+    SetCoverage(pCoverage, r);
+}
+
+
+void ClipRegion::ForEachRect(const Rect& rect, RectFunction pRectFunction, void* pContext) const
+{
+    Rect r;
+
+    if(IsEmpty() || !EA::Raster::IntersectRect(rect, mBounds, r))
+        return;
+
+    const int x2 = r.x + r.w;
+    const int y2 = r.y + r.h;
+
+    if(mpCoverage)
+    {
+        for(int y = r.y; y < y2; y++)
+        {
+            const uint8_t* const pRow = mpCoverage + ((y - mBounds.y) * mBounds.w);
+
+            for(int x = r.x; x < x2; )
+            {
+                const int coverage = pRow[x - mBounds.x];
+                int       end      = x + 1;
+
+                while((end < x2) && (pRow[end - mBounds.x] == coverage))
+                    end++;
+
+                if(coverage)
+                    pRectFunction(pContext, Rect(x, y, end - x, 1), coverage);
+
+                x = end;
+            }
+        }
+    }
+    else
+    {
+        for(int y = r.y; y < y2; )
+        {
+            const Row& row = mpRows[y - mBounds.y];
+            int        end = y + 1;
+
+            // Rows that share their spans make up a band that can be done as one rect.
+            while((end < y2) && (mpRows[end - mBounds.y].mFirstSpan == row.mFirstSpan) && (mpRows[end - mBounds.y].mSpanCount == row.mSpanCount))
+                end++;
+
+            const Span* const pRowSpans = mpSpans + row.mFirstSpan;
+
+            for(int i = 0; i < row.mSpanCount; i++)
+            {
+                const int s1 = (pRowSpans[i].mX1 > r.x) ? pRowSpans[i].mX1 : r.x;
+                const int s2 = (pRowSpans[i].mX2 < x2)  ? pRowSpans[i].mX2 : x2;
+
+                if(s2 > s1)
+                    pRectFunction(pContext, Rect(s1, y, s2 - s1, end - y), 255);
+            }
+
+            y = end;
+        }
+    }
+}
+
+
+void ClipRegion::ClipSpan(int x, int y, int length, const uint8_t* pCoverage, SpanFunction pSpanFunction, void* pContext) const
+{
+    if(IsEmpty() || (y < mBounds.y) || (y >= (mBounds.y + mBounds.h)))
+        return;
+
+    const int x1 = (x > mBounds.x) ? x : mBounds.x;
+    const int x2 = ((x + length) < (mBounds.x + mBounds.w)) ? (x + length) : (mBounds.x + mBounds.w);
+
+    if(x2 <= x1)
+        return;
+
+    if(!mpCoverage)
+    {
+        const Row&        row       = mpRows[y - mBounds.y];
+        const Span* const pRowSpans = mpSpans + row.mFirstSpan;
+
+        for(int i = 0; i < row.mSpanCount; i++)
+        {
+            const int s1 = (pRowSpans[i].mX1 > x1) ? pRowSpans[i].mX1 : x1;
+            const int s2 = (pRowSpans[i].mX2 < x2) ? pRowSpans[i].mX2 : x2;
+
+            if(s2 > s1)
+                pSpanFunction(pContext, s1, y, s2 - s1, pCoverage ? (pCoverage + (s1 - x)) : NULL);
+        }
+
+        return;
+    }
+
+    const uint8_t* const pMaskRow = mpCoverage + ((y - mBounds.y) * mBounds.w) + (x1 - mBounds.x);
+    uint8_t              combined[kClipChunkSize];
+
+    for(int chunkX = x1; chunkX < x2; chunkX += kClipChunkSize)
+    {
+        const int count = ((x2 - chunkX) < kClipChunkSize) ? (x2 - chunkX) : kClipChunkSize;
+
+        for(int i = 0; i < count; i++)
+            combined[i] = pCoverage ? (uint8_t)MultiplyCoverage(pCoverage[chunkX - x + i], pMaskRow[chunkX - x1 + i]) : pMaskRow[chunkX - x1 + i];
+
+        // Only the covered runs get passed on.
+        for(int i = 0; i < count; )
+        {
+            if(combined[i])
+            {
+                int end = i + 1;
+
+                while((end < count) && combined[end])
+                    end++;
+
+                pSpanFunction(pContext, chunkX + i, y, end - i, combined + i);
+                i = end;
+            }
+            else
+                i++;
+        }
+    }
+}
+
+
+void ClipRegion::ClipSpanFunction(void* pSpanClipper, int x, int y, int length, const uint8_t* pCoverage)
+{
+    const SpanClipper& clipper = *static_cast<const SpanClipper*>(pSpanClipper);
+
+    clipper.mpClipRegion->ClipSpan(x, y, length, pCoverage, clipper.mpSpanFunction, clipper.mpContext);
+}
+
+
+EARASTER_API ClipRegion* CreateClipRegion(const Rect& rect)
+{
+    return WTF::fastNew<ClipRegion, const Rect&>(rect);
+}
+
+
+EARASTER_API ClipRegion* CreateClipRegion(const ClipRegion& region)
+{
+    return WTF::fastNew<ClipRegion, const ClipRegion&>(region);
+}
+
+
+} // namespace Raster
+
+} // namespace EA
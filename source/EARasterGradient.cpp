@@ -0,0 +1,505 @@
+/*
+Copyright (C) 2010 Electronic Arts, Inc.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of Electronic Arts, Inc. ("EA") nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS AND ITS CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ELECTRONIC ARTS OR ITS CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+// EARasterGradient.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+// Linear and radial gradient fills. 
+// A gradient is reduced to a function from pixel position to an index in its color ramp. 
+// Spans are generated a chunk at a time: the indices are computed four pixels at a time 
+// with SSE2 where we have it, then the ramp colors get blended through the path coverage.
+
+
+#include "EARaster.h"
+#include "EARasterColor.h"
+#include <EAWebKit/internal/EAWebKitAssert.h>
+#include <math.h>
+#include <string.h>
+
+
+// SSE2 is always there on x86-64, and on 32 bit x86 if the compiler was told it can use it.
+#ifndef SSE2_GRADIENT
+    #if defined(_M_X64) || defined(_M_AMD64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+        #define SSE2_GRADIENT 1
+    #else
+        #define SSE2_GRADIENT 0
+    #endif
+#endif
+
+#if SSE2_GRADIENT
+    #include <emmintrin.h>
+#endif
+
+
+namespace EA {
+
+namespace Raster {
+
+
+// Spans are generated and blended this many pixels at a time.
+static const int kGradientChunkSize = 256;
+
+// The largest ramp index, as a float.
+static const float kRampMax = (float)(kGradientRampSize - 1);
+
+
+// The gradient, reduced to what the index computation needs. 
+struct GradientSetup
+{
+    bool  mbEmpty;          // Nothing gets painted, as with a linear gradient whose points are the same.
+    bool  mbRadial;
+
+    // Linear: the index at (px, py) is mDx * px + mDy * py + mOffset.
+    float mDx, mDy, mOffset;
+
+    // Radial: offset t is where the circle (mP0 + t * (mCdx, mCdy), mR0 + t * mDr) goes through the pixel. 
+    // With the largest t that gives a radius of at least 0, this is a quadratic in t with mA as its t^2 term. 
+    float mX0, mY0, mR0;
+    float mCdx, mCdy, mDr;
+    float mA, mInvA;
+    bool  mbLinearInT;      // mA is 0, so the quadratic is linear.
+};
+
+
+static void SetUpGradient(const GradientFill& gradient, GradientSetup& setup)
+{
+    memset(&setup, 0, sizeof(setup));
+
+    const float dx = gradient.mP1.x - gradient.mP0.x;
+    const float dy = gradient.mP1.y - gradient.mP0.y;
+
+    if(gradient.mType == kGradientTypeLinear)
+    {
+        const float length2 = (dx * dx) + (dy * dy);
+
+        if(length2 > 0)
+        {
+            // The + 0.5 rounds to the nearest ramp entry when the index gets truncated.
+            setup.mDx     = (dx / length2) * kRampMax;
+            setup.mDy     = (dy / length2) * kRampMax;
+            setup.mOffset = 0.5f - (setup.mDx * gradient.mP0.x) - (setup.mDy * gradient.mP0.y);
+        }
+        else
+            setup.mbEmpty = true;
+    }
+    else
+    {
+        setup.mbRadial = true;
+        setup.mX0      = gradient.mP0.x;
+        setup.mY0      = gradient.mP0.y;
+        setup.mR0      = gradient.mR0;
+        setup.mCdx     = dx;
+        setup.mCdy     = dy;
+        setup.mDr      = gradient.mR1 - gradient.mR0;
+        setup.mA       = (dx * dx) + (dy * dy) - (setup.mDr * setup.mDr);
+
+        const float scale = (dx * dx) + (dy * dy) + (setup.mDr * setup.mDr);
+
+        if(scale == 0)
+            setup.mbEmpty = true;
+        else if(fabsf(setup.mA) <= (scale * 1e-6f))
+            setup.mbLinearInT = true;
+        else
+            setup.mInvA = 1.f / setup.mA;
+    }
+}
+
+
+static inline int ClampIndex(float f)
+{
+    // Written so that a NaN ends up as 0.
+    return (f > 0) ? (int)((f < kRampMax) ? f : kRampMax) : 0;
+}
+
+
+// Returns the ramp index of a radial gradient at (px, py), or -1 if the gradient doesn't cover it.
+static int RadialIndex(const GradientSetup& setup, float px, float py)
+{
+    const float pdx = px - setup.mX0;
+    const float pdy = py - setup.mY0;
+    const float b   = (pdx * setup.mCdx) + (pdy * setup.mCdy) + (setup.mR0 * setup.mDr);
+    const float c   = (pdx * pdx) + (pdy * pdy) - (setup.mR0 * setup.mR0);
+    float       t;
+
+    if(setup.mbLinearInT)
+    {
+        if(b == 0)
+            return -1;
+
+        t = c / (2 * b);
+    }
+    else
+    {
+        const float discriminant = (b * b) - (setup.mA * c);
+
+        if(discriminant < 0)
+            return -1;
+
+        const float s  = sqrtf(discriminant);
+        const float t1 = (b + s) * setup.mInvA;
+        const float t2 = (b - s) * setup.mInvA;
+
+        t = (t1 > t2) ? t1 : t2;
+
+        if((setup.mR0 + (t * setup.mDr)) < 0)
+            t = (t1 > t2) ? t2 : t1;
+    }
+
+    if((setup.mR0 + (t * setup.mDr)) < 0)
+        return -1;
+
+    return ClampIndex((t * kRampMax) + 0.5f);
+}
+
+
+// Writes the ramp indices of length pixels starting at pixel (x, y), -1 for the ones not covered.
+static void GenerateIndices(const GradientSetup& setup, int x, int y, int length, int* pIndices)
+{
+    const float px = x + 0.5f;
+    const float py = y + 0.5f;
+    int         i  = 0;
+
+    if(setup.mbEmpty)
+    {
+        for(; i < length; i++)
+            pIndices[i] = -1;
+    }
+    else if(!setup.mbRadial)
+    {
+        const float f0 = (setup.mDx * px) + (setup.mDy * py) + setup.mOffset;
+
+        #if SSE2_GRADIENT
+            const __m128 vF0   = _mm_set1_ps(f0);
+            const __m128 vDx   = _mm_set1_ps(setup.mDx);
+            const __m128 vZero = _mm_setzero_ps();
+            const __m128 vMax  = _mm_set1_ps(kRampMax);
+            __m128       vI    = _mm_set_ps(3.f, 2.f, 1.f, 0.f);
+
+            for(; (i + 4) <= length; i += 4)
+            {
+                // The max comes first, as it returns its second operand for a NaN.
+                __m128 vF = _mm_add_ps(vF0, _mm_mul_ps(vI, vDx));
+                vF = _mm_min_ps(_mm_max_ps(vF, vZero), vMax);
+                _mm_storeu_si128((__m128i*)(pIndices + i), _mm_cvttps_epi32(vF));
+                vI = _mm_add_ps(vI, _mm_set1_ps(4.f));
+            }
+        #endif
+
+        for(; i < length; i++)
+            pIndices[i] = ClampIndex(f0 + (i * setup.mDx));
+    }
+    else
+    {
+        #if SSE2_GRADIENT
+            if(!setup.mbLinearInT)
+            {
+                const float  pdy    = py - setup.mY0;
+                const __m128 vCdx   = _mm_set1_ps(setup.mCdx);
+                const __m128 vB0    = _mm_set1_ps((pdy * setup.mCdy) + (setup.mR0 * setup.mDr));
+                const __m128 vC0    = _mm_set1_ps((pdy * pdy) - (setup.mR0 * setup.mR0));
+                const __m128 vA     = _mm_set1_ps(setup.mA);
+                const __m128 vInvA  = _mm_set1_ps(setup.mInvA);
+                const __m128 vR0    = _mm_set1_ps(setup.mR0);
+                const __m128 vDr    = _mm_set1_ps(setup.mDr);
+                const __m128 vScale = _mm_set1_ps(kRampMax);
+                const __m128 vHalf  = _mm_set1_ps(0.5f);
+                const __m128 vZero  = _mm_setzero_ps();
+                __m128       vPdx   = _mm_add_ps(_mm_set1_ps(px - setup.mX0), _mm_set_ps(3.f, 2.f, 1.f, 0.f));
+
+                for(; (i + 4) <= length; i += 4)
+                {
+                    const __m128 vB    = _mm_add_ps(_mm_mul_ps(vPdx, vCdx), vB0);
+                    const __m128 vC    = _mm_add_ps(_mm_mul_ps(vPdx, vPdx), vC0);
+                    const __m128 vDisc = _mm_sub_ps(_mm_mul_ps(vB, vB), _mm_mul_ps(vA, vC));
+                    __m128       vValid = _mm_cmpge_ps(vDisc, vZero);
+
+                    const __m128 vS    = _mm_sqrt_ps(_mm_max_ps(vDisc, vZero));
+                    const __m128 vT1   = _mm_mul_ps(_mm_add_ps(vB, vS), vInvA);
+                    const __m128 vT2   = _mm_mul_ps(_mm_sub_ps(vB, vS), vInvA);
+                    const __m128 vTMax = _mm_max_ps(vT1, vT2);
+                    const __m128 vTMin = _mm_min_ps(vT1, vT2);
+
+                    // Take the larger t unless its radius is negative.
+                    const __m128 vMaxOk = _mm_cmpge_ps(_mm_add_ps(vR0, _mm_mul_ps(vTMax, vDr)), vZero);
+                    const __m128 vT     = _mm_or_ps(_mm_and_ps(vMaxOk, vTMax), _mm_andnot_ps(vMaxOk, vTMin));
+                    vValid = _mm_and_ps(vValid, _mm_cmpge_ps(_mm_add_ps(vR0, _mm_mul_ps(vT, vDr)), vZero));
+
+                    __m128 vF = _mm_add_ps(_mm_mul_ps(vT, vScale), vHalf);
+                    vF = _mm_min_ps(_mm_max_ps(vF, vZero), vScale);
+
+                    // Lanes that aren't valid become -1.
+                    const __m128i vIndex = _mm_or_si128(_mm_cvttps_epi32(vF), _mm_andnot_si128(_mm_castps_si128(vValid), _mm_set1_epi32(-1)));
+                    _mm_storeu_si128((__m128i*)(pIndices + i), vIndex);
+
+                    vPdx = _mm_add_ps(vPdx, _mm_set1_ps(4.f));
+                }
+            }
+        #endif
+
+        for(; i < length; i++)
+            pIndices[i] = RadialIndex(setup, px + i, py);
+    }
+}
+
+
+static inline uint32_t ModulateAlpha(uint32_t a, uint32_t opacity)
+{
+    return ((a * opacity) + 255) >> 8;  // Exact at 0 and 255.
+}
+
+
+EARASTER_API void GenerateGradientSpan(const GradientFill& gradient, int x, int y, int length, uint32_t* pColors)
+{
+    EAW_ASSERT(gradient.mpRamp);
+
+    GradientSetup setup;
+    int           indices[kGradientChunkSize];
+
+    SetUpGradient(gradient, setup);
+
+    while(length > 0)
+    {
+        const int count = (length < kGradientChunkSize) ? length : kGradientChunkSize;
+
+        GenerateIndices(setup, x, y, count, indices);
+
+        for(int i = 0; i < count; i++)
+            pColors[i] = (indices[i] >= 0) ? gradient.mpRamp[indices[i]] : 0;
+
+        x       += count;
+        pColors += count;
+        length  -= count;
+    }
+}
+
+
+// Blends ramp colors in the dest layout into a row of 32 bit pixels with RGB in the low 24 bits.
+// This matches BlitMaskA8 with a pen color that changes per pixel.
+static void BlendRampRow(const int* pIndices, const uint8_t* pCoverage, uint32_t* pDst, int width, const uint32_t* pRamp)
+{
+    for(int i = 0; i < width; i++)
+    {
+        if(pIndices[i] < 0)
+            continue;
+
+        const uint32_t s     = pRamp[pIndices[i]];
+        const uint32_t alpha = pCoverage ? ModulateAlpha(pCoverage[i], s >> 24) : (s >> 24);
+
+        if(alpha)
+        {
+            const uint32_t pen    = s & 0x00ffffff;
+            const uint32_t d      = pDst[i];
+            const uint32_t dalpha = d & 0xff000000;
+
+            if(!dalpha)
+                pDst[i] = pen | (alpha << 24);
+            else if(alpha == 255)
+                pDst[i] = pen | dalpha;
+            else
+            {
+                const uint32_t s1 = pen & 0x00ff00ff;
+                const uint32_t s2 = pen & 0x0000ff00;
+                uint32_t       d1 = d & 0x00ff00ff;
+                uint32_t       d2 = d & 0x0000ff00;
+
+                d1 = (d1 + ((s1 - d1) * alpha >> 8)) & 0x00ff00ff;
+                d2 = (d2 + ((s2 - d2) * alpha >> 8)) & 0x0000ff00;
+
+                pDst[i] = d1 | d2 | dalpha;
+            }
+        }
+    }
+}
+
+
+// General (slow) version for other dest formats. The ramp is 0xAARRGGBB.
+static void BlendRampRowGeneral(const int* pIndices, const uint8_t* pCoverage, uint8_t* pDst, int width, const uint32_t* pRamp, const PixelFormat& df)
+{
+    const int bpp = df.mBytesPerPixel;
+
+    for(int i = 0; i < width; i++, pDst += bpp)
+    {
+        if(pIndices[i] < 0)
+            continue;
+
+        const uint32_t s     = pRamp[pIndices[i]];
+        const int      alpha = (int)(pCoverage ? ModulateAlpha(pCoverage[i], s >> 24) : (s >> 24));
+
+        if(!alpha)
+            continue;
+
+        const int sR = (int)((s >> 16) & 0xff);
+        const int sG = (int)((s >>  8) & 0xff);
+        const int sB = (int)( s        & 0xff);
+
+        uint32_t pixel = (bpp == 3) ? (pDst[0] | (pDst[1] << 8) | (pDst[2] << 16)) : *(uint32_t*)pDst;
+        int      dR    = (int)((pixel & df.mRMask) >> df.mRShift);
+        int      dG    = (int)((pixel & df.mGMask) >> df.mGShift);
+        int      dB    = (int)((pixel & df.mBMask) >> df.mBShift);
+        int      dA    = (int)((pixel & df.mAMask) >> df.mAShift);
+
+        if(!dA && df.mAMask)
+        {
+            // 0 alpha background support
+            dR = sR;
+            dG = sG;
+            dB = sB;
+            dA = alpha;
+        }
+        else if(alpha == 255)
+        {
+            dR = sR;
+            dG = sG;
+            dB = sB;
+        }
+        else
+        {
+            dR += ((sR - dR) * alpha) >> 8;
+            dG += ((sG - dG) * alpha) >> 8;
+            dB += ((sB - dB) * alpha) >> 8;
+        }
+
+        pixel = ((uint32_t)dR << df.mRShift) | ((uint32_t)dG << df.mGShift) | ((uint32_t)dB << df.mBShift) | (((uint32_t)dA << df.mAShift) & df.mAMask);
+
+        if(bpp == 3)
+        {
+            pDst[0] = (uint8_t)pixel;
+            pDst[1] = (uint8_t)(pixel >> 8);
+            pDst[2] = (uint8_t)(pixel >> 16);
+        }
+        else
+            *(uint32_t*)pDst = pixel;
+    }
+}
+
+
+struct GradientSpanContext
+{
+    Surface*      mpSurface;
+    GradientSetup mSetup;
+    bool          mbFastPath;                   // Whether the dest works with BlendRampRow.
+    bool          mbAccumulateAlpha;            // Whether the dest is an ARGB surface with kFlagAccumulateAlpha.
+    uint32_t      mRamp[kGradientRampSize];     // With the opacity applied, and in the dest layout for the fast path.
+};
+
+
+static void GradientSpan(void* pContext, int x, int y, int length, const uint8_t* pCoverage)
+{
+    const GradientSpanContext& context = *static_cast<const GradientSpanContext*>(pContext);
+    const Surface* const       pSurface = context.mpSurface;
+    const int                  bpp      = pSurface->mPixelFormat.mBytesPerPixel;
+    uint8_t*                   pRow     = (uint8_t*)pSurface->mpData + (y * pSurface->mStride) + (x * bpp);
+    int                        indices[kGradientChunkSize];
+
+    while(length > 0)
+    {
+        const int count = (length < kGradientChunkSize) ? length : kGradientChunkSize;
+
+        GenerateIndices(context.mSetup, x, y, count, indices);
+
+        if(context.mbFastPath)
+            BlendRampRow(indices, pCoverage, (uint32_t*)pRow, count, context.mRamp);
+        else if((bpp == 2) || context.mbAccumulateAlpha)
+        {
+            uint32_t colors[kGradientChunkSize];
+
+            for(int i = 0; i < count; i++)
+                colors[i] = (indices[i] < 0) ? 0 : context.mRamp[indices[i]];
+
+            // Gradients are where 16 bit banding shows the most, so they get dithered.
+            if(bpp == 2)
+                BlendRow16(context.mpSurface, x, y, count, colors, 1, pCoverage, 255, true);
+            else
+                BlendRowAccumulateAlpha(context.mpSurface, x, y, count, colors, 1, pCoverage, 255);
+        }
+        else
+            BlendRampRowGeneral(indices, pCoverage, pRow, count, context.mRamp, pSurface->mPixelFormat);
+
+        if(pCoverage)
+            pCoverage += count;
+
+        x      += count;
+        pRow   += count * bpp;
+        length -= count;
+    }
+}
+
+
+EARASTER_API int FillPathGradient(Surface* pSurface, const PointF* pPoints, const int* pContourSizes, int contourCount, const GradientFill& gradient, 
+                                  FillRule fillRule, bool bAntialias, RasterScratch* pScratch)
+{
+    EAW_ASSERT(pSurface && gradient.mpRamp);
+
+    const uint32_t opacity = (gradient.mOpacity > 255) ? 255 : (uint32_t)gradient.mOpacity;
+
+    if((gradient.mOpacity <= 0) || (pSurface->mPixelFormat.mBytesPerPixel < 2))
+        return 0;
+
+    // The clip rect is normally already within the surface, but the default one isn't.
+    const Rect rectSurface(0, 0, pSurface->mWidth, pSurface->mHeight);
+    Rect       rectClip;
+
+    if(!IntersectRect(rectSurface, pSurface->mClipRect, rectClip))
+        return 0;
+
+    const PixelFormat& df = pSurface->mPixelFormat;
+    GradientSpanContext context;
+
+    context.mpSurface         = pSurface;
+    context.mbAccumulateAlpha = ((pSurface->mSurfaceFlags & kFlagAccumulateAlpha) != 0) && (df.mPixelFormatType == kPixelFormatTypeARGB);
+    context.mbFastPath        = !context.mbAccumulateAlpha && (df.mBytesPerPixel == 4) && 
+                                ((df.mRMask | df.mGMask | df.mBMask) == 0x00ffffff) && 
+                                ((df.mAMask == 0xff000000) || (df.mAMask == 0));
+
+    SetUpGradient(gradient, context.mSetup);
+
+    for(int i = 0; i < kGradientRampSize; i++)
+    {
+        const uint32_t c     = gradient.mpRamp[i];
+        const uint32_t alpha = ModulateAlpha(c >> 24, opacity);
+
+        if(context.mbFastPath)
+            context.mRamp[i] = (((c >> 16) & 0xff) << df.mRShift) | (((c >> 8) & 0xff) << df.mGShift) | ((c & 0xff) << df.mBShift) | (alpha << 24);
+        else
+            context.mRamp[i] = (c & 0x00ffffff) | (alpha << 24);
+    }
+
+    if(pSurface->mpClipRegion)
+    {
+        ClipRegion::SpanClipper clipper = { pSurface->mpClipRegion, GradientSpan, &context };
+        return RasterizePath(pPoints, pContourSizes, contourCount, fillRule, bAntialias, rectClip, ClipRegion::ClipSpanFunction, &clipper, pScratch);
+    }
+
+    return RasterizePath(pPoints, pContourSizes, contourCount, fillRule, bAntialias, rectClip, GradientSpan, &context, pScratch);
+}
+
+
+} // namespace Raster
+
+} // namespace EA
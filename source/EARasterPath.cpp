@@ -0,0 +1,539 @@
+/*
+Copyright (C) 2010 Electronic Arts, Inc.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of Electronic Arts, Inc. ("EA") nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS AND ITS CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ELECTRONIC ARTS OR ITS CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+///////////////////////////////////////////////////////////////////////////////
+// EARasterPath.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+// Scanline rasterizer for filled paths. 
+// The edges of the contours are walked row by row with an active edge table. Each active 
+// edge adds the signed area it covers within the row to a row of accumulation cells, and a 
+// running sum over the cells then gives the coverage of each pixel under the fill rule. 
+// Only the cells that were touched get read and cleared again, so a row costs about as much 
+// as the edges that cross it. Everything lives in a RasterScratch, which makes it safe to 
+// rasterize on several threads at once.
+
+
+#include "EARaster.h"
+#include "EARasterColor.h"
+#include "Color.h"
+#include <EAWebKit/internal/EAWebKitAssert.h>
+#include <math.h>
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wtf/FastAllocBase.h>
+
+
+namespace EA {
+
+namespace Raster {
+
+
+// An edge going down from (mX0, mY0) to (mX1, mY1). 
+// mDir is 1 if the contour goes down along the edge and -1 if it goes up.
+struct RasterScratch::Edge
+{
+    float mX0, mY0;
+    float mX1, mY1;
+    float mDxDy;
+    float mDir;
+};
+
+
+RasterScratch::RasterScratch()
+  : mpEdges(NULL),
+    mpActiveEdges(NULL),
+    mEdgeCapacity(0),
+    mpCells(NULL),
+    mpCoverage(NULL),
+    mCellCapacity(0)
+{
+}
+
+
+RasterScratch::~RasterScratch()
+{
+    Reset();
+}
+
+
+void RasterScratch::Reset()
+{
+    WTF::fastDeleteArray<Edge>(mpEdges);
+    WTF::fastDeleteArray<Edge*>(mpActiveEdges);
+    WTF::fastDeleteArray<float>(mpCells);
+    WTF::fastDeleteArray<uint8_t>(mpCoverage);
+
+    mpEdges       = NULL;
+    mpActiveEdges = NULL;
+    mEdgeCapacity = 0;
+    mpCells       = NULL;
+    mpCoverage    = NULL;
+    mCellCapacity = 0;
+}
+
+
+static bool ReserveEdges(RasterScratch& scratch, int count)
+{
+    if(count > scratch.mEdgeCapacity)
+    {
+        WTF::fastDeleteArray<RasterScratch::Edge>(scratch.mpEdges);
+        WTF::fastDeleteArray<RasterScratch::Edge*>(scratch.mpActiveEdges);
+
+        scratch.mpEdges       = WTF::fastNewArray<RasterScratch::Edge>(count);
+        scratch.mpActiveEdges = WTF::fastNewArray<RasterScratch::Edge*>(count);
+        scratch.mEdgeCapacity = (scratch.mpEdges && scratch.mpActiveEdges) ? count : 0;
+    }
+
+    return (scratch.mEdgeCapacity >= count);
+}
+
+
+// The cells have to be all zero between uses; the rasterizer clears what it touches.
+static bool ReserveCells(RasterScratch& scratch, int count)
+{
+    if(count > scratch.mCellCapacity)
+    {
+        WTF::fastDeleteArray<float>(scratch.mpCells);
+        WTF::fastDeleteArray<uint8_t>(scratch.mpCoverage);
+
+        scratch.mpCells       = WTF::fastNewArray<float>(count);
+        scratch.mpCoverage    = WTF::fastNewArray<uint8_t>(count);
+        scratch.mCellCapacity = (scratch.mpCells && scratch.mpCoverage) ? count : 0;
+
+        if(scratch.mCellCapacity)
+            memset(scratch.mpCells, 0, count * sizeof(float));
+    }
+
+    return (scratch.mCellCapacity >= count);
+}
+
+
+// Adds the edge from (x0, y0) down to (x1, y1), clipped horizontally to [clipLeft, clipRight].
+// The parts right of the clip only matter to pixels right of it, so they are dropped. 
+// The parts left of it still count towards the winding of every pixel in the clip, so 
+// they are moved onto its left side.
+static void AddEdge(RasterScratch::Edge* pEdges, int& edgeCount, float x0, float y0, float x1, float y1, float dir, float clipLeft, float clipRight)
+{
+    if(!(y0 < y1)) // Also catches NaNs.
+        return;
+
+    if((x0 >= clipRight) && (x1 >= clipRight))
+        return;
+
+    if((x0 <= clipLeft) && (x1 <= clipLeft))
+        x0 = x1 = clipLeft;
+    else
+    {
+        float xSplit;
+
+        if(((x0 < clipLeft) && (x1 > clipLeft)) || ((x0 > clipLeft) && (x1 < clipLeft)))
+            xSplit = clipLeft;
+        else if(((x0 < clipRight) && (x1 > clipRight)) || ((x0 > clipRight) && (x1 < clipRight)))
+            xSplit = clipRight;
+        else
+            xSplit = FLT_MAX;
+
+        if(xSplit != FLT_MAX)
+        {
+            float ySplit = y0 + ((xSplit - x0) * (y1 - y0) / (x1 - x0));
+
+            if(ySplit < y0)
+                ySplit = y0;
+            else if(ySplit > y1)
+                ySplit = y1;
+
+            AddEdge(pEdges, edgeCount, x0, y0, xSplit, ySplit, dir, clipLeft, clipRight);
+            AddEdge(pEdges, edgeCount, xSplit, ySplit, x1, y1, dir, clipLeft, clipRight);
+            return;
+        }
+    }
+
+    RasterScratch::Edge& edge = pEdges[edgeCount++];
+
+    edge.mX0   = x0;
+    edge.mY0   = y0;
+    edge.mX1   = x1;
+    edge.mY1   = y1;
+    edge.mDxDy = (x1 - x0) / (y1 - y0);
+    edge.mDir  = dir;
+}
+
+
+static int CompareEdges(const void* a, const void* b)
+{
+    const float ya = static_cast<const RasterScratch::Edge*>(a)->mY0;
+    const float yb = static_cast<const RasterScratch::Edge*>(b)->mY0;
+
+    return (ya < yb) ? -1 : ((ya > yb) ? 1 : 0);
+}
+
+
+// Adds the part of an edge that is within one row, going from x0 at its top to x1 at its bottom.
+// d is the height of the part, signed with the edge's direction. The cells get the difference 
+// in covered area from the previous cell, so that the running sum of the cells is the coverage.
+// The x values are relative to the row's first cell and are within [0, width], so at most 
+// cell width + 1 gets written.
+static void AccumulateLine(float* pCells, float x0, float x1, float d, int& cellMin, int& cellMax)
+{
+    const float xLeft       = (x0 < x1) ? x0 : x1;
+    const float xRight      = (x0 < x1) ? x1 : x0;
+    const float xLeftFloor  = floorf(xLeft);
+    const float xRightCeil  = ceilf(xRight);
+    const int   iLeft       = (int)xLeftFloor;
+    const int   iRight      = (int)xRightCeil;
+
+    if(iRight <= (iLeft + 1))
+    {
+        // Within a single cell: the area right of the edge's midpoint spills into the next cell.
+        const float xMid = (0.5f * (x0 + x1)) - xLeftFloor;
+
+        pCells[iLeft]     += d - (d * xMid);
+        pCells[iLeft + 1] += d * xMid;
+
+        if(iLeft < cellMin)
+            cellMin = iLeft;
+        if((iLeft + 1) > cellMax)
+            cellMax = iLeft + 1;
+    }
+    else
+    {
+        // Across several cells: the edge ramps up the coverage by 1 / (xRight - xLeft) per cell, 
+        // with triangles in the first and last cell.
+        const float s       = 1.f / (xRight - xLeft);
+        const float xLeftF  = xLeft - xLeftFloor;
+        const float aLeft   = 0.5f * s * (1.f - xLeftF) * (1.f - xLeftF);
+        const float xRightF = xRight - xRightCeil + 1.f;
+        const float aRight  = 0.5f * s * xRightF * xRightF;
+
+        pCells[iLeft] += d * aLeft;
+
+        if(iRight == (iLeft + 2))
+            pCells[iLeft + 1] += d * (1.f - aLeft - aRight);
+        else
+        {
+            const float a1 = s * (1.5f - xLeftF);
+
+            pCells[iLeft + 1] += d * (a1 - aLeft);
+
+            for(int i = iLeft + 2; i < (iRight - 1); ++i)
+                pCells[i] += d * s;
+
+            const float a2 = a1 + ((iRight - iLeft - 3) * s);
+            pCells[iRight - 1] += d * (1.f - a2 - aRight);
+        }
+
+        pCells[iRight] += d * aRight;
+
+        if(iLeft < cellMin)
+            cellMin = iLeft;
+        if(iRight > cellMax)
+            cellMax = iRight;
+    }
+}
+
+
+static inline uint8_t CoverageToAlpha(float accumulation, FillRule fillRule)
+{
+    float a = fabsf(accumulation);
+
+    if(fillRule == kFillRuleEvenOdd)
+    {
+        a = fmodf(a, 2.f);
+        if(a > 1.f)
+            a = 2.f - a;
+    }
+    else if(a > 1.f)
+        a = 1.f;
+
+    return (uint8_t)((a * 255.f) + 0.5f);
+}
+
+
+static inline float ClampF(float x, float low, float high)
+{
+    return (x < low) ? low : ((x > high) ? high : x);
+}
+
+
+EARASTER_API int RasterizePath(const PointF* pPoints, const int* pContourSizes, int contourCount, FillRule fillRule, bool bAntialias, 
+                               const Rect& clipRect, SpanFunction pSpanFunction, void* pContext, RasterScratch* pScratch)
+{
+    EAW_ASSERT(pSpanFunction && (pPoints || !contourCount));
+
+    if((clipRect.w <= 0) || (clipRect.h <= 0))
+        return 0;
+
+    RasterScratch  scratchTemp;
+    RasterScratch& scratch = pScratch ? *pScratch : scratchTemp;
+
+    int pointCount = 0;
+
+    for(int c = 0; c < contourCount; ++c)
+        pointCount += pContourSizes[c];
+
+    if(pointCount < 2)
+        return 0;
+
+    // Clipping an edge to the left and right of the clip can split it in three.
+    if(!ReserveEdges(scratch, pointCount * 3) || !ReserveCells(scratch, clipRect.w + 2))
+        return -1;
+
+    const float clipLeft  = (float)clipRect.x;
+    const float clipRight = (float)(clipRect.x + clipRect.w);
+    const float clipTop   = (float)clipRect.y;
+    const float clipBottom = (float)(clipRect.y + clipRect.h);
+
+    // Build the edges, ignoring the horizontal ones and the ones entirely above or below the clip.
+    RasterScratch::Edge* const pEdges    = scratch.mpEdges;
+    int                        edgeCount = 0;
+    float                      maxY      = -FLT_MAX;
+
+    for(int c = 0; c < contourCount; pPoints += pContourSizes[c++])
+    {
+        const int n = pContourSizes[c];
+
+        for(int i = 0; i < n; ++i)
+        {
+            const PointF& p0 = pPoints[i];
+            const PointF& p1 = pPoints[((i + 1) < n) ? (i + 1) : 0];
+
+            if(((p0.y <= clipTop) && (p1.y <= clipTop)) || ((p0.y >= clipBottom) && (p1.y >= clipBottom)))
+                continue;
+
+            if(p0.y < p1.y)
+                AddEdge(pEdges, edgeCount, p0.x, p0.y, p1.x, p1.y, 1.f, clipLeft, clipRight);
+            else
+                AddEdge(pEdges, edgeCount, p1.x, p1.y, p0.x, p0.y, -1.f, clipLeft, clipRight);
+        }
+    }
+
+    if(!edgeCount)
+        return 0;
+
+    qsort(pEdges, edgeCount, sizeof(RasterScratch::Edge), CompareEdges);
+
+    for(int i = 0; i < edgeCount; ++i)
+    {
+        if(pEdges[i].mY1 > maxY)
+            maxY = pEdges[i].mY1;
+    }
+
+    RasterScratch::Edge** const pActiveEdges = scratch.mpActiveEdges;
+    float*   const pCells      = scratch.mpCells;
+    uint8_t* const pCoverage   = scratch.mpCoverage;
+    const int      width       = clipRect.w;
+    const int      yEnd        = (int)ceilf(ClampF(maxY, clipTop, clipBottom));
+    int            activeCount = 0;
+    int            nextEdge    = 0;
+
+    for(int y = (int)floorf(ClampF(pEdges[0].mY0, clipTop, clipBottom)); y < yEnd; ++y)
+    {
+        const float rowTop    = (float)y;
+        const float rowBottom = rowTop + 1.f;
+
+        // Drop the edges that ended above this row and add the ones that start in it.
+        int activeKept = 0;
+
+        for(int i = 0; i < activeCount; ++i)
+        {
+            if(pActiveEdges[i]->mY1 > rowTop)
+                pActiveEdges[activeKept++] = pActiveEdges[i];
+        }
+
+        activeCount = activeKept;
+
+        for(; (nextEdge < edgeCount) && (pEdges[nextEdge].mY0 < rowBottom); ++nextEdge)
+        {
+            if(pEdges[nextEdge].mY1 > rowTop)
+                pActiveEdges[activeCount++] = &pEdges[nextEdge];
+        }
+
+        if(!activeCount)
+        {
+            if(nextEdge == edgeCount)
+                break;
+
+            // Skip the empty rows up to the next edge.
+            const int yNext = (int)floorf(pEdges[nextEdge].mY0);
+            if(yNext > (y + 1))
+                y = yNext - 1;
+            continue;
+        }
+
+        int cellMin = width + 1;
+        int cellMax = -1;
+
+        for(int i = 0; i < activeCount; ++i)
+        {
+            const RasterScratch::Edge& edge = *pActiveEdges[i];
+
+            if(bAntialias)
+            {
+                const float y0 = (edge.mY0 > rowTop)    ? edge.mY0 : rowTop;
+                const float y1 = (edge.mY1 < rowBottom) ? edge.mY1 : rowBottom;
+
+                if(y0 < y1)
+                {
+                    const float x0 = ClampF(edge.mX0 + ((y0 - edge.mY0) * edge.mDxDy) - clipLeft, 0.f, (float)width);
+                    const float x1 = ClampF(edge.mX0 + ((y1 - edge.mY0) * edge.mDxDy) - clipLeft, 0.f, (float)width);
+
+                    AccumulateLine(pCells, x0, x1, (y1 - y0) * edge.mDir, cellMin, cellMax);
+                }
+            }
+            else
+            {
+                // Without anti-aliasing a pixel is in if its center is. The winding changes 
+                // at the first pixel center right of where the edge crosses the row's center.
+                const float yCenter = rowTop + 0.5f;
+
+                if((yCenter >= edge.mY0) && (yCenter < edge.mY1))
+                {
+                    const float x = edge.mX0 + ((yCenter - edge.mY0) * edge.mDxDy) - clipLeft - 0.5f;
+                    const int   i = (int)ceilf(ClampF(x, 0.f, (float)width));
+
+                    pCells[i] += edge.mDir;
+
+                    if(i < cellMin)
+                        cellMin = i;
+                    if(i > cellMax)
+                        cellMax = i;
+                }
+            }
+        }
+
+        if(cellMin > cellMax)
+            continue;
+
+        // Sum up the touched cells into coverage, clearing them for the next row.
+        // Past the last touched cell the coverage stays the same up to the right of the clip.
+        const int cellLast     = (cellMax < width) ? cellMax : (width - 1);
+        float     accumulation = 0.f;
+
+        for(int i = cellMin; i <= cellLast; ++i)
+        {
+            accumulation += pCells[i];
+            pCoverage[i]  = CoverageToAlpha(accumulation, fillRule);
+        }
+
+        memset(pCells + cellMin, 0, ((cellMax - cellMin) + 1) * sizeof(float));
+
+        const bool    bTail     = (cellLast < (width - 1)) && (pCoverage[cellLast] != 0);
+        const uint8_t tailAlpha = bTail ? pCoverage[cellLast] : 0;
+
+        for(int i = cellMin; i <= cellLast; )
+        {
+            const uint8_t alpha = pCoverage[i];
+            int           j     = i + 1;
+
+            if((alpha == 0) || (alpha == 255))
+            {
+                while((j <= cellLast) && (pCoverage[j] == alpha))
+                    ++j;
+            }
+            else
+            {
+                while((j <= cellLast) && (pCoverage[j] != 0) && (pCoverage[j] != 255))
+                    ++j;
+            }
+
+            int runEnd = j;
+
+            if(bTail && (j > cellLast))
+            {
+                runEnd = width;
+
+                if(alpha != 255)
+                    memset(pCoverage + j, tailAlpha, runEnd - j);
+            }
+
+            if(alpha == 255)
+                pSpanFunction(pContext, clipRect.x + i, y, runEnd - i, NULL);
+            else if(alpha)
+                pSpanFunction(pContext, clipRect.x + i, y, runEnd - i, pCoverage + i);
+
+            i = j;
+        }
+    }
+
+    return 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////
+// Solid color fill
+///////////////////////////////////////////////////////////////////////
+
+struct ColorSpanContext
+{
+    Surface*     mpSurface;
+    const Color* mpColor;
+};
+
+
+static void ColorSpan(void* pContext, int x, int y, int length, const uint8_t* pCoverage)
+{
+    const ColorSpanContext& context = *static_cast<const ColorSpanContext*>(pContext);
+
+    // Both of these honor the surface's clip region.
+    if(pCoverage)
+        BlitMaskA8(pCoverage, length, 1, length, context.mpSurface, x, y, *context.mpColor);
+    else
+    {
+        const Rect rect(x, y, length, 1);
+        FillRectColor(context.mpSurface, &rect, *context.mpColor);
+    }
+}
+
+
+EARASTER_API int FillPathColor(Surface* pSurface, const PointF* pPoints, const int* pContourSizes, int contourCount, const Color& color, 
+                               FillRule fillRule, bool bAntialias, RasterScratch* pScratch)
+{
+    EAW_ASSERT(pSurface);
+
+    if(!color.alpha())
+        return 0;
+
+    // The clip rect is normally already within the surface, but the default one isn't.
+    const Rect rectSurface(0, 0, pSurface->mWidth, pSurface->mHeight);
+    Rect       rectClip;
+
+    if(!IntersectRect(rectSurface, pSurface->mClipRect, rectClip))
+        return 0;
+
+    ColorSpanContext context = { pSurface, &color };
+
+    return RasterizePath(pPoints, pContourSizes, contourCount, fillRule, bAntialias, rectClip, ColorSpan, &context, pScratch);
+}
+
+
+} // namespace Raster
+
+} // namespace EA
@@ -113,6 +113,29 @@ static void memset4(void* pDest, uint32_t value, size_t count)
 }
 
 
+// Sets count uint16s at pDest to value.
+static void memset2(void* pDest, uint16_t value, size_t count)
+{
+    uint16_t* p = (uint16_t*)pDest;
+
+    // Align to 32 bits, then write pairs.
+    if(count && ((uintptr_t)p & 2))
+    {
+        *p++ = value;
+        --count;
+    }
+
+    if(count >= 2)
+    {
+        memset4(p, ((uint32_t)value << 16) | value, count / 2);
+        p += count & ~(size_t)1;
+    }
+
+    if(count & 1)
+        *p = value;
+}
+
+
 // VC++ does not have lrint, so provide a local inline version
 // We may be able to get away with a simpler implementation of 
 // lrint for our uses here.
@@ -173,6 +196,24 @@ static void memset4(void* pDest, uint32_t value, size_t count)
 #endif
 
 
+// Divides a premultiplied channel by its alpha, which must not be 0.
+static inline int UnpremultiplyChannel(int c, int a)
+{
+    c = ((c * 255) + (a / 2)) / a;
+
+    return (c < 255) ? c : 255;
+}
+
+
+// Multiplies a channel by alpha / 255, rounded to nearest.
+static inline int PremultiplyChannel(int c, int a)
+{
+    const int t = (c * a) + 128;
+
+    return (t + (t >> 8)) >> 8;
+}
+
+
 EARASTER_API void ConvertColor(NativeColor c, PixelFormatType cFormat, Color& result)
 {
     const PixelBytes pb = { c };
@@ -209,10 +250,44 @@ EARASTER_API void ConvertColor(NativeColor c, PixelFormatType cFormat, Color& re
         case kPixelFormatTypeRGB:
             result = Color(pb.color8[0], pb.color8[1], pb.color8[2]);
             break;
+
+        case kPixelFormatTypeRGB565:
+        {
+            const uint32_t r = (c >> 11) & 0x1f;
+            const uint32_t g = (c >>  5) & 0x3f;
+            const uint32_t b =  c        & 0x1f;
+
+            result = Color((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2));
+            break;
+        }
+
+        case kPixelFormatTypeARGB4444:
+            result = Color(((c >> 8) & 0xf) * 17, ((c >> 4) & 0xf) * 17, (c & 0xf) * 17, ((c >> 12) & 0xf) * 17);
+            break;
+
+        case kPixelFormatTypePARGB:
+        {
+            const int a = (int)(c >> 24);
+
+            if(a && (a < 255))
+                result = Color(UnpremultiplyChannel((int)((c >> 16) & 0xff), a), UnpremultiplyChannel((int)((c >> 8) & 0xff), a), UnpremultiplyChannel((int)(c & 0xff), a), a);
+            else
+                result = Color(a ? pb.color32 : 0);
+            break;
+        }
     }
 }
 
 
+// Scales a 16 bit format's packed field up to 0-255.
+static inline int ExpandField16(int value, uint32_t mask, uint8_t shift)
+{
+    const int max = (int)(mask >> shift);
+
+    return ((value * 255) + (max / 2)) / max;
+}
+
+
 EARASTER_API void ConvertColor(uint32_t pixel, const PixelFormat& pf, int& r, int& g, int& b, int& a)
 {
     // unsigned v;
@@ -237,6 +312,22 @@ EARASTER_API void ConvertColor(uint32_t pixel, const PixelFormat& pf, int& r, in
     } 
     else
         a = 255;
+
+    if(pf.mBytesPerPixel == 2)
+    {
+        r = ExpandField16(r, pf.mRMask, pf.mRShift);
+        g = ExpandField16(g, pf.mGMask, pf.mGShift);
+        b = ExpandField16(b, pf.mBMask, pf.mBShift);
+
+        if(pf.mAMask)
+            a = ExpandField16(a, pf.mAMask, pf.mAShift);
+    }
+    else if((pf.mPixelFormatType == kPixelFormatTypePARGB) && a && (a < 255))
+    {
+        r = UnpremultiplyChannel(r, a);
+        g = UnpremultiplyChannel(g, a);
+        b = UnpremultiplyChannel(b, a);
+    }
 }
 
 
@@ -255,6 +346,24 @@ EARASTER_API void ConvertColor(uint32_t pixel, const PixelFormat& pf, int& r, in
     b = (pixel & pf.mBMask) >> pf.mBShift;
     //v = (pixel & pf.mBMask) >> pf.mBShift;
     //b = v + (v >> 8);
+
+    if(pf.mBytesPerPixel == 2)
+    {
+        r = ExpandField16(r, pf.mRMask, pf.mRShift);
+        g = ExpandField16(g, pf.mGMask, pf.mGShift);
+        b = ExpandField16(b, pf.mBMask, pf.mBShift);
+    }
+    else if(pf.mPixelFormatType == kPixelFormatTypePARGB)
+    {
+        const int a = (int)((pixel & pf.mAMask) >> pf.mAShift);
+
+        if(a && (a < 255))
+        {
+            r = UnpremultiplyChannel(r, a);
+            g = UnpremultiplyChannel(g, a);
+            b = UnpremultiplyChannel(b, a);
+        }
+    }
 }
 
 
@@ -293,6 +402,33 @@ EARASTER_API NativeColor ConvertColor(const Color& c, PixelFormatType resultForm
            
             return pb.color32;
         }
+
+        // These round to the nearest 16 bit value. BlendRow16 can dither instead.
+        case kPixelFormatTypeRGB565:
+        {
+            const uint32_t r = (uint32_t)c.red();
+            const uint32_t g = (uint32_t)c.green();
+            const uint32_t b = (uint32_t)c.blue();
+
+            return (((r + 4 - (r >> 5)) >> 3) << 11) | (((g + 2 - (g >> 6)) >> 2) << 5) | ((b + 4 - (b >> 5)) >> 3);
+        }
+
+        case kPixelFormatTypeARGB4444:
+        {
+            const uint32_t a = (uint32_t)c.alpha();
+            const uint32_t r = (uint32_t)c.red();
+            const uint32_t g = (uint32_t)c.green();
+            const uint32_t b = (uint32_t)c.blue();
+
+            return (((a + 8 - (a >> 4)) >> 4) << 12) | (((r + 8 - (r >> 4)) >> 4) << 8) | (((g + 8 - (g >> 4)) >> 4) << 4) | ((b + 8 - (b >> 4)) >> 4);
+        }
+
+        case kPixelFormatTypePARGB:
+        {
+            const int a = c.alpha();
+
+            return ((NativeColor)a << 24) | ((NativeColor)PremultiplyChannel(c.red(), a) << 16) | ((NativeColor)PremultiplyChannel(c.green(), a) << 8) | (NativeColor)PremultiplyChannel(c.blue(), a);
+        }
     }
 }
 
@@ -312,7 +448,11 @@ EARASTER_API void GetPixel(Surface* pSurface, int x, int y, Color& color)
     const void* const pPixel = (char*)pSurface->mpData + (pSurface->mStride * y) + (pSurface->mPixelFormat.mBytesPerPixel * x);
 
     uint32_t c;
-    memcpy(&c, pPixel, pSurface->mPixelFormat.mBytesPerPixel);
+
+    if(pSurface->mPixelFormat.mBytesPerPixel == 2)
+        c = *(const uint16_t*)pPixel;
+    else
+        memcpy(&c, pPixel, pSurface->mPixelFormat.mBytesPerPixel);
 
     ConvertColor(c, pSurface->mPixelFormat.mPixelFormatType, color);
 }
@@ -343,6 +483,14 @@ EARASTER_API int SetPixelSolidColor(Surface* pSurface, int x, int y, const Color
                 break;
             }
 
+            case kPixelFormatTypeRGB565:
+            case kPixelFormatTypeARGB4444:
+            {
+                uint16_t* pPixel = (uint16_t*)((uint8_t*)pSurface->mpData + (pSurface->mStride * y) + (2 * x));
+                *pPixel = (uint16_t)ConvertColor(color, pSurface->mPixelFormat.mPixelFormatType);
+                break;
+            }
+
             default:
             {
                 // We assume the pPixel is 32 bit aligned.
@@ -401,6 +549,14 @@ EARASTER_API int SetPixelSolidColorNoClip(Surface* pSurface, int x, int y, const
             break;
         }
 
+        case kPixelFormatTypeRGB565:
+        case kPixelFormatTypeARGB4444:
+        {
+            uint16_t* pPixel = (uint16_t*)((uint8_t*)pSurface->mpData + (pSurface->mStride * y) + (2 * x));
+            *pPixel = (uint16_t)ConvertColor(color, pSurface->mPixelFormat.mPixelFormatType);
+            break;
+        }
+
         default:
         {
             // We assume the pPixel is 32 bit aligned.
@@ -480,6 +636,12 @@ EARASTER_API int SetPixelColorNoClip(Surface* pSurface, int x, int y, const Colo
 
             if(sA == 255)   // If the source is opaque...
                 *pPixel = color.rgb();
+            else if(pSurface->mSurfaceFlags & kFlagAccumulateAlpha)
+            {
+                const uint32_t c = color.rgb();
+
+                BlendRowAccumulateAlpha(pSurface, x, y, 1, &c, 0, NULL, 255);
+            }
             else
             {
                 // This code is taken from UTFDraw2D::Multiply(color_t x, color_t y).
@@ -505,6 +667,15 @@ EARASTER_API int SetPixelColorNoClip(Surface* pSurface, int x, int y, const Colo
             break;
         }
 
+        case kPixelFormatTypeRGB565:
+        case kPixelFormatTypeARGB4444:
+        {
+            const uint32_t c = color.rgb();
+
+            BlendRow16(pSurface, x, y, 1, &c, 0, NULL, 255, false);
+            break;
+        }
+
         default:
         {
             // To do: Complete this. Possibly use generic but slower operations.
@@ -540,6 +711,39 @@ EARASTER_API int SetPixelRGBANoClip(Surface* pSurface, int x, int y, int r, int
 // Rectanble functions
 ///////////////////////////////////////////////////////////////////////
 
+static void FillRectSolidColorNoClip(Surface* pSurface, const Rect* pRect, const Color& color);
+static void FillRectColorNoClip(Surface* pSurface, const Rect* pRect, const Color& color);
+
+
+struct ClipFillContext
+{
+    Surface*     mpSurface;
+    const Color* mpColor;
+    bool         mbSolid;
+};
+
+
+// Fills a piece of the rect that is inside the clip region. Partly covered pieces are blended.
+static void ClipFillRect(void* pContext, const Rect& rect, int coverage)
+{
+    const ClipFillContext& context = *static_cast<const ClipFillContext*>(pContext);
+    const Color&           color   = *context.mpColor;
+
+    if(coverage == 255)
+    {
+        if(context.mbSolid)
+            FillRectSolidColorNoClip(context.mpSurface, &rect, color);
+        else
+            FillRectColorNoClip(context.mpSurface, &rect, color);
+    }
+    else
+    {
+        const Color coverageColor(color.red(), color.green(), color.blue(), ((color.alpha() * coverage) + 255) >> 8);
+        FillRectColorNoClip(context.mpSurface, &rect, coverageColor);
+    }
+}
+
+
 // Applies no blending. Writes the color to the destination. Writes the color
 // alpha to the destination if the destination has an alpha channel.
 EARASTER_API int FillRectSolidColor(Surface* pSurface, const Rect* pRect, const Color& color)
@@ -556,6 +760,20 @@ EARASTER_API int FillRectSolidColor(Surface* pSurface, const Rect* pRect, const
     else
         pRect = &pSurface->mClipRect;
 
+    if(pSurface->mpClipRegion)
+    {
+        ClipFillContext context = { pSurface, &color, true };
+        pSurface->mpClipRegion->ForEachRect(*pRect, ClipFillRect, &context);
+    }
+    else
+        FillRectSolidColorNoClip(pSurface, pRect, color);
+
+    return 0;
+}
+
+
+static void FillRectSolidColorNoClip(Surface* pSurface, const Rect* pRect, const Color& color)
+{
     uint8_t* pRow = (uint8_t*)pSurface->mpData + (pRect->y * pSurface->mStride) + (pSurface->mPixelFormat.mBytesPerPixel * pRect->x);
 
     switch (pSurface->mPixelFormat.mBytesPerPixel)
@@ -593,9 +811,19 @@ EARASTER_API int FillRectSolidColor(Surface* pSurface, const Rect* pRect, const
             }
             break;
         }
-    }
 
-    return 0;
+        case 2:
+        {
+            const uint16_t c16 = (uint16_t)ConvertColor(color, pSurface->mPixelFormat.mPixelFormatType);
+
+            for(int y = pRect->h, w = pRect->w; y; --y)
+            {
+                memset2(pRow, c16, w);
+                pRow += pSurface->mStride;
+            }
+            break;
+        }
+    }
 }
 
 
@@ -613,6 +841,20 @@ EARASTER_API int FillRectColor(Surface* pSurface, const Rect* pRect, const Color
     else
         pRect = &pSurface->mClipRect;
 
+    if(pSurface->mpClipRegion)
+    {
+        ClipFillContext context = { pSurface, &color, false };
+        pSurface->mpClipRegion->ForEachRect(*pRect, ClipFillRect, &context);
+    }
+    else
+        FillRectColorNoClip(pSurface, pRect, color);
+
+    return 0;
+}
+
+
+static void FillRectColorNoClip(Surface* pSurface, const Rect* pRect, const Color& color)
+{
     const int sA = color.alpha();
     uint8_t* pRow = (uint8_t*)pSurface->mpData + (pRect->y * pSurface->mStride) + (pSurface->mPixelFormat.mBytesPerPixel * pRect->x);
 
@@ -668,6 +910,11 @@ EARASTER_API int FillRectColor(Surface* pSurface, const Rect* pRect, const Color
                     pRow += pSurface->mStride;
                 }
             }
+            else if((pSurface->mSurfaceFlags & kFlagAccumulateAlpha) && (pSurface->mPixelFormat.mPixelFormatType == kPixelFormatTypeARGB))
+            {
+                for(int y = pRect->y, yEnd = pRect->y + pRect->h; y < yEnd; ++y)
+                    BlendRowAccumulateAlpha(pSurface, pRect->x, y, pRect->w, &s, 0, NULL, 255);
+            }
             else
             {
 
@@ -749,8 +996,47 @@ EARASTER_API int FillRectColor(Surface* pSurface, const Rect* pRect, const Color
             }    
             break;
         }
+
+        case 2:
+        {
+            if(sA == 255)
+            {
+                FillRectSolidColorNoClip(pSurface, pRect, color);
+                break;
+            }
+
+            if(pSurface->mPixelFormat.mPixelFormatType == kPixelFormatTypeRGB565)
+            {
+                // The channels are spread out to 0x07e0f81f, which leaves room to blend all three with one multiply.
+                const uint32_t c16 = ConvertColor(color, kPixelFormatTypeRGB565);
+                const uint32_t s   = (c16 | (c16 << 16)) & 0x07e0f81f;
+                const uint32_t a5  = (uint32_t)(sA + 4) >> 3;
+
+                for(int y = pRect->h, w = pRect->w; y; --y)
+                {
+                    uint16_t* pPixel = (uint16_t*)pRow;
+
+                    for(int x = w; x; --x, pPixel++)
+                    {
+                        const uint32_t d = (*pPixel | ((uint32_t)*pPixel << 16)) & 0x07e0f81f;
+                        const uint32_t r = ((((s - d) * a5) >> 5) + d) & 0x07e0f81f;
+
+                        *pPixel = (uint16_t)(r | (r >> 16));
+                    }
+
+                    pRow += pSurface->mStride;
+                }
+            }
+            else
+            {
+                const uint32_t s = color.rgb();
+
+                for(int y = pRect->y, yEnd = pRect->y + pRect->h; y < yEnd; ++y)
+                    BlendRow16(pSurface, pRect->x, y, pRect->w, &s, 0, NULL, 255, false);
+            }
+            break;
+        }
     }
-    return 0;
 }
 
 
@@ -1051,6 +1337,25 @@ EARASTER_API int LineColor(Surface* pSurface, int x1, int y1, int x2, int y2, co
                 break;
             }
 
+            case kPixelFormatTypeRGB565:
+            case kPixelFormatTypeARGB4444:
+            {
+                const uint16_t c16 = (uint16_t)ConvertColor(color, pSurface->mPixelFormat.mPixelFormatType);
+
+                for(; x < dx; x++, pPixel += pixx)
+                {
+                    *(uint16_t*)pPixel = c16;
+                    y += dy;
+
+                    if(y >= dx)
+                    {
+                        y      -= dx;
+                        pPixel += pixy;
+                    }
+                }
+                break;
+            }
+
             default:
             {
                 EAW_FAIL_MSG("EA::Raster::LineSolidColor: Unimplemented pathway.");
@@ -1190,6 +1495,16 @@ EARASTER_API int HLineSolidColor(Surface* pSurface, int x1, int x2, int y, const
 
             break;
         }
+
+        case 2:
+        {
+            const uint16_t c16 = (uint16_t)ConvertColor(color, pSurface->mPixelFormat.mPixelFormatType);
+
+            for(uint8_t* pPixelLast = pPixel + (2 * w); pPixel <= pPixelLast; pPixel += 2)
+                *(uint16_t*)pPixel = c16;
+
+            break;
+        }
     }
 
     return 0;
@@ -1296,6 +1611,16 @@ EARASTER_API int VLineSolidColor(Surface* pSurface, int x, int y1, int y2, const
 
             break;
         }
+
+        case 2:
+        {
+            const uint16_t c16 = (uint16_t)ConvertColor(color, pSurface->mPixelFormat.mPixelFormatType);
+
+            for(; pPixel <= pPixelLast; pPixel += pSurface->mStride)
+                *(uint16_t*)pPixel = c16;
+
+            break;
+        }
     }
 
     return 0;
@@ -3402,60 +3727,13 @@ EARASTER_API int AAPolygonRGBA(Surface* pSurface, const int* vx, const int* vy,
 }
 
 
-//+ 5/11/09 CSidhall - Added shell sort for FilledPolygonColorMT(). 
-// The shell sort was invented by Donald Shell and first published in 1959.
-// Might move this to EAWebkit internal but it only is used here currently and  
-// this version is specialized to just the int type.
-static void ShellSort(int* pBuffer, const int nCount)
-{
-    // Use a partial increment table here as we don't expect large nCounts.
-    // Marcin Ciura, Best Increments for the Average Case of Shellsort, 13th International Symposium on Fundamentals of Computation 
-    const int INC_TABLE_SIZE = 8;  
-    const int incTable[INC_TABLE_SIZE] ={701, 301, 132, 57 ,23, 10, 4, 1}; 
-  
-    for(int k = 0; k < INC_TABLE_SIZE; k++)
-    {
-        int inc = incTable[k];           
-        if(inc > nCount)
-           continue;
-
-        for(int i=0; i < nCount; i++)
-        {
-            int j = i;
-            int value = pBuffer[i];
-            bool swap = false;
-            while((j >= inc) && (pBuffer[j-inc] > value))
-            {
-                pBuffer[j] = pBuffer[j - inc];
-                j = j - inc;
-                swap = true;
-            }
-            if(swap)
-                pBuffer[j] = value;
-        }
-    }
-}
-//- CS
-
-// Global vertex array to use if optional parameters are not given in polygon calls.
-// To do: Get rid of this global vertex array stuff along with the int** polyInts, int* polyAllocated arguments.
-//        The purpose of these variables is to deal with the case of the user not calling thus function simultaneously
-//        from multiple threads. We won't be using multiple threads at all.
-static int* gfxPrimitivesPolyIntsGlobal      = NULL;
-static int  gfxPrimitivesPolyAllocatedGlobal = 0;
-
 // Returns 0 if OK.
-// This polygon is not necessarily convex.
-// The last two parameters are optional; but required for multithreaded operation.
-EARASTER_API int FilledPolygonColorMT(Surface* pSurface, const int* vx, const int* vy, int n, const Color& color, int** polyInts, int* polyAllocated)
+// This polygon is not necessarily convex. The vertices are pixel centers, and the pixels whose 
+// centers are inside the polygon (even-odd) get filled. 
+// The fill is done by RasterizePath, which has no global state, so the polyInts and polyAllocated 
+// arguments aren't needed anymore and are ignored.
+EARASTER_API int FilledPolygonColorMT(Surface* pSurface, const int* vx, const int* vy, int n, const Color& color, int** /*polyInts*/, int* /*polyAllocated*/)
 {
-    int  i;
-    int  y, xa, xb;
-    int  x1, y1;
-    int  x2, y2;
-    int* gfxPrimitivesPolyInts = NULL;
-    int  gfxPrimitivesPolyAllocated = 0;
-
     // Check visibility of clipping rectangle
     if((pSurface->mClipRect.width() == 0) || (pSurface->mClipRect.height() == 0))
            return 0;
@@ -3463,130 +3741,22 @@ EARASTER_API int FilledPolygonColorMT(Surface* pSurface, const int* vx, const in
     // Sanity check number of edges
     if(n < 3)
         return -1;
-     
-    // Map polygon cache  
-    if((polyInts == NULL) || (polyAllocated == NULL))
-    {
-       // Use global cache
-       gfxPrimitivesPolyInts      = gfxPrimitivesPolyIntsGlobal;
-       gfxPrimitivesPolyAllocated = gfxPrimitivesPolyAllocatedGlobal;
-    }
-    else
-    {
-       // Use local cache
-       gfxPrimitivesPolyInts      = *polyInts;
-       gfxPrimitivesPolyAllocated = *polyAllocated;
-    }
 
-    // Allocate temp array, only grow array.
-    // To do: Fix the memory usage here to be non-abusive and to not use malloc and to use 
-    //        local memory when possible and not to leak memory.
-    //        Probably implement a generic allocator interface for this module.
-    if(gfxPrimitivesPolyAllocated == 0)
-        gfxPrimitivesPolyInts = (int*)malloc(sizeof(int) * n);
-    else if(gfxPrimitivesPolyAllocated < n)
-        gfxPrimitivesPolyInts = (int*)realloc(gfxPrimitivesPolyInts, sizeof(int) * n);
+    // Most polygons are small enough for the stack.
+    const int kLocalPointCount = 32;
+    PointF    localPoints[kLocalPointCount];
+    PointF*   pPoints = (n <= kLocalPointCount) ? localPoints : WTF::fastNewArray<PointF>(n);
 
-    // Check temp array
-    if(gfxPrimitivesPolyInts)       
-        gfxPrimitivesPolyAllocated = n;
-
-    // Update cache variables
-    if((polyInts == NULL) || (polyAllocated == NULL))
-    { 
-        gfxPrimitivesPolyIntsGlobal      = gfxPrimitivesPolyInts;
-        gfxPrimitivesPolyAllocatedGlobal = gfxPrimitivesPolyAllocated;
-    }
-    else
+    for(int i = 0; i < n; i++)
     {
-        *polyInts      = gfxPrimitivesPolyInts;
-        *polyAllocated = gfxPrimitivesPolyAllocated;
+        pPoints[i].x = vx[i] + 0.5f;
+        pPoints[i].y = vy[i] + 0.5f;
     }
 
-    // Check temp array again
-    if(gfxPrimitivesPolyInts == NULL)       
-        return -1;
+    const int result = FillPathColor(pSurface, pPoints, &n, 1, color, kFillRuleEvenOdd, false);
 
-    // Determine Y maxima 
-    int miny = vy[0];
-    int maxy = vy[0];
-
-    for(i = 1; (i < n); i++)
-    {
-        if(vy[i] < miny)
-            miny = vy[i];
-        else if(vy[i] > maxy)
-            maxy = vy[i];
-    }
-
-    // Draw, scanning y 
-    int result = 0;
-
-    for(y = miny; y <= maxy; y++) // For each horizontal scan line from min y to max y...
-    {
-        int intCount = 0;
-        int ind1, ind2;
-
-        for(i = 0; i < n; i++)
-        {
-            if(i)
-            {
-                ind1 = i - 1;
-                ind2 = i;
-            }
-            else
-            {
-                ind1 = n - 1;
-                ind2 = 0;
-            }
-
-            y1 = vy[ind1];
-            y2 = vy[ind2];
-
-            if(y1 < y2)
-            {
-                x1 = vx[ind1];
-                x2 = vx[ind2];
-            }
-            else if(y1 > y2)
-            {
-                y2 = vy[ind1];
-                y1 = vy[ind2];
-                x2 = vx[ind1];
-                x1 = vx[ind2];
-            }
-            else
-                continue;
-
-            // Add all points that are at the current y position. Store the points in 16:16 fixed point.
-            if( ((y >= y1) && (y < y2)) || ((y == maxy) && (y > y1) && (y <= y2)) )
-                gfxPrimitivesPolyInts[intCount++] = ((65536 * (y - y1)) / (y2 - y1)) * (x2 - x1) + (65536 * x1);
-        }
-
-//+5/10/09 Sidhall - Removed dependency on eastl sort    
-// Original code:
-//        if(intCount <= 6)
-//            eastl::bubble_sort(gfxPrimitivesPolyInts, gfxPrimitivesPolyInts + intCount);
-//        else
-//            eastl::quick_sort(gfxPrimitivesPolyInts, gfxPrimitivesPolyInts + intCount);
-// New code: 
-// Note: As this sort is per scan line, intCount should be small so a simple ShellSort should be suffient. 
-//       Could also add a merge sort here if it turns out that intCount can be large but currently it seems 
-//       to be just in the = 2 range on many main sites
-
-        ShellSort(gfxPrimitivesPolyInts, intCount);
-//- CS
-
-        for(i = 0; i < intCount; i += 2)
-        {
-            xa = gfxPrimitivesPolyInts[i + 0] + 1;
-            xb = gfxPrimitivesPolyInts[i + 1] - 1;
-            xa = (xa >> 16) + ((xa & 32768) >> 15); // Convert 16:16 fixed point to 16 bit int.
-            xb = (xb >> 16) + ((xb & 32768) >> 15);
-
-            result |= HLineColor(pSurface, xa, xb, y, color);
-        }
-    }
+    if(pPoints != localPoints)
+        WTF::fastDeleteArray<PointF>(pPoints);
 
     return result;
 }
@@ -4061,8 +4231,10 @@ EARASTER_API Surface* CreateTransparentSurface(Surface* pSource, int surfaceAlph
 
     if(pResult)
     {
-        // This code currently assumes that the format is ARGB and that stride == width.
-        EAW_ASSERT((pResult->mStride == (pResult->mWidth * 4)) && (pResult->mPixelFormat.mPixelFormatType == kPixelFormatTypeARGB));
+        // This code currently assumes that the format is ARGB or PARGB and that stride == width.
+        const bool bPremultiplied = (pResult->mPixelFormat.mPixelFormatType == kPixelFormatTypePARGB);
+
+        EAW_ASSERT((pResult->mStride == (pResult->mWidth * 4)) && ((pResult->mPixelFormat.mPixelFormatType == kPixelFormatTypeARGB) || bPremultiplied));
 
         uint32_t* pPixels = (uint32_t*)pResult->mpData;
 
@@ -4070,9 +4242,20 @@ EARASTER_API Surface* CreateTransparentSurface(Surface* pSource, int surfaceAlph
         {
             for (int x = 0; x < xEnd; ++x, ++pPixels)
             {
-                const uint32_t alpha = ((*pPixels >> 24) * surfaceAlpha) >> 8;
+                if(bPremultiplied) // The color has to go down with the alpha.
+                {
+                    const uint32_t p  = *pPixels;
+                    const uint32_t rb = (((p & 0x00ff00ff) * surfaceAlpha) >> 8) & 0x00ff00ff;
+                    const uint32_t ag = ((((p >> 8) & 0x00ff00ff) * surfaceAlpha) >> 8) & 0x00ff00ff;
 
-                *pPixels = (*pPixels & 0x00ffffff) | (alpha << 24);
+                    *pPixels = rb | (ag << 8);
+                }
+                else
+                {
+                    const uint32_t alpha = ((*pPixels >> 24) * surfaceAlpha) >> 8;
+
+                    *pPixels = (*pPixels & 0x00ffffff) | (alpha << 24);
+                }
             }
         }
     }
@@ -0,0 +1,242 @@
+/*
+Copyright (C) 2010 Electronic Arts, Inc.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+1.  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+2.  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+3.  Neither the name of Electronic Arts, Inc. ("EA") nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY ELECTRONIC ARTS AND ITS CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ELECTRONIC ARTS OR ITS CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+///////////////////////////////////////////////////////////////////////////////
+// EARasterSurfacePool.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+// Scratch surfaces. 
+// A surface that goes back to the pool keeps both its Surface object and its pixel buffer, 
+// so a draw that needs a temporary of about the same size as the last one doesn't allocate.
+
+
+#include "EARaster.h"
+#include <EAWebKit/internal/EAWebKitAssert.h>
+#include <wtf/Vector.h>
+
+
+namespace EA {
+
+namespace Raster {
+
+
+static const uint32_t kDefaultSurfacePoolCapacity = 4 * 1024 * 1024;
+static const int      kMinSizeClass               = 16;
+
+
+// The least recently released surface is first.
+static WTF::Vector<Surface*>& PooledSurfaces()
+{
+    static WTF::Vector<Surface*>* pPool = new WTF::Vector<Surface*>;
+    return *pPool;
+}
+
+static uint32_t         gSurfacePoolCapacity = kDefaultSurfacePoolCapacity;
+static SurfacePoolStats gSurfacePoolStats    = { 0, 0, 0, 0, 0, 0, 0 };
+
+
+// Rounds n up to a multiple of an eighth of the power of two at or above it. That gives 
+// 4 classes per doubling, each wasting less than a quarter of the dimension.
+static int GetSizeClass(int n)
+{
+    if(n <= kMinSizeClass)
+        return kMinSizeClass;
+
+    int power = kMinSizeClass;
+    while(power < n)
+        power <<= 1;
+
+    const int step = power >> 3;
+    return (n + step - 1) & ~(step - 1);
+}
+
+
+// The size of the buffer, which is that of the size class rather than of the requested size.
+static uint32_t GetPooledSurfaceSize(const Surface* pSurface)
+{
+    return (uint32_t)(GetSizeClass(pSurface->mWidth) * GetSizeClass(pSurface->mHeight) * pSurface->mPixelFormat.mBytesPerPixel);
+}
+
+
+static void UpdateHighWater()
+{
+    const uint32_t size = gSurfacePoolStats.mInUseSize + gSurfacePoolStats.mPooledSize;
+
+    if(gSurfacePoolStats.mHighWaterSize < size)
+        gSurfacePoolStats.mHighWaterSize = size;
+}
+
+
+static void RemovePooledSurface(size_t i)
+{
+    WTF::Vector<Surface*>& pool = PooledSurfaces();
+    Surface* const pSurface = pool[i];
+
+    gSurfacePoolStats.mPooledCount--;
+    gSurfacePoolStats.mPooledSize -= GetPooledSurfaceSize(pSurface);
+    pool.remove(i);
+}
+
+
+EARASTER_API Surface* AcquirePooledSurface(int width, int height, PixelFormatType pft)
+{
+    if((width <= 0) || (height <= 0))
+        return NULL;
+
+    const int classWidth  = GetSizeClass(width);
+    const int classHeight = GetSizeClass(height);
+
+    WTF::Vector<Surface*>& pool = PooledSurfaces();
+    Surface* pSurface = NULL;
+
+    gSurfacePoolStats.mAcquireCount++;
+
+    // The most recently released surface is the most likely to be in the CPU cache.
+    for(size_t i = pool.size(); i > 0; i--)
+    {
+        Surface* const pPooled = pool[i - 1];
+
+        if((pPooled->mPixelFormat.mPixelFormatType == pft) && 
+           (GetSizeClass(pPooled->mWidth) == classWidth) && 
+           (GetSizeClass(pPooled->mHeight) == classHeight))
+        {
+            pSurface = pPooled;
+            RemovePooledSurface(i - 1);
+            gSurfacePoolStats.mReuseCount++;
+            break;
+        }
+    }
+
+    if(!pSurface)
+    {
+        pSurface = CreateSurface(classWidth, classHeight, pft);
+
+        if(!pSurface)
+            return NULL;
+
+        pSurface->mSurfaceFlags |= kFlagPooled;
+    }
+
+    // The rows are packed from the start of the buffer, as the size class buffer is big enough for 
+    // any size in the class. Whatever the last user set up for drawing doesn't carry over.
+    pSurface->mWidth                     = width;
+    pSurface->mHeight                    = height;
+    pSurface->mStride                    = width * pSurface->mPixelFormat.mBytesPerPixel;
+    pSurface->mPixelFormat.mSurfaceAlpha = 255;
+    pSurface->mSurfaceFlags             &= ~kFlagAccumulateAlpha;
+    pSurface->mpUserData                 = NULL;
+    pSurface->mpClipRegion               = NULL;
+    pSurface->mpBlitDest                 = NULL;
+    pSurface->mDrawFlags                 = 0;
+    pSurface->mpBlitFunction             = NULL;
+    pSurface->SetAlphaRows(NULL);
+    pSurface->SetClipRect(NULL);
+
+    gSurfacePoolStats.mInUseCount++;
+    gSurfacePoolStats.mInUseSize += GetPooledSurfaceSize(pSurface);
+    UpdateHighWater();
+
+    return pSurface;
+}
+
+
+EARASTER_API void ReleasePooledSurface(Surface* pSurface)
+{
+    if(!pSurface)
+        return;
+
+    if((pSurface->mSurfaceFlags & kFlagPooled) == 0)
+    {
+        EAW_FAIL_MSG("ReleasePooledSurface: the surface didn't come from AcquirePooledSurface.");
+        DestroySurface(pSurface);
+        return;
+    }
+
+    const uint32_t size = GetPooledSurfaceSize(pSurface);
+
+    gSurfacePoolStats.mInUseCount--;
+    gSurfacePoolStats.mInUseSize -= size;
+
+    // A surface that somebody else still holds can't be handed out again.
+    if((pSurface->mRefCount > 1) || (size > gSurfacePoolCapacity))
+    {
+        DestroySurface(pSurface);
+        return;
+    }
+
+    PooledSurfaces().append(pSurface);
+    gSurfacePoolStats.mPooledCount++;
+    gSurfacePoolStats.mPooledSize += size;
+
+    TrimSurfacePool(gSurfacePoolCapacity);
+}
+
+
+EARASTER_API void SetSurfacePoolCapacity(uint32_t size)
+{
+    gSurfacePoolCapacity = size;
+    TrimSurfacePool(size);
+}
+
+
+EARASTER_API uint32_t GetSurfacePoolCapacity()
+{
+    return gSurfacePoolCapacity;
+}
+
+
+EARASTER_API void TrimSurfacePool(uint32_t size)
+{
+    WTF::Vector<Surface*>& pool = PooledSurfaces();
+
+    while(gSurfacePoolStats.mPooledSize > size)
+    {
+        Surface* const pSurface = pool[0];
+
+        RemovePooledSurface(0);
+        DestroySurface(pSurface);
+    }
+}
+
+
+EARASTER_API void GetSurfacePoolStats(SurfacePoolStats& stats)
+{
+    stats = gSurfacePoolStats;
+}
+
+
+EARASTER_API void ResetSurfacePoolHighWater()
+{
+    gSurfacePoolStats.mHighWaterSize = gSurfacePoolStats.mInUseSize + gSurfacePoolStats.mPooledSize;
+}
+
+
+} // namespace Raster
+
+} // namespace EA
@@ -43,6 +43,8 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <Cursor.h>
 #include <Cache.h>
 #include <PageCache.h>
+#include <ScaledImageCache.h>
+#include <ImageCompression.h>
 #include <FontCache.h>
 #include <ResourceHandleManager.h>
 #include <CookieManager.h>
@@ -76,6 +78,12 @@ namespace WebKit
 //////Time related  stuff
 EAWebKitTimerCallback gTimerCallback = NULL;
 
+//////Raster job dispatching
+static EAWebKitRasterJobDispatcher gRasterJobDispatcher = NULL;
+
+//////Image decode job dispatching
+static EAWebKitImageDecodeJobDispatcher gImageDecodeJobDispatcher = NULL;
+
 // Temporary assertion while we figure out the best way to define cursor ids.
 // See the definition of EA::WebKit::CursorId for a discussion of this.
 //EA_COMPILETIME_ASSERT(((int)EA::WebKit::kCursorIdCount == (int)WKAL::kCursorIdCount) && ((int)EA::WebKit::kCursorIdNone == (int)WKAL::kCursorIdNone));
@@ -349,6 +357,31 @@ EAWEBKIT_API void GetRAMCacheUsage(EA::WebKit::RAMCacheInfo& ramCacheInfo)
 }
 
 
+EAWEBKIT_API void SetRAMCacheBudgets(const EA::WebKit::RAMCacheBudgets& ramCacheBudgets)
+{
+    WKAL::scaledImageCache()->setCapacity((unsigned)ramCacheBudgets.mScaledImageCacheSize);
+    WKAL::BCImageCompressionEA::SetUnpackedImageCacheCapacity((unsigned)ramCacheBudgets.mUnpackedImageCacheSize);
+    EA::Raster::SetSurfacePoolCapacity(ramCacheBudgets.mSurfacePoolSize);
+    WebCore::cache()->setDecodedImageCapacity((unsigned)ramCacheBudgets.mDecodedImageCacheSize);
+}
+
+
+EAWEBKIT_API void GetRAMCacheBudgets(EA::WebKit::RAMCacheBudgets& ramCacheBudgets)
+{
+    // Scaled image cache. Its current size is already included in the RAM cache live size.
+    ramCacheBudgets.mScaledImageCacheSize = WKAL::scaledImageCache()->capacity();
+
+    // Decompressed image cache. This one isn't part of the live size, as the images it holds are already counted compressed.
+    ramCacheBudgets.mUnpackedImageCacheSize = WKAL::BCImageCompressionEA::GetUnpackedImageCacheCapacity();
+
+    // Scratch surfaces. EA::Raster::GetSurfacePoolStats has the sizes in use and their high-water mark.
+    ramCacheBudgets.mSurfacePoolSize = EA::Raster::GetSurfacePoolCapacity();
+
+    // Decoded images of the RAM cache.
+    ramCacheBudgets.mDecodedImageCacheSize = WebCore::cache()->decodedImageCapacity();
+}
+
+
 EAWEBKIT_API void GetDiskCacheUsage(EA::WebKit::DiskCacheInfo& diskCacheInfo)
 {
 	//Note by Arpit Baldeva: I commented out memset and pRHM->GetCacheDirectory of this function. I don't understand the use of this function the way
@@ -379,6 +412,10 @@ EAWEBKIT_API void PurgeCache(bool bPurgeRAMCache, bool bPurgeFontCache, bool bPu
         const int capacitySaved = pPageCache->capacity();
         pPageCache->setCapacity(0);
         pPageCache->setCapacity(capacitySaved);
+
+        WKAL::scaledImageCache()->clear();
+        WKAL::BCImageCompressionEA::ClearUnpackedImageCache();
+        EA::Raster::TrimSurfacePool(0);
     }
 
     if(bPurgeFontCache)
@@ -483,6 +520,26 @@ EAWEBKIT_API void SetHighResolutionTimer(EAWebKitTimerCallback timer)
 	gTimerCallback = timer;
 }
 
+EAWEBKIT_API void SetRasterJobDispatcher(EAWebKitRasterJobDispatcher dispatcher)
+{
+	gRasterJobDispatcher = dispatcher;
+}
+
+EAWEBKIT_API EAWebKitRasterJobDispatcher GetRasterJobDispatcher()
+{
+	return gRasterJobDispatcher;
+}
+
+EAWEBKIT_API void SetImageDecodeJobDispatcher(EAWebKitImageDecodeJobDispatcher dispatcher)
+{
+	gImageDecodeJobDispatcher = dispatcher;
+}
+
+EAWEBKIT_API EAWebKitImageDecodeJobDispatcher GetImageDecodeJobDispatcher()
+{
+	return gImageDecodeJobDispatcher;
+}
+
 
 ///////////////////////////////////////////////////////////////////////
 // Parameters 
@@ -1028,6 +1085,20 @@ namespace EA
 			EA::WebKit::GetRAMCacheUsage(ramCacheInfo);
 		}
 
+		void EAWebkitConcrete::SetRAMCacheBudgets(const EA::WebKit::RAMCacheBudgets& ramCacheBudgets)
+		{
+			EAW_ASSERT_MSG( (GetWebKitStatus() == kWebKitStatusActive), "Did you call EAWebKit::Init()?");
+
+			EA::WebKit::SetRAMCacheBudgets(ramCacheBudgets);
+		}
+
+		void EAWebkitConcrete::GetRAMCacheBudgets(EA::WebKit::RAMCacheBudgets& ramCacheBudgets)
+		{
+			EAW_ASSERT_MSG( (GetWebKitStatus() == kWebKitStatusActive), "Did you call EAWebKit::Init()?");
+
+			EA::WebKit::GetRAMCacheBudgets(ramCacheBudgets);
+		}
+
 		bool EAWebkitConcrete::SetDiskCacheUsage(const EA::WebKit::DiskCacheInfo& diskCacheInfo)
 		{
 			EAW_ASSERT_MSG( (GetWebKitStatus() == kWebKitStatusActive), "Did you call EAWebKit::Init()?");
@@ -1091,6 +1162,34 @@ namespace EA
 			EA::WebKit::SetHighResolutionTimer(timer);
 		}
 
+		void EAWebkitConcrete::SetRasterJobDispatcher(EAWebKitRasterJobDispatcher dispatcher)
+		{
+			EAW_ASSERT_MSG( (GetWebKitStatus() == kWebKitStatusActive), "Did you call EAWebKit::Init()?");
+
+			EA::WebKit::SetRasterJobDispatcher(dispatcher);
+		}
+
+		EAWebKitRasterJobDispatcher EAWebkitConcrete::GetRasterJobDispatcher()
+		{
+			EAW_ASSERT_MSG( (GetWebKitStatus() == kWebKitStatusActive), "Did you call EAWebKit::Init()?");
+
+			return EA::WebKit::GetRasterJobDispatcher();
+		}
+
+		void EAWebkitConcrete::SetImageDecodeJobDispatcher(EAWebKitImageDecodeJobDispatcher dispatcher)
+		{
+			EAW_ASSERT_MSG( (GetWebKitStatus() == kWebKitStatusActive), "Did you call EAWebKit::Init()?");
+
+			EA::WebKit::SetImageDecodeJobDispatcher(dispatcher);
+		}
+
+		EAWebKitImageDecodeJobDispatcher EAWebkitConcrete::GetImageDecodeJobDispatcher()
+		{
+			EAW_ASSERT_MSG( (GetWebKitStatus() == kWebKitStatusActive), "Did you call EAWebKit::Init()?");
+
+			return EA::WebKit::GetImageDecodeJobDispatcher();
+		}
+
 		void EAWebkitConcrete::SetParameters(const Parameters& parameters)
 		{
 			EAW_ASSERT_MSG( (GetWebKitStatus() == kWebKitStatusActive), "Did you call EAWebKit::Init()?");
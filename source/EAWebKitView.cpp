@@ -367,7 +367,9 @@ View::View()
 	mNavigatorTheta(PI_4),
 	mURI(),
 	mJavascriptBindingObject(0),
-    mJavascriptBindingObjectName(0)
+    mJavascriptBindingObjectName(0),
+    mViewSurfaceParameters(),
+    mbVisible(true)
 {
     gViewPtrArray.push_back(this);
 	mNodeListContainer = WTF::fastNew<NodeListContainer> ();
@@ -405,7 +407,7 @@ bool View::InitView(const ViewParameters& vp)
 	mViewParameters = vp;
 
     if(!mpSurface)
-        mpSurface = EA::Raster::CreateSurface(vp.mWidth, vp.mHeight, EA::Raster::kPixelFormatTypeARGB);
+        mpSurface = EA::Raster::CreateSurface(vp.mWidth, vp.mHeight, mViewSurfaceParameters.mPixelFormat);
 
     if(mpSurface)
     {
@@ -512,7 +514,7 @@ bool View::SetSize(int w, int h)
             bResult = mpSurface->Resize(w, h, false);
         else
         {
-            mpSurface = EA::Raster::CreateSurface(w, h, EA::Raster::kPixelFormatTypeARGB);
+            mpSurface = EA::Raster::CreateSurface(w, h, mViewSurfaceParameters.mPixelFormat);
             bResult   = (mpSurface != NULL);
         }
     }
@@ -719,6 +721,12 @@ EA::WebKit::JavascriptValue View::EvaluateJavaScript(const char* pScriptSource,
 
 
 bool View::Tick()
+{
+	return TickWithDeadline(0.0);
+}
+
+
+bool View::TickWithDeadline(double deadline)
 {
 	SET_AUTOFPUPRECISION(kFPUPrecisionExtended);   
 	
@@ -727,7 +735,13 @@ bool View::Tick()
     // Notify tick start callback (this is already known by the user but groups it with other profile calls)
     NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeViewTick, EA::WebKit::kVProcessStatusStarted);
 
-	WTF::dispatchFunctionsFromMainThread();
+    // The work below checks this deadline between units of work.
+    WebCore::setTickDeadline(deadline);
+
+    if(deadline)
+        WTF::dispatchFunctionsFromMainThread(WebCore::tickDeadlinePassed);
+    else
+        WTF::dispatchFunctionsFromMainThread();
 
 	NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeTransportTick, EA::WebKit::kVProcessStatusStarted);
 	
@@ -758,6 +772,20 @@ bool View::Tick()
   			NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeDraw, EA::WebKit::kVProcessStatusEnded);
         }
     }
+    else if(pFrameView && mpWebView && mViewSurfaceParameters.mbTiledBackingStore && !mpWebView->isLoading())
+    {
+        // Nothing to draw this tick, so use a little time to paint tiles ahead of the scroll.
+        const double kTilePaintAheadTime = 0.004;   // In seconds.
+        double       timeLimit = kTilePaintAheadTime;
+
+        if(deadline && ((deadline - EA::WebKit::GetTime()) < timeLimit))
+            timeLimit = deadline - EA::WebKit::GetTime();
+
+        if(timeLimit > 0)
+            pFrameView->paintTilesAhead(timeLimit);
+    }
+
+    WebCore::setTickDeadline(0);
 
     // Notify tick end callback (this is already known by the user but groups it with other profile calls)
 	NOTIFY_PROCESS_STATUS(EA::WebKit::kVProcessTypeViewTick, EA::WebKit::kVProcessStatusEnded);
@@ -838,6 +866,35 @@ void View::GetScrollOffset(int& x, int& y)
 }
 
 
+void View::SetVisible(bool bVisible)
+{
+	SET_AUTOFPUPRECISION(kFPUPrecisionExtended);   
+    if(mbVisible == bVisible)
+        return;
+
+    // The frame views ask for this through ScrollView::inWindow().
+    mbVisible = bVisible;
+
+    if(bVisible)
+        RedrawArea();   // Restarts the animations and redecodes the images that were dropped while hidden.
+    else
+        WebCore::cache()->pruneDecodedImages();
+}
+
+
+bool View::IsVisible() const
+{
+    return mbVisible;
+}
+
+
+void View::SetSurfaceParameters(const ViewSurfaceParameters& sp)
+{
+    EAW_ASSERT(!mpWebView); // If this fails, you are calling SetSurfaceParameters after InitView.
+    mViewSurfaceParameters = sp;
+}
+
+
 void View::OnKeyboardEvent(const KeyboardEvent& keyboardEvent)
 {
 	SET_AUTOFPUPRECISION(kFPUPrecisionExtended);   